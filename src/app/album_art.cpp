@@ -0,0 +1,227 @@
+#include "album_art.h"
+#include "config.h"
+#include "http_pool.h"
+#include "http_body_stream.h"
+#include "jpeg_decoder.h"
+#include "metrics.h"
+
+#include <HTTPClient.h>
+#include <mutex>
+
+#define ALBUM_ART_URI_LEN 64
+
+struct CoverEntry
+{
+    char uri[ALBUM_ART_URI_LEN]; // Empty while the slot is free or being filled
+    uint16_t *pixels;
+    uint32_t lastUsed;
+};
+
+struct AlbumArtWidget
+{
+    lv_image_dsc_t image;
+    char uri[ALBUM_ART_URI_LEN];
+};
+
+static CoverEntry covers[ALBUM_ART_CACHE_SIZE];
+static uint32_t useCounter;
+static AlbumArtStats stats;
+static std::mutex coverMutex;
+
+static CoverEntry *findCover(const char *albumUri)
+{
+    for (CoverEntry &cover : covers)
+    {
+        if (cover.uri[0] && strcmp(cover.uri, albumUri) == 0)
+            return &cover;
+    }
+    return NULL;
+}
+
+/**
+ * Picks the slot to decode into: a free one, else the least recently used.
+ * Its key is cleared so guiTask can't copy it while it is overwritten.
+ */
+static CoverEntry *claimSlot()
+{
+    CoverEntry *lru = NULL;
+    for (CoverEntry &cover : covers)
+    {
+        if (!cover.uri[0])
+        {
+            lru = &cover;
+            break;
+        }
+        if (!lru || cover.lastUsed < lru->lastUsed)
+            lru = &cover;
+    }
+
+    if (lru->uri[0])
+        stats.evictions++;
+    lru->uri[0] = '\0';
+
+    // Allocated on first use and then kept, so the heap doesn't fragment
+    if (!lru->pixels)
+    {
+        lru->pixels = (uint16_t *)ps_malloc(ALBUM_ART_BYTES);
+        if (!lru->pixels)
+            lru->pixels = (uint16_t *)malloc(ALBUM_ART_BYTES);
+    }
+    return lru->pixels ? lru : NULL;
+}
+
+static bool downloadCover(const String &imageUrl, uint16_t *pixels)
+{
+    HTTPClient *http = HttpPool::begin(imageUrl);
+    if (!http)
+        return false;
+
+    bool decoded = false;
+    int httpResponseCode = HttpPool::GET(http);
+    if (httpResponseCode == HTTP_CODE_OK)
+    {
+        // Smaller images would leave stale pixels from the previous cover
+        memset(pixels, 0, ALBUM_ART_BYTES);
+
+        HttpBodyStream body(*http);
+        decoded = decodeJpegRgb565(body, pixels, ALBUM_ART_SIZE, ALBUM_ART_SIZE);
+    }
+    else
+    {
+        Serial.printf("Album art request failed: %d\n", httpResponseCode);
+    }
+
+    HttpPool::end(http);
+    return decoded;
+}
+
+bool AlbumArtCache::fetch(const String &albumUri, const String &imageUrl)
+{
+    if (albumUri.isEmpty() || albumUri.length() >= ALBUM_ART_URI_LEN || imageUrl.isEmpty())
+        return false;
+
+    CoverEntry *slot;
+    {
+        std::lock_guard<std::mutex> lock(coverMutex);
+        CoverEntry *cover = findCover(albumUri.c_str());
+        if (cover)
+        {
+            cover->lastUsed = ++useCounter;
+            stats.hits++;
+            return true;
+        }
+
+        slot = claimSlot();
+        if (!slot)
+            return false;
+    }
+
+    // Only this task writes to the cache, so the slot can be filled unlocked
+    uint32_t start = millis();
+    bool decoded = downloadCover(imageUrl, slot->pixels);
+    uint32_t elapsed = millis() - start;
+
+    std::lock_guard<std::mutex> lock(coverMutex);
+    if (!decoded)
+    {
+        stats.failures++;
+        return false;
+    }
+
+    strcpy(slot->uri, albumUri.c_str());
+    slot->lastUsed = ++useCounter;
+    stats.misses++;
+    stats.fetchMsTotal += elapsed;
+    if (elapsed > stats.fetchMsMax)
+        stats.fetchMsMax = elapsed;
+    return true;
+}
+
+bool AlbumArtCache::copy(const char *albumUri, uint16_t *pixels)
+{
+    std::lock_guard<std::mutex> lock(coverMutex);
+    CoverEntry *cover = findCover(albumUri);
+    if (!cover)
+        return false;
+
+    memcpy(pixels, cover->pixels, ALBUM_ART_BYTES);
+    return true;
+}
+
+AlbumArtStats AlbumArtCache::getStats()
+{
+    std::lock_guard<std::mutex> lock(coverMutex);
+    return stats;
+}
+
+static void deleteCb(lv_event_t *e)
+{
+    lv_obj_t *image = (lv_obj_t *)lv_event_get_target(e);
+    AlbumArtWidget *widget = (AlbumArtWidget *)lv_obj_get_user_data(image);
+    free((void *)widget->image.data);
+    free(widget);
+}
+
+static void exportMetrics()
+{
+    static Metric *hits = Metrics::counter("art.hits");
+    static Metric *misses = Metrics::counter("art.misses");
+    static Metric *failures = Metrics::counter("art.failures");
+    static Metric *evictions = Metrics::counter("art.evictions");
+
+    AlbumArtStats current = AlbumArtCache::getStats();
+    hits->set(current.hits);
+    misses->set(current.misses);
+    failures->set(current.failures);
+    evictions->set(current.evictions);
+}
+
+lv_obj_t *albumArtCreate(lv_obj_t *parent)
+{
+    Metrics::addSource(exportMetrics);
+    AlbumArtWidget *widget = (AlbumArtWidget *)calloc(1, sizeof(AlbumArtWidget));
+    uint8_t *data = (uint8_t *)malloc(ALBUM_ART_BYTES);
+    if (!widget || !data)
+    {
+        free(widget);
+        free(data);
+        return NULL;
+    }
+
+    widget->image.header.magic = LV_IMAGE_HEADER_MAGIC;
+    widget->image.header.cf = LV_COLOR_FORMAT_RGB565;
+    widget->image.header.w = ALBUM_ART_SIZE;
+    widget->image.header.h = ALBUM_ART_SIZE;
+    widget->image.header.stride = ALBUM_ART_SIZE * sizeof(uint16_t);
+    widget->image.data_size = ALBUM_ART_BYTES;
+    widget->image.data = data;
+
+    lv_obj_t *image = lv_image_create(parent);
+    lv_obj_set_size(image, ALBUM_ART_SIZE, ALBUM_ART_SIZE);
+    lv_obj_add_flag(image, LV_OBJ_FLAG_HIDDEN);
+    lv_obj_set_user_data(image, widget);
+    lv_obj_add_event_cb(image, deleteCb, LV_EVENT_DELETE, NULL);
+    return image;
+}
+
+void albumArtSetText(lv_obj_t *image, const char *albumUri)
+{
+    AlbumArtWidget *widget = (AlbumArtWidget *)lv_obj_get_user_data(image);
+    if (strcmp(widget->uri, albumUri) == 0)
+        return;
+
+    if (!albumUri[0] || !AlbumArtCache::copy(albumUri, (uint16_t *)widget->image.data))
+    {
+        widget->uri[0] = '\0';
+        lv_obj_add_flag(image, LV_OBJ_FLAG_HIDDEN);
+        return;
+    }
+
+    strncpy(widget->uri, albumUri, sizeof(widget->uri) - 1);
+
+    // Same descriptor, new pixels: drop whatever LVGL cached for it
+    lv_image_cache_drop(&widget->image);
+    lv_image_set_src(image, &widget->image);
+    lv_obj_remove_flag(image, LV_OBJ_FLAG_HIDDEN);
+    lv_obj_invalidate(image);
+}
@@ -0,0 +1,57 @@
+#pragma once
+
+#include <Arduino.h>
+#include <lvgl.h>
+
+#define ALBUM_ART_SIZE 64 // The smallest cover Spotify offers
+#define ALBUM_ART_BYTES (ALBUM_ART_SIZE * ALBUM_ART_SIZE * sizeof(uint16_t))
+
+struct AlbumArtStats
+{
+    uint32_t hits;           // Covers already in the cache
+    uint32_t misses;         // Covers downloaded and decoded
+    uint32_t failures;       // Downloads or decodes that failed
+    uint32_t evictions;      // Covers dropped to make room
+    uint32_t fetchMsTotal;   // Time spent downloading and decoding misses
+    uint32_t fetchMsMax;
+};
+
+/**
+ * Decoded album covers, least recently used first out, keyed by album URI
+ * so every track of an album shares one entry. Covers are stored as RGB565
+ * ready to draw, in PSRAM when the board has it. The Spotify task fills the
+ * cache and guiTask copies out of it.
+ */
+class AlbumArtCache
+{
+public:
+    /**
+     * Makes sure an album's cover is cached, streaming the JPEG through the
+     * decoder on a miss
+     * @param albumUri Cache key
+     * @param imageUrl 64x64 JPEG to download on a miss
+     * @return false if the cover could not be downloaded or decoded
+     */
+    static bool fetch(const String &albumUri, const String &imageUrl);
+
+    /**
+     * Copies a cached cover out
+     * @param pixels ALBUM_ART_SIZE x ALBUM_ART_SIZE RGB565 buffer
+     * @return false if the album is not cached (any more)
+     */
+    static bool copy(const char *albumUri, uint16_t *pixels);
+
+    static AlbumArtStats getStats();
+};
+
+/**
+ * Creates the cover image, hidden until a cover is set
+ * @return The image, or NULL if its buffer could not be allocated
+ */
+lv_obj_t *albumArtCreate(lv_obj_t *parent);
+
+/**
+ * UiLabelSetter for the cover: the text is the album URI to show from the
+ * cache, and an empty text hides the image
+ */
+void albumArtSetText(lv_obj_t *image, const char *albumUri);
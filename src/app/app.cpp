@@ -4,34 +4,43 @@
 
 #include "app.h"
 #include "hardware.h"
-#include "lv_util.h"
+#include "ui_queue.h"
+#include "label_diff.h"
 #include "weather.h"
 #include "spotify.h"
 #include "calendar.h"
+#include "clock_widget.h"
+#include "marquee.h"
+#include "song_progress.h"
+#include "album_art.h"
 #include "config.h"
+#include "fetch_scheduler.h"
+#include "ui_cache.h"
+#include "boot_timeline.h"
+#include "wifi_manager.h"
+#include "time_service.h"
+#include "metrics.h"
+#include "clock_tick.h"
+#include "touch_calibration.h"
 
 static lv_obj_t *timeLabel;
 static lv_obj_t *dateLabel;
 static lv_obj_t *temperatureLabel;
 static lv_obj_t *songLabel;
+static lv_obj_t *songProgress;
+static lv_obj_t *albumArt;
 static lv_obj_t *calendarLabel;
 
-static void updateTimeLabel(const char *text)
+/**
+ * Touching the song refreshes it, for a skip made since the last poll
+ */
+static void songClickedCb(lv_event_t *e)
 {
-    GUILock lock;
-    lv_label_set_text(timeLabel, text);
+    SpotifyClient::pollNow();
 }
 
-static void updateDateLabel(const char *text)
+void setupUI()
 {
-    GUILock lock;
-    lv_label_set_text(dateLabel, text);
-}
-
-static void setupUI()
-{
-    GUILock lock;
-
     lv_obj_set_style_bg_color(lv_scr_act(), lv_color_hex(0x000000), LV_PART_MAIN);
 
     lv_obj_t *centerContainer = lv_obj_create(lv_scr_act());
@@ -47,10 +56,19 @@ static void setupUI()
     lv_obj_set_style_text_color(dateLabel, lv_color_hex(0xf1f3f3), LV_PART_MAIN);
     lv_label_set_text(dateLabel, "Date");
 
-    timeLabel = lv_label_create(centerContainer);
-    lv_obj_set_style_text_font(timeLabel, &lv_font_montserrat_48, LV_PART_MAIN);
-    lv_obj_set_style_text_color(timeLabel, lv_color_hex(0x60e083), LV_PART_MAIN);
-    lv_label_set_text(timeLabel, "Loading...");
+    timeLabel = clockWidgetCreate(centerContainer, &lv_font_montserrat_48, lv_color_hex(0x60e083), lv_color_hex(0x000000));
+    if (timeLabel)
+    {
+        uiBindLabel(UI_LABEL_TIME, timeLabel, clockWidgetSetText);
+    }
+    else
+    {
+        timeLabel = lv_label_create(centerContainer);
+        lv_obj_set_style_text_font(timeLabel, &lv_font_montserrat_48, LV_PART_MAIN);
+        lv_obj_set_style_text_color(timeLabel, lv_color_hex(0x60e083), LV_PART_MAIN);
+        lv_label_set_text(timeLabel, "Loading...");
+        uiBindLabel(UI_LABEL_TIME, timeLabel, setLabelTextDiff);
+    }
 
     calendarLabel = lv_label_create(centerContainer);
     lv_obj_set_style_text_font(calendarLabel, &lv_font_montserrat_14, LV_PART_MAIN);
@@ -66,58 +84,121 @@ static void setupUI()
     lv_label_set_text(temperatureLabel, "Weather");
     lv_obj_align(temperatureLabel, LV_ALIGN_TOP_RIGHT, -10, 10);
 
-    songLabel = lv_label_create(lv_scr_act());
-    lv_obj_set_style_text_font(songLabel, &lv_font_montserrat_16, LV_PART_MAIN);
-    lv_obj_set_style_text_color(songLabel, lv_color_hex(0x7c9181), LV_PART_MAIN);
-    lv_label_set_text(songLabel, "Spotify");
-    lv_obj_set_width(songLabel, LV_PCT(100));
-    lv_label_set_long_mode(songLabel, LV_LABEL_LONG_SCROLL_CIRCULAR);
-    lv_obj_set_style_text_align(songLabel, LV_TEXT_ALIGN_CENTER, LV_PART_MAIN);
+    songLabel = marqueeCreate(lv_scr_act(), SCREEN_HOR_RES, &lv_font_montserrat_16, lv_color_hex(0x7c9181),
+                              lv_color_hex(0x000000));
+    marqueeSetText(songLabel, "Spotify");
     lv_obj_align(songLabel, LV_ALIGN_BOTTOM_MID, 0, -10);
+    lv_obj_add_flag(songLabel, LV_OBJ_FLAG_CLICKABLE);
+    lv_obj_set_ext_click_area(songLabel, 10);
+    lv_obj_add_event_cb(songLabel, songClickedCb, LV_EVENT_CLICKED, NULL);
+
+    songProgress = songProgressCreate(lv_scr_act(), 200, lv_color_hex(0x7c9181));
+    if (songProgress)
+    {
+        lv_obj_align(songProgress, LV_ALIGN_BOTTOM_MID, 0, -4);
+        uiBindLabel(UI_LABEL_SONG_PROGRESS, songProgress, songProgressSetText);
+    }
+
+    albumArt = albumArtCreate(lv_scr_act());
+    if (albumArt)
+    {
+        lv_obj_align(albumArt, LV_ALIGN_TOP_LEFT, 10, 10);
+        uiBindLabel(UI_LABEL_ALBUM_ART, albumArt, albumArtSetText);
+    }
+
+    uiBindLabel(UI_LABEL_DATE, dateLabel, setLabelTextDiff);
+    uiBindLabel(UI_LABEL_CALENDAR, calendarLabel, setLabelTextDiff);
+    uiBindLabel(UI_LABEL_TEMPERATURE, temperatureLabel, setLabelTextDiff);
+    uiBindLabel(UI_LABEL_SONG, songLabel, marqueeSetText);
+
+    // Last known weather, song and event instead of placeholders
+    uiCacheRestore();
+
+    // Holding the screen through boot asks for a new touch calibration
+    if (touchscreenPressed())
+        touchCalibrationStart();
+    bootMark(BOOT_EVENT_UI_BUILT);
 }
 
-void appTask(void *pvParameters)
+/**
+ * Fetches are paused rather than failed while the link is down. A clock
+ * carried over by the RTC is good enough to fetch with, but token expiry
+ * and calendar ranges are meaningless without one.
+ */
+static void updateNetworkReady()
 {
-    setupUI();
+    FetchScheduler::setNetworkReady(WiFiManager::isConnected() && TimeService::isSet());
+}
 
-    updateDateLabel("Connecting to WiFi...");
-    connectWiFi();
+static void onTimeSynced()
+{
+    bootMark(BOOT_EVENT_TIME_SYNCED);
+    updateNetworkReady();
+    ClockTick::kick(); // The clock may have been stepped
+}
 
-    updateDateLabel("Syncing time...");
-    syncTime();
+static void onWiFiStateChange(bool connected)
+{
+    static bool timeSyncStarted = false;
 
-    WeatherTaskData weatherData = {
-        .temperatureLabel = temperatureLabel,
-    };
+    if (connected)
+    {
+        bootMark(BOOT_EVENT_WIFI_CONNECTED);
+        if (!timeSyncStarted)
+        {
+            TimeService::startSync(onTimeSynced);
+            timeSyncStarted = true;
+        }
+    }
+    updateNetworkReady();
+    ClockTick::kick(); // Refreshes the status text while the time is unset
+}
 
-    SpotifyTaskData spotifyData = {
-        .songLabel = songLabel,
-    };
+void appTask(void *pvParameters)
+{
+    TimeService::begin();
 
-    CalendarTaskData calendarData = {
-        .eventLabel = calendarLabel,
-    };
+    // The display only changes once a minute; sleep through the rest
+    ClockTick::begin(CLOCK_SHOW_SECONDS ? CLOCK_TICK_SECOND : CLOCK_TICK_MINUTE);
 
-    xTaskCreatePinnedToCore(calendarTask, "calendar", 8192, &calendarData, 3, NULL, APP_CORE);
-    xTaskCreatePinnedToCore(weatherTask, "weather", 8192, &weatherData, 3, NULL, APP_CORE);
-    xTaskCreatePinnedToCore(spotifyTask, "spotify", 8192, &spotifyData, 3, NULL, APP_CORE);
+    // One worker runs every fetch, instead of a task (and stack) per API.
+    // It starts before WiFi so the calendar is ranked from its cache at once.
+    uint32_t freeHeapBefore = ESP.getFreeHeap();
+    registerSpotifyJobs();
+    registerCalendarJobs();
+    registerWeatherJobs();
+    Metrics::registerSamplerJob();
+    FetchScheduler::start(NETWORK_STACK_SIZE, 3, APP_CORE);
+    Serial.printf("Network worker started: free heap %u -> %u bytes\n", (unsigned)freeHeapBefore,
+                  (unsigned)ESP.getFreeHeap());
 
-    TickType_t xLastWakeTime = xTaskGetTickCount();
+    WiFiManager::start(onWiFiStateChange, WIFI_STACK_SIZE, 4, APP_CORE);
 
     while (1)
     {
+        // After a power loss there is no time to show until NTP answers. A
+        // time sync or link change kicks this early.
+        if (!TimeService::isSet())
+        {
+            ClockTick::post(UI_LABEL_DATE, WiFiManager::isConnected() ? "Syncing time..." : "Connecting to WiFi...");
+            ClockTick::waitFor(1000);
+            continue;
+        }
+
         struct tm timeinfo;
-        getLocalTime(&timeinfo);
+        TimeService::localTime(&timeinfo);
 
-        char timeBuff[32];
-        strftime(timeBuff, sizeof(timeBuff), "%l:%M %p", &timeinfo);
-        updateTimeLabel(timeBuff);
+        char timeBuff[CLOCK_TICK_TEXT_SIZE];
+        strftime(timeBuff, sizeof(timeBuff), CLOCK_SHOW_SECONDS ? "%l:%M:%S %p" : "%l:%M %p", &timeinfo);
+        ClockTick::post(UI_LABEL_TIME, timeBuff);
+        bootMark(BOOT_EVENT_CLOCK_SHOWN);
 
-        char dateBuff[32];
+        // Changes at midnight, which is a minute boundary like any other
+        char dateBuff[CLOCK_TICK_TEXT_SIZE];
         strftime(dateBuff, sizeof(dateBuff), "%a, %b %d %Y", &timeinfo);
-        updateDateLabel(dateBuff);
+        ClockTick::post(UI_LABEL_DATE, dateBuff);
 
-        vTaskDelayUntil(&xLastWakeTime, pdMS_TO_TICKS(1000));
+        ClockTick::wait();
     }
 
     vTaskDelete(NULL);
@@ -1,3 +1,9 @@
 #pragma once
 
+/**
+ * Creates the clock screen and binds its labels to the UI update queues.
+ * Must run before guiTask starts.
+ */
+void setupUI();
+
 void appTask(void *pvParameters);
@@ -3,296 +3,512 @@
 #include <Arduino.h>
 #include <ArduinoJson.h>
 #include <HTTPClient.h>
+#include <Preferences.h>
 #include <time.h>
 
-#include "lv_util.h"
+#include "ui_queue.h"
+#include "http_pool.h"
+#include "http_body_stream.h"
+#include "fetch_scheduler.h"
+#include "oauth_token.h"
+#include "ui_cache.h"
+#include "boot_timeline.h"
+#include "time_service.h"
+#include "rfc3339.h"
+#include "trace.h"
 #include "config.h"
 #include "secrets.h"
 
-#define CALENDAR_UPDATE_INTERVAL_MIN 1 // Increased from 1 to 5 minutes to reduce API calls
+#define CALENDAR_UPDATE_INTERVAL_MIN 5 // Only picks up edits; the label is recomputed every second from the cache
+#define CALENDAR_UPDATE_SLACK_SEC 60   // May run this early to share a radio wakeup
+#define CALENDAR_RANK_INTERVAL_MS 1000
 #define GOOGLE_OAUTH_URL "https://oauth2.googleapis.com/token"
 #define GOOGLE_CALENDAR_API_URL "https://www.googleapis.com/calendar/v3/calendars/primary/events"
-#define MAX_CALENDAR_EVENTS 3 // Reduced from 5 to 3 events
+#define CALENDAR_CACHE_SIZE 16
+#define CALENDAR_PAGE_SIZE CALENDAR_CACHE_SIZE
+#define CALENDAR_MAX_PAGES 10       // Bounds a full incremental sync
+#define CALENDAR_JSON_CAPACITY 6144 // One filtered page of CALENDAR_PAGE_SIZE events
+#define CALENDAR_LOOKAHEAD_HOURS 2  // Events starting later are not shown
+#define CALENDAR_HORIZON_HOURS 24   // Range fetched and cached
+// Full sync interval in CALENDAR_SYNC_TOKEN mode. Deltas only mention changed
+// events, so each full sync must cover the lookahead until the next one.
+#define CALENDAR_RESYNC_HOURS (CALENDAR_HORIZON_HOURS - CALENDAR_LOOKAHEAD_HOURS)
+#define CALENDAR_NVS_NAMESPACE "calendar"
+#define CALENDAR_NVS_TEXT_LEN 63 // Stored titles, locations and ids are cut to this
 
 // Function declarations
 String formatEventTime(time_t eventTime);
 String urlEncode(const String &str);
 
-// Statics initialization
-String GoogleCalendarClient::accessToken = "";
-uint32_t GoogleCalendarClient::lastTokenRefresh = 0;
+static OAuthToken googleToken("google", GOOGLE_OAUTH_URL, GOOGLE_CLIENT_ID, GOOGLE_CLIENT_SECRET,
+                              GOOGLE_REFRESH_TOKEN, OAUTH_CLIENT_AUTH_BODY);
 
-time_t GoogleCalendarClient::parseISODateTime(const char *dateTime)
+// Statics initialization
+CalendarSyncMode GoogleCalendarClient::syncMode = CALENDAR_SYNC_MODE;
+GoogleCalendarClient::CachedEvent GoogleCalendarClient::cache[CALENDAR_CACHE_SIZE];
+int GoogleCalendarClient::cacheCount = 0;
+String GoogleCalendarClient::cacheUrl = "";
+String GoogleCalendarClient::etag = "";
+String GoogleCalendarClient::syncToken = "";
+String GoogleCalendarClient::nextPageToken = "";
+time_t GoogleCalendarClient::lastFullSync = 0;
+bool GoogleCalendarClient::cacheDirty = false;
+
+void GoogleCalendarClient::setSyncMode(CalendarSyncMode mode)
 {
-    // Format: YYYY-MM-DDTHH:MM:SSZ
-    struct tm tm = {};
-    char temp[5] = {0};
-
-    // Parse year
-    strncpy(temp, dateTime, 4);
-    tm.tm_year = atoi(temp) - 1900;
-
-    // Parse month
-    strncpy(temp, dateTime + 5, 2);
-    temp[2] = '\0';
-    tm.tm_mon = atoi(temp) - 1;
-
-    // Parse day
-    strncpy(temp, dateTime + 8, 2);
-    temp[2] = '\0';
-    tm.tm_mday = atoi(temp);
-
-    // Parse hour
-    strncpy(temp, dateTime + 11, 2);
-    temp[2] = '\0';
-    tm.tm_hour = atoi(temp);
-
-    // Parse minute
-    strncpy(temp, dateTime + 14, 2);
-    temp[2] = '\0';
-    tm.tm_min = atoi(temp);
-
-    // Parse second
-    strncpy(temp, dateTime + 17, 2);
-    temp[2] = '\0';
-    tm.tm_sec = atoi(temp);
-
-    return mktime(&tm);
+    syncMode = mode;
+    cacheCount = 0;
+    cacheUrl = "";
+    etag = "";
+    syncToken = "";
+    lastFullSync = 0;
 }
 
-bool GoogleCalendarClient::shouldRefreshToken()
+void GoogleCalendarClient::createCalendarFilter(JsonDocument &filter)
 {
-    return accessToken.isEmpty() || (millis() - lastTokenRefresh > 3540000); // ~59 minutes
+    filter["nextPageToken"] = true;
+    filter["nextSyncToken"] = true;
+
+    JsonObject items_0 = filter["items"].createNestedObject();
+    items_0["id"] = true;
+    items_0["status"] = true;
+    items_0["summary"] = true;
+    items_0["location"] = true;
+
+    JsonObject start = items_0.createNestedObject("start");
+    start["dateTime"] = true;
+
+    JsonObject end = items_0.createNestedObject("end");
+    end["dateTime"] = true;
 }
 
-String GoogleCalendarClient::getToken()
+void GoogleCalendarClient::cacheEvent(const String &id, const CalendarEvent &event, time_t now)
 {
-    if (!shouldRefreshToken())
+    // With no clock there is no horizon to check against; keep the event
+    // until a refresh with the time set replaces the cache
+    if (now > 0 && (event.endTime < now || event.startTime > now + CALENDAR_HORIZON_HOURS * 3600))
     {
-        return accessToken;
+        removeCachedEvent(id);
+        return;
     }
 
-    Serial.println("Refreshing token...");
-
-    HTTPClient http;
-    http.begin(GOOGLE_OAUTH_URL);
-    http.addHeader("Content-Type", "application/x-www-form-urlencoded");
-
-    String postData = "client_id=" + String(GOOGLE_CLIENT_ID) +
-                      "&client_secret=" + String(GOOGLE_CLIENT_SECRET) +
-                      "&refresh_token=" + String(GOOGLE_REFRESH_TOKEN) +
-                      "&grant_type=refresh_token";
+    // Update in place, else take a free slot, else replace an ended or the
+    // latest-starting event if this one is sooner
+    int slot = -1;
+    for (int i = 0; i < cacheCount && slot < 0; i++)
+    {
+        if (cache[i].id == id)
+            slot = i;
+    }
 
-    int httpCode = http.POST(postData);
+    if (slot < 0 && cacheCount < CALENDAR_CACHE_SIZE)
+        slot = cacheCount++;
 
-    if (httpCode == HTTP_CODE_OK)
+    for (int i = 0; i < cacheCount && slot < 0; i++)
     {
-        String response = http.getString();
-
-        StaticJsonDocument<512> doc; // Reduced from 1024 to 512 bytes
-        DeserializationError error = deserializeJson(doc, response);
+        if (cache[i].event.endTime < now)
+            slot = i;
+    }
 
-        if (!error)
+    if (slot < 0)
+    {
+        int latest = 0;
+        for (int i = 1; i < cacheCount; i++)
         {
-            accessToken = doc["access_token"].as<String>();
-            lastTokenRefresh = millis();
+            if (cache[i].event.startTime > cache[latest].event.startTime)
+                latest = i;
         }
+        if (cache[latest].event.startTime <= event.startTime)
+            return;
+        slot = latest;
     }
 
-    http.end();
-    return accessToken;
+    cache[slot].id = id;
+    cache[slot].event = event;
+    cacheDirty = true;
 }
 
-void GoogleCalendarClient::createCalendarFilter(JsonDocument &filter)
+void GoogleCalendarClient::removeCachedEvent(const String &id)
 {
-    JsonObject items_0 = filter["items"].createNestedObject();
-    items_0["summary"] = true;
-    items_0["location"] = true;
-
-    JsonObject start = items_0.createNestedObject("start");
-    start["dateTime"] = true;
-
-    JsonObject end = items_0.createNestedObject("end");
-    end["dateTime"] = true;
+    for (int i = 0; i < cacheCount; i++)
+    {
+        if (cache[i].id == id)
+        {
+            cache[i] = cache[--cacheCount];
+            cacheDirty = true;
+            return;
+        }
+    }
 }
 
-CalendarEvent GoogleCalendarClient::parseCalendarEvents(const String &response)
+bool GoogleCalendarClient::parseCalendarEvents(Stream &body, bool merge)
 {
-    CalendarEvent noEvent = {"No upcoming events", "", 0, 0, false};
+    StaticJsonDocument<256> filter;
+    createCalendarFilter(filter);
+
+    DynamicJsonDocument doc(CALENDAR_JSON_CAPACITY);
+    TRACE_BEGIN("json parse");
+    DeserializationError error = deserializeJson(doc, body, DeserializationOption::Filter(filter));
+    TRACE_END("json parse");
 
-    // Check for empty response
-    if (response.length() < 10)
+    if (error == DeserializationError::EmptyInput)
     {
         Serial.println("Empty calendar response");
-        return noEvent;
+        return false;
     }
 
-    StaticJsonDocument<128> filter;
-    createCalendarFilter(filter);
-
-    DynamicJsonDocument doc(1024);
-    DeserializationError error = deserializeJson(doc, response, DeserializationOption::Filter(filter));
-
     if (error)
     {
         Serial.print(F("Failed to parse calendar response: "));
         Serial.println(error.c_str());
-        return noEvent;
+        return false;
     }
 
-    JsonArray items = doc["items"];
-
-    if (items.size() == 0)
+    if (!merge)
     {
-        return noEvent;
+        cacheDirty = cacheDirty || cacheCount > 0;
+        cacheCount = 0;
     }
 
-    CalendarEvent events[MAX_CALENDAR_EVENTS];
-    int count = 0;
+    nextPageToken = doc["nextPageToken"] | "";
+    if (doc.containsKey("nextSyncToken"))
+        syncToken = doc["nextSyncToken"].as<String>();
 
-    time_t now = time(NULL);
-    time_t twoHoursFromNow = now + (2 * 60 * 60);
-
-    for (JsonObject item : items)
+    time_t now = TimeService::isSet() ? TimeService::now() : 0;
+    for (JsonObject item : doc["items"].as<JsonArray>())
     {
-        if (count >= MAX_CALENDAR_EVENTS)
-            break;
+        String id = item["id"] | "";
 
-        if (!item.containsKey("start") || !item.containsKey("end"))
-            continue;
-
-        const char *startDateTime = NULL;
-        if (item["start"].containsKey("dateTime"))
+        // Incremental sync reports deleted events as cancelled
+        if (item["status"] == "cancelled")
         {
-            startDateTime = item["start"]["dateTime"];
+            removeCachedEvent(id);
+            continue;
         }
 
-        if (!startDateTime)
+        // All-day events only have a date, not a dateTime
+        const char *startDateTime = item["start"]["dateTime"];
+        const char *endDateTime = item["end"]["dateTime"];
+        if (!startDateTime || !endDateTime)
             continue;
 
-        const char *endDateTime = NULL;
-        if (item["end"].containsKey("dateTime"))
+        CalendarEvent event;
+        if (!parseRfc3339(startDateTime, event.startTime) || !parseRfc3339(endDateTime, event.endTime))
+            continue;
+
+        event.title = item["summary"].as<String>();
+        event.location = item.containsKey("location") ? item["location"].as<String>() : "";
+        event.isActive = false;
+
+        cacheEvent(id, event, now);
+    }
+
+    return true;
+}
+
+String GoogleCalendarClient::buildEventsUrl(const String &pageToken)
+{
+    time_t now = TimeService::now();
+    char timeMin[30];
+    char timeMax[30];
+    char url[512];
+
+    if (syncMode == CALENDAR_SYNC_TOKEN)
+    {
+        // Incremental requests may not carry a time range; the token keeps
+        // the one of the initial full sync, which covers the horizon so it
+        // fits in CALENDAR_MAX_PAGES on a busy calendar
+        if (syncToken.isEmpty())
+        {
+            time_t horizon = now + CALENDAR_HORIZON_HOURS * 3600;
+            strftime(timeMin, sizeof(timeMin), "%Y-%m-%dT%H:%M:%SZ", gmtime(&now));
+            strftime(timeMax, sizeof(timeMax), "%Y-%m-%dT%H:%M:%SZ", gmtime(&horizon));
+            snprintf(url, sizeof(url), "%s?timeMin=%s&timeMax=%s&singleEvents=true&maxResults=%d",
+                     GOOGLE_CALENDAR_API_URL, urlEncode(timeMin).c_str(), urlEncode(timeMax).c_str(),
+                     CALENDAR_PAGE_SIZE);
+        }
+        else
         {
-            endDateTime = item["end"]["dateTime"];
+            snprintf(url, sizeof(url), "%s?syncToken=%s&singleEvents=true&maxResults=%d",
+                     GOOGLE_CALENDAR_API_URL, urlEncode(syncToken).c_str(), CALENDAR_PAGE_SIZE);
         }
 
-        if (!endDateTime)
-            continue;
+        String result = url;
+        if (!pageToken.isEmpty())
+            result += "&pageToken=" + urlEncode(pageToken);
+        return result;
+    }
 
-        time_t eventStart = parseISODateTime(startDateTime);
-        time_t eventEnd = parseISODateTime(endDateTime);
+    // The conditional request only pays off if the URL is the same from one
+    // poll to the next, so the window starts on the hour instead of at now
+    time_t windowStart = now;
+    if (syncMode == CALENDAR_SYNC_ETAG)
+        windowStart -= now % 3600;
+    time_t windowEnd = windowStart + CALENDAR_HORIZON_HOURS * 3600;
 
-        // Skip past events
-        if (eventEnd < now)
-            continue;
+    strftime(timeMin, sizeof(timeMin), "%Y-%m-%dT%H:%M:%SZ", gmtime(&windowStart));
+    strftime(timeMax, sizeof(timeMax), "%Y-%m-%dT%H:%M:%SZ", gmtime(&windowEnd));
 
-        // Only include events within the next 2 hours
-        if (eventStart > twoHoursFromNow)
-            continue;
+    snprintf(url, sizeof(url), "%s?timeMin=%s&timeMax=%s&singleEvents=true&orderBy=startTime&maxResults=%d",
+             GOOGLE_CALENDAR_API_URL,
+             urlEncode(timeMin).c_str(),
+             urlEncode(timeMax).c_str(),
+             CALENDAR_PAGE_SIZE);
+    return url;
+}
+
+bool GoogleCalendarClient::refreshEvents(const String &token)
+{
+    TRACE_SCOPE("calendar fetch");
+    time_t now = TimeService::now();
+    bool incremental = syncMode == CALENDAR_SYNC_TOKEN;
+
+    // A periodic full sync moves the horizon forward: incremental responses
+    // only mention events that changed, not ones that came into range
+    if (incremental && now - lastFullSync >= CALENDAR_RESYNC_HOURS * 3600)
+        syncToken = "";
+    bool fullSync = incremental && syncToken.isEmpty();
+
+    String pageToken = "";
+    for (int page = 0; page < CALENDAR_MAX_PAGES; page++)
+    {
+        String url = buildEventsUrl(pageToken);
+        HTTPClient *http = HttpPool::begin(url);
+        if (!http)
+            return false;
+
+        http->addHeader("Authorization", "Bearer " + token);
+        if (syncMode == CALENDAR_SYNC_ETAG && !etag.isEmpty() && url == cacheUrl)
+            http->addHeader("If-None-Match", etag);
+
+        int httpCode = HttpPool::GET(http);
+        bool parsed = false;
+
+        if (httpCode == HTTP_CODE_NOT_MODIFIED)
+        {
+            HttpPool::end(http);
+            return true;
+        }
+
+        if (httpCode == HTTP_CODE_OK)
+        {
+            String responseEtag = http->header("ETag");
+            HttpBodyStream body(*http);
+            parsed = parseCalendarEvents(body, (incremental && !fullSync) || page > 0);
+
+            etag = parsed ? responseEtag : "";
+            cacheUrl = parsed ? url : "";
+        }
+        else if (httpCode == HTTP_CODE_GONE)
+        {
+            // Sync token expired; the next poll starts over with a full sync
+            syncToken = "";
+        }
+        else if (httpCode == HTTP_CODE_UNAUTHORIZED)
+        {
+            // Revoked early; fetch a new one on the next poll
+            googleToken.invalidate();
+        }
 
-        events[count].title = item["summary"].as<String>();
-        events[count].location = item.containsKey("location") ? item["location"].as<String>() : "";
-        events[count].startTime = eventStart;
-        events[count].endTime = eventEnd;
-        events[count].isActive = (eventStart <= now && now <= eventEnd);
+        HttpPool::end(http);
+        if (!parsed)
+            return false;
 
-        count++;
+        // Only incremental sync pages: its token comes with the last page
+        if (!incremental || nextPageToken.isEmpty())
+            break;
+        pageToken = nextPageToken;
     }
 
-    if (count == 0)
+    // Out of pages before the sync token: every poll would repeat the same
+    // capped download, so fetch the window instead from now on
+    if (incremental && !nextPageToken.isEmpty())
     {
-        return noEvent;
+        Serial.printf("Calendar sync needs more than %d pages, using ETag mode\n", CALENDAR_MAX_PAGES);
+        syncMode = CALENDAR_SYNC_ETAG;
+        syncToken = "";
+        nextPageToken = "";
+        return refreshEvents(token);
     }
 
-    return findSoonestEvent(events, count);
+    if (fullSync)
+        lastFullSync = now;
+    return true;
+}
+
+// Blob layout: event count, then per event the start and end times as
+// little-endian int64 followed by id, title and location, each a length byte
+// and that many bytes of text
+#define CALENDAR_BLOB_EVENT_SIZE (2 * 8 + 3 * (1 + CALENDAR_NVS_TEXT_LEN))
+
+static size_t putTime(uint8_t *out, time_t value)
+{
+    int64_t wide = value;
+    memcpy(out, &wide, sizeof(wide));
+    return sizeof(wide);
 }
 
-CalendarEvent GoogleCalendarClient::findSoonestEvent(const CalendarEvent *events, int count)
+static size_t putText(uint8_t *out, const String &text)
 {
-    if (count == 0)
+    size_t length = text.length() < CALENDAR_NVS_TEXT_LEN ? text.length() : CALENDAR_NVS_TEXT_LEN;
+    out[0] = length;
+    memcpy(out + 1, text.c_str(), length);
+    return 1 + length;
+}
+
+static bool getText(const uint8_t *&in, const uint8_t *end, String &text)
+{
+    if (in >= end || in + 1 + in[0] > end)
+        return false;
+    text = String((const char *)in + 1, in[0]);
+    in += 1 + in[0];
+    return true;
+}
+
+void GoogleCalendarClient::saveCache()
+{
+#if CALENDAR_PERSIST_CACHE
+    size_t capacity = 1 + cacheCount * CALENDAR_BLOB_EVENT_SIZE;
+    uint8_t *blob = (uint8_t *)malloc(capacity);
+    uint8_t *stored = (uint8_t *)malloc(capacity);
+    if (!blob || !stored)
     {
-        CalendarEvent noEvent = {"No upcoming events", "", 0, 0, false};
-        return noEvent;
+        free(blob);
+        free(stored);
+        return;
     }
 
-    time_t now = time(NULL);
-    int soonestIndex = 0;
+    size_t length = 0;
+    blob[length++] = cacheCount;
+    for (int i = 0; i < cacheCount; i++)
+    {
+        length += putTime(blob + length, cache[i].event.startTime);
+        length += putTime(blob + length, cache[i].event.endTime);
+        length += putText(blob + length, cache[i].id);
+        length += putText(blob + length, cache[i].event.title);
+        length += putText(blob + length, cache[i].event.location);
+    }
 
-    // First, check for active events
-    for (int i = 0; i < count; i++)
+    // A full refresh rewrites every entry; skip the flash write if nothing changed
+    Preferences prefs;
+    prefs.begin(CALENDAR_NVS_NAMESPACE);
+    if (prefs.getBytesLength("events") != length || prefs.getBytes("events", stored, capacity) != length ||
+        memcmp(blob, stored, length) != 0)
     {
-        if (events[i].isActive)
-        {
-            return events[i];
-        }
+        prefs.putBytes("events", blob, length);
     }
+    prefs.end();
 
-    // If no active events, find the soonest upcoming one
-    for (int i = 1; i < count; i++)
+    free(blob);
+    free(stored);
+#endif
+    cacheDirty = false;
+}
+
+void GoogleCalendarClient::loadCache(time_t now)
+{
+#if CALENDAR_PERSIST_CACHE
+    Preferences prefs;
+    prefs.begin(CALENDAR_NVS_NAMESPACE, true);
+    size_t length = prefs.getBytesLength("events");
+    uint8_t *blob = length > 0 ? (uint8_t *)malloc(length) : NULL;
+    if (blob && prefs.getBytes("events", blob, length) == length)
     {
-        if (events[i].startTime < events[soonestIndex].startTime)
+        const uint8_t *in = blob + 1;
+        const uint8_t *end = blob + length;
+        int count = blob[0];
+
+        cacheCount = 0;
+        for (int i = 0; i < count && in + 16 <= end; i++)
         {
-            soonestIndex = i;
+            int64_t start, finish;
+            memcpy(&start, in, sizeof(start));
+            memcpy(&finish, in + 8, sizeof(finish));
+            in += 16;
+
+            String id;
+            CalendarEvent event = {"", "", (time_t)start, (time_t)finish, false};
+            if (!getText(in, end, id) || !getText(in, end, event.title) || !getText(in, end, event.location))
+                break;
+
+            // Drops whatever ended while the device was off, if the clock
+            // says so; after a power loss it is unset until NTP answers
+            cacheEvent(id, event, now);
         }
     }
-
-    return events[soonestIndex];
+    free(blob);
+    prefs.end();
+#endif
+    cacheDirty = false;
 }
 
-CalendarEvent GoogleCalendarClient::getUpcomingEvent()
+OAuthTokenStats GoogleCalendarClient::getTokenStats()
 {
-    String token = getToken();
-    CalendarEvent noEvent = {"No upcoming events", "", 0, 0, false};
+    return googleToken.getStats();
+}
 
+void GoogleCalendarClient::refresh()
+{
+    String token = googleToken.get();
     if (token.isEmpty())
     {
-        return noEvent;
+        return;
     }
 
     Serial.println("Getting upcoming event...");
+    if (!refreshEvents(token))
+        return;
 
-    HTTPClient http;
+    bootMark(BOOT_EVENT_FIRST_FRESH_DATA);
+    if (cacheDirty)
+    {
+        saveCache();
+    }
+}
 
-    time_t now = time(NULL);
-    time_t twoHoursFromNow = now + (2 * 60 * 60);
+CalendarEvent GoogleCalendarClient::getUpcomingEvent()
+{
+    CalendarEvent noEvent = {"No upcoming events", "", 0, 0, false};
 
-    char timeMin[30];
-    struct tm *timeinfo = gmtime(&now);
-    strftime(timeMin, sizeof(timeMin), "%Y-%m-%dT%H:%M:%SZ", timeinfo);
+    time_t now = TimeService::now();
+    time_t lookaheadEnd = now + CALENDAR_LOOKAHEAD_HOURS * 3600;
+    int soonest = -1;
 
-    char timeMax[30];
-    timeinfo = gmtime(&twoHoursFromNow);
-    strftime(timeMax, sizeof(timeMax), "%Y-%m-%dT%H:%M:%SZ", timeinfo);
+    for (int i = 0; i < cacheCount; i++)
+    {
+        const CalendarEvent &event = cache[i].event;
 
-    // Pre-build URL to reduce string concatenation operations
-    char url[256];
-    snprintf(url, sizeof(url), "%s?timeMin=%s&timeMax=%s&singleEvents=true&orderBy=startTime&maxResults=5",
-             GOOGLE_CALENDAR_API_URL,
-             urlEncode(timeMin).c_str(),
-             urlEncode(timeMax).c_str());
+        // Skip past events
+        if (event.endTime < now)
+            continue;
 
-    http.begin(url);
-    http.addHeader("Authorization", "Bearer " + token);
+        // Only include events within the lookahead
+        if (event.startTime > lookaheadEnd)
+            continue;
 
-    int httpCode = http.GET();
+        // An event in progress has started before any upcoming one, so the
+        // earliest start wins either way
+        if (soonest < 0 || event.startTime < cache[soonest].event.startTime)
+            soonest = i;
+    }
 
-    if (httpCode == HTTP_CODE_OK)
+    if (soonest < 0)
     {
-        String response = http.getString();
-        http.end();
-        return parseCalendarEvents(response);
+        return noEvent;
     }
 
-    http.end();
-    return noEvent;
+    CalendarEvent event = cache[soonest].event;
+    event.isActive = event.startTime <= now && now <= event.endTime;
+    return event;
 }
 
 String formatEventTime(time_t eventTime)
 {
     char buffer[20];
-    struct tm *timeinfo = localtime(&eventTime);
+    struct tm timeinfo;
+    localtime_r(&eventTime, &timeinfo);
 
-    int hour = timeinfo->tm_hour;
+    int hour = timeinfo.tm_hour;
     if (hour > 12)
     {
         hour -= 12;
@@ -304,8 +520,8 @@ String formatEventTime(time_t eventTime)
 
     snprintf(buffer, sizeof(buffer), "%d:%02d %s",
              hour,
-             timeinfo->tm_min,
-             timeinfo->tm_hour >= 12 ? "PM" : "AM");
+             timeinfo.tm_min,
+             timeinfo.tm_hour >= 12 ? "PM" : "AM");
 
     return String(buffer);
 }
@@ -348,43 +564,66 @@ String urlEncode(const String &str)
     return encoded;
 }
 
-void calendarTask(void *pvParameters)
+static void formatEventText(const CalendarEvent &event, char *text, size_t size)
 {
-    CalendarTaskData *calendarData = (CalendarTaskData *)pvParameters;
-
-    while (1)
+    if (event.isActive)
     {
-        Serial.println("Updating calendar events...");
+        snprintf(text, size, LV_SYMBOL_BELL " Now: %s", event.title.c_str());
+    }
+    else if (event.startTime > 0)
+    {
+        snprintf(text, size, LV_SYMBOL_BELL " %s: %s",
+                 formatEventTime(event.startTime).c_str(),
+                 event.title.c_str());
+    }
+    else
+    {
+        snprintf(text, size, "No upcoming events");
+    }
+}
 
-        CalendarEvent event = GoogleCalendarClient::getUpcomingEvent();
+static uint32_t calendarTokenJob()
+{
+    return googleToken.maintain();
+}
 
-        if (event.isActive)
-        {
-            char eventText[128];
-            snprintf(eventText, sizeof(eventText), LV_SYMBOL_BELL " Now: %s",
-                     event.title.c_str());
+static uint32_t calendarJob()
+{
+    Serial.println("Updating calendar events...");
+    GoogleCalendarClient::refresh();
+    return CALENDAR_UPDATE_INTERVAL_MIN * 60 * 1000;
+}
 
-            GUILock lock;
-            lv_label_set_text(calendarData->eventLabel, eventText);
-        }
-        else if (event.startTime > 0)
-        {
-            char eventText[128];
-            snprintf(eventText, sizeof(eventText), LV_SYMBOL_BELL " %s: %s",
-                     formatEventTime(event.startTime).c_str(),
-                     event.title.c_str());
+static uint32_t calendarRankJob()
+{
+    static char lastText[128] = "";
 
-            GUILock lock;
-            lv_label_set_text(calendarData->eventLabel, eventText);
-        }
-        else
-        {
-            GUILock lock;
-            lv_label_set_text(calendarData->eventLabel, "No upcoming events");
-        }
+    // Without a clock every event looks far off; keep the boot cache's text
+    if (!TimeService::isSet())
+        return CALENDAR_RANK_INTERVAL_MS;
 
-        vTaskDelay(pdMS_TO_TICKS(CALENDAR_UPDATE_INTERVAL_MIN * 60 * 1000));
+    // Re-rank from the cache every second so the label rolls over to the
+    // next meeting the moment one ends, without waiting for a fetch
+    CalendarEvent event = GoogleCalendarClient::getUpcomingEvent();
+
+    char eventText[128];
+    formatEventText(event, eventText, sizeof(eventText));
+    if (strcmp(eventText, lastText) != 0)
+    {
+        uiPostText(UI_LABEL_CALENDAR, eventText);
+        uiCacheSave(UI_LABEL_CALENDAR, eventText);
+        strcpy(lastText, eventText);
     }
 
-    vTaskDelete(NULL);
+    return CALENDAR_RANK_INTERVAL_MS;
+}
+
+void registerCalendarJobs()
+{
+    // Show the events from before the reboot while the first fetch runs
+    GoogleCalendarClient::loadCache(TimeService::isSet() ? TimeService::now() : 0);
+
+    FetchScheduler::addJob("google-token", calendarTokenJob, FETCH_PRIORITY_HIGH, true, OAUTH_REFRESH_SLACK_MS);
+    FetchScheduler::addJob("calendar", calendarJob, FETCH_PRIORITY_NORMAL, true, CALENDAR_UPDATE_SLACK_SEC * 1000);
+    FetchScheduler::addJob("calendar-rank", calendarRankJob, FETCH_PRIORITY_NORMAL, false, 0);
 }
@@ -1,8 +1,9 @@
 #pragma once
 
 #include <Arduino.h>
-#include <lvgl.h>
 #include <ArduinoJson.h>
+#include "oauth_token.h"
+
 struct CalendarEvent
 {
     String title;
@@ -12,26 +13,74 @@ struct CalendarEvent
     bool isActive;
 };
 
-struct CalendarTaskData
+/**
+ * How the events list is refreshed on each poll
+ */
+enum CalendarSyncMode
 {
-    lv_obj_t *eventLabel;
+    CALENDAR_SYNC_FULL,  // Download the list every time
+    CALENDAR_SYNC_ETAG,  // Send If-None-Match; 304 reuses the cached events
+    CALENDAR_SYNC_TOKEN, // Calendar API incremental sync: only changed events
 };
 
-void calendarTask(void *pvParameters);
+/**
+ * Loads the persisted event cache and registers the token refresh, event
+ * fetch and once-a-second re-rank with the FetchScheduler
+ */
+void registerCalendarJobs();
 
 class GoogleCalendarClient
 {
 public:
+    /** Fetches changes to the next 24 h of events into the event cache */
+    static void refresh();
+
+    static OAuthTokenStats getTokenStats();
+
+    /**
+     * Picks the event to show from the cache: the one in progress, else the
+     * next to start within the lookahead. Cheap enough to call every second.
+     */
     static CalendarEvent getUpcomingEvent();
 
+    /**
+     * Restores the event cache saved in NVS by the last refresh
+     * @param now Current time, to drop events that ended meanwhile; 0 if
+     *        the clock is not set yet, which keeps them all
+     */
+    static void loadCache(time_t now);
+
+    static void setSyncMode(CalendarSyncMode mode);
+
+    /**
+     * Parses one page of an events list into the event cache. A page that
+     * does not merge replaces the cache; merged pages update events by id
+     * and drop cancelled ones, as incremental sync responses need.
+     * @return false if the body could not be parsed
+     */
+    static bool parseCalendarEvents(Stream &body, bool merge);
+
 private:
-    static String accessToken;
-    static uint32_t lastTokenRefresh;
-
-    static String getToken();
-    static bool shouldRefreshToken();
-    static CalendarEvent parseCalendarEvents(const String &response);
-    static time_t parseISODateTime(const char *dateTime);
-    static CalendarEvent findSoonestEvent(const CalendarEvent *events, int count);
+    struct CachedEvent
+    {
+        String id;
+        CalendarEvent event;
+    };
+
+    static CalendarSyncMode syncMode;
+    static CachedEvent cache[];
+    static int cacheCount;
+    static String cacheUrl;  // Request the cached list came from, for If-None-Match
+    static String etag;
+    static String syncToken;
+    static String nextPageToken;
+    static time_t lastFullSync;
+    static bool cacheDirty;
+
+    static bool refreshEvents(const String &token);
+    static String buildEventsUrl(const String &pageToken);
+    static void cacheEvent(const String &id, const CalendarEvent &event, time_t now);
+    static void removeCachedEvent(const String &id);
+    static void saveCache();
     static void createCalendarFilter(JsonDocument &filter);
 };
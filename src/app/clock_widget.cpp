@@ -0,0 +1,267 @@
+#include "clock_widget.h"
+
+#include <Arduino.h>
+#include <string.h>
+
+#define CLOCK_GLYPHS "0123456789:APM"
+#define CLOCK_GLYPH_COUNT (sizeof(CLOCK_GLYPHS) - 1)
+#define CLOCK_MAX_TEXT 16
+
+struct ClockSprite
+{
+    lv_image_dsc_t image;
+    int32_t width;
+};
+
+struct ClockWidget
+{
+    ClockSprite sprites[CLOCK_GLYPH_COUNT];
+    int32_t digitWidth;
+    int32_t spaceWidth;
+    int32_t height;
+    char text[CLOCK_MAX_TEXT];
+};
+
+static int glyphIndex(char c)
+{
+    const char *pos = c ? strchr(CLOCK_GLYPHS, c) : NULL;
+    return pos ? pos - CLOCK_GLYPHS : -1;
+}
+
+static int32_t cellWidth(const ClockWidget *clock, char c)
+{
+    if (c >= '0' && c <= '9')
+        return clock->digitWidth;
+
+    int index = glyphIndex(c);
+    return index >= 0 ? clock->sprites[index].width : clock->spaceWidth;
+}
+
+static int32_t textWidth(const ClockWidget *clock, const char *text)
+{
+    int32_t width = 0;
+    for (; *text; text++)
+        width += cellWidth(clock, *text);
+    return width;
+}
+
+/**
+ * Renders one glyph through a throwaway label into the scratch buffer
+ */
+static bool snapshotGlyph(lv_obj_t *screen, const lv_font_t *font, lv_color_t color, lv_color_t bgColor,
+                          char c, lv_draw_buf_t *scratch)
+{
+    char text[2] = {c, '\0'};
+
+    lv_obj_t *label = lv_label_create(screen);
+    lv_obj_set_style_text_font(label, font, LV_PART_MAIN);
+    lv_obj_set_style_text_color(label, color, LV_PART_MAIN);
+    lv_obj_set_style_bg_color(label, bgColor, LV_PART_MAIN);
+    lv_obj_set_style_bg_opa(label, LV_OPA_COVER, LV_PART_MAIN);
+    lv_obj_set_style_pad_all(label, 0, LV_PART_MAIN);
+    lv_label_set_text(label, text);
+    lv_obj_update_layout(label);
+
+    lv_result_t result = lv_snapshot_take_to_draw_buf(label, LV_COLOR_FORMAT_RGB565, scratch);
+    lv_obj_delete(label);
+    return result == LV_RESULT_OK;
+}
+
+/**
+ * Builds the sprite cache. Glyphs are rendered twice: once to find the rows
+ * any of them actually ink, then again to keep only that band, which roughly
+ * halves the cache compared to storing full line-height cells.
+ */
+static bool buildSprites(ClockWidget *clock, lv_obj_t *screen, const lv_font_t *font, lv_color_t color,
+                         lv_color_t bgColor)
+{
+    int32_t lineHeight = lv_font_get_line_height(font);
+    int32_t maxWidth = 0;
+    for (size_t i = 0; i < CLOCK_GLYPH_COUNT; i++)
+    {
+        clock->sprites[i].width = lv_font_get_glyph_width(font, CLOCK_GLYPHS[i], 0);
+        maxWidth = LV_MAX(maxWidth, clock->sprites[i].width);
+        if (CLOCK_GLYPHS[i] >= '0' && CLOCK_GLYPHS[i] <= '9')
+            clock->digitWidth = LV_MAX(clock->digitWidth, clock->sprites[i].width);
+    }
+    clock->spaceWidth = lv_font_get_glyph_width(font, ' ', 0);
+
+    uint32_t scratchStride = lv_draw_buf_width_to_stride(maxWidth, LV_COLOR_FORMAT_RGB565);
+    uint32_t scratchSize = scratchStride * lineHeight;
+    uint8_t *scratchData = (uint8_t *)malloc(scratchSize);
+    if (!scratchData)
+        return false;
+
+    lv_draw_buf_t scratch;
+    uint16_t bg = lv_color_to_u16(bgColor);
+    int32_t top = lineHeight;
+    int32_t bottom = -1;
+
+    for (size_t i = 0; i < CLOCK_GLYPH_COUNT; i++)
+    {
+        lv_draw_buf_init(&scratch, maxWidth, lineHeight, LV_COLOR_FORMAT_RGB565, scratchStride, scratchData, scratchSize);
+        if (!snapshotGlyph(screen, font, color, bgColor, CLOCK_GLYPHS[i], &scratch))
+        {
+            free(scratchData);
+            return false;
+        }
+
+        for (int32_t y = 0; y < (int32_t)scratch.header.h; y++)
+        {
+            const uint16_t *row = (const uint16_t *)(scratch.data + y * scratch.header.stride);
+            for (int32_t x = 0; x < (int32_t)scratch.header.w; x++)
+            {
+                if (row[x] != bg)
+                {
+                    top = LV_MIN(top, y);
+                    bottom = LV_MAX(bottom, y);
+                    break;
+                }
+            }
+        }
+    }
+
+    if (bottom < top)
+    {
+        top = 0;
+        bottom = lineHeight - 1;
+    }
+    clock->height = bottom - top + 1;
+
+    for (size_t i = 0; i < CLOCK_GLYPH_COUNT; i++)
+    {
+        ClockSprite *sprite = &clock->sprites[i];
+        uint32_t stride = sprite->width * sizeof(uint16_t);
+        uint8_t *data = (uint8_t *)malloc(stride * clock->height);
+
+        lv_draw_buf_init(&scratch, maxWidth, lineHeight, LV_COLOR_FORMAT_RGB565, scratchStride, scratchData, scratchSize);
+        if (!data || !snapshotGlyph(screen, font, color, bgColor, CLOCK_GLYPHS[i], &scratch))
+        {
+            free(data);
+            free(scratchData);
+            return false;
+        }
+
+        uint32_t copyBytes = LV_MIN(stride, scratch.header.w * sizeof(uint16_t));
+        for (int32_t y = 0; y < clock->height; y++)
+        {
+            memset(data + y * stride, 0, stride);
+            memcpy(data + y * stride, scratch.data + (top + y) * scratch.header.stride, copyBytes);
+        }
+
+        memset(&sprite->image, 0, sizeof(sprite->image));
+        sprite->image.header.magic = LV_IMAGE_HEADER_MAGIC;
+        sprite->image.header.cf = LV_COLOR_FORMAT_RGB565;
+        sprite->image.header.w = sprite->width;
+        sprite->image.header.h = clock->height;
+        sprite->image.header.stride = stride;
+        sprite->image.data_size = stride * clock->height;
+        sprite->image.data = data;
+    }
+
+    free(scratchData);
+    return true;
+}
+
+static void freeSprites(ClockWidget *clock)
+{
+    for (size_t i = 0; i < CLOCK_GLYPH_COUNT; i++)
+        free((void *)clock->sprites[i].image.data);
+}
+
+static void clockEventCb(lv_event_t *e)
+{
+    lv_obj_t *obj = (lv_obj_t *)lv_event_get_target(e);
+    ClockWidget *clock = (ClockWidget *)lv_event_get_user_data(e);
+
+    if (lv_event_get_code(e) == LV_EVENT_DELETE)
+    {
+        freeSprites(clock);
+        delete clock;
+        return;
+    }
+
+    lv_layer_t *layer = lv_event_get_layer(e);
+    lv_area_t coords;
+    lv_obj_get_content_coords(obj, &coords);
+
+    int32_t x = coords.x1;
+    for (const char *c = clock->text; *c; c++)
+    {
+        int32_t cell = cellWidth(clock, *c);
+        int index = glyphIndex(*c);
+
+        if (index >= 0)
+        {
+            const ClockSprite *sprite = &clock->sprites[index];
+            lv_area_t area = {
+                x + (cell - sprite->width) / 2,
+                coords.y1,
+                x + (cell - sprite->width) / 2 + sprite->width - 1,
+                coords.y1 + clock->height - 1,
+            };
+
+            lv_draw_image_dsc_t dsc;
+            lv_draw_image_dsc_init(&dsc);
+            dsc.src = &sprite->image;
+            lv_draw_image(layer, &dsc, &area);
+        }
+
+        x += cell;
+    }
+}
+
+lv_obj_t *clockWidgetCreate(lv_obj_t *parent, const lv_font_t *font, lv_color_t color, lv_color_t bgColor)
+{
+    ClockWidget *clock = new ClockWidget();
+    if (!buildSprites(clock, lv_obj_get_screen(parent), font, color, bgColor))
+    {
+        Serial.println("Failed to build clock sprite cache");
+        freeSprites(clock);
+        delete clock;
+        return NULL;
+    }
+
+    lv_obj_t *obj = lv_obj_create(parent);
+    lv_obj_remove_style_all(obj);
+    lv_obj_set_size(obj, 0, clock->height);
+    lv_obj_add_event_cb(obj, clockEventCb, LV_EVENT_DRAW_MAIN, clock);
+    lv_obj_add_event_cb(obj, clockEventCb, LV_EVENT_DELETE, clock);
+    lv_obj_set_user_data(obj, clock);
+    return obj;
+}
+
+void clockWidgetSetText(lv_obj_t *obj, const char *text)
+{
+    ClockWidget *clock = (ClockWidget *)lv_obj_get_user_data(obj);
+    if (strcmp(clock->text, text) == 0)
+        return;
+
+    // A width change reflows the parent, so let LVGL invalidate everything
+    size_t length = strlen(text);
+    if (length != strlen(clock->text) || textWidth(clock, text) != textWidth(clock, clock->text))
+    {
+        snprintf(clock->text, sizeof(clock->text), "%s", text);
+        lv_obj_set_width(obj, textWidth(clock, clock->text));
+        lv_obj_invalidate(obj);
+        return;
+    }
+
+    // Same width means the same cell layout, so only changed cells are redrawn
+    lv_area_t coords;
+    lv_obj_get_content_coords(obj, &coords);
+
+    int32_t x = coords.x1;
+    for (size_t i = 0; i < length; i++)
+    {
+        int32_t cell = cellWidth(clock, text[i]);
+        if (text[i] != clock->text[i])
+        {
+            lv_area_t area = {x, coords.y1, x + cell - 1, coords.y2};
+            lv_obj_invalidate_area(obj, &area);
+        }
+        x += cell;
+    }
+
+    snprintf(clock->text, sizeof(clock->text), "%s", text);
+}
@@ -0,0 +1,27 @@
+#pragma once
+
+#include <lvgl.h>
+
+/**
+ * Creates a clock widget that draws "h:mm AM"-style text from a cache of
+ * pre-rendered RGB565 glyph sprites instead of rasterizing the font on every
+ * update. The sprites for 0-9, ':', 'A', 'P' and 'M' are rendered once here,
+ * pre-blended onto the background colour; digits share one cell width so
+ * changing a digit never reflows the widget. Must be called from the GUI
+ * task, or before it starts.
+ * @param parent Parent object
+ * @param font Font to render the glyphs with
+ * @param color Text colour
+ * @param bgColor Colour the sprites are blended onto (the parent's background)
+ * @return The clock object, or NULL if the sprite cache could not be allocated
+ */
+lv_obj_t *clockWidgetCreate(lv_obj_t *parent, const lv_font_t *font, lv_color_t color, lv_color_t bgColor);
+
+/**
+ * Sets the displayed text, invalidating only the cells that changed.
+ * Characters without a sprite are drawn as blanks. Must be called from
+ * the GUI task.
+ * @param clock Clock widget
+ * @param text New text, at most 15 characters
+ */
+void clockWidgetSetText(lv_obj_t *clock, const char *text);
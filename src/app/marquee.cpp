@@ -0,0 +1,225 @@
+#include "marquee.h"
+
+#include <Arduino.h>
+#include <string.h>
+
+#include "ui_queue.h"
+
+#define MARQUEE_MAX_STRIP_WIDTH 1024 // ~100 characters of a 16 px font, 26 KB of strip
+#define MARQUEE_GAP " \xE2\x80\xA2 "   // Between the end of the text and its next start
+#define MARQUEE_SPEED_PX_S 30
+#define MARQUEE_PAUSE_MS 3000 // Held at the start of every round
+
+struct Marquee
+{
+    const lv_font_t *font;
+    lv_color_t color;
+    lv_color_t bgColor;
+    lv_image_dsc_t strip;
+    uint32_t capacity;   // Bytes allocated for strip.data
+    int32_t textWidth;   // Strip columns that are text; the rest is the gap
+    int32_t period;      // Scroll distance of one round
+    int32_t offset;
+    lv_timer_t *timer;
+    char text[UI_UPDATE_TEXT_SIZE];
+};
+
+/**
+ * Renders text through a throwaway label into the strip, then crops the
+ * rows no glyph inks
+ * @return false if the strip could not be allocated or rendered
+ */
+static bool renderStrip(lv_obj_t *obj, Marquee *marquee, const char *text)
+{
+    lv_obj_t *label = lv_label_create(lv_obj_get_screen(obj));
+    lv_obj_set_style_text_font(label, marquee->font, LV_PART_MAIN);
+    lv_obj_set_style_text_color(label, marquee->color, LV_PART_MAIN);
+    lv_obj_set_style_bg_color(label, marquee->bgColor, LV_PART_MAIN);
+    lv_obj_set_style_bg_opa(label, LV_OPA_COVER, LV_PART_MAIN);
+    lv_obj_set_style_pad_all(label, 0, LV_PART_MAIN);
+    lv_label_set_long_mode(label, LV_LABEL_LONG_CLIP);
+    lv_label_set_text(label, text);
+    lv_obj_update_layout(label);
+
+    int32_t width = LV_MIN(lv_obj_get_width(label), MARQUEE_MAX_STRIP_WIDTH);
+    int32_t height = lv_obj_get_height(label);
+    // A fixed width makes the label wrap; keep the first line only
+    lv_obj_set_size(label, width, height);
+    lv_obj_update_layout(label);
+
+    uint32_t stride = lv_draw_buf_width_to_stride(width, LV_COLOR_FORMAT_RGB565);
+    uint32_t size = stride * height;
+    if (size > marquee->capacity)
+    {
+        // Grows only, so track changes do not churn the heap
+        void *data = realloc((void *)marquee->strip.data, size);
+        if (!data)
+        {
+            lv_obj_delete(label);
+            return false;
+        }
+        marquee->strip.data = (const uint8_t *)data;
+        marquee->capacity = size;
+    }
+
+    lv_draw_buf_t buf;
+    lv_draw_buf_init(&buf, width, height, LV_COLOR_FORMAT_RGB565, stride, (void *)marquee->strip.data, size);
+    lv_result_t result = lv_snapshot_take_to_draw_buf(label, LV_COLOR_FORMAT_RGB565, &buf);
+    lv_obj_delete(label);
+    if (result != LV_RESULT_OK)
+        return false;
+
+    uint8_t *data = (uint8_t *)marquee->strip.data;
+    uint16_t bg = lv_color_to_u16(marquee->bgColor);
+    int32_t top = height;
+    int32_t bottom = -1;
+    for (int32_t y = 0; y < height; y++)
+    {
+        const uint16_t *row = (const uint16_t *)(data + y * stride);
+        for (int32_t x = 0; x < width; x++)
+        {
+            if (row[x] != bg)
+            {
+                top = LV_MIN(top, y);
+                bottom = LV_MAX(bottom, y);
+                break;
+            }
+        }
+    }
+    if (bottom < top)
+    {
+        top = 0;
+        bottom = height - 1;
+    }
+
+    // Rows only move up, so cropping in place is safe
+    if (top > 0)
+        memmove(data, data + top * stride, (bottom - top + 1) * stride);
+
+    marquee->strip.header.magic = LV_IMAGE_HEADER_MAGIC;
+    marquee->strip.header.cf = LV_COLOR_FORMAT_RGB565;
+    marquee->strip.header.w = width;
+    marquee->strip.header.h = bottom - top + 1;
+    marquee->strip.header.stride = stride;
+    marquee->strip.data_size = stride * (bottom - top + 1);
+    return true;
+}
+
+static void scrollTimerCb(lv_timer_t *timer)
+{
+    lv_obj_t *obj = (lv_obj_t *)lv_timer_get_user_data(timer);
+    Marquee *marquee = (Marquee *)lv_obj_get_user_data(obj);
+
+    marquee->offset++;
+    if (marquee->offset >= marquee->period)
+        marquee->offset = 0;
+
+    // Back at the start: hold still before the next round
+    lv_timer_set_period(timer, marquee->offset == 0 ? MARQUEE_PAUSE_MS : 1000 / MARQUEE_SPEED_PX_S);
+    lv_obj_invalidate(obj);
+}
+
+static void drawStrip(lv_layer_t *layer, const Marquee *marquee, int32_t x, int32_t y)
+{
+    lv_area_t area = {x, y, x + (int32_t)marquee->strip.header.w - 1, y + (int32_t)marquee->strip.header.h - 1};
+
+    lv_draw_image_dsc_t dsc;
+    lv_draw_image_dsc_init(&dsc);
+    dsc.src = &marquee->strip;
+    lv_draw_image(layer, &dsc, &area);
+}
+
+static void marqueeEventCb(lv_event_t *e)
+{
+    lv_obj_t *obj = (lv_obj_t *)lv_event_get_target(e);
+    Marquee *marquee = (Marquee *)lv_event_get_user_data(e);
+
+    if (lv_event_get_code(e) == LV_EVENT_DELETE)
+    {
+        lv_timer_delete(marquee->timer);
+        free((void *)marquee->strip.data);
+        delete marquee;
+        return;
+    }
+
+    if (!marquee->strip.data || !marquee->strip.header.w)
+        return;
+
+    lv_layer_t *layer = lv_event_get_layer(e);
+    lv_area_t coords;
+    lv_obj_get_content_coords(obj, &coords);
+
+    if (!marquee->period)
+    {
+        int32_t x = coords.x1 + (lv_area_get_width(&coords) - marquee->textWidth) / 2;
+        drawStrip(layer, marquee, x, coords.y1);
+        return;
+    }
+
+    // The strip ends with the gap, so two copies side by side make the loop
+    int32_t x = coords.x1 - marquee->offset;
+    drawStrip(layer, marquee, x, coords.y1);
+    if (x + marquee->period <= coords.x2)
+        drawStrip(layer, marquee, x + marquee->period, coords.y1);
+}
+
+lv_obj_t *marqueeCreate(lv_obj_t *parent, int32_t width, const lv_font_t *font, lv_color_t color,
+                        lv_color_t bgColor)
+{
+    Marquee *marquee = new Marquee();
+    marquee->font = font;
+    marquee->color = color;
+    marquee->bgColor = bgColor;
+
+    lv_obj_t *obj = lv_obj_create(parent);
+    lv_obj_remove_style_all(obj);
+    lv_obj_set_size(obj, width, lv_font_get_line_height(font));
+    lv_obj_remove_flag(obj, LV_OBJ_FLAG_CLICKABLE);
+
+    marquee->timer = lv_timer_create(scrollTimerCb, MARQUEE_PAUSE_MS, obj);
+    lv_timer_pause(marquee->timer);
+    lv_obj_set_user_data(obj, marquee);
+    lv_obj_add_event_cb(obj, marqueeEventCb, LV_EVENT_DRAW_MAIN, marquee);
+    lv_obj_add_event_cb(obj, marqueeEventCb, LV_EVENT_DELETE, marquee);
+    return obj;
+}
+
+void marqueeSetText(lv_obj_t *obj, const char *text)
+{
+    Marquee *marquee = (Marquee *)lv_obj_get_user_data(obj);
+    if (strcmp(marquee->text, text) == 0)
+        return;
+    strncpy(marquee->text, text, sizeof(marquee->text) - 1);
+
+    lv_timer_pause(marquee->timer);
+    marquee->offset = 0;
+    marquee->period = 0;
+
+    // Measure the text alone first: if it fits there is nothing to scroll
+    int32_t textWidth = lv_text_get_width(text, strlen(text), marquee->font, 0);
+    bool scrolls = textWidth > lv_obj_get_content_width(obj);
+
+    char stripText[UI_UPDATE_TEXT_SIZE + sizeof(MARQUEE_GAP)];
+    snprintf(stripText, sizeof(stripText), "%s%s", text, scrolls ? MARQUEE_GAP : "");
+    if (!renderStrip(obj, marquee, stripText))
+    {
+        Serial.println("Marquee: cannot render the text strip");
+        marquee->strip.header.w = 0;
+        lv_obj_invalidate(obj);
+        return;
+    }
+
+    // Same descriptor, new pixels: drop whatever LVGL cached for it
+    lv_image_cache_drop(&marquee->strip);
+    marquee->textWidth = LV_MIN(textWidth, (int32_t)marquee->strip.header.w);
+    if (scrolls)
+    {
+        marquee->period = marquee->strip.header.w;
+        lv_timer_set_period(marquee->timer, MARQUEE_PAUSE_MS);
+        lv_timer_reset(marquee->timer);
+        lv_timer_resume(marquee->timer);
+    }
+
+    lv_obj_set_height(obj, marquee->strip.header.h);
+    lv_obj_invalidate(obj);
+}
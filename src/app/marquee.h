@@ -0,0 +1,28 @@
+#pragma once
+
+#include <lvgl.h>
+
+/**
+ * Creates a single-line marquee: text that fits is shown centred and still,
+ * longer text scrolls round, pausing each time it comes back to the start.
+ * Each new text is rasterized once into an RGB565 strip, pre-blended onto
+ * the background colour and cropped to the rows the font inks; frames then
+ * only blit a window of that strip, so scrolling never runs the font
+ * renderer. Must be called from the GUI task, or before it starts.
+ * @param parent Parent object
+ * @param width Width of the visible window
+ * @param font Font to render the text with
+ * @param color Text colour
+ * @param bgColor Colour the strip is blended onto (the parent's background)
+ * @return The marquee object
+ */
+lv_obj_t *marqueeCreate(lv_obj_t *parent, int32_t width, const lv_font_t *font, lv_color_t color,
+                        lv_color_t bgColor);
+
+/**
+ * Sets the text; the same text again keeps the scroll position. Text too
+ * long for the strip is cut short. Usable as a UiLabelSetter.
+ * @param marquee Marquee widget
+ * @param text New text
+ */
+void marqueeSetText(lv_obj_t *marquee, const char *text);
@@ -0,0 +1,98 @@
+#include "song_progress.h"
+
+#include <Arduino.h>
+
+#define SONG_PROGRESS_MIN_PERIOD_MS 250
+
+struct SongProgress
+{
+    lv_timer_t *timer;
+    uint32_t progressMs;
+    uint32_t durationMs;
+    uint32_t updatedAt; // lv_tick_get() when progressMs was reported
+    bool playing;
+};
+
+static void updateBar(lv_obj_t *bar)
+{
+    SongProgress *state = (SongProgress *)lv_obj_get_user_data(bar);
+    if (state->durationMs == 0)
+        return;
+
+    uint64_t position = state->progressMs;
+    if (state->playing)
+        position += lv_tick_elaps(state->updatedAt);
+    if (position > state->durationMs)
+        position = state->durationMs;
+
+    // The range is the width in pixels, so the value only changes, and the
+    // bar only redraws, when the indicator actually grows
+    lv_bar_set_value(bar, position * lv_bar_get_max_value(bar) / state->durationMs, LV_ANIM_OFF);
+}
+
+static void progressTimerCb(lv_timer_t *timer)
+{
+    updateBar((lv_obj_t *)lv_timer_get_user_data(timer));
+}
+
+static void deleteCb(lv_event_t *e)
+{
+    lv_obj_t *bar = (lv_obj_t *)lv_event_get_target(e);
+    SongProgress *state = (SongProgress *)lv_obj_get_user_data(bar);
+    lv_timer_delete(state->timer);
+    free(state);
+}
+
+lv_obj_t *songProgressCreate(lv_obj_t *parent, int32_t width, lv_color_t color)
+{
+    SongProgress *state = (SongProgress *)calloc(1, sizeof(SongProgress));
+    if (!state)
+        return NULL;
+
+    lv_obj_t *bar = lv_bar_create(parent);
+    lv_obj_set_size(bar, width, 3);
+    lv_bar_set_range(bar, 0, width);
+    lv_obj_set_style_bg_color(bar, lv_color_hex(0x1c2520), LV_PART_MAIN);
+    lv_obj_set_style_bg_color(bar, color, LV_PART_INDICATOR);
+    lv_obj_set_style_radius(bar, 0, LV_PART_MAIN);
+    lv_obj_set_style_radius(bar, 0, LV_PART_INDICATOR);
+    lv_obj_add_flag(bar, LV_OBJ_FLAG_HIDDEN);
+
+    state->timer = lv_timer_create(progressTimerCb, SONG_PROGRESS_MIN_PERIOD_MS, bar);
+    lv_timer_pause(state->timer);
+    lv_obj_set_user_data(bar, state);
+    lv_obj_add_event_cb(bar, deleteCb, LV_EVENT_DELETE, NULL);
+    return bar;
+}
+
+void songProgressSetText(lv_obj_t *bar, const char *text)
+{
+    SongProgress *state = (SongProgress *)lv_obj_get_user_data(bar);
+    unsigned progressMs, durationMs, playing;
+
+    if (sscanf(text, "%u %u %u", &progressMs, &durationMs, &playing) != 3 || durationMs == 0)
+    {
+        lv_timer_pause(state->timer);
+        lv_obj_add_flag(bar, LV_OBJ_FLAG_HIDDEN);
+        return;
+    }
+
+    state->progressMs = progressMs;
+    state->durationMs = durationMs;
+    state->updatedAt = lv_tick_get();
+    state->playing = playing != 0;
+    lv_obj_remove_flag(bar, LV_OBJ_FLAG_HIDDEN);
+    updateBar(bar);
+
+    // Wake up about once per pixel of growth rather than every frame
+    if (state->playing)
+    {
+        uint32_t period = durationMs / lv_bar_get_max_value(bar);
+        lv_timer_set_period(state->timer, period > SONG_PROGRESS_MIN_PERIOD_MS ? period : SONG_PROGRESS_MIN_PERIOD_MS);
+        lv_timer_resume(state->timer);
+    }
+    else
+    {
+        lv_timer_pause(state->timer);
+    }
+}
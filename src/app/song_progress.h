@@ -0,0 +1,23 @@
+#pragma once
+
+#include <lvgl.h>
+
+/**
+ * Creates a thin progress bar for the current track. Between updates it
+ * extrapolates the position from the tick count, redrawing only when the
+ * bar grows by a pixel, so no per-second updates have to be posted.
+ * @param parent Parent object
+ * @param width Bar width in pixels
+ * @param color Indicator colour
+ * @return The bar, hidden until the first update
+ */
+lv_obj_t *songProgressCreate(lv_obj_t *parent, int32_t width, lv_color_t color);
+
+/**
+ * UiLabelSetter for the bar. The text is "<progress_ms> <duration_ms>
+ * <playing>" as reported by the player; a paused track freezes the bar and
+ * an empty text hides it.
+ * @param bar Song progress bar
+ * @param text New state
+ */
+void songProgressSetText(lv_obj_t *bar, const char *text);
@@ -1,118 +1,176 @@
 #include "spotify.h"
 #include "secrets.h"
-#include "lv_util.h"
+#include "ui_queue.h"
+#include "http_pool.h"
+#include "http_body_stream.h"
+#include "album_art.h"
+#include "fetch_scheduler.h"
+#include "oauth_token.h"
+#include "ui_cache.h"
+#include "boot_timeline.h"
+#include "trace.h"
 
 #include <lvgl.h>
 #include <Arduino.h>
 #include <HTTPClient.h>
 #include <ArduinoJson.h>
-#include <base64.h>
 
-#define SPOTIFY_UPDATE_INTERVAL_SEC 10
+#define SPOTIFY_MIN_POLL_MS 1000
+#define SPOTIFY_MAX_POLL_MS 60000     // Longest a skip or pause can go unnoticed without a touch
+#define SPOTIFY_TRACK_END_SLACK_MS 1500 // Lets the player move on before we ask
+#define SPOTIFY_PAUSED_POLL_MS 10000  // As the old fixed poll, so a resume shows as quickly
+#define SPOTIFY_IDLE_BACKOFF_MIN_MS 10000
+#define SPOTIFY_IDLE_BACKOFF_MAX_MS 300000
 
-String SpotifyClient::accessToken;
-uint32_t SpotifyClient::lastTokenRefresh = 0;
+static OAuthToken spotifyToken("spotify", "https://accounts.spotify.com/api/token", SPOTIFY_CLIENT_ID,
+                               SPOTIFY_CLIENT_SECRET, SPOTIFY_REFRESH_TOKEN, OAUTH_CLIENT_AUTH_BASIC);
 
-void spotifyTask(void *pvParameters)
+static uint32_t spotifyTokenJob()
 {
-    SpotifyTaskData *data = (SpotifyTaskData *)pvParameters;
-    lv_obj_t *songLabel = data->songLabel;
+    return spotifyToken.maintain();
+}
+
+static uint32_t spotifyJob()
+{
+    static String lastText;
+    static bool textShown = false; // The label may still show the boot cache
+    static String lastAlbum;
+    static uint32_t idleBackoffMs = 0;
 
-    const TickType_t xFrequency = pdMS_TO_TICKS(SPOTIFY_UPDATE_INTERVAL_SEC * 1000);
-    TickType_t xLastWakeTime = xTaskGetTickCount();
+    NowPlaying nowPlaying = SpotifyClient::getCurrentlyPlaying();
 
-    while (1)
+    String displayText;
+    if (nowPlaying.isPlaying)
     {
-        NowPlaying nowPlaying = SpotifyClient::getCurrentlyPlaying();
-
-        String displayText;
-        if (nowPlaying.isPlaying)
-        {
-            displayText = String(LV_SYMBOL_AUDIO) + "  " + nowPlaying.song;
-        }
-        else
-        {
-            displayText = "";
-        }
-
-        // Update UI with song info
-        {
-            GUILock lock;
-            lv_label_set_text(songLabel, displayText.c_str());
-        }
-
-        vTaskDelayUntil(&xLastWakeTime, xFrequency);
+        displayText = String(LV_SYMBOL_AUDIO) + "  " + nowPlaying.song;
+    }
+    else
+    {
+        displayText = "";
     }
 
-    vTaskDelete(NULL);
-}
+    // Update UI with song info
+    if (!textShown || displayText != lastText)
+    {
+        uiPostText(UI_LABEL_SONG, displayText.c_str());
+        uiCacheSave(UI_LABEL_SONG, displayText.c_str());
+        lastText = displayText;
+        textShown = true;
+    }
 
-NowPlaying SpotifyClient::getCurrentlyPlaying()
-{
-    if (shouldRefreshToken())
+    // Covers are cached by album, so only a new album costs a download
+    String album = nowPlaying.isPlaying ? nowPlaying.albumUri : "";
+    if (album != lastAlbum)
     {
-        accessToken = getToken();
-        lastTokenRefresh = millis();
+        if (!album.isEmpty() && !AlbumArtCache::fetch(album, nowPlaying.albumImageUrl))
+            album = "";
+        uiPostText(UI_LABEL_ALBUM_ART, album.c_str());
+        lastAlbum = album;
     }
 
-    return getPlayingState(accessToken);
+    // The bar extrapolates on its own, so this only resynchronises it
+    char progressText[32] = "";
+    if (nowPlaying.isActive && nowPlaying.durationMs > 0)
+    {
+        snprintf(progressText, sizeof(progressText), "%u %u %u", (unsigned)nowPlaying.progressMs,
+                 (unsigned)nowPlaying.durationMs, nowPlaying.isPlaying ? 1u : 0u);
+    }
+    uiPostText(UI_LABEL_SONG_PROGRESS, progressText);
+
+    return SpotifyClient::nextPollDelayMs(nowPlaying, idleBackoffMs);
+}
+
+void registerSpotifyJobs()
+{
+    FetchScheduler::addJob("spotify-token", spotifyTokenJob, FETCH_PRIORITY_HIGH, true, OAUTH_REFRESH_SLACK_MS);
+    // Polls are timed to track ends, so they never run early to share a
+    // batch; a touch on the song pulls one forward with pollNow()
+    FetchScheduler::addJob("spotify", spotifyJob, FETCH_PRIORITY_NORMAL, true, 0);
 }
 
-bool SpotifyClient::shouldRefreshToken()
+void SpotifyClient::pollNow()
 {
-    return accessToken.isEmpty() || (millis() - lastTokenRefresh >= 3600000);
+    FetchScheduler::runNow(spotifyJob);
 }
 
-String SpotifyClient::getToken()
+uint32_t SpotifyClient::nextPollDelayMs(const NowPlaying &now_playing, uint32_t &idleBackoffMs)
 {
-    HTTPClient http;
-    http.begin("https://accounts.spotify.com/api/token");
-    http.addHeader("Content-Type", "application/x-www-form-urlencoded");
-    http.addHeader("Authorization", "Basic " + base64::encode(String(SPOTIFY_CLIENT_ID) + ":" + String(SPOTIFY_CLIENT_SECRET)));
-
-    String body = "grant_type=refresh_token&refresh_token=" + String(SPOTIFY_REFRESH_TOKEN);
-    int httpResponseCode = http.POST(body);
-    if (httpResponseCode > 0)
+    if (!now_playing.isActive)
     {
-        String response = http.getString();
-        StaticJsonDocument<512> doc;
-        deserializeJson(doc, response);
-        return doc["access_token"].as<String>();
+        idleBackoffMs = idleBackoffMs == 0 ? SPOTIFY_IDLE_BACKOFF_MIN_MS : idleBackoffMs * 2;
+        if (idleBackoffMs > SPOTIFY_IDLE_BACKOFF_MAX_MS)
+            idleBackoffMs = SPOTIFY_IDLE_BACKOFF_MAX_MS;
+        return idleBackoffMs;
     }
 
-    return "";
+    idleBackoffMs = 0;
+    if (!now_playing.isPlaying || now_playing.durationMs == 0)
+        return SPOTIFY_PAUSED_POLL_MS;
+
+    uint32_t remaining = now_playing.durationMs > now_playing.progressMs
+                             ? now_playing.durationMs - now_playing.progressMs
+                             : 0;
+    uint32_t delay = remaining + SPOTIFY_TRACK_END_SLACK_MS;
+    if (delay < SPOTIFY_MIN_POLL_MS)
+        delay = SPOTIFY_MIN_POLL_MS;
+    if (delay > SPOTIFY_MAX_POLL_MS)
+        delay = SPOTIFY_MAX_POLL_MS;
+    return delay;
+}
+
+NowPlaying SpotifyClient::getCurrentlyPlaying()
+{
+    return getPlayingState(spotifyToken.get());
+}
+
+OAuthTokenStats SpotifyClient::getTokenStats()
+{
+    return spotifyToken.getStats();
 }
 
 NowPlaying SpotifyClient::getPlayingState(const String &access_token)
 {
-    HTTPClient http;
-    http.begin("https://api.spotify.com/v1/me/player/currently-playing");
-    http.addHeader("Authorization", "Bearer " + access_token);
+    TRACE_SCOPE("spotify fetch");
+    NowPlaying now_playing = {"", "", "", "", false, false, 0, 0};
+
+    HTTPClient *http = HttpPool::begin("https://api.spotify.com/v1/me/player/currently-playing");
+    if (!http)
+        return now_playing;
 
-    NowPlaying now_playing = {"", "", "", false};
+    http->addHeader("Authorization", "Bearer " + access_token);
+
+    int httpResponseCode = HttpPool::GET(http);
+    if (httpResponseCode == 200 || httpResponseCode == 204)
+        bootMark(BOOT_EVENT_FIRST_FRESH_DATA);
 
-    int httpResponseCode = http.GET();
     if (httpResponseCode == 200)
     {
-        String response = http.getString();
-        parseSpotifyResponse(response, now_playing);
+        HttpBodyStream body(*http);
+        parseSpotifyResponse(body, now_playing);
     }
     else if (httpResponseCode == 204)
     {
         now_playing.artist = "Spotify Inactive";
     }
+    else if (httpResponseCode == HTTP_CODE_UNAUTHORIZED)
+    {
+        // Revoked early; fetch a new one on the next poll
+        spotifyToken.invalidate();
+    }
 
-    http.end();
+    HttpPool::end(http);
     return now_playing;
 }
 
-void SpotifyClient::parseSpotifyResponse(const String &response, NowPlaying &now_playing)
+void SpotifyClient::parseSpotifyResponse(Stream &body, NowPlaying &now_playing)
 {
     StaticJsonDocument<256> filter;
     createSpotifyFilter(filter);
 
     DynamicJsonDocument doc(1024);
-    DeserializationError error = deserializeJson(doc, response, DeserializationOption::Filter(filter));
+    TRACE_BEGIN("json parse");
+    DeserializationError error = deserializeJson(doc, body, DeserializationOption::Filter(filter));
+    TRACE_END("json parse");
     if (error)
     {
         Serial.print(F("deserializeJson() deserialization failed: "));
@@ -122,8 +180,12 @@ void SpotifyClient::parseSpotifyResponse(const String &response, NowPlaying &now
 
     now_playing.artist = getArtistsString(doc["item"]["artists"]);
     now_playing.song = doc["item"]["name"].as<String>();
+    now_playing.albumUri = doc["item"]["album"]["uri"].as<String>();
     now_playing.albumImageUrl = getAlbumImageUrl(doc["item"]["album"]["images"]);
     now_playing.isPlaying = doc["is_playing"].as<bool>();
+    now_playing.isActive = true;
+    now_playing.progressMs = doc["progress_ms"] | 0u;
+    now_playing.durationMs = doc["item"]["duration_ms"] | 0u;
 }
 
 void SpotifyClient::createSpotifyFilter(JsonDocument &filter)
@@ -1,36 +1,53 @@
 #pragma once
 #include <Arduino.h>
 #include <ArduinoJson.h>
-#include <lvgl.h>
-
-struct SpotifyTaskData
-{
-    lv_obj_t *songLabel;
-};
-
-void spotifyTask(void *pvParameters);
+#include "oauth_token.h"
 
 struct NowPlaying
 {
     String artist;
     String song;
+    String albumUri;
     String albumImageUrl;
     bool isPlaying;
+    bool isActive;       // The player returned a track (HTTP 200)
+    uint32_t progressMs; // Position in the track when it was fetched
+    uint32_t durationMs;
 };
 
+/**
+ * Registers the token refresh and the now-playing poll with the
+ * FetchScheduler
+ */
+void registerSpotifyJobs();
+
 class SpotifyClient
 {
 public:
     static NowPlaying getCurrentlyPlaying();
 
-private:
-    static String accessToken;
-    static uint32_t lastTokenRefresh;
+    static OAuthTokenStats getTokenStats();
+    static void parseSpotifyResponse(Stream &body, NowPlaying &now_playing);
+
+    /**
+     * Picks the delay until the next poll. While a track plays the poll
+     * lands just after it should end, capped so skips still show up within
+     * a minute; while the player is inactive the delay backs off
+     * exponentially.
+     * @param now_playing Result of the last poll
+     * @param idleBackoffMs Current idle backoff, carried between calls
+     * @return Delay in milliseconds
+     */
+    static uint32_t nextPollDelayMs(const NowPlaying &now_playing, uint32_t &idleBackoffMs);
 
-    static String getToken();
-    static bool shouldRefreshToken();
+    /**
+     * Polls the player as soon as the network worker can, so a skip or
+     * pause shows without waiting for the next scheduled poll
+     */
+    static void pollNow();
+
+private:
     static NowPlaying getPlayingState(const String &access_token);
-    static void parseSpotifyResponse(const String &response, NowPlaying &now_playing);
     static void createSpotifyFilter(JsonDocument &filter);
     static String getArtistsString(JsonArray artists);
     static String getAlbumImageUrl(JsonArray images);
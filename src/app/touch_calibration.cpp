@@ -0,0 +1,130 @@
+#include "touch_calibration.h"
+
+#include <Arduino.h>
+
+#include "hardware.h"
+#include "touch_input.h"
+
+#define TOUCH_CALIBRATION_POINTS 3
+#define TOUCH_CALIBRATION_CROSS 20
+#define TOUCH_CALIBRATION_DONE_MS 1000
+
+// Targets in percent of the screen, spread out so the solve is well conditioned
+static const uint8_t targets[TOUCH_CALIBRATION_POINTS][2] = {{10, 15}, {90, 50}, {35, 88}};
+
+static lv_obj_t *overlay;
+static lv_obj_t *cross;
+static lv_obj_t *hint;
+static int step;
+static bool waitingForLift;  // Started while the pen was down, e.g. the boot hold
+static bool pressedOnTarget; // The current press began after this target was shown
+static TouchPoint screenPoints[TOUCH_CALIBRATION_POINTS];
+static TouchPoint rawPoints[TOUCH_CALIBRATION_POINTS];
+
+static void showTarget()
+{
+    lv_display_t *disp = lv_obj_get_display(overlay);
+    int32_t x = lv_display_get_horizontal_resolution(disp) * targets[step][0] / 100;
+    int32_t y = lv_display_get_vertical_resolution(disp) * targets[step][1] / 100;
+
+    lv_obj_set_pos(cross, x - TOUCH_CALIBRATION_CROSS / 2, y - TOUCH_CALIBRATION_CROSS / 2);
+    screenPoints[step].x = x;
+    screenPoints[step].y = y;
+    lv_label_set_text_fmt(hint, "Touch the cross (%d/%d)", step + 1, TOUCH_CALIBRATION_POINTS);
+    pressedOnTarget = false;
+}
+
+static void finishTimerCb(lv_timer_t *timer)
+{
+    lv_obj_delete(overlay);
+    overlay = NULL;
+}
+
+static void touchCb(lv_event_t *e)
+{
+    if (lv_event_get_code(e) == LV_EVENT_PRESSED)
+    {
+        pressedOnTarget = !waitingForLift;
+        return;
+    }
+
+    // Only a press that started on the shown target is a sample; the release
+    // of the hold that opened calibration just arms it
+    if (waitingForLift)
+    {
+        waitingForLift = false;
+        return;
+    }
+    if (!pressedOnTarget)
+        return;
+
+    rawPoints[step++] = TouchInput::lastRaw();
+    if (step < TOUCH_CALIBRATION_POINTS)
+    {
+        showTarget();
+        return;
+    }
+
+    step = 0;
+    if (!TouchInput::calibrate(screenPoints, rawPoints))
+    {
+        showTarget();
+        lv_label_set_text(hint, "Missed a target, again (1/3)");
+        return;
+    }
+
+    lv_obj_add_flag(cross, LV_OBJ_FLAG_HIDDEN);
+    lv_obj_remove_event_cb(overlay, touchCb);
+    lv_label_set_text(hint, "Calibrated");
+    lv_timer_t *timer = lv_timer_create(finishTimerCb, TOUCH_CALIBRATION_DONE_MS, NULL);
+    lv_timer_set_repeat_count(timer, 1);
+}
+
+/**
+ * A cross drawn from two thin bars
+ */
+static lv_obj_t *createCross(lv_obj_t *parent)
+{
+    lv_obj_t *box = lv_obj_create(parent);
+    lv_obj_remove_style_all(box);
+    lv_obj_set_size(box, TOUCH_CALIBRATION_CROSS, TOUCH_CALIBRATION_CROSS);
+    lv_obj_remove_flag(box, LV_OBJ_FLAG_CLICKABLE);
+
+    for (int i = 0; i < 2; i++)
+    {
+        lv_obj_t *bar = lv_obj_create(box);
+        lv_obj_remove_style_all(bar);
+        lv_obj_set_style_bg_opa(bar, LV_OPA_COVER, LV_PART_MAIN);
+        lv_obj_set_style_bg_color(bar, lv_color_hex(0xf1f3f3), LV_PART_MAIN);
+        lv_obj_set_size(bar, i ? 2 : TOUCH_CALIBRATION_CROSS, i ? TOUCH_CALIBRATION_CROSS : 2);
+        lv_obj_center(bar);
+        lv_obj_remove_flag(bar, LV_OBJ_FLAG_CLICKABLE);
+    }
+    return box;
+}
+
+void touchCalibrationStart()
+{
+    if (overlay)
+        return;
+
+    // Covers the whole screen on the top layer, so no touch reaches the app
+    overlay = lv_obj_create(lv_layer_top());
+    lv_obj_remove_style_all(overlay);
+    lv_obj_set_size(overlay, LV_PCT(100), LV_PCT(100));
+    lv_obj_set_style_bg_opa(overlay, LV_OPA_COVER, LV_PART_MAIN);
+    lv_obj_set_style_bg_color(overlay, lv_color_hex(0x000000), LV_PART_MAIN);
+    lv_obj_add_flag(overlay, LV_OBJ_FLAG_CLICKABLE);
+    lv_obj_add_event_cb(overlay, touchCb, LV_EVENT_PRESSED, NULL);
+    lv_obj_add_event_cb(overlay, touchCb, LV_EVENT_RELEASED, NULL);
+
+    hint = lv_label_create(overlay);
+    lv_obj_set_style_text_font(hint, &lv_font_montserrat_14, LV_PART_MAIN);
+    lv_obj_set_style_text_color(hint, lv_color_hex(0xf1f3f3), LV_PART_MAIN);
+    lv_obj_center(hint);
+
+    cross = createCross(overlay);
+    step = 0;
+    waitingForLift = touchscreenPressed();
+    showTarget();
+}
@@ -0,0 +1,12 @@
+#pragma once
+
+#include <lvgl.h>
+
+/**
+ * Shows the three-point touch calibration over the current screen: a cross
+ * at each target in turn, then solves and saves the calibration and
+ * removes itself. Points that turn out collinear (a missed target) start
+ * it over. A touch already down when it starts is ignored until lifted.
+ * Must be called from the GUI task, or before it starts.
+ */
+void touchCalibrationStart();
@@ -4,10 +4,17 @@
 #include <ArduinoJson.h>
 #include <HTTPClient.h>
 
-#include "lv_util.h"
+#include "ui_queue.h"
+#include "http_pool.h"
+#include "http_body_stream.h"
+#include "fetch_scheduler.h"
+#include "ui_cache.h"
+#include "boot_timeline.h"
+#include "trace.h"
 #include "config.h"
 
 #define WEATHER_UPDATE_INTERVAL_MIN 2
+#define WEATHER_UPDATE_SLACK_SEC 60 // May run this early to share a radio wakeup
 #define OPENMETEO_API_URL "http://api.open-meteo.com/v1/forecast"
 
 const char *getWeatherDescription(int weatherCode)
@@ -67,50 +74,61 @@ void createWeatherFilter(JsonDocument &filter)
     current["weather_code"] = true;
 }
 
-void weatherTask(void *pvParameters)
+bool parseWeatherResponse(Stream &body, float &temperature, int &weatherCode)
 {
-    WeatherTaskData *weatherData = (WeatherTaskData *)pvParameters;
-    HTTPClient http;
-
-    while (1)
-    {
-        Serial.println("Updating weather...");
-
-        char url[256];
-        snprintf(url, sizeof(url),
-                 "%s?latitude=%f&longitude=%f&current=temperature_2m,weather_code&temperature_unit=fahrenheit",
-                 OPENMETEO_API_URL, LATITUDE, LONGITUDE);
+    StaticJsonDocument<128> filter;
+    createWeatherFilter(filter);
+
+    DynamicJsonDocument doc(512);
+    TRACE_BEGIN("json parse");
+    DeserializationError error = deserializeJson(doc, body, DeserializationOption::Filter(filter));
+    TRACE_END("json parse");
+    if (error)
+        return false;
+
+    temperature = doc["current"]["temperature_2m"];
+    weatherCode = doc["current"]["weather_code"];
+    return true;
+}
 
-        http.begin(url);
-        int httpCode = http.GET();
+static uint32_t weatherJob()
+{
+    TRACE_SCOPE("weather fetch");
+    Serial.println("Updating weather...");
 
-        if (httpCode == HTTP_CODE_OK)
-        {
-            String payload = http.getString();
+    char url[256];
+    snprintf(url, sizeof(url),
+             "%s?latitude=%f&longitude=%f&current=temperature_2m,weather_code&temperature_unit=fahrenheit",
+             OPENMETEO_API_URL, LATITUDE, LONGITUDE);
 
-            StaticJsonDocument<128> filter;
-            createWeatherFilter(filter);
+    HTTPClient *http = HttpPool::begin(url);
+    int httpCode = http ? HttpPool::GET(http) : HTTPC_ERROR_CONNECTION_REFUSED;
 
-            DynamicJsonDocument doc(512);
-            DeserializationError error = deserializeJson(doc, payload, DeserializationOption::Filter(filter));
+    if (httpCode == HTTP_CODE_OK)
+    {
+        HttpBodyStream body(*http);
 
-            if (!error)
-            {
-                float temperature = doc["current"]["temperature_2m"];
-                int weatherCode = doc["current"]["weather_code"];
-                const char *weatherDesc = getWeatherDescription(weatherCode);
+        float temperature;
+        int weatherCode;
+        if (parseWeatherResponse(body, temperature, weatherCode))
+        {
+            const char *weatherDesc = getWeatherDescription(weatherCode);
 
-                char weatherText[64];
-                snprintf(weatherText, sizeof(weatherText), "%.0f°F (%s)", temperature, weatherDesc);
+            char weatherText[64];
+            snprintf(weatherText, sizeof(weatherText), "%.0f°F (%s)", temperature, weatherDesc);
 
-                GUILock lock;
-                lv_label_set_text(weatherData->temperatureLabel, weatherText);
-            }
+            uiPostText(UI_LABEL_TEMPERATURE, weatherText);
+            uiCacheSave(UI_LABEL_TEMPERATURE, weatherText);
+            bootMark(BOOT_EVENT_FIRST_FRESH_DATA);
         }
-
-        http.end();
-        vTaskDelay(pdMS_TO_TICKS(WEATHER_UPDATE_INTERVAL_MIN * 60 * 1000));
     }
 
-    vTaskDelete(NULL);
+    if (http)
+        HttpPool::end(http);
+    return WEATHER_UPDATE_INTERVAL_MIN * 60 * 1000;
+}
+
+void registerWeatherJobs()
+{
+    FetchScheduler::addJob("weather", weatherJob, FETCH_PRIORITY_LOW, true, WEATHER_UPDATE_SLACK_SEC * 1000);
 }
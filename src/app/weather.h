@@ -1,10 +1,14 @@
 #pragma once
 
-#include <lvgl.h>
+#include <Arduino.h>
 
-struct WeatherTaskData
-{
-    lv_obj_t *temperatureLabel;
-};
+/**
+ * Registers the periodic weather fetch with the FetchScheduler
+ */
+void registerWeatherJobs();
 
-void weatherTask(void *pvParameters);
+/**
+ * Reads the current conditions out of an Open-Meteo forecast response
+ * @return false if the body is not a valid forecast
+ */
+bool parseWeatherResponse(Stream &body, float &temperature, int &weatherCode);
@@ -0,0 +1,59 @@
+#include "boot_timeline.h"
+
+#include <Arduino.h>
+#include <atomic>
+
+#include "display_stats.h"
+
+static const char *const eventNames[BOOT_EVENT_COUNT] = {
+    "ui built", "first frame", "clock", "wifi", "ntp", "fresh data",
+};
+
+// Time of each event plus one, so zero-initialised means "not yet"
+static std::atomic<uint32_t> eventTimes[BOOT_EVENT_COUNT];
+
+void bootMark(BootEvent event)
+{
+    uint32_t unset = 0;
+    uint32_t now = millis();
+    if (!eventTimes[event].compare_exchange_strong(unset, now + 1))
+        return;
+
+    Serial.printf("boot: %s at %u ms\n", eventNames[event], (unsigned)now);
+    if (event == BOOT_EVENT_FIRST_FRESH_DATA)
+        bootTimelinePrint();
+}
+
+int32_t bootEventMs(BootEvent event)
+{
+    return (int32_t)eventTimes[event].load() - 1;
+}
+
+static void refreshReadyCb(lv_event_t *e)
+{
+    // The whole screen starts out invalid, so the first refresh that
+    // flushed anything drew a complete frame
+    if (getDisplayStats().bytesFlushed > 0)
+        bootMark(BOOT_EVENT_FIRST_FRAME);
+}
+
+void bootTimelineWatchDisplay(lv_display_t *disp)
+{
+    lv_display_add_event_cb(disp, refreshReadyCb, LV_EVENT_REFR_READY, NULL);
+}
+
+void bootTimelinePrint()
+{
+    char line[160];
+    int length = snprintf(line, sizeof(line), "boot timeline:");
+    const char *separator = " ";
+    for (int i = 0; i < BOOT_EVENT_COUNT; i++)
+    {
+        int32_t ms = bootEventMs((BootEvent)i);
+        if (ms < 0)
+            continue;
+        length += snprintf(line + length, sizeof(line) - length, "%s%s %d ms", separator, eventNames[i], (int)ms);
+        separator = ", ";
+    }
+    Serial.println(line);
+}
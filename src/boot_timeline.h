@@ -0,0 +1,41 @@
+#pragma once
+
+#include <lvgl.h>
+#include <stdint.h>
+
+/**
+ * Milestones of a boot, in the order they usually happen
+ */
+enum BootEvent : uint8_t
+{
+    BOOT_EVENT_UI_BUILT,        // Widgets created and filled from the cache
+    BOOT_EVENT_FIRST_FRAME,     // First full frame pushed to the panel
+    BOOT_EVENT_CLOCK_SHOWN,     // Time first posted to the clock
+    BOOT_EVENT_WIFI_CONNECTED,
+    BOOT_EVENT_TIME_SYNCED,     // NTP answered
+    BOOT_EVENT_FIRST_FRESH_DATA, // First successful fetch from any API
+    BOOT_EVENT_COUNT,
+};
+
+/**
+ * Records when an event first happened, in ms since boot (process start on
+ * the native build). Later calls for the same event are ignored, so it is
+ * cheap to call on every success. Safe from any task.
+ */
+void bootMark(BootEvent event);
+
+/**
+ * @return Time of the event in ms since boot, or -1 if it has not happened
+ */
+int32_t bootEventMs(BootEvent event);
+
+/**
+ * Marks BOOT_EVENT_FIRST_FRAME after the first refresh that reached the
+ * panel. Call once the UI is built, before guiTask starts.
+ */
+void bootTimelineWatchDisplay(lv_display_t *disp);
+
+/**
+ * Prints every event recorded so far on one line
+ */
+void bootTimelinePrint();
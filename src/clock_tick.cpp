@@ -0,0 +1,140 @@
+#include "clock_tick.h"
+
+#include <atomic>
+#include <mutex>
+
+#include "metrics.h"
+#include "time_service.h"
+
+// Slewing runs the clock up to 500 ppm fast or slow, 30 ms over a minute.
+// Waking this late usually avoids a second sleep; when it does not, the
+// remainder is slept off.
+#define CLOCK_TICK_MARGIN_MS 20
+#define CLOCK_TICK_STATS_INTERVAL_MS (60 * 60 * 1000)
+
+static TaskHandle_t clockTask;
+static std::atomic<uint8_t> tickUnit(CLOCK_TICK_MINUTE);
+static char shownText[UI_LABEL_COUNT][CLOCK_TICK_TEXT_SIZE];
+static ClockTickStats stats;
+static std::mutex statsMutex;
+
+static void countWakeup(bool kicked)
+{
+    static ClockTickStats last;
+    static uint32_t lastReport = millis();
+
+    std::lock_guard<std::mutex> lock(statsMutex);
+    stats.wakeups++;
+    if (kicked)
+        stats.kicks++;
+
+    if (millis() - lastReport >= CLOCK_TICK_STATS_INTERVAL_MS)
+    {
+        lastReport = millis();
+        Serial.printf("clock tick: %u wakeups (%u kicked, %u early), %u GUI posts in the last hour\n",
+                      (unsigned)(stats.wakeups - last.wakeups), (unsigned)(stats.kicks - last.kicks),
+                      (unsigned)(stats.early - last.early), (unsigned)(stats.posts - last.posts));
+        last = stats;
+    }
+}
+
+uint32_t clockTickDelayMs(int64_t nowUs, ClockTickUnit unit)
+{
+    int64_t periodUs = unit == CLOCK_TICK_SECOND ? 1000000 : 60000000;
+    int64_t untilUs = periodUs - nowUs % periodUs;
+    return (untilUs + 999) / 1000 + CLOCK_TICK_MARGIN_MS;
+}
+
+static void exportMetrics()
+{
+    static Metric *wakeups = Metrics::counter("tick.wakeups");
+    static Metric *posts = Metrics::counter("tick.posts");
+    static Metric *unchanged = Metrics::counter("tick.unchanged");
+
+    ClockTickStats current = ClockTick::getStats();
+    wakeups->set(current.wakeups);
+    posts->set(current.posts);
+    unchanged->set(current.unchanged);
+}
+
+void ClockTick::begin(ClockTickUnit unit)
+{
+    Metrics::addSource(exportMetrics);
+    clockTask = xTaskGetCurrentTaskHandle();
+    tickUnit = unit;
+}
+
+void ClockTick::setUnit(ClockTickUnit unit)
+{
+    tickUnit = unit;
+    kick();
+}
+
+ClockTickUnit ClockTick::getUnit()
+{
+    return (ClockTickUnit)tickUnit.load();
+}
+
+void ClockTick::kick()
+{
+    if (clockTask)
+        xTaskNotifyGive(clockTask);
+}
+
+bool ClockTick::wait()
+{
+    ClockTickUnit unit = getUnit();
+    int64_t periodUs = unit == CLOCK_TICK_SECOND ? 1000000 : 60000000;
+    int64_t nowUs = TimeService::nowUs();
+    int64_t boundaryUs = nowUs - nowUs % periodUs + periodUs;
+    bool kicked = false;
+
+    while (1)
+    {
+        if (ulTaskNotifyTake(pdTRUE, pdMS_TO_TICKS(clockTickDelayMs(nowUs, unit))) > 0)
+        {
+            kicked = true;
+            break;
+        }
+
+        nowUs = TimeService::nowUs();
+        if (nowUs >= boundaryUs)
+            break;
+
+        std::lock_guard<std::mutex> lock(statsMutex);
+        stats.early++;
+    }
+
+    countWakeup(kicked);
+    return kicked;
+}
+
+bool ClockTick::waitFor(uint32_t ms)
+{
+    bool kicked = ulTaskNotifyTake(pdTRUE, pdMS_TO_TICKS(ms)) > 0;
+    countWakeup(kicked);
+    return kicked;
+}
+
+bool ClockTick::post(UiLabelId label, const char *text)
+{
+    bool changed = strncmp(shownText[label], text, CLOCK_TICK_TEXT_SIZE) != 0;
+    if (changed)
+    {
+        strncpy(shownText[label], text, CLOCK_TICK_TEXT_SIZE - 1);
+        uiPostText(label, text);
+    }
+
+    std::lock_guard<std::mutex> lock(statsMutex);
+    if (changed)
+        stats.posts++;
+    else
+        stats.unchanged++;
+    return changed;
+}
+
+ClockTickStats ClockTick::getStats()
+{
+    std::lock_guard<std::mutex> lock(statsMutex);
+    return stats;
+}
@@ -0,0 +1,73 @@
+#pragma once
+
+#include <Arduino.h>
+
+#include "ui_queue.h"
+
+#define CLOCK_TICK_TEXT_SIZE 32
+
+enum ClockTickUnit : uint8_t
+{
+    CLOCK_TICK_MINUTE,
+    CLOCK_TICK_SECOND,
+};
+
+struct ClockTickStats
+{
+    uint32_t wakeups;  // Returns from wait()
+    uint32_t kicks;    // Wakeups brought forward by kick()
+    uint32_t early;    // Sleeps that ended before the boundary and were resumed
+    uint32_t posts;    // Text posted to the GUI, each one a guiTask wakeup
+    uint32_t unchanged; // post() calls dropped as identical to the shown text
+};
+
+/**
+ * Wakes the clock task only when the displayed time can change: at the
+ * next minute boundary, or second in CLOCK_TICK_SECOND mode, on
+ * TimeService's clock. Local midnight and DST changes fall on minute
+ * boundaries too, so the date needs no tick of its own. When the clock is
+ * stepped, kick() cuts the sleep short so the new time shows at once.
+ *
+ * begin(), wait() and post() belong to the one clock task; kick() and
+ * setUnit() may be called from any task.
+ */
+class ClockTick
+{
+public:
+    /** Makes the calling task the one that wait() puts to sleep */
+    static void begin(ClockTickUnit unit);
+
+    static void setUnit(ClockTickUnit unit);
+    static ClockTickUnit getUnit();
+
+    /** Ends the current wait() now, e.g. after a time sync */
+    static void kick();
+
+    /**
+     * Sleeps until just past the next boundary, or until kick()
+     * @return true if kicked
+     */
+    static bool wait();
+
+    /**
+     * Sleeps for a fixed time, or until kick(); for use while the clock is
+     * not set and there is no boundary to wait for
+     * @return true if kicked
+     */
+    static bool waitFor(uint32_t ms);
+
+    /**
+     * Posts text to a label unless it is already showing it
+     * @return true if posted
+     */
+    static bool post(UiLabelId label, const char *text);
+
+    static ClockTickStats getStats();
+};
+
+/**
+ * Time from nowUs until just past the next multiple of the unit, late by a
+ * margin that covers the clock being slewed during the sleep
+ * @param nowUs Microseconds since the epoch
+ */
+uint32_t clockTickDelayMs(int64_t nowUs, ClockTickUnit unit);
@@ -3,19 +3,54 @@
 #define TFT_HOR_RES 240
 #define TFT_VER_RES 320
 
+// The panel scans in landscape through MADCTL (tft.setRotation(1)), so LVGL
+// renders at this size straight in the order pixels go out, and rotates nothing
+#define SCREEN_HOR_RES TFT_VER_RES
+#define SCREEN_VER_RES TFT_HOR_RES
+
 #define XPT2046_IRQ 36
 #define XPT2046_MOSI 32
 #define XPT2046_MISO 39
 #define XPT2046_CLK 25
 #define XPT2046_CS 33
 
-#define DRAW_BUF_SIZE (TFT_HOR_RES * TFT_VER_RES / 20 * (LV_COLOR_DEPTH / 8))
+// Each of the two DMA draw buffers covers 1/DRAW_BUF_FRACTION of the screen
+#define DRAW_BUF_FRACTION 10
+#define DRAW_BUF_SIZE (TFT_HOR_RES * TFT_VER_RES / DRAW_BUF_FRACTION * (LV_COLOR_DEPTH / 8))
 
 #define LVGL_CORE 0
 #define APP_CORE 1
 
 #define LVGL_STACK_SIZE 6144
 #define APP_STACK_SIZE 8192
+#define NETWORK_STACK_SIZE 8192 // Shared by every fetch; TLS handshakes are the deepest
+#define WIFI_STACK_SIZE 3072
+
+// Calendar refresh: CALENDAR_SYNC_FULL, CALENDAR_SYNC_ETAG (conditional
+// requests) or CALENDAR_SYNC_TOKEN (incremental sync; falls back to ETag for
+// a calendar with too many events in the next 24 h to sync)
+#define CALENDAR_SYNC_MODE CALENDAR_SYNC_ETAG
+// Keep the calendar's event cache in NVS so it is shown right after a reboot
+#define CALENDAR_PERSIST_CACHE 1
+
+// Decoded album covers kept in RAM, 8 KB each (PSRAM when the board has it)
+#define ALBUM_ART_CACHE_SIZE 6
+
+// POSIX TZ string with its daylight saving rules: US Eastern
+#define TIME_ZONE "EST5EDT,M3.2.0,M11.1.0"
+// Show seconds on the clock, which then wakes every second instead of every minute
+#define CLOCK_SHOW_SECONDS 0
+
+// Record GUI, render and fetch timings into a ring that serial 't' dumps (see
+// trace.h). Off unless a build sets it; the native build does.
+#ifndef TRACE_ENABLED
+#define TRACE_ENABLED 0
+#endif
+#define TRACE_RING_SIZE 1024 // Events kept, 12 bytes each; a power of two
+
+// Heap, stack, CPU and module metrics printed as "metrics:" frames (see
+// metrics.h); 0 keeps the registry but prints nothing
+#define METRICS_INTERVAL_MS 10000
 
 #define LATITUDE 39.7876
 #define LONGITUDE -75.6966
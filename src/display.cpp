@@ -0,0 +1,165 @@
+#include <Arduino.h>
+#include <lvgl.h>
+#include <TFT_eSPI.h>
+#include <SPI.h>
+#include <esp_heap_caps.h>
+
+#include "hardware.h"
+#include "config.h"
+#include "display_stats.h"
+#include "rgb565_kernels.h"
+#include "trace.h"
+#include "touch_input.h"
+
+TFT_eSPI tft = TFT_eSPI();
+
+SPIClass touchscreenSpi(VSPI);
+
+// XPT2046 control bytes: start bit, channel, 12-bit differential mode. The
+// last conversion of a read powers down with PENIRQ enabled again.
+#define XPT2046_CMD_X 0x91
+#define XPT2046_CMD_Y 0xD1
+#define XPT2046_CMD_Z1 0xB1
+#define XPT2046_CMD_Z2 0xC1
+#define XPT2046_CMD_POWER_DOWN 0xD0
+
+// PENIRQ goes low while the panel is touched. It is not valid during a
+// conversion, so the edge only arms the next read; the pin level is what
+// says the pen is up again.
+static volatile bool penDown;
+
+static void IRAM_ATTR penIrq()
+{
+    penDown = true;
+}
+
+void initTouchscreen()
+{
+    pinMode(XPT2046_CS, OUTPUT);
+    digitalWrite(XPT2046_CS, HIGH);
+    pinMode(XPT2046_IRQ, INPUT);
+    touchscreenSpi.begin(XPT2046_CLK, XPT2046_MISO, XPT2046_MOSI, XPT2046_CS);
+    attachInterrupt(digitalPinToInterrupt(XPT2046_IRQ), penIrq, FALLING);
+    penDown = digitalRead(XPT2046_IRQ) == LOW;
+    TouchInput::begin();
+
+    lv_indev_t *indev = lv_indev_create();
+    lv_indev_set_type(indev, LV_INDEV_TYPE_POINTER);
+    lv_indev_set_read_cb(indev, touchpadRead);
+}
+
+// LVGL alternates between the two draw buffers, so a buffer is only rendered
+// into again after the following flush. Waiting for the previous DMA transfer
+// here is therefore enough to keep it from being overwritten mid-transfer, and
+// flush_ready can be signalled immediately so LVGL renders the next chunk
+// while this one is still on the bus. With only one buffer LVGL renders into
+// it straight away, so the transfer has to finish first.
+static bool singleBuffer;
+
+static void tftFlush(lv_display_t *disp, const lv_area_t *area, uint8_t *px_map)
+{
+    uint32_t w = lv_area_get_width(area);
+    uint32_t h = lv_area_get_height(area);
+    TRACE_SCOPE("flush");
+
+    tft.dmaWait();
+    rgb565Swap((uint16_t *)px_map, w * h); // The panel takes big-endian RGB565
+    tft.setAddrWindow(area->x1, area->y1, w, h);
+    tft.pushPixelsDMA((uint16_t *)px_map, w * h);
+    if (singleBuffer)
+        tft.dmaWait();
+    recordDisplayFlush(area, w * h * sizeof(uint16_t));
+
+    lv_display_flush_ready(disp);
+}
+
+void initDisplay()
+{
+    tft.begin();
+    tft.setRotation(1); // Landscape in MADCTL: the panel does the rotating, not LVGL
+    tft.setSwapBytes(false); // tftFlush swaps a word at a time instead of a pixel at a time
+    tft.initDMA();
+    tft.startWrite(); // The panel owns its SPI bus, so keep it selected for DMA
+
+    uint8_t *draw_buf1 = (uint8_t *)heap_caps_malloc(DRAW_BUF_SIZE, MALLOC_CAP_DMA);
+    uint8_t *draw_buf2 = (uint8_t *)heap_caps_malloc(DRAW_BUF_SIZE, MALLOC_CAP_DMA);
+    if (!draw_buf1)
+    {
+        draw_buf1 = draw_buf2;
+        draw_buf2 = NULL;
+    }
+    if (!draw_buf1)
+    {
+        Serial.printf("No DMA memory for a %u byte draw buffer, restarting\n", (unsigned)DRAW_BUF_SIZE);
+        delay(1000); // Lets the message out
+        ESP.restart();
+    }
+    if (!draw_buf2)
+    {
+        Serial.println("Only one draw buffer fits in DMA memory, flushes will block");
+        singleBuffer = true;
+    }
+
+    lv_display_t *disp = lv_display_create(SCREEN_HOR_RES, SCREEN_VER_RES);
+    lv_display_set_flush_cb(disp, tftFlush);
+    lv_display_set_buffers(disp, draw_buf1, draw_buf2, DRAW_BUF_SIZE, LV_DISPLAY_RENDER_MODE_PARTIAL);
+    initDisplayStats(disp);
+}
+
+bool touchscreenPressed()
+{
+    return digitalRead(XPT2046_IRQ) == LOW;
+}
+
+/**
+ * Reads pressure and a burst of positions in one SPI transaction. Each
+ * transfer clocks out the previous conversion's result while sending the
+ * next command, and the first position after a channel switch is noisy.
+ */
+static int readTouchBurst(TouchSample *samples)
+{
+    touchscreenSpi.beginTransaction(SPISettings(SPI_TOUCH_FREQUENCY, MSBFIRST, SPI_MODE0));
+    digitalWrite(XPT2046_CS, LOW);
+
+    touchscreenSpi.transfer(XPT2046_CMD_Z1);
+    int32_t z1 = touchscreenSpi.transfer16(XPT2046_CMD_Z2) >> 3;
+    int32_t z2 = touchscreenSpi.transfer16(XPT2046_CMD_X) >> 3;
+    int32_t z = z1 + 4095 - z2;
+
+    touchscreenSpi.transfer16(XPT2046_CMD_X);
+    for (int i = 0; i < TOUCH_BURST_SIZE; i++)
+    {
+        uint16_t x = touchscreenSpi.transfer16(XPT2046_CMD_Y) >> 3;
+        uint8_t next = i == TOUCH_BURST_SIZE - 1 ? XPT2046_CMD_POWER_DOWN : XPT2046_CMD_X;
+        uint16_t y = touchscreenSpi.transfer16(next) >> 3;
+
+        // The orientation XPT2046_Touchscreen's setRotation(2) gave
+        samples[i].x = y;
+        samples[i].y = 4095 - x;
+        samples[i].z = z < 0 ? 0 : z;
+    }
+    touchscreenSpi.transfer16(0);
+
+    digitalWrite(XPT2046_CS, HIGH);
+    touchscreenSpi.endTransaction();
+    return TOUCH_BURST_SIZE;
+}
+
+void touchpadRead(lv_indev_t *indev, lv_indev_data_t *data)
+{
+    // Untouched: answer from the IRQ line without waking the controller
+    TouchSample samples[TOUCH_BURST_SIZE];
+    int count = 0;
+    if (penDown || digitalRead(XPT2046_IRQ) == LOW)
+    {
+        count = readTouchBurst(samples);
+        if (digitalRead(XPT2046_IRQ) == HIGH)
+            penDown = false;
+    }
+
+    TouchPoint point;
+    bool pressed = TouchInput::update(count ? samples : NULL, count, &point);
+    data->point.x = point.x;
+    data->point.y = point.y;
+    data->state = pressed ? LV_INDEV_STATE_PRESSED : LV_INDEV_STATE_RELEASED;
+}
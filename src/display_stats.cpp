@@ -0,0 +1,59 @@
+#include "display_stats.h"
+
+#include <Arduino.h>
+
+#include "metrics.h"
+
+#define DISPLAY_STATS_INTERVAL_MS 1000
+
+static DisplayStats totals;
+static DisplayStats lastReport;
+
+static void invalidateEventCb(lv_event_t *e)
+{
+    totals.areasInvalidated++;
+}
+
+static void reportTimerCb(lv_timer_t *timer)
+{
+    DisplayStats delta = {
+        totals.areasInvalidated - lastReport.areasInvalidated,
+        totals.pixelsRendered - lastReport.pixelsRendered,
+        totals.bytesFlushed - lastReport.bytesFlushed,
+    };
+    lastReport = totals;
+
+    if (delta.areasInvalidated == 0 && delta.bytesFlushed == 0)
+        return;
+
+    Serial.printf("display/s: %u areas invalidated, %u px rendered, %u bytes flushed\n",
+                  (unsigned)delta.areasInvalidated, (unsigned)delta.pixelsRendered, (unsigned)delta.bytesFlushed);
+}
+
+static void exportMetrics()
+{
+    static Metric *areas = Metrics::counter("display.areas");
+    static Metric *pixels = Metrics::counter("display.pixels");
+    static Metric *bytes = Metrics::counter("display.bytes");
+    areas->set(totals.areasInvalidated);
+    pixels->set(totals.pixelsRendered);
+    bytes->set(totals.bytesFlushed);
+}
+
+void initDisplayStats(lv_display_t *disp)
+{
+    Metrics::addSource(exportMetrics);
+    lv_display_add_event_cb(disp, invalidateEventCb, LV_EVENT_INVALIDATE_AREA, NULL);
+    lv_timer_create(reportTimerCb, DISPLAY_STATS_INTERVAL_MS, NULL);
+}
+
+void recordDisplayFlush(const lv_area_t *area, uint32_t bytes)
+{
+    totals.pixelsRendered += lv_area_get_size(area);
+    totals.bytesFlushed += bytes;
+}
+
+DisplayStats getDisplayStats()
+{
+    return totals;
+}
@@ -0,0 +1,32 @@
+#pragma once
+
+#include <lvgl.h>
+
+/**
+ * Display work counters, accumulated since the last reset
+ */
+struct DisplayStats
+{
+    uint32_t areasInvalidated;
+    uint32_t pixelsRendered;
+    uint32_t bytesFlushed;
+};
+
+/**
+ * Hooks invalidation counting onto the display and starts a 1 Hz LVGL timer
+ * that prints the per-second counters to serial whenever the screen changed
+ * @param disp Display to monitor
+ */
+void initDisplayStats(lv_display_t *disp);
+
+/**
+ * Records one flushed area; called from the display driver's flush callback
+ * @param area Area being flushed
+ * @param bytes Bytes pushed to the panel for it
+ */
+void recordDisplayFlush(const lv_area_t *area, uint32_t bytes);
+
+/**
+ * Returns the counters accumulated since startup
+ */
+DisplayStats getDisplayStats();
@@ -0,0 +1,231 @@
+#include "fetch_scheduler.h"
+
+#include <atomic>
+
+#include "metrics.h"
+
+#define FETCH_REPORT_INTERVAL_MS (10 * 60 * 1000)
+#define FETCH_MAX_SLEEP_MS 60000
+
+struct FetchJob
+{
+    FetchJobFn run;
+    FetchPriority priority;
+    bool network;
+    uint32_t slackMs;
+    uint32_t dueAt;
+    uint32_t batch; // Last batch the job ran in, so each runs at most once per batch
+    Metric *runMs;
+    std::atomic<bool> runRequested; // Set by runNow() from other tasks
+};
+
+// Fetches range from a cached ETag answer to a TLS handshake on a weak link
+static const uint32_t runMsBuckets[METRIC_BUCKETS - 1] = {50, 100, 250, 500, 1000, 2500, 5000};
+
+static FetchJob jobs[FETCH_MAX_JOBS];
+static FetchSchedulerStats stats;
+static TaskHandle_t workerTask;
+static std::atomic<bool> networkReady{false};
+
+static inline int32_t msUntil(uint32_t time, uint32_t now)
+{
+    return (int32_t)(time - now);
+}
+
+bool FetchScheduler::addJob(const char *name, FetchJobFn run, FetchPriority priority, bool network,
+                            uint32_t slackMs, uint32_t firstDelayMs)
+{
+    if (stats.jobCount >= FETCH_MAX_JOBS)
+        return false;
+
+    FetchJob &job = jobs[stats.jobCount];
+    job.run = run;
+    job.priority = priority;
+    job.network = network;
+    job.slackMs = slackMs;
+    job.dueAt = millis() + firstDelayMs;
+    job.batch = 0;
+
+    char metricName[METRIC_NAME_SIZE];
+    snprintf(metricName, sizeof(metricName), "job.%s.ms", name);
+    job.runMs = Metrics::histogram(metricName, runMsBuckets);
+
+    stats.jobs[stats.jobCount].name = name;
+    stats.jobCount++;
+    return true;
+}
+
+/**
+ * Most urgent job that may run in this batch: past its deadline, or for a
+ * radio batch within its slack of it
+ */
+static int nextJob(uint32_t now, bool radio, bool online)
+{
+    int best = -1;
+    for (uint32_t i = 0; i < stats.jobCount; i++)
+    {
+        const FetchJob &job = jobs[i];
+        if (job.batch == stats.batches || (job.network && !online))
+            continue;
+
+        int32_t untilDue = msUntil(job.dueAt, now);
+        if (untilDue > 0 && !(radio && job.network && untilDue <= (int32_t)job.slackMs))
+            continue;
+
+        if (best < 0 || job.priority < jobs[best].priority ||
+            (job.priority == jobs[best].priority && msUntil(job.dueAt, jobs[best].dueAt) < 0))
+            best = i;
+    }
+    return best;
+}
+
+static void runJob(int index, uint32_t now)
+{
+    FetchJob &job = jobs[index];
+    FetchJobStats &jobStats = stats.jobs[index];
+
+    int32_t late = -msUntil(job.dueAt, now);
+    if (late < 0)
+        jobStats.earlyRuns++;
+    else if ((uint32_t)late > jobStats.maxLateMs)
+        jobStats.maxLateMs = late;
+
+    job.batch = stats.batches;
+    uint32_t delayMs = job.run();
+
+    uint32_t finished = millis();
+    uint32_t busy = finished - now;
+    job.dueAt = finished + delayMs;
+    job.runMs->observe(busy);
+    jobStats.runs++;
+    jobStats.busyMsTotal += busy;
+    if (busy > jobStats.busyMsMax)
+        jobStats.busyMsMax = busy;
+}
+
+static void reportStats()
+{
+    Serial.printf("network worker: %u batches (%u radio), stack high water %u bytes, free heap %u bytes\n",
+                  (unsigned)stats.batches, (unsigned)stats.radioBatches, (unsigned)stats.stackHighWater,
+                  (unsigned)ESP.getFreeHeap());
+    for (uint32_t i = 0; i < stats.jobCount; i++)
+    {
+        const FetchJobStats &job = stats.jobs[i];
+        Serial.printf("  %-14s %5u runs, %4u early, max %u ms late, avg %u ms busy\n", job.name,
+                      (unsigned)job.runs, (unsigned)job.earlyRuns, (unsigned)job.maxLateMs,
+                      job.runs ? (unsigned)(job.busyMsTotal / job.runs) : 0u);
+    }
+}
+
+static void fetchWorkerTask(void *pvParameters)
+{
+    uint32_t lastReport = millis();
+    stats.stackHighWater = uxTaskGetStackHighWaterMark(NULL);
+    bool wasOnline = false;
+
+    while (1)
+    {
+        uint32_t now = millis();
+        bool online = networkReady.load();
+        if (online && !wasOnline)
+        {
+            // Jobs held back for the network are due now, not late
+            for (uint32_t i = 0; i < stats.jobCount; i++)
+            {
+                if (jobs[i].network && msUntil(jobs[i].dueAt, now) < 0)
+                    jobs[i].dueAt = now;
+            }
+        }
+        wasOnline = online;
+
+        for (uint32_t i = 0; i < stats.jobCount; i++)
+        {
+            if (jobs[i].runRequested.exchange(false))
+                jobs[i].dueAt = now;
+        }
+
+        int32_t sleepMs = FETCH_MAX_SLEEP_MS;
+        bool radio = false;
+        for (uint32_t i = 0; i < stats.jobCount; i++)
+        {
+            if (jobs[i].network && !online)
+                continue;
+
+            int32_t untilDue = msUntil(jobs[i].dueAt, now);
+            if (untilDue < sleepMs)
+                sleepMs = untilDue;
+            if (untilDue <= 0 && jobs[i].network)
+                radio = true;
+        }
+
+        if (sleepMs > 0)
+        {
+            ulTaskNotifyTake(pdTRUE, pdMS_TO_TICKS(sleepMs));
+            continue;
+        }
+
+        stats.batches++;
+        if (radio)
+            stats.radioBatches++;
+
+        int index;
+        while ((index = nextJob(now, radio, online)) >= 0)
+        {
+            runJob(index, now);
+            now = millis();
+        }
+
+        uint32_t highWater = uxTaskGetStackHighWaterMark(NULL);
+        if (highWater < stats.stackHighWater)
+            stats.stackHighWater = highWater;
+
+        if (now - lastReport >= FETCH_REPORT_INTERVAL_MS)
+        {
+            reportStats();
+            lastReport = now;
+        }
+    }
+
+    vTaskDelete(NULL);
+}
+
+static void exportMetrics()
+{
+    static Metric *batches = Metrics::counter("fetch.batches");
+    static Metric *radioBatches = Metrics::counter("fetch.radio_batches");
+    batches->set(stats.batches);
+    radioBatches->set(stats.radioBatches);
+}
+
+void FetchScheduler::start(uint32_t stackSize, UBaseType_t priority, BaseType_t core)
+{
+    Metrics::addSource(exportMetrics);
+    xTaskCreatePinnedToCore(fetchWorkerTask, "network", stackSize, NULL, priority, &workerTask, core);
+}
+
+void FetchScheduler::setNetworkReady(bool ready)
+{
+    networkReady = ready;
+    if (workerTask)
+        xTaskNotifyGive(workerTask);
+}
+
+bool FetchScheduler::runNow(FetchJobFn run)
+{
+    for (uint32_t i = 0; i < stats.jobCount; i++)
+    {
+        if (jobs[i].run == run)
+        {
+            jobs[i].runRequested = true;
+            if (workerTask)
+                xTaskNotifyGive(workerTask);
+            return true;
+        }
+    }
+    return false;
+}
+
+FetchSchedulerStats FetchScheduler::getStats()
+{
+    return stats;
+}
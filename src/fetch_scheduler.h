@@ -0,0 +1,85 @@
+#pragma once
+
+#include <Arduino.h>
+
+#define FETCH_MAX_JOBS 8
+
+enum FetchPriority : uint8_t
+{
+    FETCH_PRIORITY_HIGH, // Token refreshes, which the other fetches depend on
+    FETCH_PRIORITY_NORMAL,
+    FETCH_PRIORITY_LOW,
+};
+
+/**
+ * Runs one job on the network worker
+ * @return Milliseconds until it should run again
+ */
+typedef uint32_t (*FetchJobFn)();
+
+struct FetchJobStats
+{
+    const char *name;
+    uint32_t runs;
+    uint32_t earlyRuns;  // Runs pulled forward into another job's batch
+    uint32_t maxLateMs;  // Worst delay past the deadline, e.g. behind a slow fetch
+    uint32_t busyMsTotal;
+    uint32_t busyMsMax;
+};
+
+struct FetchSchedulerStats
+{
+    uint32_t batches;       // Wakeups that ran at least one job
+    uint32_t radioBatches;  // Batches that used the network
+    uint32_t stackHighWater; // Least free stack the worker has had, in bytes
+    uint32_t jobCount;
+    FetchJobStats jobs[FETCH_MAX_JOBS];
+};
+
+/**
+ * Single network worker replacing one task per API. Jobs are kept in a
+ * deadline queue: the worker sleeps until the earliest deadline, then runs
+ * every job that is due, most important first, so requests never compete
+ * for the radio. Network jobs may also declare some slack; when the radio
+ * is woken for one job, any other whose deadline is within its slack runs
+ * in the same batch instead of waking it again later.
+ *
+ * Register all jobs with addJob() before start(). Network jobs are held
+ * until setNetworkReady(true), so local jobs can start right at boot.
+ */
+class FetchScheduler
+{
+public:
+    /**
+     * @param name For logs and stats
+     * @param run Job body, which returns its next delay
+     * @param priority Order among jobs due together
+     * @param network Whether the job uses the radio; local jobs (e.g.
+     *        re-ranking a cache) never start or join a radio batch
+     * @param slackMs How early the job may run to share a radio batch
+     * @param firstDelayMs Delay before the first run
+     * @return false if the job table is full
+     */
+    static bool addJob(const char *name, FetchJobFn run, FetchPriority priority, bool network, uint32_t slackMs,
+                       uint32_t firstDelayMs = 0);
+
+    /**
+     * Makes a registered job due now, e.g. for a refresh the user asked for.
+     * Safe from any task; the job still waits for the network.
+     * @return false if the job is not registered
+     */
+    static bool runNow(FetchJobFn run);
+
+    /**
+     * Starts the worker task
+     */
+    static void start(uint32_t stackSize, UBaseType_t priority, BaseType_t core);
+
+    /**
+     * Releases or holds the network jobs. Jobs that fell due while held run
+     * as soon as the network is ready; the wait does not count as late.
+     */
+    static void setNetworkReady(bool ready);
+
+    static FetchSchedulerStats getStats();
+};
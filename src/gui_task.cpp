@@ -0,0 +1,86 @@
+#include "gui_task.h"
+
+#include <Arduino.h>
+#include <lvgl.h>
+
+#include "ui_queue.h"
+#include "metrics.h"
+#include "trace.h"
+
+#define GUI_MIN_SLEEP_MS 1
+#define GUI_MAX_SLEEP_MS 500
+#define GUI_STATS_INTERVAL_MS 60000
+
+static GuiTaskStats stats;
+static uint64_t startMicros;
+
+// A wakeup that only runs timers is well under a millisecond; a full-screen
+// redraw is tens of them
+static const uint32_t busyUsBuckets[METRIC_BUCKETS - 1] = {500, 1000, 2000, 5000, 10000, 20000, 50000};
+
+static void reportStats()
+{
+    static GuiTaskStats last;
+
+    uint32_t wakeups = stats.wakeups - last.wakeups;
+    uint32_t notified = stats.notifiedWakeups - last.notifiedWakeups;
+    uint64_t busy = stats.busyMicros - last.busyMicros;
+    uint64_t elapsed = stats.elapsedMicros - last.elapsedMicros;
+    last = stats;
+
+    Serial.printf("guiTask: %.1f wakeups/s (%u notified), %.1f%% idle\n",
+                  wakeups * 1000000.0 / elapsed, (unsigned)notified, 100.0 - busy * 100.0 / elapsed);
+}
+
+static void exportMetrics()
+{
+    static Metric *wakeups = Metrics::counter("gui.wakeups");
+    static Metric *notified = Metrics::counter("gui.notified");
+    wakeups->set(stats.wakeups);
+    notified->set(stats.notifiedWakeups);
+}
+
+void guiTask(void *pvParameters)
+{
+    Metric *busyUs = Metrics::histogram("gui.busy_us", busyUsBuckets);
+    Metrics::addSource(exportMetrics);
+    startMicros = micros();
+    uint32_t lastReport = millis();
+
+    while (1)
+    {
+        uint64_t busyStart = micros();
+        TRACE_BEGIN("ui drain");
+        uiDrainUpdates();
+        TRACE_END("ui drain");
+        TRACE_BEGIN("lv_timer_handler");
+        uint32_t sleepMs = lv_timer_handler();
+        TRACE_END("lv_timer_handler");
+        uint64_t now = micros();
+
+        busyUs->observe(now - busyStart);
+        stats.wakeups++;
+        stats.busyMicros += now - busyStart;
+        stats.elapsedMicros = now - startMicros;
+
+        if (millis() - lastReport >= GUI_STATS_INTERVAL_MS)
+        {
+            lastReport = millis();
+            reportStats();
+        }
+
+        // LV_NO_TIMER_READY means nothing is scheduled; still wake now and
+        // then in case a timer gets created from outside a callback
+        sleepMs = LV_CLAMP(GUI_MIN_SLEEP_MS, sleepMs, GUI_MAX_SLEEP_MS);
+        TRACE_BEGIN("gui sleep");
+        uint32_t notified = ulTaskNotifyTake(pdTRUE, pdMS_TO_TICKS(sleepMs));
+        TRACE_END("gui sleep");
+        if (notified > 0)
+            stats.notifiedWakeups++;
+    }
+}
+
+GuiTaskStats getGuiTaskStats()
+{
+    return stats;
+}
@@ -0,0 +1,22 @@
+#pragma once
+
+#include <stdint.h>
+
+struct GuiTaskStats
+{
+    uint32_t wakeups;         // Loop iterations of guiTask
+    uint32_t notifiedWakeups; // Iterations started early by a UI update
+    uint64_t busyMicros;      // Time spent draining updates and running LVGL
+    uint64_t elapsedMicros;   // Time since guiTask started
+};
+
+/**
+ * Runs LVGL. Sleeps until the next LVGL timer is due, as reported by
+ * lv_timer_handler(), or until uiPostText() notifies it of new text.
+ */
+void guiTask(void *pvParameters);
+
+/**
+ * Returns guiTask's wakeup and busy-time counters since it started
+ */
+GuiTaskStats getGuiTaskStats();
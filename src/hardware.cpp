@@ -1,100 +0,0 @@
-#include <Arduino.h>
-#include <WiFi.h>
-#include <time.h>
-#include <lvgl.h>
-#include <XPT2046_Touchscreen.h>
-
-#include "hardware.h"
-#include "secrets.h"
-#include "config.h"
-
-SPIClass touchscreenSpi(VSPI);
-XPT2046_Touchscreen touchscreen(XPT2046_CS, XPT2046_IRQ);
-
-uint16_t touchScreenMinimumX = 200, touchScreenMaximumX = 3700, touchScreenMinimumY = 240, touchScreenMaximumY = 3800;
-
-void initTouchscreen()
-{
-    touchscreenSpi.begin(XPT2046_CLK, XPT2046_MISO, XPT2046_MOSI, XPT2046_CS);
-    touchscreen.begin(touchscreenSpi);
-    touchscreen.setRotation(2);
-
-    lv_indev_t *indev = lv_indev_create();
-    lv_indev_set_type(indev, LV_INDEV_TYPE_POINTER);
-    lv_indev_set_read_cb(indev, touchpadRead);
-}
-
-void initDisplay()
-{
-    static uint8_t draw_buf1[DRAW_BUF_SIZE];
-
-    lv_display_t *disp;
-    disp = lv_tft_espi_create(TFT_HOR_RES, TFT_VER_RES, draw_buf1, DRAW_BUF_SIZE);
-    lv_display_set_rotation(disp, LV_DISP_ROTATION_90);
-}
-
-bool connectWiFi()
-{
-    Serial.print("Connecting to WiFi: ");
-    Serial.println(WIFI_SSID);
-    WiFi.begin(WIFI_SSID, WIFI_PASSWORD);
-    int retries = 0;
-    while (WiFi.status() != WL_CONNECTED && retries < 30)
-    {
-        vTaskDelay(pdMS_TO_TICKS(500));
-        Serial.print(".");
-        retries++;
-    }
-
-    if (WiFi.status() == WL_CONNECTED)
-    {
-        Serial.println("\nWiFi connected!");
-        Serial.print("IP Address: ");
-        Serial.println(WiFi.localIP());
-        return true;
-    }
-
-    Serial.println("\nWiFi connection failed!");
-    return false;
-}
-
-bool syncTime()
-{
-    configTime(-4 * 3600, 0, "pool.ntp.org", "time.nist.gov");
-
-    struct tm timeinfo;
-    if (!getLocalTime(&timeinfo))
-    {
-        Serial.println("Failed to obtain time");
-        return false;
-    }
-
-    char timeStr[64];
-    strftime(timeStr, sizeof(timeStr), "%Y-%m-%d %H:%M:%S", &timeinfo);
-    Serial.printf("Time synchronized. Current time: %s\n", timeStr);
-    return true;
-}
-
-void touchpadRead(lv_indev_t *indev, lv_indev_data_t *data)
-{
-    if (touchscreen.touched())
-    {
-        TS_Point p = touchscreen.getPoint();
-        // Dynamically calibrate touch boundaries
-        if (p.x < touchScreenMinimumX)
-            touchScreenMinimumX = p.x;
-        if (p.x > touchScreenMaximumX)
-            touchScreenMaximumX = p.x;
-        if (p.y < touchScreenMinimumY)
-            touchScreenMinimumY = p.y;
-        if (p.y > touchScreenMaximumY)
-            touchScreenMaximumY = p.y;
-        data->point.x = map(p.x, touchScreenMinimumX, touchScreenMaximumX, 1, TFT_HOR_RES);
-        data->point.y = map(p.y, touchScreenMinimumY, touchScreenMaximumY, 1, TFT_VER_RES);
-        data->state = LV_INDEV_STATE_PRESSED;
-    }
-    else
-    {
-        data->state = LV_INDEV_STATE_RELEASED;
-    }
-}
\ No newline at end of file
@@ -8,25 +8,20 @@
 void initDisplay();
 
 /**
- * Initializes the XPT2046 touchscreen and registers it with LVGL
+ * Initializes the XPT2046 touchscreen, with reads gated on its pen IRQ, and
+ * registers it with LVGL
  */
 void initTouchscreen();
 
 /**
- * LVGL touchpad read callback function
- * @param indev Pointer to the input device driver
- * @param data Pointer to the input data to be filled
+ * @return true if the panel is being touched right now
  */
-void touchpadRead(lv_indev_t *indev, lv_indev_data_t *data);
+bool touchscreenPressed();
 
 /**
- * Connects to WiFi using credentials from secrets.h
- * @return true if connection successful, false otherwise
- */
-bool connectWiFi();
-
-/**
- * Synchronizes device time with NTP servers
- * @return true if time sync successful, false otherwise
+ * LVGL touchpad read callback function. Reads the controller only while the
+ * pen IRQ shows a touch and filters the result through TouchInput.
+ * @param indev Pointer to the input device driver
+ * @param data Pointer to the input data to be filled
  */
-bool syncTime();
+void touchpadRead(lv_indev_t *indev, lv_indev_data_t *data);
@@ -0,0 +1,131 @@
+#include "http_body_stream.h"
+
+HttpBodyStream::HttpBodyStream(HTTPClient &http)
+    : _raw(http.getStreamPtr()), _chunked(false), _untilClose(false), _remaining(0)
+{
+    if (!_raw)
+        return;
+
+    int size = http.getSize();
+    if (size >= 0)
+        _remaining = size;
+    else if (http.header("Transfer-Encoding").equalsIgnoreCase("chunked"))
+        _chunked = true;
+    else
+        _untilClose = true;
+}
+
+HttpBodyStream::~HttpBodyStream()
+{
+    // The parser stops at the closing brace; consume the rest so the next
+    // request on this connection starts at a status line
+    char buf[64];
+    if (!_untilClose)
+    {
+        while (readBytes(buf, sizeof(buf)) > 0)
+            ;
+    }
+}
+
+bool HttpBodyStream::readRawLine(char *line, size_t size)
+{
+    size_t length = 0;
+    char c;
+    while (_raw->readBytes(&c, 1) == 1)
+    {
+        if (c == '\n')
+        {
+            line[length] = '\0';
+            return true;
+        }
+        if (c != '\r' && length + 1 < size)
+            line[length++] = c;
+    }
+    return false;
+}
+
+/**
+ * Moves to the next chunk once the current one is used up.
+ * @return false at the end of the body
+ */
+bool HttpBodyStream::nextChunk()
+{
+    if (!_chunked)
+        return _remaining > 0 || _untilClose;
+    if (_remaining > 0)
+        return true;
+
+    char line[32];
+    if (!readRawLine(line, sizeof(line)))
+    {
+        _chunked = false;
+        return false;
+    }
+
+    // The CRLF that ends the previous chunk comes first
+    if (line[0] == '\0' && !readRawLine(line, sizeof(line)))
+    {
+        _chunked = false;
+        return false;
+    }
+
+    _remaining = strtoul(line, NULL, 16);
+    if (_remaining == 0)
+    {
+        // Last chunk: skip any trailers up to the blank line ending the body
+        while (readRawLine(line, sizeof(line)) && line[0] != '\0')
+            ;
+        _chunked = false;
+        return false;
+    }
+    return true;
+}
+
+int HttpBodyStream::available()
+{
+    if (!_raw || (!_chunked && !_untilClose && _remaining == 0))
+        return 0;
+
+    int raw = _raw->available();
+    if (_untilClose)
+        return raw;
+    return raw < (int)_remaining ? raw : _remaining;
+}
+
+int HttpBodyStream::read()
+{
+    char c;
+    return readBytes(&c, 1) == 1 ? (uint8_t)c : -1;
+}
+
+int HttpBodyStream::peek()
+{
+    if (!_raw || !nextChunk())
+        return -1;
+    return _raw->peek();
+}
+
+size_t HttpBodyStream::readBytes(char *buffer, size_t length)
+{
+    size_t total = 0;
+    while (_raw && total < length && nextChunk())
+    {
+        size_t want = length - total;
+        if (!_untilClose && want > _remaining)
+            want = _remaining;
+
+        size_t count = _raw->readBytes(buffer + total, want);
+        if (count == 0)
+        {
+            // Timed out or closed mid-body
+            _chunked = _untilClose = false;
+            _remaining = 0;
+            break;
+        }
+
+        total += count;
+        if (!_untilClose)
+            _remaining -= count;
+    }
+    return total;
+}
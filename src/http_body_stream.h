@@ -0,0 +1,36 @@
+#pragma once
+
+#include <Arduino.h>
+#include <HTTPClient.h>
+
+/**
+ * Response body of an HTTPClient request as a Stream, so ArduinoJson can
+ * deserialize straight from the connection instead of from a String copy of
+ * the whole payload. Chunked transfer encoding is decoded and reads stop at
+ * the end of the body, leaving a keep-alive connection clean for the next
+ * request; whatever the parser leaves unread is drained on destruction.
+ *
+ * Needs "Transfer-Encoding" among the client's collected headers, which
+ * HttpPool::begin() sets up. Destroy it before HttpPool::end().
+ */
+class HttpBodyStream : public Stream
+{
+public:
+    explicit HttpBodyStream(HTTPClient &http);
+    ~HttpBodyStream();
+
+    int available();
+    int read();
+    int peek();
+    size_t readBytes(char *buffer, size_t length);
+    size_t write(uint8_t) { return 0; }
+
+private:
+    Stream *_raw;
+    bool _chunked;
+    bool _untilClose; // No length given: the body ends when the server closes
+    size_t _remaining; // Bytes left in the current chunk, or in the whole body
+
+    bool nextChunk();
+    bool readRawLine(char *line, size_t size);
+};
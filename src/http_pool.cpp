@@ -0,0 +1,278 @@
+#include "http_pool.h"
+
+#include <WiFiClientSecure.h>
+#include <mutex>
+
+#include "metrics.h"
+#include "trace.h"
+
+#define HTTP_POOL_SIZE 2         // Each open TLS connection costs ~40 KB of heap
+#define HTTP_POOL_IDLE_MS 60000  // Servers drop idle keep-alives around here anyway
+#define HTTP_POOL_HOST_LEN 64
+
+struct PoolEntry
+{
+    char host[HTTP_POOL_HOST_LEN];
+    uint16_t port;
+    HTTPClient *http;
+    WiFiClientSecure *client;
+    bool inUse;
+    bool reused; // The current lease started on an already-open connection
+    uint32_t lastUsed;
+};
+
+// Response headers the callers read back; HttpBodyStream needs the encoding
+static const char *collectedHeaders[] = {"Transfer-Encoding", "ETag"};
+
+static PoolEntry entries[HTTP_POOL_SIZE];
+static HttpPoolStats stats;
+static std::mutex poolMutex;
+
+static bool parseHttpsUrl(const String &url, char *host, size_t hostSize, uint16_t &port)
+{
+    const char *rest = url.c_str();
+    if (strncmp(rest, "https://", 8) != 0)
+        return false;
+    rest += 8;
+
+    size_t length = strcspn(rest, ":/");
+    if (length == 0 || length >= hostSize)
+        return false;
+
+    memcpy(host, rest, length);
+    host[length] = '\0';
+    port = rest[length] == ':' ? atoi(rest + length + 1) : 443;
+    return true;
+}
+
+static HTTPClient *newClient()
+{
+    HTTPClient *http = new HTTPClient();
+    http->collectHeaders(collectedHeaders, sizeof(collectedHeaders) / sizeof(collectedHeaders[0]));
+    return http;
+}
+
+static PoolEntry *findLease(HTTPClient *http)
+{
+    for (PoolEntry &entry : entries)
+    {
+        if (entry.inUse && entry.http == http)
+            return &entry;
+    }
+    return NULL;
+}
+
+/**
+ * Picks the entry to lend for a host: an open connection to it, then a
+ * closed one, then an unused slot, then the least recently used idle entry.
+ * Must be called with poolMutex held.
+ */
+static PoolEntry *selectEntry(const char *host, uint16_t port, bool &reuse)
+{
+    PoolEntry *closedMatch = NULL;
+    PoolEntry *unused = NULL;
+    PoolEntry *lru = NULL;
+    uint32_t now = millis();
+
+    reuse = false;
+    for (PoolEntry &entry : entries)
+    {
+        if (entry.inUse)
+            continue;
+
+        if (!entry.client)
+        {
+            unused = unused ? unused : &entry;
+            continue;
+        }
+
+        if (now - entry.lastUsed > HTTP_POOL_IDLE_MS)
+            entry.client->stop();
+
+        if (strcmp(entry.host, host) == 0 && entry.port == port)
+        {
+            if (entry.client->connected())
+            {
+                reuse = true;
+                return &entry;
+            }
+            closedMatch = &entry;
+        }
+
+        if (!lru || entry.lastUsed < lru->lastUsed)
+            lru = &entry;
+    }
+
+    if (closedMatch)
+        return closedMatch;
+    if (unused)
+        return unused;
+
+    if (lru && lru->client->connected())
+    {
+        lru->client->stop();
+        stats.evictions++;
+    }
+    return lru;
+}
+
+static bool connectEntry(PoolEntry *entry)
+{
+    uint32_t start = millis();
+    bool connected = entry->client->connect(entry->host, entry->port);
+    uint32_t elapsed = millis() - start;
+
+    std::lock_guard<std::mutex> lock(poolMutex);
+    stats.handshakes++;
+    stats.handshakeMsTotal += elapsed;
+    if (elapsed > stats.handshakeMsMax)
+        stats.handshakeMsMax = elapsed;
+    return connected;
+}
+
+static void releaseEntry(PoolEntry *entry)
+{
+    std::lock_guard<std::mutex> lock(poolMutex);
+    entry->inUse = false;
+    entry->lastUsed = millis();
+}
+
+static void exportMetrics()
+{
+    static Metric *hits = Metrics::counter("http.hits");
+    static Metric *misses = Metrics::counter("http.misses");
+    static Metric *staleRetries = Metrics::counter("http.stale_retries");
+    static Metric *handshakes = Metrics::counter("http.handshakes");
+    static Metric *handshakeMsMax = Metrics::gauge("http.handshake_ms_max");
+
+    HttpPoolStats current = HttpPool::getStats();
+    hits->set(current.hits);
+    misses->set(current.misses);
+    staleRetries->set(current.staleRetries);
+    handshakes->set(current.handshakes);
+    handshakeMsMax->set(current.handshakeMsMax);
+}
+
+HTTPClient *HttpPool::begin(const String &url)
+{
+    // The pool has no init of its own; register on first use
+    static bool exported = Metrics::addSource(exportMetrics);
+    (void)exported;
+
+    char host[HTTP_POOL_HOST_LEN];
+    uint16_t port;
+    PoolEntry *entry = NULL;
+    bool reuse = false;
+
+    if (parseHttpsUrl(url, host, sizeof(host), port))
+    {
+        std::lock_guard<std::mutex> lock(poolMutex);
+        entry = selectEntry(host, port, reuse);
+        if (entry)
+        {
+            if (!entry->client)
+            {
+                entry->client = new WiFiClientSecure();
+                entry->client->setInsecure();
+                entry->http = newClient();
+                entry->http->setReuse(true);
+            }
+            strcpy(entry->host, host);
+            entry->port = port;
+            entry->inUse = true;
+            entry->reused = reuse;
+            reuse ? stats.hits++ : stats.misses++;
+        }
+    }
+
+    if (!entry)
+    {
+        {
+            std::lock_guard<std::mutex> lock(poolMutex);
+            stats.unpooled++;
+        }
+
+        HTTPClient *http = newClient();
+        if (!http->begin(url))
+        {
+            delete http;
+            return NULL;
+        }
+        return http;
+    }
+
+    // Handshake outside the lock so other tasks can still borrow connections
+    if ((!reuse && !connectEntry(entry)) || !entry->http->begin(*entry->client, url))
+    {
+        entry->client->stop();
+        releaseEntry(entry);
+        return NULL;
+    }
+
+    return entry->http;
+}
+
+/**
+ * After a failed request on a reused connection, reconnects so the caller
+ * can retry once. Fresh connections are not retried: their failure is real.
+ */
+static bool reconnectIfStale(HTTPClient *http, int httpCode)
+{
+    if (httpCode != HTTPC_ERROR_CONNECTION_LOST && httpCode != HTTPC_ERROR_SEND_HEADER_FAILED &&
+        httpCode != HTTPC_ERROR_NOT_CONNECTED && httpCode != HTTPC_ERROR_READ_TIMEOUT)
+        return false;
+
+    PoolEntry *entry;
+    {
+        std::lock_guard<std::mutex> lock(poolMutex);
+        entry = findLease(http);
+        if (!entry || !entry->reused)
+            return false;
+        entry->reused = false;
+        stats.staleRetries++;
+    }
+
+    entry->client->stop();
+    return connectEntry(entry);
+}
+
+int HttpPool::GET(HTTPClient *http)
+{
+    TRACE_SCOPE("http GET");
+    int httpCode = http->GET();
+    if (reconnectIfStale(http, httpCode))
+        httpCode = http->GET();
+    return httpCode;
+}
+
+int HttpPool::POST(HTTPClient *http, const String &payload)
+{
+    TRACE_SCOPE("http POST");
+    int httpCode = http->POST(payload);
+    if (reconnectIfStale(http, httpCode))
+        httpCode = http->POST(payload);
+    return httpCode;
+}
+
+void HttpPool::end(HTTPClient *http)
+{
+    // end() keeps the socket open when the server agreed to keep-alive
+    http->end();
+
+    PoolEntry *entry;
+    {
+        std::lock_guard<std::mutex> lock(poolMutex);
+        entry = findLease(http);
+    }
+
+    if (entry)
+        releaseEntry(entry);
+    else
+        delete http;
+}
+
+HttpPoolStats HttpPool::getStats()
+{
+    std::lock_guard<std::mutex> lock(poolMutex);
+    return stats;
+}
@@ -0,0 +1,59 @@
+#pragma once
+
+#include <Arduino.h>
+#include <HTTPClient.h>
+
+struct HttpPoolStats
+{
+    uint32_t hits;             // Requests that reused an open keep-alive connection
+    uint32_t misses;           // Requests that had to open a new connection
+    uint32_t staleRetries;     // Reused connections the server had already closed
+    uint32_t evictions;        // Idle connections closed to make room
+    uint32_t unpooled;         // Requests made outside the pool (plain HTTP or pool full)
+    uint32_t handshakes;       // TCP + TLS handshakes performed by the pool
+    uint32_t handshakeMsTotal; // Time spent in those handshakes
+    uint32_t handshakeMsMax;   // Slowest single handshake
+};
+
+/**
+ * Keep-alive HTTPS connections shared by the API clients. Each pooled
+ * connection belongs to one host and is lent, together with the HTTPClient
+ * driving it, to one request at a time; between requests it stays open, so
+ * a poll to the same host skips the TCP and TLS handshake entirely. The
+ * HTTPClient is pooled too because destroying one closes its connection.
+ * Idle connections are evicted least recently used first, since every open
+ * TLS session holds tens of KB of heap.
+ *
+ * Usage:
+ *   HTTPClient *http = HttpPool::begin(url);
+ *   http->addHeader(...);
+ *   int code = HttpPool::GET(http);
+ *   ...
+ *   HttpPool::end(http);
+ */
+class HttpPool
+{
+public:
+    /**
+     * Starts a request on a pooled connection to the URL's host, opening it
+     * first if needed. Plain http:// URLs, or a pool with every connection
+     * lent out, get a one-off client instead.
+     * @return Client to issue the request with, or NULL if the connection
+     *         cannot be opened. Always hand it back with end().
+     */
+    static HTTPClient *begin(const String &url);
+
+    /**
+     * GET/POST that retry once on a fresh connection when a reused one turns
+     * out to have been closed by the server while idle
+     */
+    static int GET(HTTPClient *http);
+    static int POST(HTTPClient *http, const String &payload);
+
+    /**
+     * Finishes the request and returns the connection to the pool
+     */
+    static void end(HTTPClient *http);
+
+    static HttpPoolStats getStats();
+};
@@ -0,0 +1,677 @@
+#include "jpeg_decoder.h"
+
+#define JPEG_INPUT_SIZE 512
+#define JPEG_MAX_COMPONENTS 3
+#define JPEG_MAX_BLOCKS 6 // Four luma blocks and two chroma blocks at 4:2:0
+#define JPEG_HUFF_LOOKUP_BITS 8
+#define JPEG_MAX_COEFFICIENT 4095  // Well beyond what 8-bit samples produce
+#define JPEG_MAX_COLUMN_VALUE 16383 // Keeps the row pass inside 32 bits
+
+// Markers, after the 0xFF prefix
+#define JPEG_SOF0 0xC0 // Baseline
+#define JPEG_SOF1 0xC1 // Extended sequential, Huffman
+#define JPEG_DHT 0xC4
+#define JPEG_SOI 0xD8
+#define JPEG_EOI 0xD9
+#define JPEG_SOS 0xDA
+#define JPEG_DQT 0xDB
+#define JPEG_DRI 0xDD
+
+static const uint8_t zigzag[64] = {
+    0, 1, 8, 16, 9, 2, 3, 10, 17, 24, 32, 25, 18, 11, 4, 5,
+    12, 19, 26, 33, 40, 48, 41, 34, 27, 20, 13, 6, 7, 14, 21, 28,
+    35, 42, 49, 56, 57, 50, 43, 36, 29, 22, 15, 23, 30, 37, 44, 51,
+    58, 59, 52, 45, 38, 31, 39, 46, 53, 60, 61, 54, 47, 55, 62, 63};
+
+struct HuffTable
+{
+    uint16_t lookup[1 << JPEG_HUFF_LOOKUP_BITS]; // (length << 8) | value for short codes, 0 for longer ones
+    int32_t maxCode[17];                         // Largest code of each length, -1 if there are none
+    int32_t valueOffset[17];                     // Index into values minus the first code of each length
+    uint8_t values[256];
+    bool defined;
+};
+
+struct JpegComponent
+{
+    uint8_t id;
+    uint8_t h;
+    uint8_t v;
+    uint8_t quant;
+    uint8_t dcTable;
+    uint8_t acTable;
+    int32_t dcPred;
+};
+
+struct JpegDecoder
+{
+    Stream *in;
+    uint8_t input[JPEG_INPUT_SIZE];
+    size_t inputPos;
+    size_t inputLen;
+
+    // Entropy-coded data, MSB first; past a marker it reads as zeros
+    uint32_t bits;
+    int bitCount;
+    int marker; // Marker that ended the data, -1 if the stream did
+
+    uint16_t width;
+    uint16_t height;
+    uint16_t restartInterval;
+    int componentCount;
+    JpegComponent components[JPEG_MAX_COMPONENTS];
+    uint16_t quant[4][64]; // Zigzag order, as stored in the file
+    HuffTable dc[2];
+    HuffTable ac[2];
+
+    int32_t block[64];
+    uint8_t mcu[JPEG_MAX_BLOCKS][64];
+};
+
+static int readByte(JpegDecoder *jpeg)
+{
+    if (jpeg->inputPos == jpeg->inputLen)
+    {
+        jpeg->inputLen = jpeg->in->readBytes(jpeg->input, JPEG_INPUT_SIZE);
+        jpeg->inputPos = 0;
+        if (jpeg->inputLen == 0)
+            return -1;
+    }
+    return jpeg->input[jpeg->inputPos++];
+}
+
+static int readWord(JpegDecoder *jpeg)
+{
+    int high = readByte(jpeg);
+    int low = readByte(jpeg);
+    return high < 0 || low < 0 ? -1 : (high << 8) | low;
+}
+
+static bool skipBytes(JpegDecoder *jpeg, int count)
+{
+    for (; count > 0; count--)
+    {
+        if (readByte(jpeg) < 0)
+            return false;
+    }
+    return true;
+}
+
+static bool parseQuantTables(JpegDecoder *jpeg, int length)
+{
+    while (length > 0)
+    {
+        int info = readByte(jpeg);
+        int precision = info >> 4;
+        int id = info & 0x0F;
+        if (info < 0 || precision > 1 || id > 3)
+            return false;
+
+        for (int i = 0; i < 64; i++)
+        {
+            int value = precision ? readWord(jpeg) : readByte(jpeg);
+            if (value < 0)
+                return false;
+            jpeg->quant[id][i] = value;
+        }
+        length -= 1 + 64 * (precision + 1);
+    }
+    return length == 0;
+}
+
+/**
+ * Builds the canonical codes of one table: the first 8 bits of the stream
+ * index the lookup directly, longer codes are found by comparing against the
+ * largest code of each length.
+ */
+static bool buildHuffTable(HuffTable *table, const uint8_t counts[17])
+{
+    memset(table->lookup, 0, sizeof(table->lookup));
+
+    int32_t code = 0;
+    int index = 0;
+    for (int length = 1; length <= 16; length++)
+    {
+        table->valueOffset[length] = index - code;
+        for (int i = 0; i < counts[length]; i++, code++, index++)
+        {
+            if (code >= (1 << length))
+                return false;
+            if (length <= JPEG_HUFF_LOOKUP_BITS)
+            {
+                int shift = JPEG_HUFF_LOOKUP_BITS - length;
+                for (int fill = 0; fill < (1 << shift); fill++)
+                    table->lookup[(code << shift) | fill] = (length << 8) | table->values[index];
+            }
+        }
+        table->maxCode[length] = counts[length] ? code - 1 : -1;
+        code <<= 1;
+    }
+
+    table->defined = true;
+    return true;
+}
+
+static bool parseHuffTables(JpegDecoder *jpeg, int length)
+{
+    while (length > 0)
+    {
+        int info = readByte(jpeg);
+        int tableClass = info >> 4;
+        int id = info & 0x0F;
+        if (info < 0 || tableClass > 1 || id > 1)
+            return false;
+
+        uint8_t counts[17] = {0};
+        int total = 0;
+        for (int i = 1; i <= 16; i++)
+        {
+            int count = readByte(jpeg);
+            if (count < 0)
+                return false;
+            counts[i] = count;
+            total += count;
+        }
+        if (total > 256)
+            return false;
+
+        HuffTable *table = tableClass ? &jpeg->ac[id] : &jpeg->dc[id];
+        for (int i = 0; i < total; i++)
+        {
+            int value = readByte(jpeg);
+            if (value < 0)
+                return false;
+            table->values[i] = value;
+        }
+        if (!buildHuffTable(table, counts))
+            return false;
+
+        length -= 17 + total;
+    }
+    return length == 0;
+}
+
+static bool parseFrame(JpegDecoder *jpeg, int length)
+{
+    int precision = readByte(jpeg);
+    int height = readWord(jpeg);
+    int width = readWord(jpeg);
+    int count = readByte(jpeg);
+    if (precision != 8 || height <= 0 || width <= 0 || (count != 1 && count != 3) || length != 6 + 3 * count)
+        return false;
+
+    jpeg->width = width;
+    jpeg->height = height;
+    jpeg->componentCount = count;
+    for (int i = 0; i < count; i++)
+    {
+        JpegComponent *component = &jpeg->components[i];
+        int id = readByte(jpeg);
+        int sampling = readByte(jpeg);
+        int quant = readByte(jpeg);
+        if (id < 0 || sampling < 0 || quant < 0 || quant > 3)
+            return false;
+
+        component->id = id;
+        component->h = sampling >> 4;
+        component->v = sampling & 0x0F;
+        component->quant = quant;
+    }
+
+    // A single component is coded one block per MCU whatever it claims
+    if (count == 1)
+    {
+        jpeg->components[0].h = 1;
+        jpeg->components[0].v = 1;
+        return true;
+    }
+
+    // Only luma may be subsampled against, by at most 2 in each direction
+    const JpegComponent *luma = &jpeg->components[0];
+    if (luma->h < 1 || luma->h > 2 || luma->v < 1 || luma->v > 2)
+        return false;
+    for (int i = 1; i < count; i++)
+    {
+        if (jpeg->components[i].h != 1 || jpeg->components[i].v != 1)
+            return false;
+    }
+    return true;
+}
+
+static bool parseScan(JpegDecoder *jpeg, int length)
+{
+    int count = readByte(jpeg);
+    if (count != jpeg->componentCount || length != 4 + 2 * count)
+        return false;
+
+    for (int i = 0; i < count; i++)
+    {
+        int id = readByte(jpeg);
+        int tables = readByte(jpeg);
+        JpegComponent *component = &jpeg->components[i];
+        if (id != component->id || tables < 0)
+            return false;
+
+        component->dcTable = tables >> 4;
+        component->acTable = tables & 0x0F;
+        component->dcPred = 0;
+        if (component->dcTable > 1 || component->acTable > 1 || !jpeg->dc[component->dcTable].defined ||
+            !jpeg->ac[component->acTable].defined)
+            return false;
+    }
+
+    // Spectral selection and successive approximation are fixed for baseline
+    return skipBytes(jpeg, 3);
+}
+
+static void fillBits(JpegDecoder *jpeg)
+{
+    while (jpeg->bitCount <= 24)
+    {
+        int c = 0;
+        if (!jpeg->marker)
+        {
+            c = readByte(jpeg);
+            if (c == 0xFF)
+            {
+                int next;
+                do
+                {
+                    next = readByte(jpeg);
+                } while (next == 0xFF);
+
+                if (next != 0)
+                {
+                    jpeg->marker = next;
+                    c = 0;
+                }
+            }
+            else if (c < 0)
+            {
+                jpeg->marker = -1;
+                c = 0;
+            }
+        }
+        jpeg->bits |= (uint32_t)c << (24 - jpeg->bitCount);
+        jpeg->bitCount += 8;
+    }
+}
+
+static inline void consumeBits(JpegDecoder *jpeg, int count)
+{
+    jpeg->bits <<= count;
+    jpeg->bitCount -= count;
+}
+
+static int decodeHuffman(JpegDecoder *jpeg, const HuffTable *table)
+{
+    fillBits(jpeg);
+
+    uint16_t entry = table->lookup[jpeg->bits >> (32 - JPEG_HUFF_LOOKUP_BITS)];
+    if (entry)
+    {
+        consumeBits(jpeg, entry >> 8);
+        return entry & 0xFF;
+    }
+
+    for (int length = JPEG_HUFF_LOOKUP_BITS + 1; length <= 16; length++)
+    {
+        int32_t code = jpeg->bits >> (32 - length);
+        if (code <= table->maxCode[length])
+        {
+            consumeBits(jpeg, length);
+            return table->values[code + table->valueOffset[length]];
+        }
+    }
+    return -1;
+}
+
+/**
+ * Reads a magnitude category's extra bits as a signed coefficient
+ */
+static int receiveExtend(JpegDecoder *jpeg, int size)
+{
+    if (size == 0)
+        return 0;
+
+    fillBits(jpeg);
+    int value = jpeg->bits >> (32 - size);
+    consumeBits(jpeg, size);
+    return value < (1 << (size - 1)) ? value - (1 << size) + 1 : value;
+}
+
+static inline int minInt(int a, int b)
+{
+    return a < b ? a : b;
+}
+
+static inline uint8_t clampSample(int32_t value)
+{
+    return value < 0 ? 0 : value > 255 ? 255 : value;
+}
+
+// Fixed-point constants of the islow IDCT (Loeffler, Ligtenberg and
+// Moschytz), scaled by 2^13
+#define FIX_0_298631336 2446
+#define FIX_0_390180644 3196
+#define FIX_0_541196100 4433
+#define FIX_0_765366865 6270
+#define FIX_0_899976223 7373
+#define FIX_1_175875602 9633
+#define FIX_1_501321110 12299
+#define FIX_1_847759065 15137
+#define FIX_1_961570560 16069
+#define FIX_2_053119869 16819
+#define FIX_2_562915447 20995
+#define FIX_3_072711026 25172
+
+/**
+ * One 8-point inverse DCT. Outputs are scaled by 2^13 relative to the inputs.
+ */
+static inline void idct8(const int32_t *in, int stride, int32_t out[8])
+{
+    int32_t z2 = in[2 * stride], z3 = in[6 * stride];
+    int32_t z1 = (z2 + z3) * FIX_0_541196100;
+    int32_t tmp2 = z1 - z3 * FIX_1_847759065;
+    int32_t tmp3 = z1 + z2 * FIX_0_765366865;
+
+    int32_t tmp0 = (in[0] + in[4 * stride]) * (1 << 13);
+    int32_t tmp1 = (in[0] - in[4 * stride]) * (1 << 13);
+
+    int32_t even0 = tmp0 + tmp3, even3 = tmp0 - tmp3;
+    int32_t even1 = tmp1 + tmp2, even2 = tmp1 - tmp2;
+
+    int32_t o0 = in[7 * stride], o1 = in[5 * stride], o2 = in[3 * stride], o3 = in[stride];
+    int32_t z13 = o0 + o2, z24 = o1 + o3;
+    int32_t z5 = (z13 + z24) * FIX_1_175875602;
+    int32_t z14 = (o0 + o3) * -FIX_0_899976223;
+    int32_t z23 = (o1 + o2) * -FIX_2_562915447;
+    z13 = z13 * -FIX_1_961570560 + z5;
+    z24 = z24 * -FIX_0_390180644 + z5;
+
+    o0 = o0 * FIX_0_298631336 + z14 + z13;
+    o1 = o1 * FIX_2_053119869 + z23 + z24;
+    o2 = o2 * FIX_3_072711026 + z23 + z13;
+    o3 = o3 * FIX_1_501321110 + z14 + z24;
+
+    out[0] = even0 + o3;
+    out[7] = even0 - o3;
+    out[1] = even1 + o2;
+    out[6] = even1 - o2;
+    out[2] = even2 + o1;
+    out[5] = even2 - o1;
+    out[3] = even3 + o0;
+    out[4] = even3 - o0;
+}
+
+/**
+ * Inverse DCT of the dequantised block into 8x8 samples. Columns keep two
+ * extra fraction bits for the row pass, as in libjpeg's jidctint.
+ */
+static void inverseDct(const int32_t *block, uint8_t *out)
+{
+    int32_t columns[64];
+    int32_t values[8];
+
+    for (int x = 0; x < 8; x++)
+    {
+        const int32_t *in = block + x;
+        if (!in[8] && !in[16] && !in[24] && !in[32] && !in[40] && !in[48] && !in[56])
+        {
+            for (int y = 0; y < 8; y++)
+                columns[y * 8 + x] = in[0] * 4;
+            continue;
+        }
+
+        idct8(in, 8, values);
+        for (int y = 0; y < 8; y++)
+        {
+            int32_t value = (values[y] + (1 << 10)) >> 11;
+            columns[y * 8 + x] = value < -JPEG_MAX_COLUMN_VALUE  ? -JPEG_MAX_COLUMN_VALUE
+                                 : value > JPEG_MAX_COLUMN_VALUE ? JPEG_MAX_COLUMN_VALUE
+                                                                 : value;
+        }
+    }
+
+    for (int y = 0; y < 8; y++)
+    {
+        idct8(columns + y * 8, 1, values);
+        for (int x = 0; x < 8; x++)
+            out[y * 8 + x] = clampSample(((values[x] + (1 << 17)) >> 18) + 128);
+    }
+}
+
+/**
+ * Dequantises one coefficient. Real files stay far inside the clamp; it
+ * only keeps corrupt ones from overflowing the IDCT.
+ */
+static inline int32_t dequantize(int32_t value, uint16_t quant)
+{
+    int64_t product = (int64_t)value * quant;
+    return product < -JPEG_MAX_COEFFICIENT ? -JPEG_MAX_COEFFICIENT
+           : product > JPEG_MAX_COEFFICIENT ? JPEG_MAX_COEFFICIENT
+                                            : (int32_t)product;
+}
+
+static bool decodeBlock(JpegDecoder *jpeg, JpegComponent *component, uint8_t *out)
+{
+    const uint16_t *quant = jpeg->quant[component->quant];
+    int32_t *block = jpeg->block;
+    memset(block, 0, sizeof(jpeg->block));
+
+    int size = decodeHuffman(jpeg, &jpeg->dc[component->dcTable]);
+    if (size < 0 || size > 11)
+        return false;
+    component->dcPred += receiveExtend(jpeg, size);
+    if (component->dcPred < -JPEG_MAX_COEFFICIENT || component->dcPred > JPEG_MAX_COEFFICIENT)
+        return false;
+    block[0] = dequantize(component->dcPred, quant[0]);
+
+    const HuffTable *ac = &jpeg->ac[component->acTable];
+    for (int k = 1; k < 64; k++)
+    {
+        int symbol = decodeHuffman(jpeg, ac);
+        if (symbol < 0)
+            return false;
+
+        int run = symbol >> 4;
+        size = symbol & 0x0F;
+        if (size == 0)
+        {
+            if (run != 15)
+                break; // End of block
+            k += 15;
+            continue;
+        }
+
+        k += run;
+        if (k > 63 || size > 10)
+            return false;
+        block[zigzag[k]] = dequantize(receiveExtend(jpeg, size), quant[k]);
+    }
+
+    inverseDct(block, out);
+    return true;
+}
+
+/**
+ * Resynchronises on the RSTn marker that follows every restartInterval MCUs
+ */
+static bool restart(JpegDecoder *jpeg)
+{
+    jpeg->bits = 0;
+    jpeg->bitCount = 0;
+
+    while (!jpeg->marker)
+    {
+        int c = readByte(jpeg);
+        if (c < 0)
+            return false;
+        if (c == 0xFF)
+        {
+            int next = readByte(jpeg);
+            if (next != 0 && next != 0xFF)
+                jpeg->marker = next;
+        }
+    }
+
+    if (jpeg->marker < 0xD0 || jpeg->marker > 0xD7)
+        return false;
+
+    jpeg->marker = 0;
+    for (int i = 0; i < jpeg->componentCount; i++)
+        jpeg->components[i].dcPred = 0;
+    return true;
+}
+
+static inline uint16_t toRgb565(int32_t y, int32_t cb, int32_t cr)
+{
+    // BT.601 full range, 16.16 fixed point
+    int32_t r = y + ((91881 * cr + 32768) >> 16);
+    int32_t g = y - ((22554 * cb + 46802 * cr - 32768) >> 16);
+    int32_t b = y + ((116130 * cb + 32768) >> 16);
+    return (clampSample(r) & 0xF8) << 8 | (clampSample(g) & 0xFC) << 3 | clampSample(b) >> 3;
+}
+
+/**
+ * Colour-converts one decoded MCU into the output, clipping at both the
+ * image and the output edges
+ */
+static void writeMcu(JpegDecoder *jpeg, int mcuX, int mcuY, uint16_t *pixels, uint16_t width, uint16_t height)
+{
+    const JpegComponent *luma = &jpeg->components[0];
+    int mcuWidth = luma->h * 8, mcuHeight = luma->v * 8;
+    int x0 = mcuX * mcuWidth, y0 = mcuY * mcuHeight;
+    int right = minInt(minInt(width, jpeg->width) - x0, mcuWidth);
+    int bottom = minInt(minInt(height, jpeg->height) - y0, mcuHeight);
+    int lumaBlocks = luma->h * luma->v;
+
+    for (int y = 0; y < bottom; y++)
+    {
+        uint16_t *row = pixels + (y0 + y) * width + x0;
+        for (int x = 0; x < right; x++)
+        {
+            int32_t sample = jpeg->mcu[(y >> 3) * luma->h + (x >> 3)][(y & 7) * 8 + (x & 7)];
+            if (jpeg->componentCount == 1)
+            {
+                row[x] = toRgb565(sample, 0, 0);
+                continue;
+            }
+
+            int chroma = (y / luma->v) * 8 + x / luma->h;
+            row[x] = toRgb565(sample, jpeg->mcu[lumaBlocks][chroma] - 128, jpeg->mcu[lumaBlocks + 1][chroma] - 128);
+        }
+    }
+}
+
+static bool decodeScan(JpegDecoder *jpeg, uint16_t *pixels, uint16_t width, uint16_t height)
+{
+    const JpegComponent *luma = &jpeg->components[0];
+    int mcuWidth = luma->h * 8, mcuHeight = luma->v * 8;
+    int mcusX = (jpeg->width + mcuWidth - 1) / mcuWidth;
+    int mcusY = (jpeg->height + mcuHeight - 1) / mcuHeight;
+    int visibleX = (minInt(width, jpeg->width) + mcuWidth - 1) / mcuWidth;
+    int visibleY = (minInt(height, jpeg->height) + mcuHeight - 1) / mcuHeight;
+
+    jpeg->bits = 0;
+    jpeg->bitCount = 0;
+    jpeg->marker = 0;
+
+    // Rows below the output are never needed, so stop decoding there
+    uint32_t mcuCount = 0;
+    for (int mcuY = 0; mcuY < minInt(mcusY, visibleY); mcuY++)
+    {
+        for (int mcuX = 0; mcuX < mcusX; mcuX++, mcuCount++)
+        {
+            if (jpeg->restartInterval && mcuCount && mcuCount % jpeg->restartInterval == 0 && !restart(jpeg))
+                return false;
+
+            int blockIndex = 0;
+            for (int i = 0; i < jpeg->componentCount; i++)
+            {
+                JpegComponent *component = &jpeg->components[i];
+                for (int block = 0; block < component->h * component->v; block++)
+                {
+                    if (!decodeBlock(jpeg, component, jpeg->mcu[blockIndex++]))
+                        return false;
+                }
+            }
+
+            if (mcuX < visibleX)
+                writeMcu(jpeg, mcuX, mcuY, pixels, width, height);
+        }
+    }
+
+    // A download cut short would otherwise decode as a grey tail
+    return jpeg->marker >= 0;
+}
+
+static bool decode(JpegDecoder *jpeg, uint16_t *pixels, uint16_t width, uint16_t height)
+{
+    if (readByte(jpeg) != 0xFF || readByte(jpeg) != JPEG_SOI)
+        return false;
+
+    bool haveFrame = false;
+    while (true)
+    {
+        if (readByte(jpeg) != 0xFF)
+            return false;
+
+        int marker;
+        do
+        {
+            marker = readByte(jpeg);
+        } while (marker == 0xFF);
+        if (marker < 0 || marker == JPEG_EOI)
+            return false;
+
+        int length = readWord(jpeg);
+        if (length < 2)
+            return false;
+        length -= 2;
+
+        switch (marker)
+        {
+        case JPEG_SOF0:
+        case JPEG_SOF1:
+            if (!parseFrame(jpeg, length))
+                return false;
+            haveFrame = true;
+            break;
+        case JPEG_DHT:
+            if (!parseHuffTables(jpeg, length))
+                return false;
+            break;
+        case JPEG_DQT:
+            if (!parseQuantTables(jpeg, length))
+                return false;
+            break;
+        case JPEG_DRI:
+            if (length != 2)
+                return false;
+            jpeg->restartInterval = readWord(jpeg);
+            break;
+        case JPEG_SOS:
+            return haveFrame && parseScan(jpeg, length) && decodeScan(jpeg, pixels, width, height);
+        default:
+            // Other frame types (progressive, lossless, arithmetic) are unsupported
+            if (marker >= 0xC0 && marker <= 0xCF && marker != 0xC4 && marker != 0xC8 && marker != 0xCC)
+                return false;
+            if (!skipBytes(jpeg, length))
+                return false;
+            break;
+        }
+    }
+}
+
+bool decodeJpegRgb565(Stream &in, uint16_t *pixels, uint16_t width, uint16_t height)
+{
+    JpegDecoder *jpeg = (JpegDecoder *)calloc(1, sizeof(JpegDecoder));
+    if (!jpeg)
+        return false;
+
+    jpeg->in = &in;
+    bool ok = decode(jpeg, pixels, width, height);
+    free(jpeg);
+    return ok;
+}
@@ -0,0 +1,22 @@
+#pragma once
+
+#include <Arduino.h>
+
+/**
+ * Decodes a baseline JPEG to RGB565 in the manner of TJpgDec: the
+ * compressed data is pulled from the stream through a 512 byte buffer and
+ * each MCU (8x8 to 16x16 pixels) is written straight into the output, so
+ * the whole file is never held in memory. The decoder's workspace is about
+ * 5 KB of heap for the duration of the call.
+ *
+ * Handles 8-bit greyscale and YCbCr with 4:4:4, 4:2:2, 4:4:0 and 4:2:0
+ * subsampling, and restart markers. Progressive and arithmetic-coded files
+ * are rejected.
+ * @param in Compressed image
+ * @param pixels Output, width x height native-endian RGB565 as LVGL expects.
+ * A larger image is clipped to it; a smaller one leaves the rest untouched.
+ * @param width Output width in pixels
+ * @param height Output height in pixels
+ * @return false if the data is truncated, corrupt or unsupported
+ */
+bool decodeJpegRgb565(Stream &in, uint16_t *pixels, uint16_t width, uint16_t height);
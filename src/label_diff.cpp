@@ -0,0 +1,174 @@
+#include "label_diff.h"
+
+#include <string.h>
+
+#define MAX_DIRTY_AREAS 8
+
+static bool isAscii(const char *text)
+{
+    for (; *text; text++)
+    {
+        if ((uint8_t)*text >= 0x80)
+            return false;
+    }
+    return true;
+}
+
+static lv_point_t textSize(lv_obj_t *label, const char *text)
+{
+    lv_point_t size;
+    lv_text_get_size(&size, text, lv_obj_get_style_text_font(label, LV_PART_MAIN),
+                     lv_obj_get_style_text_letter_space(label, LV_PART_MAIN),
+                     lv_obj_get_style_text_line_space(label, LV_PART_MAIN), LV_COORD_MAX, LV_TEXT_FLAG_NONE);
+    return size;
+}
+
+static lv_area_t joinAreas(const lv_area_t *a, const lv_area_t *b)
+{
+    lv_area_t joined = {
+        LV_MIN(a->x1, b->x1),
+        LV_MIN(a->y1, b->y1),
+        LV_MAX(a->x2, b->x2),
+        LV_MAX(a->y2, b->y2),
+    };
+    return joined;
+}
+
+/**
+ * Merges areas whose bounding box costs no more pixels than the areas
+ * themselves, i.e. ones that touch or overlap along a shared edge
+ * @return Number of areas left
+ */
+static int mergeDirtyAreas(lv_area_t *areas, int count)
+{
+    bool merged = true;
+    while (merged)
+    {
+        merged = false;
+        for (int i = 0; i < count && !merged; i++)
+        {
+            for (int j = i + 1; j < count; j++)
+            {
+                lv_area_t joined = joinAreas(&areas[i], &areas[j]);
+                if (lv_area_get_size(&joined) <= lv_area_get_size(&areas[i]) + lv_area_get_size(&areas[j]))
+                {
+                    areas[i] = joined;
+                    areas[j] = areas[--count];
+                    merged = true;
+                    break;
+                }
+            }
+        }
+    }
+    return count;
+}
+
+/**
+ * Absolute area covered by characters [start, end) of a single-line label
+ */
+static lv_area_t glyphSpan(lv_obj_t *label, uint32_t start, uint32_t end, uint32_t length)
+{
+    lv_area_t content;
+    lv_obj_get_content_coords(label, &content);
+    int32_t lineHeight = lv_font_get_line_height(lv_obj_get_style_text_font(label, LV_PART_MAIN));
+
+    lv_point_t startPos;
+    lv_label_get_letter_pos(label, start, &startPos);
+
+    int32_t x2 = content.x2;
+    if (end < length)
+    {
+        lv_point_t endPos;
+        lv_label_get_letter_pos(label, end, &endPos);
+        x2 = content.x1 + endPos.x - 1;
+    }
+
+    lv_area_t span = {
+        content.x1 + startPos.x,
+        content.y1 + startPos.y,
+        x2,
+        content.y1 + startPos.y + lineHeight - 1,
+    };
+    return span;
+}
+
+void setLabelTextDiff(lv_obj_t *label, const char *text)
+{
+    const char *oldText = lv_label_get_text(label);
+    if (strcmp(oldText, text) == 0)
+        return;
+
+    // Per-glyph invalidation needs a 1:1 byte/character mapping on one line,
+    // and a text size change reflows the label and its centred siblings, which
+    // only the stock path invalidates correctly
+    uint32_t length = strlen(text);
+    if (strlen(oldText) != length || !isAscii(oldText) || !isAscii(text) || strchr(text, '\n'))
+    {
+        lv_label_set_text(label, text);
+        return;
+    }
+
+    lv_point_t oldSize = textSize(label, oldText);
+    lv_point_t newSize = textSize(label, text);
+    if (oldSize.x != newSize.x || oldSize.y != newSize.y)
+    {
+        lv_label_set_text(label, text);
+        return;
+    }
+
+    uint32_t runStart[MAX_DIRTY_AREAS];
+    uint32_t runEnd[MAX_DIRTY_AREAS];
+    int runs = 0;
+    for (uint32_t i = 0; i < length; i++)
+    {
+        if (oldText[i] == text[i])
+            continue;
+
+        if (runs > 0 && runEnd[runs - 1] == i)
+        {
+            runEnd[runs - 1] = i + 1;
+            continue;
+        }
+
+        if (runs == MAX_DIRTY_AREAS)
+        {
+            lv_label_set_text(label, text);
+            return;
+        }
+        runStart[runs] = i;
+        runEnd[runs] = i + 1;
+        runs++;
+    }
+
+    lv_area_t dirty[MAX_DIRTY_AREAS];
+    for (int i = 0; i < runs; i++)
+        dirty[i] = glyphSpan(label, runStart[i], runEnd[i], length);
+
+    // Apply the text without LVGL invalidating the whole label
+    lv_display_t *disp = lv_obj_get_display(label);
+    lv_display_enable_invalidation(disp, false);
+    lv_label_set_text(label, text);
+    lv_display_enable_invalidation(disp, true);
+
+    // Proportional glyphs may have moved within the run, so cover both
+    // layouts. Unchanged text between runs only stays put if every run still
+    // starts and ends where it did; if not, cover everything from the first
+    // changed glyph to the last.
+    bool moved = false;
+    for (int i = 0; i < runs; i++)
+    {
+        lv_area_t span = glyphSpan(label, runStart[i], runEnd[i], length);
+        moved = moved || span.x1 != dirty[i].x1 || span.x2 != dirty[i].x2 || span.y1 != dirty[i].y1;
+        dirty[i] = joinAreas(&dirty[i], &span);
+    }
+    if (moved)
+    {
+        for (int i = 1; i < runs; i++)
+            dirty[0] = joinAreas(&dirty[0], &dirty[i]);
+        runs = 1;
+    }
+
+    int count = mergeDirtyAreas(dirty, runs);
+    for (int i = 0; i < count; i++)
+        lv_obj_invalidate_area(label, &dirty[i]);
+}
@@ -0,0 +1,14 @@
+#pragma once
+
+#include <lvgl.h>
+
+/**
+ * Sets a label's text, invalidating only what actually changed. Identical
+ * text is a no-op; when the label keeps its size, only the cells of the
+ * changed glyphs are invalidated (adjacent cells merged into one area), or
+ * one span from the first to the last if the glyphs between them moved.
+ * Must be called from the GUI task.
+ * @param label Label to update
+ * @param text New text
+ */
+void setLabelTextDiff(lv_obj_t *label, const char *text);
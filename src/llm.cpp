@@ -1,5 +1,8 @@
 #include "llm.h"
 #include <HTTPClient.h>
+#include "http_pool.h"
+#include "http_body_stream.h"
+#include "trace.h"
 #include <ArduinoJson.h>
 
 LLM::LLM(const String &apiKey, const String &baseUrl) : _apiKey(apiKey), _baseUrl(baseUrl)
@@ -15,12 +18,15 @@ void createLLMResponseFilter(JsonDocument &filter)
 
 ChatMessage LLM::chatCompletion(const std::vector<ChatMessage> &messages, const LLMCompletionOptions &options)
 {
-    HTTPClient http;
+    TRACE_SCOPE("llm request");
     String endpoint = _baseUrl + "/chat/completions";
 
-    http.begin(endpoint);
-    http.addHeader("Content-Type", "application/json");
-    http.addHeader("Authorization", "Bearer " + _apiKey);
+    HTTPClient *http = HttpPool::begin(endpoint);
+    if (!http)
+        return ChatMessage{"assistant", "Error on HTTP request: cannot connect"};
+
+    http->addHeader("Content-Type", "application/json");
+    http->addHeader("Authorization", "Bearer " + _apiKey);
 
     DynamicJsonDocument requestDoc(4096);
 
@@ -39,18 +45,20 @@ ChatMessage LLM::chatCompletion(const std::vector<ChatMessage> &messages, const
     String payload;
     serializeJson(requestDoc, payload);
 
-    int httpResponseCode = http.POST(payload);
+    int httpResponseCode = HttpPool::POST(http, payload);
     String response = "";
 
     if (httpResponseCode > 0)
     {
-        response = http.getString();
+        HttpBodyStream body(*http);
 
         StaticJsonDocument<128> filter;
         createLLMResponseFilter(filter);
 
         DynamicJsonDocument responseDoc(4096);
-        DeserializationError error = deserializeJson(responseDoc, response, DeserializationOption::Filter(filter));
+        TRACE_BEGIN("json parse");
+        DeserializationError error = deserializeJson(responseDoc, body, DeserializationOption::Filter(filter));
+        TRACE_END("json parse");
 
         if (!error && responseDoc.containsKey("choices") && responseDoc["choices"].size() > 0)
         {
@@ -60,12 +68,16 @@ ChatMessage LLM::chatCompletion(const std::vector<ChatMessage> &messages, const
                 response = responseDoc["choices"][0]["message"]["content"].as<String>();
             }
         }
+
+        // The body is consumed by the parser, so report the status instead
+        if (response.isEmpty())
+            response = "Unexpected response (HTTP " + String(httpResponseCode) + ")";
     }
     else
     {
         response = "Error on HTTP request: " + String(httpResponseCode);
     }
 
-    http.end();
+    HttpPool::end(http);
     return ChatMessage{"assistant", response};
 }
@@ -181,10 +181,11 @@
         #define LV_DRAW_SW_CIRCLE_CACHE_SIZE 4
     #endif
 
-    #define  LV_USE_DRAW_SW_ASM     LV_DRAW_SW_ASM_NONE
+    /* Solid and masked RGB565 fills go to the kernels in rgb565_kernels.h */
+    #define  LV_USE_DRAW_SW_ASM     LV_DRAW_SW_ASM_CUSTOM
 
     #if LV_USE_DRAW_SW_ASM == LV_DRAW_SW_ASM_CUSTOM
-        #define  LV_DRAW_SW_ASM_CUSTOM_INCLUDE ""
+        #define  LV_DRAW_SW_ASM_CUSTOM_INCLUDE "rgb565_kernels.h"
     #endif
 
     /* Enable drawing complex gradients in software: linear at an angle, radial or conical */
@@ -858,7 +859,7 @@
  *==================*/
 
 /*1: Enable API to take snapshot for object*/
-#define LV_USE_SNAPSHOT 0
+#define LV_USE_SNAPSHOT 1
 
 /*1: Enable system monitor component*/
 #define LV_USE_SYSMON   0
@@ -1023,8 +1024,8 @@
 /*Driver for /dev/dri/card*/
 #define LV_USE_LINUX_DRM        0
 
-/*Interface for TFT_eSPI*/
-#define LV_USE_TFT_ESPI         1
+/*Interface for TFT_eSPI (unused: display.cpp drives TFT_eSPI with its own double-buffered DMA flush)*/
+#define LV_USE_TFT_ESPI         0
 
 /*Driver for evdev input devices*/
 #define LV_USE_EVDEV    0
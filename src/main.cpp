@@ -1,23 +1,17 @@
 #include <Arduino.h>
 #include <lvgl.h>
-#include <TFT_eSPI.h>
-#include <XPT2046_Touchscreen.h>
-#include <WiFi.h>
-#include <HTTPClient.h>
-#include <ArduinoJson.h>
 #include <freertos/FreeRTOS.h>
 #include <freertos/task.h>
 #include <time.h>
 
 #include "config.h"
 #include "hardware.h"
-#include "lv_util.h"
+#include "ui_queue.h"
+#include "gui_task.h"
+#include "boot_timeline.h"
+#include "trace.h"
 #include "app/app.h"
 
-SemaphoreHandle_t guiMutex;
-
-void guiTask(void *pvParameters);
-
 static uint32_t tickCallback(void) { return millis(); }
 
 void setup()
@@ -29,13 +23,11 @@ void setup()
     initTouchscreen();
     lv_tick_set_cb(tickCallback);
 
-    guiMutex = xSemaphoreCreateMutex();
-
-    {
-        GUILock lock;
-
-        lv_obj_set_style_bg_color(lv_scr_act(), lv_color_hex(0x000000), LV_PART_MAIN);
-    }
+    // Build the UI before guiTask starts; from then on only guiTask touches
+    // LVGL and other tasks hand it text through the UI update queues
+    setupUI();
+    bootTimelineWatchDisplay(lv_display_get_default());
+    traceWatchDisplay(lv_display_get_default());
 
     TaskHandle_t guiTaskHandle;
     TaskHandle_t appTaskHandle;
@@ -48,6 +40,7 @@ void setup()
         5,
         &guiTaskHandle,
         LVGL_CORE);
+    uiSetConsumerTask(guiTaskHandle);
 
     xTaskCreatePinnedToCore(
         appTask,
@@ -59,24 +52,15 @@ void setup()
         APP_CORE);
 }
 
-void guiTask(void *pvParameters)
+// Main loop is not used in this project, other than to dump the trace
+void loop()
 {
-    const TickType_t xFrequency = pdMS_TO_TICKS(5);
-    TickType_t xLastWakeTime = xTaskGetTickCount();
-
+#if TRACE_ENABLED
     while (1)
     {
-
-        lockGui();
-        lv_task_handler();
-        unlockGui();
-
-        vTaskDelayUntil(&xLastWakeTime, xFrequency);
+        traceServiceSerial();
+        delay(100);
     }
-}
-
-// Main loop is not used in this project
-void loop()
-{
+#endif
     vTaskDelete(NULL);
 }
\ No newline at end of file
@@ -0,0 +1,392 @@
+#include "metrics.h"
+
+#include <Arduino.h>
+#include <algorithm>
+#include <mutex>
+#include <string.h>
+
+#include "config.h"
+#include "fetch_scheduler.h"
+
+#define METRICS_MAX 96
+#define METRICS_MAX_HISTOGRAMS 12
+#define METRICS_MAX_SOURCES 16
+#define METRICS_MAX_TASKS 24
+#define METRICS_FRAME_SIZE 192 // Bytes per frame before base64; 256 characters per line
+#define METRICS_ENTRY_MAX (2 + METRIC_NAME_SIZE + 1 + METRIC_BUCKETS * 5)
+#define METRICS_FRAME_VERSION 1
+#define METRICS_FRAME_SCHEMA 'S'
+#define METRICS_FRAME_VALUES 'V'
+#define METRICS_SCHEMA_EVERY 30 // Samples between repeats of the schema
+
+struct Histogram
+{
+    uint32_t bounds[METRIC_BUCKETS - 1];
+    std::atomic<uint32_t> counts[METRIC_BUCKETS];
+    std::atomic<uint32_t> sum;
+};
+
+struct TaskRunTime
+{
+    TaskHandle_t handle;
+    uint32_t runTime;
+};
+
+static Metric registry[METRICS_MAX];
+static Histogram histograms[METRICS_MAX_HISTOGRAMS];
+static std::atomic<uint32_t> metricCount{0};
+static uint32_t histogramCount;
+static Metric scratch; // Handed out once the registry is full
+static std::mutex registryMutex;
+
+static MetricsSource sources[METRICS_MAX_SOURCES];
+static uint32_t sourceCount;
+
+static uint32_t sampleCount;
+static uint32_t schemaCount; // Metrics covered by the last schema sent
+
+void Metric::observe(uint32_t v)
+{
+    if (type != METRIC_HISTOGRAM)
+        return;
+
+    Histogram &h = histograms[histogram];
+    int bucket = 0;
+    while (bucket < METRIC_BUCKETS - 1 && v > h.bounds[bucket])
+        bucket++;
+    h.counts[bucket].fetch_add(1, std::memory_order_relaxed);
+    h.sum.fetch_add(v, std::memory_order_relaxed);
+    value.fetch_add(1, std::memory_order_relaxed);
+}
+
+static Metric *findOrCreate(const char *name, MetricType type, const uint32_t *bounds)
+{
+    std::lock_guard<std::mutex> lock(registryMutex);
+    uint32_t count = metricCount.load(std::memory_order_relaxed);
+    for (uint32_t i = 0; i < count; i++)
+    {
+        if (strcmp(registry[i].name, name) == 0)
+            return &registry[i];
+    }
+
+    if (count == METRICS_MAX || (type == METRIC_HISTOGRAM && histogramCount == METRICS_MAX_HISTOGRAMS))
+    {
+        Serial.printf("Metrics registry full, not recording %s\n", name);
+        return &scratch;
+    }
+
+    Metric &metric = registry[count];
+    strncpy(metric.name, name, METRIC_NAME_SIZE - 1);
+    metric.type = type;
+    if (type == METRIC_HISTOGRAM)
+    {
+        metric.histogram = histogramCount;
+        memcpy(histograms[histogramCount++].bounds, bounds, sizeof(Histogram::bounds));
+    }
+
+    // The sampler reads up to metricCount without the lock
+    metricCount.store(count + 1, std::memory_order_release);
+    return &metric;
+}
+
+Metric *Metrics::counter(const char *name)
+{
+    return findOrCreate(name, METRIC_COUNTER, NULL);
+}
+
+Metric *Metrics::gauge(const char *name)
+{
+    return findOrCreate(name, METRIC_GAUGE, NULL);
+}
+
+Metric *Metrics::histogram(const char *name, const uint32_t bounds[METRIC_BUCKETS - 1])
+{
+    return findOrCreate(name, METRIC_HISTOGRAM, bounds);
+}
+
+bool Metrics::addSource(MetricsSource source)
+{
+    std::lock_guard<std::mutex> lock(registryMutex);
+    for (uint32_t i = 0; i < sourceCount; i++)
+    {
+        if (sources[i] == source)
+            return true;
+    }
+    if (sourceCount < METRICS_MAX_SOURCES)
+        sources[sourceCount++] = source;
+    return true;
+}
+
+uint32_t Metrics::count()
+{
+    return metricCount.load(std::memory_order_acquire);
+}
+
+static void sampleHeap()
+{
+    // Free heap that is all in small pieces can still fail a TLS handshake;
+    // the largest block falling while free heap holds steady is the sign
+    static Metric *heapFree = Metrics::gauge("heap.free");
+    static Metric *heapMinFree = Metrics::gauge("heap.min_free");
+    static Metric *heapLargest = Metrics::gauge("heap.largest");
+    static Metric *heapFragmentation = Metrics::gauge("heap.frag_pct");
+
+    uint32_t freeHeap = ESP.getFreeHeap();
+    uint32_t largest = ESP.getMaxAllocHeap();
+    heapFree->set(freeHeap);
+    heapMinFree->set(ESP.getMinFreeHeap());
+    heapLargest->set(largest);
+    heapFragmentation->set(freeHeap ? 100 - (int32_t)((uint64_t)largest * 100 / freeHeap) : 0);
+}
+
+static void sampleTasks()
+{
+#if configUSE_TRACE_FACILITY
+    static TaskStatus_t statuses[METRICS_MAX_TASKS];
+    static TaskRunTime lastRunTimes[METRICS_MAX_TASKS];
+    static uint32_t lastRunTimeCount;
+    static uint32_t lastTotal;
+    static Metric *taskCount = Metrics::gauge("tasks");
+
+    uint32_t total = 0;
+    UBaseType_t count = uxTaskGetSystemState(statuses, METRICS_MAX_TASKS, &total);
+    taskCount->set(count);
+
+    // In creation order, so a repeated name (the app's "wifi" and the
+    // driver's) gets the same suffix every time
+    std::sort(statuses, statuses + count, [](const TaskStatus_t &a, const TaskStatus_t &b)
+              { return a.xTaskNumber < b.xTaskNumber; });
+
+    // Run time counts without GENERATE_RUN_TIME_STATS stay at zero
+    uint32_t elapsed = total - lastTotal;
+    bool haveCpu = lastTotal != 0 && elapsed != 0;
+
+    for (UBaseType_t i = 0; i < count; i++)
+    {
+        const TaskStatus_t &status = statuses[i];
+        int repeats = 0;
+        for (UBaseType_t j = 0; j < i; j++)
+        {
+            if (strcmp(statuses[j].pcTaskName, status.pcTaskName) == 0)
+                repeats++;
+        }
+
+        char taskName[METRIC_NAME_SIZE - 6];
+        if (repeats)
+            snprintf(taskName, sizeof(taskName), "%s/%d", status.pcTaskName, repeats + 1);
+        else
+            snprintf(taskName, sizeof(taskName), "%s", status.pcTaskName);
+
+        char name[METRIC_NAME_SIZE];
+        snprintf(name, sizeof(name), "stack.%s", taskName);
+        Metrics::gauge(name)->set(status.usStackHighWaterMark);
+
+        if (!haveCpu)
+            continue;
+        for (uint32_t j = 0; j < lastRunTimeCount; j++)
+        {
+            if (lastRunTimes[j].handle != status.xHandle)
+                continue;
+
+            // Per mille of one core over the interval
+            uint32_t ran = status.ulRunTimeCounter - lastRunTimes[j].runTime;
+            snprintf(name, sizeof(name), "cpu.%s", taskName);
+            Metrics::gauge(name)->set((int32_t)((uint64_t)ran * 1000 / elapsed));
+            break;
+        }
+    }
+
+    for (UBaseType_t i = 0; i < count; i++)
+        lastRunTimes[i] = {statuses[i].xHandle, statuses[i].ulRunTimeCounter};
+    lastRunTimeCount = count;
+    lastTotal = total;
+#endif
+}
+
+void Metrics::sample()
+{
+    uint32_t count;
+    {
+        std::lock_guard<std::mutex> lock(registryMutex);
+        count = sourceCount;
+    }
+    for (uint32_t i = 0; i < count; i++)
+        sources[i]();
+
+    sampleHeap();
+    sampleTasks();
+    sampleCount++;
+}
+
+static size_t putVarint(uint8_t *out, uint32_t value)
+{
+    size_t length = 0;
+    while (value >= 0x80)
+    {
+        out[length++] = (uint8_t)value | 0x80;
+        value >>= 7;
+    }
+    out[length++] = (uint8_t)value;
+    return length;
+}
+
+static uint16_t crc16(const uint8_t *data, size_t length)
+{
+    // CRC-16/CCITT-FALSE
+    uint16_t crc = 0xFFFF;
+    for (size_t i = 0; i < length; i++)
+    {
+        crc ^= (uint16_t)data[i] << 8;
+        for (int bit = 0; bit < 8; bit++)
+            crc = crc & 0x8000 ? (crc << 1) ^ 0x1021 : crc << 1;
+    }
+    return crc;
+}
+
+/**
+ * Builds frames of whole entries and prints each as a base64 line
+ */
+class FrameWriter
+{
+public:
+    FrameWriter(char kind) : _kind(kind) {}
+
+    void add(uint32_t index, const uint8_t *entry, size_t length)
+    {
+        if (_count > 0 && (_length + length > sizeof(_entries) || _count == 255))
+            flush();
+        if (_count == 0)
+            _first = index;
+        memcpy(_entries + _length, entry, length);
+        _length += length;
+        _count++;
+    }
+
+    void flush()
+    {
+        if (_count == 0)
+            return;
+
+        // version, kind, sample, uptime, first index, entry count, entries, CRC
+        uint8_t frame[2 + 3 * 5 + 1 + METRICS_FRAME_SIZE + 2];
+        size_t length = 0;
+        frame[length++] = METRICS_FRAME_VERSION;
+        frame[length++] = _kind;
+        length += putVarint(frame + length, sampleCount);
+        length += putVarint(frame + length, millis());
+        length += putVarint(frame + length, _first);
+        frame[length++] = _count;
+        memcpy(frame + length, _entries, _length);
+        length += _length;
+        uint16_t crc = crc16(frame, length);
+        frame[length++] = crc >> 8;
+        frame[length++] = crc & 0xFF;
+
+        static const char alphabet[] = "ABCDEFGHIJKLMNOPQRSTUVWXYZabcdefghijklmnopqrstuvwxyz0123456789+/";
+        char line[(sizeof(frame) + 2) / 3 * 4 + 1];
+        char *out = line;
+        for (size_t i = 0; i < length; i += 3)
+        {
+            uint32_t chunk = frame[i] << 16;
+            if (i + 1 < length)
+                chunk |= frame[i + 1] << 8;
+            if (i + 2 < length)
+                chunk |= frame[i + 2];
+            *out++ = alphabet[(chunk >> 18) & 0x3f];
+            *out++ = alphabet[(chunk >> 12) & 0x3f];
+            *out++ = i + 1 < length ? alphabet[(chunk >> 6) & 0x3f] : '=';
+            *out++ = i + 2 < length ? alphabet[chunk & 0x3f] : '=';
+        }
+        *out = '\0';
+
+        // One call per line, so other tasks' logs cannot split it
+        Serial.printf("metrics: %s\n", line);
+        _length = 0;
+        _count = 0;
+    }
+
+private:
+    char _kind;
+    uint8_t _entries[METRICS_FRAME_SIZE];
+    size_t _length = 0;
+    uint32_t _first = 0;
+    uint32_t _count = 0;
+};
+
+/**
+ * Type, name and, for histograms, bucket bounds
+ */
+static size_t encodeSchema(const Metric &metric, uint8_t *out)
+{
+    size_t length = 0;
+    size_t nameLength = strlen(metric.name);
+    out[length++] = metric.type;
+    out[length++] = nameLength;
+    memcpy(out + length, metric.name, nameLength);
+    length += nameLength;
+    if (metric.type == METRIC_HISTOGRAM)
+    {
+        out[length++] = METRIC_BUCKETS - 1;
+        for (uint32_t bound : histograms[metric.histogram].bounds)
+            length += putVarint(out + length, bound);
+    }
+    return length;
+}
+
+/**
+ * Counters as varints, gauges zigzag-encoded, histograms as their bucket
+ * counts and then the sum
+ */
+static size_t encodeValue(const Metric &metric, uint8_t *out)
+{
+    uint32_t value = metric.value.load(std::memory_order_relaxed);
+    switch (metric.type)
+    {
+    case METRIC_GAUGE:
+        return putVarint(out, (value << 1) ^ (uint32_t)((int32_t)value >> 31));
+    case METRIC_HISTOGRAM:
+    {
+        Histogram &h = histograms[metric.histogram];
+        size_t length = 0;
+        for (const std::atomic<uint32_t> &count : h.counts)
+            length += putVarint(out + length, count.load(std::memory_order_relaxed));
+        length += putVarint(out + length, h.sum.load(std::memory_order_relaxed));
+        return length;
+    }
+    default:
+        return putVarint(out, value);
+    }
+}
+
+void Metrics::report()
+{
+    uint32_t count = metricCount.load(std::memory_order_acquire);
+    uint8_t entry[METRICS_ENTRY_MAX];
+
+    if (count > schemaCount || sampleCount % METRICS_SCHEMA_EVERY == 1)
+    {
+        FrameWriter schema(METRICS_FRAME_SCHEMA);
+        for (uint32_t i = 0; i < count; i++)
+            schema.add(i, entry, encodeSchema(registry[i], entry));
+        schema.flush();
+        schemaCount = count;
+    }
+
+    FrameWriter values(METRICS_FRAME_VALUES);
+    for (uint32_t i = 0; i < count; i++)
+        values.add(i, entry, encodeValue(registry[i], entry));
+    values.flush();
+}
+
+static uint32_t samplerJob()
+{
+    Metrics::sample();
+    Metrics::report();
+    return METRICS_INTERVAL_MS;
+}
+
+void Metrics::registerSamplerJob()
+{
+    if (METRICS_INTERVAL_MS)
+        FetchScheduler::addJob("metrics", samplerJob, FETCH_PRIORITY_LOW, false, 0, METRICS_INTERVAL_MS);
+}
@@ -0,0 +1,101 @@
+#pragma once
+
+#include <atomic>
+#include <stdint.h>
+
+#define METRIC_NAME_SIZE 24
+#define METRIC_BUCKETS 8 // Per histogram, the last one open-ended
+
+enum MetricType : uint8_t
+{
+    METRIC_COUNTER,   // Only goes up; wraps at 2^32, which the decoder undoes
+    METRIC_GAUGE,     // Signed value that is set, e.g. free heap
+    METRIC_HISTOGRAM, // Observations counted into fixed buckets, plus their sum
+};
+
+/**
+ * One named value in the registry. Pointers stay valid for the life of the
+ * program, so a module looks its metrics up once and keeps them. Updates
+ * are single relaxed atomics and safe from any task.
+ */
+struct Metric
+{
+    char name[METRIC_NAME_SIZE];
+    MetricType type;
+    uint8_t histogram; // Index into the histogram pool
+    std::atomic<uint32_t> value;
+
+    void add(uint32_t n = 1) { value.fetch_add(n, std::memory_order_relaxed); }
+    void set(int32_t v) { value.store((uint32_t)v, std::memory_order_relaxed); }
+
+    /**
+     * Counts one observation into its bucket; histograms only
+     */
+    void observe(uint32_t v);
+};
+
+/**
+ * Copies a module's own stats into its metrics just before each sample
+ */
+typedef void (*MetricsSource)();
+
+/**
+ * Registry of counters, gauges and histograms, and a sampler that adds heap
+ * and per-task figures and prints everything over serial as compact frames.
+ *
+ * Every METRICS_INTERVAL_MS the sampler runs the registered sources, then
+ * records free heap, the largest free block, the lowest free heap so far,
+ * and for every FreeRTOS task its stack high-water mark and share of a core
+ * since the last sample (the latter needs configGENERATE_RUN_TIME_STATS).
+ *
+ * Each sample goes out as one or more "metrics:" lines, each a base64
+ * frame with a CRC. Values are sent by index; a schema frame naming them
+ * goes out first, whenever metrics were added, and every
+ * METRICS_SCHEMA_EVERY samples for a monitor attached mid-run.
+ * tools/metrics_decode.py turns a log into a table or CSV and flags heap
+ * and stack trends.
+ */
+class Metrics
+{
+public:
+    /**
+     * Looks a metric up by name, creating it on first use. When the
+     * registry is full a scratch metric that is never reported comes back,
+     * so callers need no checks.
+     */
+    static Metric *counter(const char *name);
+    static Metric *gauge(const char *name);
+
+    /**
+     * @param bounds Inclusive upper bounds of the first METRIC_BUCKETS - 1
+     *        buckets, ascending; copied
+     */
+    static Metric *histogram(const char *name, const uint32_t bounds[METRIC_BUCKETS - 1]);
+
+    /**
+     * Adds a function to run before each sample. Adding one twice is a no-op.
+     * @return true, so a module can register from a function-local static
+     */
+    static bool addSource(MetricsSource source);
+
+    /**
+     * Adds the sampler to the network worker as a local job. Call before
+     * FetchScheduler::start().
+     */
+    static void registerSamplerJob();
+
+    /**
+     * Runs the sources and records heap and task figures
+     */
+    static void sample();
+
+    /**
+     * Prints the current values as frames, after the schema if it is due
+     */
+    static void report();
+
+    /**
+     * @return Metrics registered so far
+     */
+    static uint32_t count();
+};
@@ -0,0 +1,148 @@
+#include <Arduino.h>
+#include <WiFi.h>
+#include <base64.h>
+#include <esp_sntp.h>
+#include <esp_timer.h>
+#include <sys/time.h>
+#include <malloc.h>
+#include <atomic>
+#include <random>
+
+HardwareSerial Serial;
+EspClass ESP;
+WiFiClass WiFi;
+
+static uint64_t monotonicMicros()
+{
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (uint64_t)ts.tv_sec * 1000000ULL + ts.tv_nsec / 1000;
+}
+
+static const uint64_t startMicros = monotonicMicros();
+
+uint32_t millis()
+{
+    return (uint32_t)(micros() / 1000);
+}
+
+uint64_t micros()
+{
+    return monotonicMicros() - startMicros;
+}
+
+int64_t esp_timer_get_time()
+{
+    return micros();
+}
+
+void delay(uint32_t ms)
+{
+    vTaskDelay(pdMS_TO_TICKS(ms));
+}
+
+// Fixed seed so benchmark runs repeat
+static std::mt19937 randomEngine(1);
+
+long random(long max)
+{
+    return max > 0 ? random(0, max) : 0;
+}
+
+long random(long min, long max)
+{
+    if (max <= min)
+        return min;
+    return std::uniform_int_distribution<long>(min, max - 1)(randomEngine);
+}
+
+void configTime(long gmtOffsetSec, int daylightOffsetSec, const char *server1,
+                const char *server2, const char *server3)
+{
+    // POSIX offsets are west-positive, the opposite of gmtOffsetSec
+    long offset = -(gmtOffsetSec + daylightOffsetSec);
+    char tz[32];
+    snprintf(tz, sizeof(tz), "UTC%+ld:%02ld", offset / 3600, labs(offset % 3600) / 60);
+    setenv("TZ", tz, 1);
+    tzset();
+}
+
+static sntp_sync_time_cb_t sntpCallback;
+
+void sntp_set_time_sync_notification_cb(sntp_sync_time_cb_t callback)
+{
+    sntpCallback = callback;
+}
+
+void sntp_set_sync_interval(uint32_t intervalMs)
+{
+}
+
+void configTzTime(const char *tz, const char *server1, const char *server2, const char *server3)
+{
+    setenv("TZ", tz, 1);
+    tzset();
+
+    if (sntpCallback)
+    {
+        struct timeval now;
+        gettimeofday(&now, NULL);
+        sntpCallback(&now);
+    }
+}
+
+bool getLocalTime(struct tm *info, uint32_t ms)
+{
+    time_t now = time(NULL);
+    return localtime_r(&now, info) != NULL;
+}
+
+String base64::encode(const String &text)
+{
+    static const char alphabet[] = "ABCDEFGHIJKLMNOPQRSTUVWXYZabcdefghijklmnopqrstuvwxyz0123456789+/";
+
+    const uint8_t *data = (const uint8_t *)text.c_str();
+    size_t length = text.length();
+    String encoded;
+    encoded.reserve((length + 2) / 3 * 4);
+
+    for (size_t i = 0; i < length; i += 3)
+    {
+        uint32_t chunk = data[i] << 16;
+        if (i + 1 < length)
+            chunk |= data[i + 1] << 8;
+        if (i + 2 < length)
+            chunk |= data[i + 2];
+
+        encoded += alphabet[(chunk >> 18) & 0x3f];
+        encoded += alphabet[(chunk >> 12) & 0x3f];
+        encoded += i + 1 < length ? alphabet[(chunk >> 6) & 0x3f] : '=';
+        encoded += i + 2 < length ? alphabet[chunk & 0x3f] : '=';
+    }
+
+    return encoded;
+}
+
+static std::atomic<uint32_t> minFreeHeap{UINT32_MAX};
+
+uint32_t EspClass::getFreeHeap()
+{
+    struct mallinfo2 info = mallinfo2();
+    uint32_t freeHeap = info.fordblks;
+    uint32_t lowest = minFreeHeap.load();
+    while (freeHeap < lowest && !minFreeHeap.compare_exchange_weak(lowest, freeHeap))
+        ;
+    return freeHeap;
+}
+
+uint32_t EspClass::getMinFreeHeap()
+{
+    getFreeHeap();
+    return minFreeHeap.load();
+}
+
+uint32_t EspClass::getMaxAllocHeap()
+{
+    struct mallinfo2 info = mallinfo2();
+    return info.keepcost;
+}
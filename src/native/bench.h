@@ -0,0 +1,122 @@
+#pragma once
+
+/**
+ * Benchmarks run by `program --bench <name>`. Each one is called after
+ * lv_init() and initDisplay(), without the app tasks running, and prints its
+ * own results.
+ */
+
+/**
+ * Time per minute update and flushed bytes: stock lv_label vs the sprite
+ * clock widget
+ */
+void runClockBenchmark();
+
+/**
+ * Stress test of the UI update queues: one producer thread per label posting
+ * flat out against a consumer draining at guiTask's rate, compared with the
+ * same traffic through a single mutex
+ */
+void runUiQueueBenchmark();
+
+/**
+ * Peak heap per fetch of canned Spotify, Calendar and weather responses from
+ * a local mock server: body buffered in a String and parsed, vs parsed
+ * straight from the connection
+ */
+void runJsonBenchmark();
+
+/**
+ * Bytes downloaded over an hour of calendar polling against a local mock
+ * Calendar API, for each CalendarSyncMode
+ */
+void runCalendarBenchmark();
+
+/**
+ * RFC 3339 parser: edge-case corpus, DST sweep across several zones, random
+ * round trips and mutation fuzzing, then ns/parse against the old
+ * strncpy/atoi/mktime parser
+ */
+void runRfc3339Benchmark();
+
+/**
+ * Spotify polls over simulated listening sessions: fixed 10 s interval vs the
+ * adaptive track-end scheduler, in requests per hour and how long each track
+ * change takes to show
+ */
+void runSpotifyBenchmark();
+
+/**
+ * Album art: decode time, peak heap and error against libjpeg for sample
+ * covers of each supported layout, then the cover cache over a simulated
+ * listening session served by a local mock image host
+ */
+void runAlbumArtBenchmark();
+
+/**
+ * OAuth token against a local mock token endpoint: cold, maintained and
+ * expired get() latency, reuse from NVS after a reboot, the refresh schedule
+ * for several lifetimes and jittered retries during an outage
+ */
+void runOAuthBenchmark();
+
+/**
+ * WiFi manager against the simulated station: reconnect latency histograms
+ * over repeated link drops with and without the cached BSSID and channel,
+ * the fallback when the access point moves, and fetches held while down
+ */
+void runWiFiBenchmark();
+
+/**
+ * Time service over simulated days on a drifting oscillator: never going
+ * backwards, the slew rate, the drift estimate converging and the error it
+ * removes between syncs, and local time across the TIME_ZONE DST changes
+ */
+void runTimeBenchmark();
+
+/**
+ * Clock task over a simulated day across a DST change, a slew and a clock
+ * step: wakeups and GUI posts per hour and how late each minute shows, for
+ * the old 1 Hz loop and the minute-aligned ClockTick
+ */
+void runTickBenchmark();
+
+/**
+ * Touch pipeline over a replayed XPT2046 trace, synthetic or recorded
+ * (CLOCK_TOUCH_TRACE): tap latency, split presses, jitter, position error
+ * and SPI reads for the old polled min/max mapping and the IRQ-gated
+ * median+IIR filter, then the three-point calibration on a skewed panel
+ */
+void runTouchBenchmark();
+
+/**
+ * Render time per full-screen refresh of the clock screen with the panel
+ * rotating in MADCTL, against rotating each flushed area in software
+ */
+void runRotateBenchmark();
+
+/**
+ * GUI task busy time and flush traffic while a long song title scrolls,
+ * for the circular-scroll label and the pre-rendered marquee strip
+ */
+void runMarqueeBenchmark();
+
+/**
+ * Mpixel/s of the RGB565 fill, A8 blend and byte-swap kernels against the
+ * generic per-pixel loops, and a full refresh of the clock screen with
+ * LVGL's own blends and with the kernels hooked in
+ */
+void runKernelsBenchmark();
+
+/**
+ * Cost of recording a trace event from one or more tasks, the events and
+ * tracing time in a full refresh of the clock screen, and the dump time
+ */
+void runTraceBenchmark();
+
+/**
+ * Cost of updating a counter and a histogram from one or more tasks, of a
+ * metrics sample with the board's tasks running, and the serial bytes each
+ * report takes
+ */
+void runMetricsBenchmark();
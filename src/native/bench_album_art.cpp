@@ -0,0 +1,304 @@
+#include <Arduino.h>
+#include <jpeglib.h>
+#include <random>
+#include <string>
+#include <unistd.h>
+#include <vector>
+
+#include "bench.h"
+#include "heap_trace.h"
+#include "mock_server.h"
+#include "jpeg_decoder.h"
+#include "config.h"
+#include "app/album_art.h"
+
+#define BENCH_DECODES 2000
+#define BENCH_ALBUMS 12
+#define BENCH_TRACKS 200
+
+/**
+ * Stream over a byte array, standing in for the HTTP body
+ */
+class MemoryStream : public Stream
+{
+public:
+    MemoryStream(const std::string &data) : _data(data), _pos(0) {}
+
+    int available() { return _data.size() - _pos; }
+    int read() { return _pos < _data.size() ? (uint8_t)_data[_pos++] : -1; }
+    int peek() { return _pos < _data.size() ? (uint8_t)_data[_pos] : -1; }
+
+    size_t readBytes(char *buffer, size_t length)
+    {
+        size_t count = std::min(length, _data.size() - _pos);
+        memcpy(buffer, _data.data() + _pos, count);
+        _pos += count;
+        return count;
+    }
+
+private:
+    const std::string &_data;
+    size_t _pos;
+};
+
+struct SampleCover
+{
+    const char *name;
+    int size;
+    int components;
+    int lumaH; // Luma sampling factors; chroma is always 1x1
+    int lumaV;
+    int quality;
+    int restartRows;
+    bool progressive;
+};
+
+static const SampleCover samples[] = {
+    {"4:2:0 q75", 64, 3, 2, 2, 75, 0, false},
+    {"4:2:0 q95", 64, 3, 2, 2, 95, 0, false},
+    {"4:4:4 q90", 64, 3, 1, 1, 90, 0, false},
+    {"4:2:2 q85", 64, 3, 2, 1, 85, 0, false},
+    {"grey q85", 64, 1, 1, 1, 85, 0, false},
+    {"restarts", 64, 3, 2, 2, 80, 1, false},
+    {"300 clip", 300, 3, 2, 2, 80, 0, false},
+    {"progress.", 64, 3, 2, 2, 80, 0, true},
+};
+
+/**
+ * Synthetic cover art: a diagonal gradient, a disc and some fine noise, so
+ * both flat areas and high-frequency detail get coded
+ */
+static std::vector<uint8_t> renderCover(int size, int seed)
+{
+    std::mt19937 rng(seed);
+    std::uniform_int_distribution<int> noise(-24, 24);
+    std::vector<uint8_t> rgb(size * size * 3);
+
+    for (int y = 0; y < size; y++)
+    {
+        for (int x = 0; x < size; x++)
+        {
+            int dx = x - size / 2, dy = y - size / 2;
+            bool disc = dx * dx + dy * dy < size * size / 9;
+            int n = noise(rng);
+            uint8_t *p = &rgb[(y * size + x) * 3];
+            p[0] = disc ? 230 : (x * 255 / size + seed * 40) & 0xFF;
+            p[1] = disc ? 40 + (y * 4 % 64) : (y * 255 / size);
+            p[2] = std::max(0, std::min(255, (disc ? 60 : 160) + n));
+        }
+    }
+    return rgb;
+}
+
+static std::string encodeCover(const SampleCover &sample, int seed)
+{
+    std::vector<uint8_t> rgb = renderCover(sample.size, seed);
+
+    jpeg_compress_struct cinfo;
+    jpeg_error_mgr jerr;
+    cinfo.err = jpeg_std_error(&jerr);
+    jpeg_create_compress(&cinfo);
+
+    unsigned char *buffer = NULL;
+    unsigned long length = 0;
+    jpeg_mem_dest(&cinfo, &buffer, &length);
+
+    cinfo.image_width = sample.size;
+    cinfo.image_height = sample.size;
+    cinfo.input_components = 3;
+    cinfo.in_color_space = JCS_RGB;
+    jpeg_set_defaults(&cinfo);
+    if (sample.components == 1)
+        jpeg_set_colorspace(&cinfo, JCS_GRAYSCALE);
+    jpeg_set_quality(&cinfo, sample.quality, TRUE);
+    cinfo.comp_info[0].h_samp_factor = sample.lumaH;
+    cinfo.comp_info[0].v_samp_factor = sample.lumaV;
+    cinfo.restart_in_rows = sample.restartRows;
+    if (sample.progressive)
+        jpeg_simple_progression(&cinfo);
+
+    jpeg_start_compress(&cinfo, TRUE);
+    while (cinfo.next_scanline < cinfo.image_height)
+    {
+        JSAMPROW row = &rgb[cinfo.next_scanline * sample.size * 3];
+        jpeg_write_scanlines(&cinfo, &row, 1);
+    }
+    jpeg_finish_compress(&cinfo);
+    jpeg_destroy_compress(&cinfo);
+
+    std::string jpeg((const char *)buffer, length);
+    free(buffer);
+    return jpeg;
+}
+
+/**
+ * libjpeg's decode of the same file, with the same integer IDCT and
+ * replicated chroma, as the reference to compare against
+ */
+static void referenceDecode(const std::string &jpeg, uint16_t *pixels)
+{
+    jpeg_decompress_struct cinfo;
+    jpeg_error_mgr jerr;
+    cinfo.err = jpeg_std_error(&jerr);
+    jpeg_create_decompress(&cinfo);
+    jpeg_mem_src(&cinfo, (const unsigned char *)jpeg.data(), jpeg.size());
+    jpeg_read_header(&cinfo, TRUE);
+    cinfo.out_color_space = JCS_RGB;
+    cinfo.dct_method = JDCT_ISLOW;
+    cinfo.do_fancy_upsampling = FALSE;
+    jpeg_start_decompress(&cinfo);
+
+    std::vector<uint8_t> row(cinfo.output_width * 3);
+    while (cinfo.output_scanline < cinfo.output_height)
+    {
+        int y = cinfo.output_scanline;
+        JSAMPROW rowPtr = row.data();
+        jpeg_read_scanlines(&cinfo, &rowPtr, 1);
+        if (y >= ALBUM_ART_SIZE)
+            continue;
+        for (int x = 0; x < (int)cinfo.output_width && x < ALBUM_ART_SIZE; x++)
+        {
+            const uint8_t *p = &row[x * 3];
+            pixels[y * ALBUM_ART_SIZE + x] = (p[0] & 0xF8) << 8 | (p[1] & 0xFC) << 3 | p[2] >> 3;
+        }
+    }
+    jpeg_finish_decompress(&cinfo);
+    jpeg_destroy_decompress(&cinfo);
+}
+
+/**
+ * Largest difference of any RGB565 channel, in that channel's own steps
+ */
+static int maxChannelError(const uint16_t *a, const uint16_t *b)
+{
+    int worst = 0;
+    for (int i = 0; i < ALBUM_ART_SIZE * ALBUM_ART_SIZE; i++)
+    {
+        worst = std::max(worst, abs((a[i] >> 11) - (b[i] >> 11)));
+        worst = std::max(worst, abs(((a[i] >> 5) & 0x3F) - ((b[i] >> 5) & 0x3F)));
+        worst = std::max(worst, abs((a[i] & 0x1F) - (b[i] & 0x1F)));
+    }
+    return worst;
+}
+
+static void runDecodeBenchmark()
+{
+    static uint16_t pixels[ALBUM_ART_SIZE * ALBUM_ART_SIZE];
+    static uint16_t reference[ALBUM_ART_SIZE * ALBUM_ART_SIZE];
+
+    printf("%-10s %6s %9s %9s %10s %9s\n", "cover", "bytes", "us/decode", "peak heap", "libjpeg us", "max error");
+    for (const SampleCover &sample : samples)
+    {
+        std::string jpeg = encodeCover(sample, 1);
+
+        int64_t heapBefore = heapTraceInUse();
+        heapTraceResetPeak();
+        MemoryStream first(jpeg);
+        bool ok = decodeJpegRgb565(first, pixels, ALBUM_ART_SIZE, ALBUM_ART_SIZE);
+        int64_t peak = heapTracePeak() - heapBefore;
+
+        if (!ok)
+        {
+            printf("%-10s %6zu  rejected (%lld bytes peak heap)\n", sample.name, jpeg.size(), (long long)peak);
+            continue;
+        }
+
+        uint64_t start = micros();
+        for (int i = 0; i < BENCH_DECODES; i++)
+        {
+            MemoryStream in(jpeg);
+            decodeJpegRgb565(in, pixels, ALBUM_ART_SIZE, ALBUM_ART_SIZE);
+        }
+        double decodeUs = (double)(micros() - start) / BENCH_DECODES;
+
+        start = micros();
+        for (int i = 0; i < BENCH_DECODES; i++)
+            referenceDecode(jpeg, reference);
+        double referenceUs = (double)(micros() - start) / BENCH_DECODES;
+
+        printf("%-10s %6zu %9.1f %9lld %10.1f %9d\n", sample.name, jpeg.size(), decodeUs, (long long)peak,
+               referenceUs, maxChannelError(pixels, reference));
+    }
+
+    // Truncated files must fail cleanly rather than read past the end
+    std::string jpeg = encodeCover(samples[0], 2);
+    int accepted = 0;
+    for (size_t length = 0; length < jpeg.size(); length++)
+    {
+        std::string truncated = jpeg.substr(0, length);
+        MemoryStream in(truncated);
+        accepted += decodeJpegRgb565(in, pixels, ALBUM_ART_SIZE, ALBUM_ART_SIZE);
+    }
+    printf("truncations: %zu prefixes of a cover, %d accepted\n", jpeg.size(), accepted);
+}
+
+/**
+ * A listening session against the cover cache: tracks come from a small
+ * set of albums, the favourites far more often than the rest
+ */
+static void runCacheBenchmark()
+{
+    std::vector<std::string> covers;
+    for (int album = 0; album < BENCH_ALBUMS; album++)
+        covers.push_back(encodeCover(samples[0], album));
+
+    MockServer server;
+    if (!server.start([&](const MockRequest &request)
+                      {
+                          MockResponse response;
+                          int album = atoi(request.path.c_str() + strlen("/image/"));
+                          if (album < 0 || album >= BENCH_ALBUMS)
+                          {
+                              response.status = 404;
+                              return response;
+                          }
+                          response.headers.push_back({"Content-Type", "image/jpeg"});
+                          response.body = String(covers[album].data(), covers[album].size());
+                          return response; },
+                      true))
+    {
+        printf("album art benchmark: cannot start mock server\n");
+        return;
+    }
+
+    char redirect[32];
+    snprintf(redirect, sizeof(redirect), "127.0.0.1:%u", server.port());
+    setenv("CLOCK_REDIRECT_HTTPS", redirect, 1);
+
+    std::mt19937 rng(7);
+    std::geometric_distribution<int> pick(0.3);
+    static uint16_t pixels[ALBUM_ART_SIZE * ALBUM_ART_SIZE];
+    uint64_t hitUs = 0;
+    int hitCount = 0;
+
+    for (int track = 0; track < BENCH_TRACKS; track++)
+    {
+        int album = std::min(pick(rng), BENCH_ALBUMS - 1);
+        String uri = "spotify:album:" + String(album);
+        String url = "https://i.scdn.co/image/" + String(album);
+
+        AlbumArtStats before = AlbumArtCache::getStats();
+        uint64_t start = micros();
+        AlbumArtCache::fetch(uri, url);
+        AlbumArtCache::copy(uri.c_str(), pixels);
+        if (AlbumArtCache::getStats().hits > before.hits)
+        {
+            hitUs += micros() - start;
+            hitCount++;
+        }
+    }
+
+    AlbumArtStats stats = AlbumArtCache::getStats();
+    printf("cache: %d tracks from %d albums, %d slots: %u hits, %u misses, %u evictions, %u failures\n",
+           BENCH_TRACKS, BENCH_ALBUMS, ALBUM_ART_CACHE_SIZE, stats.hits, stats.misses, stats.evictions,
+           stats.failures);
+    printf("cover shown after: miss %.1f ms avg (download + decode, loopback TLS), hit %.1f us avg\n",
+           stats.misses ? (double)stats.fetchMsTotal / stats.misses : 0.0, hitCount ? (double)hitUs / hitCount : 0.0);
+    unsetenv("CLOCK_REDIRECT_HTTPS");
+}
+
+void runAlbumArtBenchmark()
+{
+    runDecodeBenchmark();
+    runCacheBenchmark();
+}
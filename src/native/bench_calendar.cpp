@@ -0,0 +1,268 @@
+#include <Arduino.h>
+#include <mutex>
+#include <string>
+#include <unistd.h>
+#include <vector>
+
+#include "bench.h"
+#include "fixtures.h"
+#include "mock_server.h"
+#include "config.h"
+#include "app/calendar.h"
+#include "rfc3339.h"
+
+#define BENCH_POLLS 60 // One hour at the calendar task's one-minute interval
+#define BENCH_EVENTS 5
+#define BENCH_BUSY_EVENTS 200 // Thirteen pages of sixteen
+#define BENCH_BUSY_POLLS 10
+
+/**
+ * @return The query parameter's value with %XX escapes decoded, or "" if absent
+ */
+static std::string queryParam(const String &path, const char *name)
+{
+    std::string key = std::string("?") + name + "=";
+    int at = path.indexOf(key.c_str());
+    if (at < 0)
+    {
+        key[0] = '&';
+        at = path.indexOf(key.c_str());
+    }
+    if (at < 0)
+        return "";
+
+    std::string value;
+    for (const char *c = path.c_str() + at + key.size(); *c && *c != '&'; c++)
+    {
+        if (*c == '%' && isxdigit(c[1]) && isxdigit(c[2]))
+        {
+            char hex[3] = {c[1], c[2], 0};
+            value += (char)strtol(hex, NULL, 16);
+            c += 2;
+        }
+        else
+            value += *c;
+    }
+    return value;
+}
+
+/**
+ * Calendar API stand-in that honours If-None-Match, syncToken, timeMax and
+ * paging. Each event remembers the version of the calendar it last changed
+ * in; a sync token is simply the version it was issued at, and a page token
+ * the offset of the page.
+ */
+struct MockCalendar
+{
+    struct Event
+    {
+        int index;
+        time_t start;
+        int version;
+        bool cancelled;
+    };
+
+    std::mutex mutex;
+    std::vector<Event> events;
+    int version = 1;
+
+    void reset(time_t now, int count = BENCH_EVENTS, int spacing = 1800)
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        events.clear();
+        version = 1;
+        for (int i = 0; i < count; i++)
+            events.push_back({i, now + i * spacing - 600, version, false});
+    }
+
+    void reschedule(int index, time_t start)
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        events[index].start = start;
+        events[index].version = ++version;
+    }
+
+    void cancel(int index)
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        events[index].cancelled = true;
+        events[index].version = ++version;
+    }
+
+    MockResponse handle(const MockRequest &request)
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        MockResponse response;
+        response.chunked = true;
+
+        if (request.path.startsWith("/token"))
+        {
+            response.body = "{\"access_token\":\"mock-token\",\"expires_in\":3599,\"scope\":\"https://www.googleapis.com/auth/calendar.readonly\","
+                            "\"token_type\":\"Bearer\"}";
+            return response;
+        }
+
+        char etag[16];
+        snprintf(etag, sizeof(etag), "\"v%d\"", version);
+        response.headers.push_back({"ETag", etag});
+
+        int since = 0;
+        int tokenAt = request.path.indexOf("syncToken=");
+        if (tokenAt >= 0)
+            since = atoi(request.path.c_str() + tokenAt + 10);
+        else if (request.header("If-None-Match") == etag)
+        {
+            response.status = 304;
+            return response;
+        }
+
+        time_t until = 0;
+        std::string timeMax = queryParam(request.path, "timeMax");
+        if (!timeMax.empty())
+            parseRfc3339(timeMax.c_str(), until);
+        int offset = atoi(queryParam(request.path, "pageToken").c_str());
+        std::string maxResults = queryParam(request.path, "maxResults");
+        int pageSize = maxResults.empty() ? 250 : atoi(maxResults.c_str());
+
+        std::string items;
+        int matched = 0;
+        for (const Event &event : events)
+        {
+            // A full listing leaves deleted events out; a delta reports them
+            if (event.version <= since || (event.cancelled && since == 0) || (until && event.start >= until))
+                continue;
+            if (matched++ < offset || matched > offset + pageSize)
+                continue;
+            items += (items.empty() ? "" : ",") +
+                     calendarEventJson(event.index, event.start, event.start + 1500, event.cancelled ? "cancelled" : "confirmed");
+        }
+
+        // The sync token only comes with the last page
+        std::string syncToken = std::to_string(version);
+        std::string pageToken = std::to_string(offset + pageSize);
+        if (matched > offset + pageSize)
+            response.body = calendarListJson(items, NULL, pageToken.c_str());
+        else
+            response.body = calendarListJson(items, syncToken.c_str());
+        return response;
+    }
+};
+
+/**
+ * Polls a calendar with more events than CALENDAR_MAX_PAGES pages hold in
+ * sync token mode and prints the requests each poll takes
+ */
+static void busyCalendar(MockCalendar &calendar, MockServer &server, FILE *results, time_t now, int spacing,
+                         const char *label)
+{
+    calendar.reset(now, BENCH_BUSY_EVENTS, spacing);
+    GoogleCalendarClient::setSyncMode(CALENDAR_SYNC_TOKEN);
+
+    uint32_t before = server.requests();
+    GoogleCalendarClient::refresh();
+    uint32_t first = server.requests() - before;
+
+    before = server.requests();
+    for (int poll = 1; poll < BENCH_BUSY_POLLS; poll++)
+        GoogleCalendarClient::refresh();
+    double later = (double)(server.requests() - before) / (BENCH_BUSY_POLLS - 1);
+
+    CalendarEvent shown = GoogleCalendarClient::getUpcomingEvent();
+    fprintf(results, "%-24s first poll %2u requests, then %.1f per poll, showing \"%s\" (%s)\n", label, first,
+            later, shown.title.c_str(), later <= 1 && shown.startTime > 0 ? "ok" : "FAILED");
+}
+
+static const char *modeName(CalendarSyncMode mode)
+{
+    switch (mode)
+    {
+    case CALENDAR_SYNC_FULL:
+        return "full";
+    case CALENDAR_SYNC_ETAG:
+        return "etag";
+    default:
+        return "synctoken";
+    }
+}
+
+void runCalendarBenchmark()
+{
+    MockCalendar calendar;
+    MockServer server;
+    if (!server.start([&](const MockRequest &request)
+                      { return calendar.handle(request); },
+                      true))
+    {
+        printf("calendar benchmark: cannot start mock server\n");
+        return;
+    }
+
+    char redirect[32];
+    snprintf(redirect, sizeof(redirect), "127.0.0.1:%u", server.port());
+    setenv("CLOCK_REDIRECT_HTTPS", redirect, 1);
+
+    // Keep the mock events out of the app's persisted cache
+    char nvsDir[] = "/tmp/clock-bench-XXXXXX";
+    if (mkdtemp(nvsDir))
+        setenv("CLOCK_NVS_DIR", nvsDir, 1);
+
+    printf("calendar benchmark: %d polls (one hour), %d events, one reschedule and one cancellation\n",
+           BENCH_POLLS, BENCH_EVENTS);
+
+    // The client logs every poll; keep the results readable
+    fflush(stdout);
+    int savedStdout = dup(STDOUT_FILENO);
+    FILE *results = fdopen(dup(savedStdout), "w");
+    freopen("/dev/null", "w", stdout);
+
+    time_t now = time(NULL);
+    calendar.reset(now);
+    GoogleCalendarClient::refresh(); // Fetch the OAuth token outside the measurement
+
+    for (CalendarSyncMode mode : {CALENDAR_SYNC_FULL, CALENDAR_SYNC_ETAG, CALENDAR_SYNC_TOKEN})
+    {
+        calendar.reset(now);
+        GoogleCalendarClient::setSyncMode(mode);
+
+        uint64_t bytesBefore = server.bytesSent();
+        uint32_t requestsBefore = server.requests();
+        CalendarEvent shown;
+
+        for (int poll = 0; poll < BENCH_POLLS; poll++)
+        {
+            if (poll == BENCH_POLLS / 3)
+                calendar.reschedule(0, now + 300);
+            if (poll == 2 * BENCH_POLLS / 3)
+                calendar.cancel(0);
+            GoogleCalendarClient::refresh();
+            shown = GoogleCalendarClient::getUpcomingEvent();
+        }
+
+        fprintf(results, "%-10s %8llu bytes/hour  %3u requests  showing \"%s\"\n", modeName(mode),
+                (unsigned long long)(server.bytesSent() - bytesBefore), server.requests() - requestsBefore,
+                shown.title.c_str());
+    }
+
+    // Power loss: NVS survives but the clock does not, so the cache is
+    // loaded before TimeService is set and must not be checked against 0
+    calendar.reset(now);
+    GoogleCalendarClient::setSyncMode(CALENDAR_SYNC_FULL);
+    GoogleCalendarClient::refresh();
+    GoogleCalendarClient::setSyncMode(CALENDAR_SYNC_FULL); // Empties the in-memory cache
+    GoogleCalendarClient::loadCache(0);
+    CalendarEvent restored = GoogleCalendarClient::getUpcomingEvent();
+    fprintf(results, "power loss: cache loaded with the clock unset is showing \"%s\" (%s)\n",
+            restored.title.c_str(), restored.startTime > 0 ? "ok" : "FAILED");
+
+    // The initial sync is bounded by the horizon; a calendar that still has
+    // more pages than the cap falls back to ETag rather than resyncing each poll
+    fprintf(results, "\nsynctoken, %d events:\n", BENCH_BUSY_EVENTS);
+    busyCalendar(calendar, server, results, now, 1800, "over four days");
+    busyCalendar(calendar, server, results, now, 300, "within 24 h");
+
+    fclose(results);
+    fflush(stdout);
+    dup2(savedStdout, STDOUT_FILENO);
+    close(savedStdout);
+    GoogleCalendarClient::setSyncMode(CALENDAR_SYNC_MODE);
+}
@@ -0,0 +1,86 @@
+#include <Arduino.h>
+#include <lvgl.h>
+
+#include "bench.h"
+#include "framebuffer.h"
+#include "display_stats.h"
+#include "app/clock_widget.h"
+
+#define BENCH_MINUTES (24 * 60)
+
+struct BenchResult
+{
+    uint64_t micros;
+    uint64_t bytes;
+};
+
+static void formatMinute(int minute, char *buf, size_t size)
+{
+    struct tm timeinfo = {};
+    timeinfo.tm_hour = minute / 60;
+    timeinfo.tm_min = minute % 60;
+    strftime(buf, size, "%l:%M %p", &timeinfo);
+}
+
+template <typename SetText>
+static BenchResult runUpdates(SetText setText)
+{
+    BenchResult result = {0, 0};
+    char text[16];
+
+    for (int minute = 0; minute < BENCH_MINUTES; minute++)
+    {
+        formatMinute(minute, text, sizeof(text));
+
+        uint32_t bytesBefore = getDisplayStats().bytesFlushed;
+        uint64_t start = micros();
+        setText(text);
+        lv_refr_now(NULL);
+        result.micros += micros() - start;
+        result.bytes += getDisplayStats().bytesFlushed - bytesBefore;
+    }
+
+    return result;
+}
+
+static void printResult(const char *name, const BenchResult &result)
+{
+    printf("%-14s %8.0f ns/update %8.0f bytes/update\n", name,
+           result.micros * 1000.0 / BENCH_MINUTES, (double)result.bytes / BENCH_MINUTES);
+}
+
+void runClockBenchmark()
+{
+    setFramebufferSpiModel(false);
+
+    lv_obj_t *screen = lv_screen_active();
+    lv_obj_set_style_bg_color(screen, lv_color_hex(0x000000), LV_PART_MAIN);
+
+    lv_obj_t *label = lv_label_create(screen);
+    lv_obj_set_style_text_font(label, &lv_font_montserrat_48, LV_PART_MAIN);
+    lv_obj_set_style_text_color(label, lv_color_hex(0x60e083), LV_PART_MAIN);
+    lv_obj_align(label, LV_ALIGN_TOP_MID, 0, 20);
+
+    uint64_t buildStart = micros();
+    lv_obj_t *clock = clockWidgetCreate(screen, &lv_font_montserrat_48, lv_color_hex(0x60e083), lv_color_hex(0x000000));
+    uint64_t buildMicros = micros() - buildStart;
+    if (!clock)
+    {
+        printf("clock widget creation failed\n");
+        return;
+    }
+    lv_obj_align(clock, LV_ALIGN_BOTTOM_MID, 0, -20);
+    lv_refr_now(NULL);
+
+    BenchResult labelResult = runUpdates([&](const char *text)
+                                         { lv_label_set_text(label, text); });
+    lv_label_set_text(label, "");
+
+    BenchResult clockResult = runUpdates([&](const char *text)
+                                         { clockWidgetSetText(clock, text); });
+
+    printf("clock benchmark: %d minute updates, sprite cache built in %llu us\n",
+           BENCH_MINUTES, (unsigned long long)buildMicros);
+    printResult("lv_label", labelResult);
+    printResult("clock widget", clockResult);
+}
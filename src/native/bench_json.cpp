@@ -0,0 +1,138 @@
+#include <Arduino.h>
+#include <ArduinoJson.h>
+#include <string>
+
+#include "bench.h"
+#include "heap_trace.h"
+#include "mock_server.h"
+#include "fixtures.h"
+#include "http_pool.h"
+#include "http_body_stream.h"
+#include "app/spotify.h"
+#include "app/calendar.h"
+#include "app/weather.h"
+
+#define BENCH_FETCHES 20
+
+/**
+ * The old code path: the whole body in a String, parsed from memory
+ */
+class StringStream : public Stream
+{
+public:
+    explicit StringStream(const String &str) : _str(str) {}
+
+    int available() override { return _str.length() - _pos; }
+    int read() override { return _pos < _str.length() ? (uint8_t)_str[_pos++] : -1; }
+    int peek() override { return _pos < _str.length() ? (uint8_t)_str[_pos] : -1; }
+
+private:
+    const String &_str;
+    size_t _pos = 0;
+};
+
+struct FetchResult
+{
+    size_t peakBytes;
+    uint64_t micros;
+};
+
+/**
+ * Fetches a fixture and parses it either from a String copy of the body or
+ * straight from the connection, measuring the heap peak above what was in
+ * use before the request
+ */
+template <typename Parse>
+static FetchResult fetch(const String &url, bool streaming, Parse parse)
+{
+    size_t baseline = heapTraceInUse();
+    heapTraceResetPeak();
+    uint64_t start = micros();
+
+    HTTPClient *http = HttpPool::begin(url);
+    if (http && HttpPool::GET(http) == HTTP_CODE_OK)
+    {
+        if (streaming)
+        {
+            HttpBodyStream body(*http);
+            parse(body);
+        }
+        else
+        {
+            String payload = http->getString();
+            StringStream body(payload);
+            parse(body);
+        }
+    }
+    if (http)
+        HttpPool::end(http);
+
+    return {heapTracePeak() - baseline, micros() - start};
+}
+
+template <typename Parse>
+static void runFixture(const char *name, MockServer &server, const char *path, size_t bodySize, Parse parse)
+{
+    FetchResult worst[2] = {};
+    uint64_t totalMicros[2] = {};
+
+    for (int i = 0; i < BENCH_FETCHES; i++)
+    {
+        for (int streaming = 0; streaming < 2; streaming++)
+        {
+            FetchResult result = fetch(server.url(path), streaming, parse);
+            if (result.peakBytes > worst[streaming].peakBytes)
+                worst[streaming].peakBytes = result.peakBytes;
+            totalMicros[streaming] += result.micros;
+        }
+    }
+
+    printf("%-9s %7zu B body  string: %7zu B peak %6.0f us   stream: %7zu B peak %6.0f us\n", name, bodySize,
+           worst[0].peakBytes, (double)totalMicros[0] / BENCH_FETCHES,
+           worst[1].peakBytes, (double)totalMicros[1] / BENCH_FETCHES);
+}
+
+void runJsonBenchmark()
+{
+    std::string spotify = spotifyFixture();
+    std::string calendar;
+    time_t now = time(NULL);
+    for (int i = 0; i < 5; i++)
+        calendar += (i ? "," : "") + calendarEventJson(i, now + i * 1800, now + i * 1800 + 1500);
+    calendar = calendarListJson(calendar);
+    std::string weather = weatherFixture();
+
+    MockServer server;
+    bool started = server.start([&](const MockRequest &request)
+                                {
+        MockResponse response;
+        response.chunked = true; // As Google and Spotify send them
+        if (request.path == "/spotify")
+            response.body = spotify;
+        else if (request.path == "/calendar")
+            response.body = calendar;
+        else if (request.path == "/weather")
+            response.body = weather;
+        else
+            response.status = 404;
+        return response; });
+    if (!started)
+    {
+        printf("json benchmark: cannot start mock server\n");
+        return;
+    }
+
+    printf("json benchmark: worst heap peak per fetch over %d fetches, chunked responses\n", BENCH_FETCHES);
+
+    runFixture("spotify", server, "/spotify", spotify.size(), [](Stream &body)
+               {
+        NowPlaying nowPlaying;
+        SpotifyClient::parseSpotifyResponse(body, nowPlaying); });
+    runFixture("calendar", server, "/calendar", calendar.size(), [](Stream &body)
+               { GoogleCalendarClient::parseCalendarEvents(body, false); });
+    runFixture("weather", server, "/weather", weather.size(), [](Stream &body)
+               {
+        float temperature;
+        int weatherCode;
+        parseWeatherResponse(body, temperature, weatherCode); });
+}
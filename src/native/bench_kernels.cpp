@@ -0,0 +1,222 @@
+#include <Arduino.h>
+#include <lvgl.h>
+#include <random>
+#include <vector>
+
+#include "bench.h"
+#include "config.h"
+#include "rgb565_kernels.h"
+#include "ui_queue.h"
+#include "app/app.h"
+
+#define BENCH_WIDTH SCREEN_HOR_RES
+#define BENCH_HEIGHT (DRAW_BUF_SIZE / sizeof(uint16_t) / SCREEN_HOR_RES) // One draw buffer
+#define BENCH_MIN_US 200000
+#define BENCH_REFRESHES 200
+
+typedef void (*KernelRun)(uint16_t *pixels, const uint8_t *mask, int32_t width, int32_t height);
+
+struct Kernel
+{
+    const char *name;
+    const char *version;
+    KernelRun run;
+};
+
+static const uint16_t fillColor = 0x7C91;
+
+/**
+ * Baselines, a pixel at a time: the fill and the mix LVGL's generic blend
+ * does, and the swap TFT_eSPI does before a DMA push
+ */
+static void fillGeneric(uint16_t *pixels, const uint8_t *, int32_t width, int32_t height)
+{
+    for (int32_t y = 0; y < height; y++, pixels += width)
+        for (int32_t x = 0; x < width; x++)
+            pixels[x] = fillColor;
+}
+
+static void blendGeneric(uint16_t *pixels, const uint8_t *mask, int32_t width, int32_t height)
+{
+    for (int32_t y = 0; y < height; y++, pixels += width, mask += width)
+        for (int32_t x = 0; x < width; x++)
+            pixels[x] = lv_color_16_16_mix(fillColor, pixels[x], mask[x]);
+}
+
+static void swapGeneric(uint16_t *pixels, const uint8_t *, int32_t width, int32_t height)
+{
+    for (int32_t i = 0; i < width * height; i++)
+        pixels[i] = pixels[i] << 8 | pixels[i] >> 8;
+}
+
+static void fillPortable(uint16_t *pixels, const uint8_t *, int32_t width, int32_t height)
+{
+    rgb565FillPortable(pixels, width, height, width * sizeof(uint16_t), fillColor);
+}
+
+static void blendPortable(uint16_t *pixels, const uint8_t *mask, int32_t width, int32_t height)
+{
+    rgb565BlendA8Portable(pixels, width, height, width * sizeof(uint16_t), mask, width, fillColor, 255);
+}
+
+static void swapPortable(uint16_t *pixels, const uint8_t *, int32_t width, int32_t height)
+{
+    rgb565SwapPortable(pixels, width * height);
+}
+
+static void fillTuned(uint16_t *pixels, const uint8_t *, int32_t width, int32_t height)
+{
+    rgb565Fill(pixels, width, height, width * sizeof(uint16_t), fillColor);
+}
+
+static void blendTuned(uint16_t *pixels, const uint8_t *mask, int32_t width, int32_t height)
+{
+    rgb565BlendA8(pixels, width, height, width * sizeof(uint16_t), mask, width, fillColor, 255);
+}
+
+static void swapTuned(uint16_t *pixels, const uint8_t *, int32_t width, int32_t height)
+{
+    rgb565Swap(pixels, width * height);
+}
+
+/**
+ * Coverage shaped like rendered text: runs of blank and solid pixels with
+ * an anti-aliased pixel or two between them
+ */
+static std::vector<uint8_t> glyphMask()
+{
+    std::mt19937 rng(3);
+    std::uniform_int_distribution<int> blank(2, 12);
+    std::uniform_int_distribution<int> solid(1, 6);
+    std::uniform_int_distribution<int> edge(1, 2);
+    std::uniform_int_distribution<int> coverage(1, 254);
+    std::vector<uint8_t> mask;
+    while (mask.size() < BENCH_WIDTH * BENCH_HEIGHT)
+    {
+        mask.insert(mask.end(), blank(rng), 0);
+        for (int i = edge(rng); i > 0; i--)
+            mask.push_back(coverage(rng));
+        mask.insert(mask.end(), solid(rng), 255);
+        for (int i = edge(rng); i > 0; i--)
+            mask.push_back(coverage(rng));
+    }
+    mask.resize(BENCH_WIDTH * BENCH_HEIGHT);
+    return mask;
+}
+
+static std::vector<uint16_t> background()
+{
+    std::mt19937 rng(5);
+    std::vector<uint16_t> pixels(BENCH_WIDTH * BENCH_HEIGHT);
+    for (uint16_t &p : pixels)
+        p = rng();
+    return pixels;
+}
+
+/**
+ * @return Mpixel/s
+ */
+static double measure(const Kernel &kernel, const std::vector<uint8_t> &mask, int32_t width, int32_t height)
+{
+    std::vector<uint16_t> pixels = background();
+    uint32_t runs = 0;
+    uint64_t start = micros();
+    uint64_t elapsed;
+    do
+    {
+        kernel.run(pixels.data(), mask.data(), width, height);
+        runs++;
+        elapsed = micros() - start;
+    } while (elapsed < BENCH_MIN_US);
+    return (double)runs * width * height / elapsed;
+}
+
+static bool matchesGeneric(const Kernel &kernel, const Kernel &generic, const std::vector<uint8_t> &mask,
+                           int32_t width, int32_t height)
+{
+    std::vector<uint16_t> expected = background();
+    std::vector<uint16_t> actual = expected;
+    generic.run(expected.data(), mask.data(), width, height);
+    kernel.run(actual.data(), mask.data(), width, height);
+    return actual == expected;
+}
+
+static uint64_t flushHash;
+
+/**
+ * Hashes what would go to the panel, to check the hooks change nothing
+ */
+static void benchFlush(lv_display_t *disp, const lv_area_t *area, uint8_t *px_map)
+{
+    uint32_t bytes = lv_area_get_size(area) * sizeof(uint16_t);
+    for (uint32_t i = 0; i < bytes; i++)
+        flushHash = (flushHash ^ px_map[i]) * 0x100000001B3ULL;
+    lv_display_flush_ready(disp);
+}
+
+/**
+ * Full-screen refreshes of the clock screen
+ * @return Microseconds per refresh
+ */
+static double refresh(lv_display_t *disp, bool hooks)
+{
+    rgb565SetLvglHooks(hooks);
+    flushHash = 0xCBF29CE484222325ULL;
+    uint64_t start = micros();
+    for (int i = 0; i < BENCH_REFRESHES; i++)
+    {
+        lv_obj_invalidate(lv_screen_active());
+        lv_refr_now(disp);
+    }
+    return (double)(micros() - start) / BENCH_REFRESHES;
+}
+
+void runKernelsBenchmark()
+{
+    static const Kernel kernels[][3] = {
+        {{"fill", "generic", fillGeneric}, {"fill", "portable", fillPortable}, {"fill", NULL, fillTuned}},
+        {{"A8 blend", "generic", blendGeneric}, {"A8 blend", "portable", blendPortable}, {"A8 blend", NULL, blendTuned}},
+        {{"byte swap", "generic", swapGeneric}, {"byte swap", "portable", swapPortable}, {"byte swap", NULL, swapTuned}},
+    };
+
+    // Sizes known only at run time, as they are inside LVGL
+    lv_display_t *disp = lv_display_get_default();
+    int32_t width = lv_display_get_horizontal_resolution(disp);
+    int32_t height = BENCH_WIDTH * BENCH_HEIGHT / width;
+
+    std::vector<uint8_t> mask = glyphMask();
+    printf("%dx%d RGB565 area per call (one draw buffer), %s kernels compiled in\n\n", (int)width, (int)height,
+           rgb565KernelVariant());
+    printf("%-10s %-9s %10s %9s %10s\n", "kernel", "version", "Mpixel/s", "speedup", "bit-exact");
+    for (const auto &set : kernels)
+    {
+        double generic = 0;
+        for (const Kernel &kernel : set)
+        {
+            double rate = measure(kernel, mask, width, height);
+            if (!generic)
+                generic = rate;
+            printf("%-10s %-9s %10.1f %8.2fx %10s\n", kernel.name,
+                   kernel.version ? kernel.version : rgb565KernelVariant(), rate, rate / generic,
+                   matchesGeneric(kernel, set[0], mask, width, height) ? "yes" : "NO");
+        }
+    }
+
+    // The same kernels inside LVGL, rendering the real screen
+    lv_display_set_flush_cb(disp, benchFlush);
+    setupUI();
+    uiApplyText(UI_LABEL_TIME, "12:34 PM");
+    uiApplyText(UI_LABEL_DATE, "Sat, Oct 17 2026");
+    uiApplyText(UI_LABEL_TEMPERATURE, "61°F (Partly cloudy)");
+    uiApplyText(UI_LABEL_SONG, "Artist Name - A Fairly Long Song Title (Remastered)");
+    uiApplyText(UI_LABEL_CALENDAR, "Team sync at 2:00 PM");
+    lv_refr_now(disp);
+
+    double genericUs = refresh(disp, false);
+    uint64_t genericHash = flushHash;
+    double hookedUs = refresh(disp, true);
+    printf("\nclock screen, full refresh: %.0f us with LVGL's blends, %.0f us with the kernels (%.0f%% less), "
+           "output %s\n",
+           genericUs, hookedUs, (genericUs - hookedUs) * 100.0 / genericUs,
+           flushHash == genericHash ? "identical" : "DIFFERS");
+}
@@ -0,0 +1,86 @@
+#include <Arduino.h>
+#include <lvgl.h>
+
+#include "bench.h"
+#include "config.h"
+#include "app/marquee.h"
+
+#define BENCH_SECONDS 10
+#define BENCH_SONG "Artist Name - A Fairly Long Song Title (Remastered 2011 Deluxe Edition)"
+
+static uint64_t flushedBytes;
+static uint32_t flushes;
+
+/**
+ * Counts what would go out over SPI; the panel itself is not modelled
+ */
+static void benchFlush(lv_display_t *disp, const lv_area_t *area, uint8_t *px_map)
+{
+    flushedBytes += lv_area_get_size(area) * sizeof(uint16_t);
+    flushes++;
+    lv_display_flush_ready(disp);
+}
+
+/**
+ * The GUI task's loop, for a while, on a screen holding just the song line
+ * @param label What to print in the table
+ * @param screen Screen to load
+ */
+static void run(const char *label, lv_obj_t *screen)
+{
+    lv_display_t *disp = lv_display_get_default();
+    lv_screen_load(screen);
+    lv_refr_now(disp);
+
+    flushedBytes = 0;
+    flushes = 0;
+    uint64_t busy = 0;
+    uint64_t start = micros();
+    while (micros() - start < BENCH_SECONDS * 1000000ULL)
+    {
+        uint64_t busyStart = micros();
+        uint32_t sleepMs = lv_timer_handler();
+        busy += micros() - busyStart;
+        delay(LV_CLAMP(1, sleepMs, 100));
+    }
+    double seconds = (micros() - start) / 1000000.0;
+
+    printf("%-24s %8.2f%% %10.0f %12.0f %10.0f\n", label, busy * 100.0 / (seconds * 1000000.0), flushes / seconds,
+           flushedBytes / seconds, (double)busy / flushes);
+}
+
+void runMarqueeBenchmark()
+{
+    lv_display_t *disp = lv_display_get_default();
+    lv_display_set_flush_cb(disp, benchFlush);
+
+    // As the song label was built before the marquee
+    lv_obj_t *labelScreen = lv_obj_create(NULL);
+    lv_obj_set_style_bg_color(labelScreen, lv_color_hex(0x000000), LV_PART_MAIN);
+    lv_obj_t *songLabel = lv_label_create(labelScreen);
+    lv_obj_set_style_text_font(songLabel, &lv_font_montserrat_16, LV_PART_MAIN);
+    lv_obj_set_style_text_color(songLabel, lv_color_hex(0x7c9181), LV_PART_MAIN);
+    lv_obj_set_width(songLabel, LV_PCT(100));
+    lv_label_set_long_mode(songLabel, LV_LABEL_LONG_SCROLL_CIRCULAR);
+    lv_obj_set_style_text_align(songLabel, LV_TEXT_ALIGN_CENTER, LV_PART_MAIN);
+    lv_obj_align(songLabel, LV_ALIGN_BOTTOM_MID, 0, -10);
+    lv_label_set_text(songLabel, BENCH_SONG);
+
+    lv_obj_t *marqueeScreen = lv_obj_create(NULL);
+    lv_obj_set_style_bg_color(marqueeScreen, lv_color_hex(0x000000), LV_PART_MAIN);
+    lv_obj_t *marquee = marqueeCreate(marqueeScreen, SCREEN_HOR_RES, &lv_font_montserrat_16,
+                                      lv_color_hex(0x7c9181), lv_color_hex(0x000000));
+    lv_obj_align(marquee, LV_ALIGN_BOTTOM_MID, 0, -10);
+
+    uint64_t renderStart = micros();
+    marqueeSetText(marquee, BENCH_SONG);
+    uint64_t renderUs = micros() - renderStart;
+
+    printf("\"%s\" scrolling for %d s each (host CPU; no SPI time modelled)\n\n", BENCH_SONG, BENCH_SECONDS);
+    printf("%-24s %9s %10s %12s %10s\n", "song line", "GUI busy", "flushes/s", "flush B/s", "us/flush");
+    run("label, scroll circular", labelScreen);
+    run("marquee strip", marqueeScreen);
+
+    printf("marquee: text rasterized once per song, %llu us, strip %d rows high\n", (unsigned long long)renderUs,
+           (int)lv_obj_get_height(marquee));
+}
@@ -0,0 +1,108 @@
+#include <Arduino.h>
+#include <atomic>
+#include <unistd.h>
+
+#include "bench.h"
+#include "config.h"
+#include "metrics.h"
+
+#define BENCH_UPDATES 1000000
+#define BENCH_SAMPLES 100
+#define BENCH_BAUD 115200
+
+static std::atomic<int> running;
+static Metric *benchCounter;
+static Metric *benchHistogram;
+
+static const uint32_t benchBuckets[METRIC_BUCKETS - 1] = {50, 100, 250, 500, 1000, 2500, 5000};
+
+static void counterTask(void *)
+{
+    for (int i = 0; i < BENCH_UPDATES; i++)
+        benchCounter->add();
+    running--;
+    vTaskDelete(NULL);
+}
+
+static void histogramTask(void *)
+{
+    for (int i = 0; i < BENCH_UPDATES; i++)
+        benchHistogram->observe(i & 8191);
+    running--;
+    vTaskDelete(NULL);
+}
+
+/**
+ * @return Nanoseconds per update with this many tasks updating the same metric
+ */
+static double updateCost(TaskFunction_t task, int taskCount)
+{
+    running = taskCount;
+    uint64_t start = micros();
+    for (int i = 0; i < taskCount; i++)
+        xTaskCreatePinnedToCore(task, "bench", 4096, NULL, 1, NULL, i % 2);
+    while (running > 0)
+        delay(1);
+    return (micros() - start) * 1000.0 / BENCH_UPDATES;
+}
+
+static void idleTask(void *)
+{
+    while (1)
+        delay(1000);
+}
+
+/**
+ * @return Bytes report() printed
+ */
+static long reportBytes()
+{
+    // Frames go to stdout as they would to the serial log; count them instead
+    fflush(stdout);
+    int savedStdout = dup(STDOUT_FILENO);
+    char path[] = "/tmp/clock-metrics-XXXXXX";
+    close(mkstemp(path));
+    freopen(path, "w", stdout);
+    Metrics::report();
+    fflush(stdout);
+    long bytes = ftell(stdout);
+    dup2(savedStdout, STDOUT_FILENO);
+    close(savedStdout);
+    unlink(path);
+    return bytes;
+}
+
+void runMetricsBenchmark()
+{
+    benchCounter = Metrics::counter("bench.count");
+    benchHistogram = Metrics::histogram("bench.ms", benchBuckets);
+    for (int tasks : {1, 2, 4})
+    {
+        printf("update, %d task%s: %5.1f ns per counter add, %5.1f ns per histogram observe\n", tasks,
+               tasks > 1 ? "s" : " ", updateCost(counterTask, tasks), updateCost(histogramTask, tasks));
+    }
+
+    // The board's own tasks, for the per-task stack and CPU metrics
+    xTaskCreatePinnedToCore(idleTask, "guiTask", LVGL_STACK_SIZE, NULL, 5, NULL, LVGL_CORE);
+    xTaskCreatePinnedToCore(idleTask, "appTask", APP_STACK_SIZE, NULL, 5, NULL, APP_CORE);
+    xTaskCreatePinnedToCore(idleTask, "network", NETWORK_STACK_SIZE, NULL, 3, NULL, APP_CORE);
+    xTaskCreatePinnedToCore(idleTask, "wifi", WIFI_STACK_SIZE, NULL, 4, NULL, APP_CORE);
+    Metrics::sample();
+
+    uint64_t start = micros();
+    for (int i = 0; i < BENCH_SAMPLES; i++)
+        Metrics::sample();
+    double sampleUs = (double)(micros() - start) / BENCH_SAMPLES;
+    printf("\nsample: %.0f us for %u metrics, %u tasks (host stacks are painted 256 KB deep; the board's "
+           "are %u-%u bytes)\n",
+           sampleUs, (unsigned)Metrics::count(), (unsigned)uxTaskGetNumberOfTasks(), WIFI_STACK_SIZE,
+           NETWORK_STACK_SIZE);
+
+    long firstBytes = reportBytes(); // Schema and values
+    long valueBytes = reportBytes();
+    double intervalS = METRICS_INTERVAL_MS / 1000.0;
+    printf("report: %ld bytes with the schema, %ld bytes of values alone\n", firstBytes, valueBytes);
+    printf("serial at %d baud: %.1f ms per report, %.2f%% of the link and %.0f KB/h at one report per %.0f s\n",
+           BENCH_BAUD, valueBytes * 10 * 1000.0 / BENCH_BAUD, valueBytes * 10 * 100.0 / BENCH_BAUD / intervalS,
+           valueBytes * 3600.0 / intervalS / 1024, intervalS);
+}
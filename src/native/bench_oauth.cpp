@@ -0,0 +1,147 @@
+#include <Arduino.h>
+#include <atomic>
+#include <stdlib.h>
+#include <unistd.h>
+
+#include "bench.h"
+#include "mock_server.h"
+#include "oauth_token.h"
+
+#define BENCH_TOKEN_URL "https://oauth.example.com/token"
+#define BENCH_GETS 200
+#define BENCH_FAILED_REFRESHES 8
+
+/**
+ * Token endpoint that hands out numbered tokens and can be told to fail
+ */
+struct MockTokenEndpoint
+{
+    std::atomic<int> expiresIn{3600};
+    std::atomic<bool> failing{false};
+    std::atomic<int> issued{0};
+
+    MockResponse handle(const MockRequest &request)
+    {
+        MockResponse response;
+        if (failing || !request.body.startsWith("grant_type=refresh_token"))
+        {
+            response.status = 503;
+            return response;
+        }
+
+        // Google sends an id_token too, larger than the access token itself
+        response.headers.push_back({"Content-Type", "application/json"});
+        response.body = "{\"access_token\":\"bench-token-" + String(++issued) + "\",\"token_type\":\"Bearer\","
+                        "\"expires_in\":" + String((int)expiresIn) + ",\"scope\":\"calendar.readonly\",\"id_token\":\"";
+        for (int i = 0; i < 40; i++)
+            response.body += "eyJhbGciOiJSUzI1NiIsImtpZCI6";
+        response.body += "\"}";
+        return response;
+    }
+};
+
+static OAuthToken benchToken(const char *name)
+{
+    return OAuthToken(name, BENCH_TOKEN_URL, "client", "secret", "refresh", OAUTH_CLIENT_AUTH_BODY);
+}
+
+void runOAuthBenchmark()
+{
+    MockTokenEndpoint endpoint;
+    MockServer server;
+    if (!server.start([&](const MockRequest &request)
+                      { return endpoint.handle(request); },
+                      true))
+    {
+        printf("oauth benchmark: cannot start mock server\n");
+        return;
+    }
+
+    char redirect[32];
+    snprintf(redirect, sizeof(redirect), "127.0.0.1:%u", server.port());
+    setenv("CLOCK_REDIRECT_HTTPS", redirect, 1);
+
+    // Start without a token from an earlier run
+    char nvsDir[] = "/tmp/clock-bench-XXXXXX";
+    if (mkdtemp(nvsDir))
+        setenv("CLOCK_NVS_DIR", nvsDir, 1);
+
+    // The token logs every refresh; keep the results readable
+    fflush(stdout);
+    int savedStdout = dup(STDOUT_FILENO);
+    FILE *results = fdopen(dup(savedStdout), "w");
+    freopen("/dev/null", "w", stdout);
+
+    // Cold start: the first get() has to go to the endpoint
+    OAuthToken token = benchToken("bench");
+    uint32_t before = server.requests();
+    uint64_t start = micros();
+    String value = token.get();
+    fprintf(results, "cold get():       %-16s %u request, %.1f ms, expires in %u s\n", value.c_str(),
+            server.requests() - before, (micros() - start) / 1000.0, token.secondsLeft());
+
+    // Kept fresh by maintain(), get() never blocks on the network
+    before = server.requests();
+    start = micros();
+    for (int i = 0; i < BENCH_GETS; i++)
+        token.get();
+    fprintf(results, "maintained get(): %u requests over %d calls, %.2f us each\n", server.requests() - before,
+            BENCH_GETS, (double)(micros() - start) / BENCH_GETS);
+
+    // What every fetch used to pay whenever the lazy refresh came due
+    start = micros();
+    for (int i = 0; i < BENCH_GETS / 10; i++)
+    {
+        token.invalidate();
+        token.get();
+    }
+    fprintf(results, "expired get():    %.1f ms each (synchronous refresh, loopback TLS)\n",
+            (double)(micros() - start) / 1000.0 / (BENCH_GETS / 10));
+
+    // Reboot: a new instance picks the token up from NVS
+    OAuthToken rebooted = benchToken("bench");
+    before = server.requests();
+    value = rebooted.get();
+    fprintf(results, "after reboot:     %-16s %u requests, %u NVS loads\n", value.c_str(),
+            server.requests() - before, rebooted.getStats().nvsLoads);
+
+    // Refresh schedule for a few token lifetimes
+    fprintf(results, "\n%-10s %14s %16s\n", "expires_in", "maintain() in", "refreshed early");
+    for (int lifetime : {3600, 600, 120})
+    {
+        endpoint.expiresIn = lifetime;
+        OAuthToken scheduled = benchToken("sched");
+        scheduled.invalidate();
+        uint32_t first = scheduled.maintain(); // Refreshes: there is no token yet
+        uint32_t next = scheduled.maintain();  // Nothing due, just reports the delay
+        fprintf(results, "%8d s %12.0f s %14.0f s\n", lifetime, next / 1000.0,
+                lifetime - first / 1000.0);
+    }
+    endpoint.expiresIn = 3600;
+
+    // Outage: two clients failing together drift apart with jitter
+    endpoint.failing = true;
+    OAuthToken a = benchToken("fail_a");
+    OAuthToken b = benchToken("fail_b");
+    fprintf(results, "\nretry delays during an outage (s):\n");
+    for (const char *label : {"a", "b"})
+    {
+        OAuthToken &failing = *label == 'a' ? a : b;
+        fprintf(results, "  %s:", label);
+        for (int i = 0; i < BENCH_FAILED_REFRESHES; i++)
+            fprintf(results, " %6.1f", failing.maintain() / 1000.0);
+        fprintf(results, "\n");
+    }
+
+    endpoint.failing = false;
+    uint32_t recovered = a.maintain();
+    OAuthTokenStats stats = a.getStats();
+    fprintf(results, "recovered: next run in %.0f s, %u refreshes, %u failures\n", recovered / 1000.0,
+            stats.refreshes, stats.failures);
+
+    fclose(results);
+    fflush(stdout);
+    dup2(savedStdout, STDOUT_FILENO);
+    close(savedStdout);
+    unsetenv("CLOCK_REDIRECT_HTTPS");
+}
@@ -0,0 +1,285 @@
+#include <Arduino.h>
+#include <random>
+
+#include "bench.h"
+#include "rfc3339.h"
+
+#define BENCH_PARSES 1000000
+#define BENCH_ROUND_TRIPS 200000
+#define BENCH_MUTATIONS 1000000
+#define BENCH_VALID_SEEDS 16 // Leading valid entries of the corpus
+
+/**
+ * The parser this replaced: fixed positions, offset ignored, and mktime()
+ * reading the fields as local time in whatever TZ the process has
+ */
+static time_t legacyParse(const char *dateTime)
+{
+    struct tm tm = {};
+    char temp[5] = {0};
+
+    strncpy(temp, dateTime, 4);
+    tm.tm_year = atoi(temp) - 1900;
+    strncpy(temp, dateTime + 5, 2);
+    temp[2] = '\0';
+    tm.tm_mon = atoi(temp) - 1;
+    strncpy(temp, dateTime + 8, 2);
+    temp[2] = '\0';
+    tm.tm_mday = atoi(temp);
+    strncpy(temp, dateTime + 11, 2);
+    temp[2] = '\0';
+    tm.tm_hour = atoi(temp);
+    strncpy(temp, dateTime + 14, 2);
+    temp[2] = '\0';
+    tm.tm_min = atoi(temp);
+    strncpy(temp, dateTime + 17, 2);
+    temp[2] = '\0';
+    tm.tm_sec = atoi(temp);
+
+    return mktime(&tm);
+}
+
+/**
+ * Writes t as local time at the given offset, the way Google does
+ * @return false if the year does not fit in four digits
+ */
+static bool formatWithOffset(time_t t, long offset, const char *fraction, char *buf, size_t size)
+{
+    time_t local = t + offset;
+    struct tm tm;
+    gmtime_r(&local, &tm);
+    if (tm.tm_year + 1900 < 0 || tm.tm_year + 1900 > 9999)
+        return false;
+
+    // strftime's %Y does not zero-pad years before 1000
+    size_t length = snprintf(buf, size, "%04d-%02d-%02dT%02d:%02d:%02d%s", tm.tm_year + 1900, tm.tm_mon + 1,
+                             tm.tm_mday, tm.tm_hour, tm.tm_min, tm.tm_sec, fraction);
+    if (offset == 0)
+        snprintf(buf + length, size - length, "Z");
+    else
+        snprintf(buf + length, size - length, "%c%02ld:%02ld", offset < 0 ? '-' : '+', labs(offset) / 3600,
+                 labs(offset) % 3600 / 60);
+    return true;
+}
+
+struct CorpusEntry
+{
+    const char *text;
+    bool valid;
+    time_t expected;
+};
+
+// Hand-picked edge cases; expected values are seconds since the epoch. The
+// valid ones come first and seed the mutation fuzzer.
+static const CorpusEntry corpus[] = {
+    {"1970-01-01T00:00:00Z", true, 0},
+    {"2024-03-10T07:00:00Z", true, 1710054000},
+    {"2024-03-10T02:00:00-05:00", true, 1710054000},      // Spring forward, last EST second +1
+    {"2024-03-10T03:00:00-04:00", true, 1710054000},      // Same instant in EDT
+    {"2024-11-03T01:30:00-04:00", true, 1730611800},      // Fall back, first 1:30
+    {"2024-11-03T01:30:00-05:00", true, 1730615400},      // Second 1:30, an hour later
+    {"2024-03-31T01:00:00+00:00", true, 1711846800},      // Europe/London spring forward
+    {"2024-03-31T02:00:00+01:00", true, 1711846800},
+    {"2024-10-27T01:30:00+01:00", true, 1729989000},      // London fall back, first 1:30
+    {"2024-10-27T01:30:00+00:00", true, 1729992600},
+    {"2024-02-29T12:00:00.123456789+05:30", true, 1709188200},
+    {"2000-02-29t23:59:59z", true, 951868799},
+    {"2023-12-31 23:59:60Z", true, 1704067200},           // Leap second rolls over
+    {"2024-06-01T00:00:00+14:00", true, 1717149600},
+    {"2024-06-01T00:00:00-12:00", true, 1717243200},
+    {"2038-01-19T03:14:07Z", true, 2147483647},
+    {"2023-02-29T00:00:00Z", false, 0},                   // Not a leap year
+    {"1900-02-29T00:00:00Z", false, 0},
+    {"2024-13-01T00:00:00Z", false, 0},
+    {"2024-00-10T00:00:00Z", false, 0},
+    {"2024-04-31T00:00:00Z", false, 0},
+    {"2024-01-01T24:00:00Z", false, 0},
+    {"2024-01-01T00:60:00Z", false, 0},
+    {"2024-01-01T00:00:61Z", false, 0},
+    {"2024-01-01T00:00:00", false, 0},                    // Offset is mandatory
+    {"2024-01-01T00:00:00.Z", false, 0},
+    {"2024-01-01T00:00:00+0500", false, 0},
+    {"2024-01-01T00:00:00+05", false, 0},
+    {"2024-01-01T00:00:00+24:00", false, 0},
+    {"2024-01-01T00:00:00Zjunk", false, 0},
+    {"2024-01-01", false, 0},                             // All-day events use "date"
+    {"2024-1-01T00:00:00Z", false, 0},
+    {"24-01-01T00:00:00Z", false, 0},
+    {"2024-01-01X00:00:00Z", false, 0},
+    {"", false, 0},
+};
+
+static void runCorpus()
+{
+    int failures = 0;
+    for (const CorpusEntry &entry : corpus)
+    {
+        time_t parsed = 0;
+        bool ok = parseRfc3339(entry.text, parsed);
+        if (ok != entry.valid || (ok && parsed != entry.expected))
+        {
+            printf("  FAIL %-40s got %s %lld\n", entry.text, ok ? "valid" : "invalid", (long long)parsed);
+            failures++;
+        }
+    }
+
+    printf("corpus:      %zu cases, %d failures\n", sizeof(corpus) / sizeof(corpus[0]), failures);
+}
+
+/**
+ * Formats instants around the DST changes of a few zones with the offset
+ * the zone had at that instant, then parses them back
+ */
+static void runDstSweep()
+{
+    static const char *zones[] = {"America/New_York", "Europe/London", "Australia/Lord_Howe", "Asia/Kolkata"};
+    int cases = 0;
+    int failures = 0;
+    int legacyWrong = 0;
+
+    for (const char *zone : zones)
+    {
+        setenv("TZ", zone, 1);
+        tzset();
+
+        // Every 15 minutes through 2024, which crosses each zone's transitions
+        for (time_t t = 1704067200; t < 1735689600; t += 900)
+        {
+            struct tm local;
+            localtime_r(&t, &local);
+
+            char text[40];
+            formatWithOffset(t, local.tm_gmtoff, "", text, sizeof(text));
+
+            time_t parsed;
+            if (!parseRfc3339(text, parsed) || parsed != t)
+                failures++;
+            if (legacyParse(text) != t)
+                legacyWrong++;
+            cases++;
+        }
+    }
+
+    unsetenv("TZ");
+    tzset();
+    printf("dst sweep:   %d instants in 4 zones, %d failures (old parser wrong on %d)\n", cases, failures, legacyWrong);
+}
+
+static void runRoundTrips(std::mt19937 &rng)
+{
+    std::uniform_int_distribution<int64_t> instant(0, 0x7fffffff);
+    std::uniform_int_distribution<int> quarterHours(-48, 56);
+    static const char *fractions[] = {"", ".5", ".250", ".123456", ".999999999"};
+    int failures = 0;
+
+    for (int i = 0; i < BENCH_ROUND_TRIPS; i++)
+    {
+        time_t t = instant(rng);
+        long offset = quarterHours(rng) * 900L;
+
+        char text[48];
+        formatWithOffset(t, offset, fractions[i % 5], text, sizeof(text));
+
+        time_t parsed;
+        if (!parseRfc3339(text, parsed) || parsed != t)
+        {
+            if (failures++ < 5)
+                printf("  FAIL %s\n", text);
+        }
+    }
+
+    printf("round trips: %d random instants and offsets, %d failures\n", BENCH_ROUND_TRIPS, failures);
+}
+
+/**
+ * Random edits of valid timestamps must never crash, and anything still
+ * accepted must mean the same instant when written back out in UTC
+ */
+static void runMutations(std::mt19937 &rng)
+{
+    static const char alphabet[] = "0123456789-+:.TtZz \x7f\xff";
+    int accepted = 0;
+    int failures = 0;
+
+    for (int i = 0; i < BENCH_MUTATIONS; i++)
+    {
+        char text[64];
+        snprintf(text, sizeof(text), "%s", corpus[rng() % BENCH_VALID_SEEDS].text);
+
+        for (int edits = 1 + rng() % 3; edits > 0; edits--)
+        {
+            size_t length = strlen(text);
+            size_t at = length ? rng() % length : 0;
+            switch (rng() % 3)
+            {
+            case 0: // Replace
+                text[at] = alphabet[rng() % (sizeof(alphabet) - 1)];
+                break;
+            case 1: // Delete
+                memmove(text + at, text + at + 1, length - at);
+                break;
+            default: // Insert
+                if (length + 2 < sizeof(text))
+                {
+                    memmove(text + at + 1, text + at, length - at + 1);
+                    text[at] = alphabet[rng() % (sizeof(alphabet) - 1)];
+                }
+                break;
+            }
+        }
+
+        time_t parsed;
+        if (!parseRfc3339(text, parsed))
+            continue;
+        accepted++;
+
+        char utc[48];
+        if (!formatWithOffset(parsed, 0, "", utc, sizeof(utc)))
+            continue;
+        time_t reparsed;
+        if (!parseRfc3339(utc, reparsed) || reparsed != parsed)
+        {
+            if (failures++ < 5)
+                printf("  FAIL %s -> %s\n", text, utc);
+        }
+    }
+
+    printf("mutations:   %d fuzzed inputs, %d still valid, %d inconsistent\n", BENCH_MUTATIONS, accepted, failures);
+}
+
+template <typename Parse>
+static void timeParser(const char *name, Parse parse)
+{
+    static const char *inputs[] = {"2024-03-10T03:00:00-04:00", "2024-11-03T01:30:00.000Z",
+                                   "2025-07-14T16:45:00+02:00", "2024-12-31T23:59:59Z"};
+    time_t sink = 0;
+
+    uint64_t start = micros();
+    for (int i = 0; i < BENCH_PARSES; i++)
+        sink += parse(inputs[i & 3]);
+    uint64_t elapsed = micros() - start;
+
+    printf("%-12s %6.1f ns/parse (checksum %lld)\n", name, elapsed * 1000.0 / BENCH_PARSES, (long long)sink);
+}
+
+void runRfc3339Benchmark()
+{
+    std::mt19937 rng(3339);
+
+    runCorpus();
+    runDstSweep();
+    runRoundTrips(rng);
+    runMutations(rng);
+
+    // The old parser's cost depends on the zone rules mktime() has to apply
+    setenv("TZ", "America/New_York", 1);
+    tzset();
+    timeParser("mktime:", legacyParse);
+    timeParser("rfc3339:", [](const char *text)
+               {
+        time_t t = 0;
+        parseRfc3339(text, t);
+        return t; });
+    unsetenv("TZ");
+    tzset();
+}
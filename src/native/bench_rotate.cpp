@@ -0,0 +1,81 @@
+#include <Arduino.h>
+#include <lvgl.h>
+
+#include "bench.h"
+#include "config.h"
+#include "ui_queue.h"
+#include "app/app.h"
+
+#define BENCH_REFRESHES 300
+
+static bool rotateInFlush;
+static uint64_t rotateMicros;
+static uint8_t rotated[DRAW_BUF_SIZE];
+
+/**
+ * Stands in for the panel driver. With rotateInFlush it first turns each
+ * area into portrait order, as a driver must when the panel is left in its
+ * native scan and LVGL is told the display is rotated; otherwise the buffer
+ * would go out over DMA untouched.
+ */
+static void benchFlush(lv_display_t *disp, const lv_area_t *area, uint8_t *px_map)
+{
+    if (rotateInFlush)
+    {
+        int32_t w = lv_area_get_width(area);
+        int32_t h = lv_area_get_height(area);
+        uint64_t start = micros();
+        lv_draw_sw_rotate(px_map, rotated, w, h, w * sizeof(uint16_t), h * sizeof(uint16_t),
+                          LV_DISPLAY_ROTATION_90, LV_COLOR_FORMAT_RGB565);
+        rotateMicros += micros() - start;
+    }
+    lv_display_flush_ready(disp);
+}
+
+/**
+ * Full-screen refreshes of the clock screen
+ * @return Microseconds per refresh
+ */
+static double refresh(lv_display_t *disp, bool rotate)
+{
+    rotateInFlush = rotate;
+    rotateMicros = 0;
+
+    uint64_t start = micros();
+    for (int i = 0; i < BENCH_REFRESHES; i++)
+    {
+        lv_obj_invalidate(lv_screen_active());
+        lv_refr_now(disp);
+    }
+    return (double)(micros() - start) / BENCH_REFRESHES;
+}
+
+void runRotateBenchmark()
+{
+    lv_display_t *disp = lv_display_get_default();
+    lv_display_set_flush_cb(disp, benchFlush);
+
+    // The real screen with typical text, so rendering costs what it does on the device
+    setupUI();
+    uiApplyText(UI_LABEL_TIME, "12:34 PM");
+    uiApplyText(UI_LABEL_DATE, "Sat, Oct 17 2026");
+    uiApplyText(UI_LABEL_TEMPERATURE, "61°F (Partly cloudy)");
+    uiApplyText(UI_LABEL_SONG, "Artist Name - A Fairly Long Song Title (Remastered)");
+    uiApplyText(UI_LABEL_CALENDAR, "Team sync at 2:00 PM");
+    lv_refr_now(disp);
+
+    int32_t pixels = lv_display_get_horizontal_resolution(disp) * lv_display_get_vertical_resolution(disp);
+    printf("%d full-screen refreshes of %dx%d, %d-line draw buffers\n\n", BENCH_REFRESHES,
+           (int)lv_display_get_horizontal_resolution(disp), (int)lv_display_get_vertical_resolution(disp),
+           (int)(DRAW_BUF_SIZE / sizeof(uint16_t) / lv_display_get_horizontal_resolution(disp)));
+
+    double panelUs = refresh(disp, false);
+    double softwareUs = refresh(disp, true);
+    double rotateUs = (double)rotateMicros / BENCH_REFRESHES;
+
+    printf("%-26s %12s %12s %14s\n", "rotation", "us/refresh", "rotate us", "extra bytes");
+    printf("%-26s %12.0f %12.0f %14d\n", "panel (MADCTL)", panelUs, 0.0, 0);
+    printf("%-26s %12.0f %12.0f %14d\n", "software, in flush", softwareUs, rotateUs,
+           (int)(pixels * sizeof(uint16_t) * 2));
+    printf("software rotation adds %.0f%% per full-screen refresh\n", (softwareUs - panelUs) * 100.0 / panelUs);
+}
@@ -0,0 +1,151 @@
+#include <Arduino.h>
+#include <random>
+#include <vector>
+
+#include "bench.h"
+#include "app/spotify.h"
+
+#define BENCH_SESSIONS 50
+#define BENCH_LISTEN_MS (2 * 3600 * 1000UL)
+#define BENCH_IDLE_MS (30 * 60 * 1000UL)
+#define BENCH_FIXED_POLL_MS 10000
+#define BENCH_SKIP_PERCENT 15
+
+struct SimTrack
+{
+    uint32_t start;    // Session time the track started
+    uint32_t duration; // Full length of the track
+    uint32_t end;      // When it stopped, earlier than start + duration if skipped
+};
+
+/**
+ * Two hours of back-to-back tracks with the odd skip, then half an hour of
+ * the player reporting nothing
+ */
+static std::vector<SimTrack> makeSession(std::mt19937 &rng)
+{
+    std::uniform_int_distribution<uint32_t> duration(150000, 300000);
+    std::uniform_int_distribution<int> percent(0, 99);
+    std::vector<SimTrack> tracks;
+
+    uint32_t t = 0;
+    while (t < BENCH_LISTEN_MS)
+    {
+        SimTrack track;
+        track.start = t;
+        track.duration = duration(rng);
+        track.end = t + track.duration;
+        if (percent(rng) < BENCH_SKIP_PERCENT)
+            track.end = t + std::uniform_int_distribution<uint32_t>(5000, track.duration - 5000)(rng);
+        tracks.push_back(track);
+        t = track.end;
+    }
+    return tracks;
+}
+
+/**
+ * What the currently-playing endpoint would return at time t
+ */
+static NowPlaying playerAt(const std::vector<SimTrack> &tracks, uint32_t t, int &index)
+{
+    NowPlaying now = {"", "", "", "", false, false, 0, 0};
+    index = -1;
+    for (size_t i = 0; i < tracks.size(); i++)
+    {
+        if (t >= tracks[i].start && t < tracks[i].end)
+        {
+            index = i;
+            now.song = String((int)i);
+            now.isPlaying = true;
+            now.isActive = true;
+            now.progressMs = t - tracks[i].start;
+            now.durationMs = tracks[i].duration;
+            break;
+        }
+    }
+    return now;
+}
+
+struct LatencyStats
+{
+    uint32_t count;
+    uint64_t total;
+    uint32_t max;
+};
+
+struct PollStats
+{
+    uint32_t polls;
+    LatencyStats trackEnd; // Previous track played out
+    LatencyStats skip;     // Previous track was cut short
+};
+
+static void addLatency(LatencyStats &stats, uint32_t latency)
+{
+    stats.count++;
+    stats.total += latency;
+    if (latency > stats.max)
+        stats.max = latency;
+}
+
+/**
+ * Polls one session on a virtual clock and measures how long each track
+ * change takes to reach the display
+ */
+static void simulate(const std::vector<SimTrack> &tracks, bool adaptive, PollStats &stats)
+{
+    uint32_t sessionEnd = tracks.back().end + BENCH_IDLE_MS;
+    uint32_t idleBackoffMs = 0;
+    int shown = -2;
+
+    for (uint32_t t = 0; t < sessionEnd;)
+    {
+        int index;
+        NowPlaying now = playerAt(tracks, t, index);
+        stats.polls++;
+
+        if (index != shown)
+        {
+            if (index > 0 && shown != -2)
+            {
+                const SimTrack &previous = tracks[index - 1];
+                bool skipped = previous.end < previous.start + previous.duration;
+                addLatency(skipped ? stats.skip : stats.trackEnd, t - tracks[index].start);
+            }
+            shown = index;
+        }
+
+        t += adaptive ? SpotifyClient::nextPollDelayMs(now, idleBackoffMs) : BENCH_FIXED_POLL_MS;
+    }
+}
+
+static void printStats(const char *name, const PollStats &stats, uint32_t hours)
+{
+    const LatencyStats &end = stats.trackEnd, &skip = stats.skip;
+    printf("%-9s %6.1f polls/h  new track shown after: track end avg %5.2f s max %5.2f s, "
+           "skip avg %5.2f s max %5.2f s\n",
+           name, (double)stats.polls / hours, end.count ? end.total / 1000.0 / end.count : 0.0, end.max / 1000.0,
+           skip.count ? skip.total / 1000.0 / skip.count : 0.0, skip.max / 1000.0);
+}
+
+void runSpotifyBenchmark()
+{
+    std::mt19937 rng(12);
+    PollStats fixed = {}, adaptive = {};
+    uint64_t simulatedMs = 0;
+
+    for (int i = 0; i < BENCH_SESSIONS; i++)
+    {
+        std::vector<SimTrack> tracks = makeSession(rng);
+        simulatedMs += tracks.back().end + BENCH_IDLE_MS;
+        simulate(tracks, false, fixed);
+        simulate(tracks, true, adaptive);
+    }
+
+    uint32_t hours = simulatedMs / 3600000;
+    printf("%d sessions of ~2 h listening (%d%% skips) + 30 min idle, %u h simulated\n", BENCH_SESSIONS,
+           BENCH_SKIP_PERCENT, hours);
+    printStats("fixed", fixed, hours);
+    printStats("adaptive", adaptive, hours);
+    printf("requests: %.1f%% fewer\n", 100.0 * (1.0 - (double)adaptive.polls / fixed.polls));
+}
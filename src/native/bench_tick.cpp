@@ -0,0 +1,147 @@
+#include <Arduino.h>
+#include <algorithm>
+#include <string.h>
+#include <time.h>
+
+#include "bench.h"
+#include "clock_tick.h"
+#include "config.h"
+#include "time_service.h"
+
+// A day across the autumn DST change, on a clock 40 ppm slow that starts
+// 800 ms behind (slewed in over the first half hour) and is stepped 3 s
+// forward by an NTP answer at noon
+#define BENCH_START_UTC 1793505600LL // 2026-11-01 00:00 EDT
+#define BENCH_HOURS 24
+#define BENCH_OSCILLATOR_PPB 40000
+#define BENCH_INITIAL_ERROR_US 800000
+#define BENCH_STEP_AT_SEC (12 * 3600 + 17)
+#define BENCH_STEP_US 3000000
+
+struct TickResult
+{
+    uint32_t wakeups;
+    uint32_t kicks;
+    uint32_t early;
+    uint32_t posts;
+    int64_t maxLateUs; // Worst delay from a minute boundary to posting its text
+};
+
+/** Real time when the counter reads monoUs */
+static int64_t trueTimeUs(int64_t monoUs)
+{
+    return BENCH_START_UTC * 1000000 + monoUs + monoUs * BENCH_OSCILLATOR_PPB / 1000000000;
+}
+
+/**
+ * Formats the labels for the displayed time and counts the posts: all of
+ * them for the old loop, only changed text for ClockTick::post()
+ * @param onTick Whether this wakeup was for a boundary, rather than boot or
+ *        a kick, and so counts towards lateness
+ */
+static void showTime(int64_t nowUs, char shown[2][CLOCK_TICK_TEXT_SIZE], bool postAll, bool onTick,
+                     TickResult &result)
+{
+    time_t seconds = nowUs / 1000000;
+    struct tm local;
+    localtime_r(&seconds, &local);
+
+    char text[2][CLOCK_TICK_TEXT_SIZE];
+    strftime(text[0], sizeof(text[0]), "%l:%M %p", &local);
+    strftime(text[1], sizeof(text[1]), "%a, %b %d %Y", &local);
+
+    for (int i = 0; i < 2; i++)
+    {
+        bool changed = strcmp(shown[i], text[i]) != 0;
+        strcpy(shown[i], text[i]);
+        if (changed || postAll)
+            result.posts++;
+
+        // The minute started at its boundary; anything after that is late
+        if (i == 0 && changed && onTick)
+            result.maxLateUs = std::max(result.maxLateUs, nowUs % 60000000);
+    }
+}
+
+static ClockModel makeClock()
+{
+    ClockModel model;
+    model.setDriftPpb(BENCH_OSCILLATOR_PPB);
+    model.seed(0, trueTimeUs(0) - BENCH_INITIAL_ERROR_US);
+    model.sample(1000, trueTimeUs(1000));
+    return model;
+}
+
+/**
+ * Runs a day of the clock task on the simulated counter
+ * @param pollMs Sleep of the old fixed-rate loop, or 0 for ClockTick's
+ */
+static TickResult simulate(uint32_t pollMs)
+{
+    TickResult result = {};
+    char shown[2][CLOCK_TICK_TEXT_SIZE] = {};
+    ClockModel model = makeClock();
+    int64_t stepAtUs = (int64_t)BENCH_STEP_AT_SEC * 1000000;
+    bool stepped = false;
+    int64_t monoUs = 1000;
+
+    bool postAll = pollMs != 0;
+    showTime(model.now(monoUs), shown, postAll, false, result);
+    while (monoUs < (int64_t)BENCH_HOURS * 3600 * 1000000)
+    {
+        int64_t nowUs = model.now(monoUs);
+        int64_t boundaryUs = nowUs - nowUs % 60000000 + 60000000;
+        uint32_t sleepMs = pollMs ? pollMs : clockTickDelayMs(nowUs, CLOCK_TICK_MINUTE);
+
+        // The NTP answer arrives during this sleep and kicks it short
+        if (!stepped && monoUs + (int64_t)sleepMs * 1000 > stepAtUs)
+        {
+            monoUs = stepAtUs;
+            model.sample(monoUs, trueTimeUs(monoUs) + BENCH_STEP_US);
+            stepped = true;
+            result.wakeups++;
+            if (!pollMs)
+            {
+                result.kicks++;
+                showTime(model.now(monoUs), shown, postAll, false, result);
+                continue;
+            }
+        }
+        else
+        {
+            monoUs += (int64_t)sleepMs * 1000;
+            result.wakeups++;
+        }
+
+        if (!pollMs && model.now(monoUs) < boundaryUs)
+        {
+            result.early++;
+            continue;
+        }
+        showTime(model.now(monoUs), shown, postAll, true, result);
+    }
+    return result;
+}
+
+void runTickBenchmark()
+{
+    setenv("TZ", TIME_ZONE, 1);
+    tzset();
+
+    printf("%d h across a DST change, 800 ms slew and a 3 s step, TZ %s\n\n", BENCH_HOURS, TIME_ZONE);
+    printf("%-16s %10s %8s %8s %10s %12s\n", "clock task", "wakeups/h", "kicked", "early", "GUI posts/h",
+           "max late");
+    struct
+    {
+        const char *name;
+        uint32_t pollMs;
+    } loops[] = {{"1 Hz polling", 1000}, {"minute ticks", 0}};
+
+    for (const auto &loop : loops)
+    {
+        TickResult result = simulate(loop.pollMs);
+        printf("%-16s %10.1f %8u %8u %10.1f %9.1f ms\n", loop.name, (double)result.wakeups / BENCH_HOURS,
+               result.kicks, result.early, (double)result.posts / BENCH_HOURS, result.maxLateUs / 1000.0);
+    }
+    printf("(each GUI post wakes guiTask and takes the LVGL side of the UI queue once)\n");
+}
@@ -0,0 +1,154 @@
+#include <Arduino.h>
+#include <cstdlib>
+#include <random>
+#include <time.h>
+
+#include "bench.h"
+#include "config.h"
+#include "time_service.h"
+
+// Oscillator model: the counter runs this much slow against real time, in
+// parts per billion, and each NTP sample is off by up to the jitter
+#define BENCH_OSCILLATOR_PPB 40000
+#define BENCH_JITTER_US 5000
+#define BENCH_SYNC_INTERVAL_SEC 3600
+#define BENCH_HOURS 48
+#define BENCH_EPOCH_US 1780000000000000LL // Late May 2026
+
+/**
+ * Real time when the counter reads monoUs
+ */
+static int64_t trueTimeUs(int64_t monoUs)
+{
+    return BENCH_EPOCH_US + monoUs + monoUs * BENCH_OSCILLATOR_PPB / 1000000000;
+}
+
+struct SlewResult
+{
+    int64_t offsetUs;
+    bool stepped;
+    uint32_t settledSec;  // Until the clock is within 1 ms of real time
+    int64_t maxRatePpm;   // Furthest any second ran from a real second
+    int64_t minStepUs;    // Smallest clock advance over one real second
+};
+
+/**
+ * Starts a clock offsetUs wrong, as after a reboot on the RTC, and follows
+ * it second by second after the first NTP sample
+ */
+static SlewResult runSlew(int64_t offsetUs)
+{
+    SlewResult result = {offsetUs, false, 0, 0, INT64_MAX};
+    ClockModel model;
+    model.seed(0, trueTimeUs(0) - offsetUs);
+    model.setDriftPpb(BENCH_OSCILLATOR_PPB); // Already learnt, to isolate the slew
+    model.sample(1000000, trueTimeUs(1000000));
+    result.stepped = model.steps() > 0;
+
+    int64_t last = model.now(1000000);
+    for (int64_t sec = 2; sec < 4 * 3600; sec++)
+    {
+        int64_t monoUs = sec * 1000000;
+        int64_t now = model.now(monoUs);
+        int64_t step = now - last;
+        last = now;
+
+        result.minStepUs = std::min(result.minStepUs, step);
+        result.maxRatePpm = std::max(result.maxRatePpm, std::abs(step - 1000000 - BENCH_OSCILLATOR_PPB / 1000));
+        if (!result.settledSec && std::abs(now - trueTimeUs(monoUs)) < 1000)
+            result.settledSec = sec;
+    }
+    return result;
+}
+
+/**
+ * Hourly syncs with jitter over BENCH_HOURS; reports the worst error seen
+ * just before a sync in the second day, once the estimate has settled
+ */
+static int64_t runDrift(bool correct, int32_t *driftPpb)
+{
+    std::mt19937 rng(3);
+    std::uniform_int_distribution<int> jitter(-BENCH_JITTER_US, BENCH_JITTER_US);
+    ClockModel model;
+    int64_t worstUs = 0;
+
+    for (int64_t sec = 0; sec <= BENCH_HOURS * 3600; sec += BENCH_SYNC_INTERVAL_SEC)
+    {
+        int64_t monoUs = sec * 1000000;
+        int64_t errorUs = model.now(monoUs) - trueTimeUs(monoUs);
+        if (sec >= BENCH_HOURS / 2 * 3600)
+            worstUs = std::max(worstUs, std::abs(errorUs));
+
+        model.sample(monoUs, trueTimeUs(monoUs) + jitter(rng));
+        if (!correct)
+            model.setDriftPpb(0);
+    }
+    *driftPpb = model.driftPpb();
+    return worstUs;
+}
+
+struct DstCase
+{
+    const char *utc; // YYYY-MM-DD HH:MM:SS
+    const char *local;
+};
+
+// The US rules TIME_ZONE encodes, for this year's changes
+static const DstCase dstCases[] = {
+    {"2026-03-08 06:59:59", "2026-03-08 01:59:59 EST"},
+    {"2026-03-08 07:00:00", "2026-03-08 03:00:00 EDT"},
+    {"2026-07-04 16:00:00", "2026-07-04 12:00:00 EDT"},
+    {"2026-11-01 05:59:59", "2026-11-01 01:59:59 EDT"},
+    {"2026-11-01 06:00:00", "2026-11-01 01:00:00 EST"},
+    {"2026-12-25 17:00:00", "2026-12-25 12:00:00 EST"},
+};
+
+static void runDst()
+{
+    setenv("TZ", TIME_ZONE, 1);
+    tzset();
+
+    int failures = 0;
+    printf("\nTZ %s\n", TIME_ZONE);
+    for (const DstCase &test : dstCases)
+    {
+        struct tm utc = {};
+        strptime(test.utc, "%Y-%m-%d %H:%M:%S", &utc);
+        time_t t = timegm(&utc);
+
+        struct tm local;
+        localtime_r(&t, &local);
+        char text[40];
+        strftime(text, sizeof(text), "%Y-%m-%d %H:%M:%S %Z", &local);
+
+        bool ok = strcmp(text, test.local) == 0;
+        failures += !ok;
+        printf("  %s UTC -> %s %s\n", test.utc, text, ok ? "ok" : "WRONG");
+    }
+    printf("dst: %d of %zu conversions wrong\n", failures, sizeof(dstCases) / sizeof(dstCases[0]));
+}
+
+void runTimeBenchmark()
+{
+    printf("oscillator %.0f ppm slow, NTP every %d s with +/-%d ms jitter\n\n", BENCH_OSCILLATOR_PPB / 1000.0,
+           BENCH_SYNC_INTERVAL_SEC, BENCH_JITTER_US / 1000);
+
+    printf("%10s %8s %12s %14s %16s\n", "offset", "action", "settled in", "max rate error", "min 1 s advance");
+    for (int64_t offsetUs : {-800000LL, 300000LL, 950000LL, 3000000LL, -90000000LL})
+    {
+        SlewResult result = runSlew(offsetUs);
+        printf("%7.0f ms %8s %10u s %10lld ppm %13.6f s\n", offsetUs / 1000.0, result.stepped ? "step" : "slew",
+               result.settledSec, (long long)result.maxRatePpm, result.minStepUs / 1e6);
+    }
+
+    int32_t learntPpb;
+    int32_t ignoredPpb;
+    int64_t corrected = runDrift(true, &learntPpb);
+    int64_t uncorrected = runDrift(false, &ignoredPpb);
+    printf("\ndrift estimate after %d h: %.2f ppm (actual %.2f)\n", BENCH_HOURS, learntPpb / 1000.0,
+           BENCH_OSCILLATOR_PPB / 1000.0);
+    printf("worst error before a sync: %.1f ms with drift correction, %.1f ms without\n", corrected / 1000.0,
+           uncorrected / 1000.0);
+
+    runDst();
+}
@@ -0,0 +1,385 @@
+#include <Arduino.h>
+#include <algorithm>
+#include <cmath>
+#include <random>
+#include <vector>
+
+#include "bench.h"
+#include "config.h"
+#include "lv_conf.h"
+#include "touch_input.h"
+
+// Trace model: XPT2046 conversions every 25 us while touched, with noise,
+// rare spikes, a scattered landing and lift-off, and pressure dips
+#define BENCH_SAMPLE_US 25
+#define BENCH_NOISE_RAW 6
+#define BENCH_SPIKE_PERCENT 2
+#define BENCH_SETTLE_US 8000
+#define BENCH_HOLD_MS 300
+#define BENCH_GAP_MS 200
+#define BENCH_READ_MS LV_DEF_REFR_PERIOD // LVGL's input read timer
+#define BENCH_CONVERSION_US 25           // 24 SPI clocks at SPI_TOUCH_FREQUENCY plus CS handling
+
+/**
+ * One conversion of the trace. Synthetic traces also know where the pen
+ * really was; recorded ones have truth = false.
+ */
+struct TraceSample
+{
+    uint32_t us;
+    uint16_t x, y, z;
+    bool truth;
+    bool moving;
+    int16_t screenX, screenY;
+};
+
+struct PipelineResult
+{
+    uint32_t taps;
+    uint32_t presses;
+    uint32_t spiReads;
+    double latencyMsTotal;
+    uint32_t latencyMsMax;
+    double errorTotal;
+    double errorMax;
+    uint32_t errorCount;
+    double jitterTotal; // Spread of the points reported during a hold
+    uint32_t jitterCount;
+};
+
+/**
+ * The nominal mapping, inverted: where a screen point reads. Screen x runs
+ * along raw y and screen y along raw x.
+ */
+static void screenToRaw(const TouchCalibration &cal, double sx, double sy, double *rx, double *ry)
+{
+    *rx = (sy + 0.5 - cal.f / 65536.0) / (cal.d / 65536.0);
+    *ry = (sx + 0.5 - cal.c / 65536.0) / (cal.b / 65536.0);
+}
+
+static std::vector<TraceSample> syntheticTrace()
+{
+    std::mt19937 rng(5);
+    std::normal_distribution<double> noise(0, BENCH_NOISE_RAW);
+    std::normal_distribution<double> scatter(0, 150);
+    std::uniform_int_distribution<int> percent(0, 99);
+    std::uniform_int_distribution<int> spike(-1500, 1500);
+    TouchCalibration nominal = TouchInput::getCalibration();
+    std::vector<TraceSample> trace;
+    uint32_t us = 0;
+
+    for (int tap = 0; tap < 24; tap++)
+    {
+        us += BENCH_GAP_MS * 1000;
+        int16_t px = 20 + (tap % 4) * 70;
+        int16_t py = 20 + (tap / 4) * 40;
+        bool drag = tap % 6 == 5;
+        bool dip = tap % 5 == 2;
+        uint32_t holdUs = BENCH_HOLD_MS * 1000;
+
+        for (uint32_t t = 0; t < holdUs; t += BENCH_SAMPLE_US)
+        {
+            double fx = px + (drag ? 60.0 * t / holdUs : 0);
+            double fy = py;
+            double rx, ry;
+            screenToRaw(nominal, fx, fy, &rx, &ry);
+
+            // Landing and lift-off: light pressure, positions all over
+            bool settling = t < BENCH_SETTLE_US || holdUs - t < BENCH_SETTLE_US / 2;
+            double z = settling ? 150 + 1000.0 * std::min(t, holdUs - t) / BENCH_SETTLE_US : 1200;
+            if (dip && t > holdUs / 2 && t < holdUs / 2 + 20000)
+                z = 300;
+            rx += settling ? scatter(rng) : noise(rng);
+            ry += settling ? scatter(rng) : noise(rng);
+            if (percent(rng) < BENCH_SPIKE_PERCENT)
+                (percent(rng) < 50 ? rx : ry) += spike(rng);
+
+            TraceSample sample;
+            sample.us = us + t;
+            sample.x = std::max(0.0, std::min(4095.0, rx));
+            sample.y = std::max(0.0, std::min(4095.0, ry));
+            sample.z = z;
+            sample.truth = !settling;
+            sample.moving = drag;
+            sample.screenX = lround(fx);
+            sample.screenY = fy;
+            trace.push_back(sample);
+        }
+        us += holdUs;
+    }
+    return trace;
+}
+
+/**
+ * Loads a recorded trace, one "<us> <x> <y> <z>" conversion per line
+ */
+static bool loadTrace(const char *path, std::vector<TraceSample> &trace)
+{
+    FILE *file = fopen(path, "r");
+    if (!file)
+        return false;
+
+    unsigned us, x, y, z;
+    while (fscanf(file, "%u %u %u %u", &us, &x, &y, &z) == 4)
+        trace.push_back({us, (uint16_t)x, (uint16_t)y, (uint16_t)z, false, false, 0, 0});
+    fclose(file);
+    return true;
+}
+
+/**
+ * The pipeline this replaces: XPT2046_Touchscreen's best-two-of-three
+ * average, then a per-axis map whose range widens to every outlier. The
+ * library was given the IRQ pin too, so it was already gated on PENIRQ.
+ */
+class OldPipeline
+{
+public:
+    bool update(const TouchSample *samples, int count, TouchPoint *point)
+    {
+        if (!count)
+            return false;
+        uint32_t z = 0;
+        for (int i = 0; i < count; i++)
+            z += samples[i].z;
+        if (z / count < 400)
+            return false;
+
+        uint16_t x = bestTwo(samples[0].x, samples[1].x, samples[2].x);
+        uint16_t y = bestTwo(samples[0].y, samples[1].y, samples[2].y);
+        minX = std::min(minX, x);
+        maxX = std::max(maxX, x);
+        minY = std::min(minY, y);
+        maxY = std::max(maxY, y);
+        // Mapped onto the portrait panel, then turned as LVGL's rotation did
+        int32_t panelX = map(x, minX, maxX, 1, TFT_HOR_RES);
+        int32_t panelY = map(y, minY, maxY, 1, TFT_VER_RES);
+        point->x = SCREEN_HOR_RES - 1 - panelY;
+        point->y = panelX;
+        return true;
+    }
+
+    uint16_t minX = 200, maxX = 3700, minY = 240, maxY = 3800;
+
+private:
+    static uint16_t bestTwo(int a, int b, int c)
+    {
+        int ab = abs(a - b), ac = abs(a - c), bc = abs(b - c);
+        if (ab <= ac && ab <= bc)
+            return (a + b) / 2;
+        if (ac <= ab && ac <= bc)
+            return (a + c) / 2;
+        return (b + c) / 2;
+    }
+};
+
+template <typename Pipeline>
+static PipelineResult replay(const std::vector<TraceSample> &trace, Pipeline &pipeline)
+{
+    PipelineResult result = {};
+    bool truth = !trace.empty() && std::any_of(trace.begin(), trace.end(), [](const TraceSample &s)
+                                               { return s.truth; });
+    size_t next = 0;
+    bool wasPressed = false;
+    bool penWasDown = false;
+    uint32_t downAtUs = 0;
+    bool tapCounted = false;
+    std::vector<TouchPoint> hold;
+    uint32_t endUs = trace.empty() ? 0 : trace.back().us + 100000;
+
+    auto finishHold = [&]()
+    {
+        if (hold.size() < 3)
+        {
+            hold.clear();
+            return;
+        }
+        double mx = 0, my = 0;
+        for (const TouchPoint &p : hold)
+            mx += p.x, my += p.y;
+        mx /= hold.size();
+        my /= hold.size();
+        double var = 0;
+        for (const TouchPoint &p : hold)
+            var += (p.x - mx) * (p.x - mx) + (p.y - my) * (p.y - my);
+        result.jitterTotal += sqrt(var / hold.size());
+        result.jitterCount++;
+        hold.clear();
+    };
+
+    for (uint32_t readUs = 0; readUs < endUs; readUs += BENCH_READ_MS * 1000)
+    {
+        while (next < trace.size() && trace[next].us + BENCH_SAMPLE_US <= readUs)
+            next++;
+
+        // The pen is down if the trace has a conversion now; that is what PENIRQ shows
+        bool penDown = next < trace.size() && trace[next].us <= readUs + BENCH_SAMPLE_US;
+        if (penDown && !penWasDown)
+        {
+            downAtUs = trace[next].us;
+            tapCounted = false;
+        }
+        penWasDown = penDown;
+
+        TouchSample samples[TOUCH_BURST_SIZE];
+        int count = 0;
+        if (penDown)
+        {
+            result.spiReads++;
+            for (; count < TOUCH_BURST_SIZE; count++)
+            {
+                uint32_t at = readUs + count * BENCH_CONVERSION_US;
+                size_t i = next;
+                while (i < trace.size() && trace[i].us + BENCH_SAMPLE_US <= at)
+                    i++;
+                if (i >= trace.size() || trace[i].us > at + BENCH_SAMPLE_US)
+                    samples[count] = {0, 0, 0};
+                else
+                    samples[count] = {trace[i].x, trace[i].y, trace[i].z};
+            }
+        }
+
+        TouchPoint point;
+        bool pressed = pipeline.update(count ? samples : NULL, count, &point);
+        if (pressed && !wasPressed)
+        {
+            result.presses++;
+            if (!tapCounted)
+            {
+                uint32_t latencyMs = (readUs - downAtUs) / 1000;
+                result.taps++;
+                result.latencyMsTotal += latencyMs;
+                result.latencyMsMax = std::max(result.latencyMsMax, latencyMs);
+                tapCounted = true;
+            }
+        }
+        if (!pressed && wasPressed)
+            finishHold();
+        wasPressed = pressed;
+
+        if (pressed && penDown && trace[next].truth)
+        {
+            double error = hypot(point.x - trace[next].screenX, point.y - trace[next].screenY);
+            result.errorTotal += error;
+            result.errorMax = std::max(result.errorMax, error);
+            result.errorCount++;
+        }
+        // Drags move on purpose; only the steady part of a tap counts as
+        // jitter, or all of it for a recorded trace
+        if (pressed && penDown && (!truth || (trace[next].truth && !trace[next].moving)))
+            hold.push_back(point);
+    }
+    finishHold();
+    return result;
+}
+
+static void printResult(const char *name, const PipelineResult &r, uint32_t durationMs, bool truth)
+{
+    printf("%-22s %4u %7u %8.1f %5u %9.2f", name, r.taps, r.presses - r.taps,
+           r.taps ? r.latencyMsTotal / r.taps : 0.0, r.latencyMsMax,
+           r.jitterCount ? r.jitterTotal / r.jitterCount : 0.0);
+    if (truth)
+        printf(" %7.2f %6.1f", r.errorCount ? r.errorTotal / r.errorCount : 0.0, r.errorMax);
+    else
+        printf(" %7s %6s", "-", "-");
+    printf(" %8.1f\n", r.spiReads * 1000.0 / durationMs);
+}
+
+/**
+ * Calibration from three noisy taps on a skewed, rotated panel, checked
+ * over a grid of points
+ */
+static void runCalibration()
+{
+    std::mt19937 rng(9);
+    std::normal_distribution<double> noise(0, 4);
+    const double angle = 0.02; // ~1 degree of mounting error
+    auto toRaw = [&](double px, double py, double *rx, double *ry)
+    {
+        *rx = 200 + 14.6 * (py * cos(angle) + px * sin(angle)) + 0.3 * px;
+        *ry = 3800 - 11.1 * (px * cos(angle) - py * sin(angle));
+    };
+
+    TouchPoint screen[3] = {{32, 36}, {288, 120}, {112, 211}};
+    TouchPoint raw[3];
+    for (int i = 0; i < 3; i++)
+    {
+        double rx, ry;
+        toRaw(screen[i].x, screen[i].y, &rx, &ry);
+        raw[i] = {(int16_t)lround(rx + noise(rng)), (int16_t)lround(ry + noise(rng))};
+    }
+
+    TouchCalibration solved;
+    bool ok = touchCalibrationSolve(screen, raw, &solved);
+    double worst = 0, total = 0;
+    int count = 0;
+    TouchCalibration nominal = TouchInput::getCalibration();
+    double worstNominal = 0;
+    for (int py = 10; py < SCREEN_VER_RES; py += 20)
+    {
+        for (int px = 10; px < SCREEN_HOR_RES; px += 20)
+        {
+            double rx, ry;
+            toRaw(px, py, &rx, &ry);
+            TouchPoint p = touchCalibrationApply(solved, lround(rx), lround(ry));
+            TouchPoint n = touchCalibrationApply(nominal, lround(rx), lround(ry));
+            double error = hypot(p.x - px, p.y - py);
+            worst = std::max(worst, error);
+            worstNominal = std::max(worstNominal, hypot(n.x - px, n.y - py));
+            total += error;
+            count++;
+        }
+    }
+
+    TouchPoint collinear[3] = {{100, 100}, {200, 200}, {300, 300}};
+    printf("\ncalibration: solved %s, mean error %.2f px, worst %.2f px over %d points (nominal ranges: worst %.1f "
+           "px)\n",
+           ok ? "yes" : "NO", total / count, worst, count, worstNominal);
+    printf("collinear taps rejected: %s\n", touchCalibrationSolve(screen, collinear, &solved) ? "NO" : "yes");
+}
+
+void runTouchBenchmark()
+{
+    TouchInput::begin();
+
+    std::vector<TraceSample> trace;
+    const char *path = getenv("CLOCK_TOUCH_TRACE");
+    bool truth = !path;
+    if (path)
+    {
+        if (!loadTrace(path, trace))
+        {
+            printf("touch benchmark: cannot read %s\n", path);
+            return;
+        }
+        printf("trace %s: %zu conversions\n", path, trace.size());
+    }
+    else
+    {
+        trace = syntheticTrace();
+        printf("synthetic trace: %zu conversions, 24 taps (4 drags, 5 pressure dips), %d%% spikes\n", trace.size(),
+               BENCH_SPIKE_PERCENT);
+    }
+    uint32_t durationMs = trace.empty() ? 1 : trace.back().us / 1000 + 100;
+    printf("LVGL reads every %d ms, %d conversions each\n\n", BENCH_READ_MS, TOUCH_BURST_SIZE);
+
+    printf("%-22s %4s %7s %8s %5s %9s %7s %6s %8s\n", "pipeline", "taps", "splits", "lat ms", "max", "jitter px",
+           "err px", "max", "SPI/s");
+    OldPipeline old;
+    PipelineResult oldResult = replay(trace, old);
+    printResult("library, min/max map", oldResult, durationMs, truth);
+
+    struct
+    {
+        bool update(const TouchSample *samples, int count, TouchPoint *point)
+        {
+            return TouchInput::update(samples, count, point);
+        }
+    } filtered;
+    printResult("IRQ, median+IIR", replay(trace, filtered), durationMs, truth);
+
+    // The old mapping widened for good on any reading outside its range
+    printf("\nold range after the trace: x %u-%u, y %u-%u (started 200-3700, 240-3800)\n", old.minX, old.maxX,
+           old.minY, old.maxY);
+
+    runCalibration();
+}
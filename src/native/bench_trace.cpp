@@ -0,0 +1,102 @@
+#include <Arduino.h>
+#include <atomic>
+#include <lvgl.h>
+#include <unistd.h>
+
+#include "bench.h"
+#include "trace.h"
+#include "ui_queue.h"
+#include "app/app.h"
+
+#define BENCH_EVENTS 1000000
+#define BENCH_REFRESHES 200
+
+static std::atomic<int> running;
+
+static void recordTask(void *)
+{
+    for (int i = 0; i < BENCH_EVENTS / 2; i++)
+    {
+        TRACE_SCOPE("bench");
+    }
+    running--;
+    vTaskDelete(NULL);
+}
+
+/**
+ * @return Nanoseconds per event with this many tasks recording at once
+ */
+static double recordCost(int taskCount)
+{
+    running = taskCount;
+    uint64_t start = micros();
+    for (int i = 0; i < taskCount; i++)
+        xTaskCreatePinnedToCore(recordTask, "bench", 4096, NULL, 1, NULL, i % 2);
+    while (running > 0)
+        delay(1);
+    return (micros() - start) * 1000.0 / BENCH_EVENTS;
+}
+
+static void benchFlush(lv_display_t *disp, const lv_area_t *area, uint8_t *px_map)
+{
+    TRACE_SCOPE("flush");
+    lv_display_flush_ready(disp);
+}
+
+void runTraceBenchmark()
+{
+    if (!TRACE_ENABLED)
+    {
+        printf("trace benchmark: built without TRACE_ENABLED\n");
+        return;
+    }
+
+    printf("%d-event ring\n", TRACE_RING_SIZE);
+    double eventNs = 0;
+    for (int tasks : {1, 2, 4})
+    {
+        double ns = recordCost(tasks);
+        if (!eventNs)
+            eventNs = ns;
+        printf("record: %.1f ns per event, %d task%s recording\n", ns, tasks, tasks > 1 ? "s" : "");
+    }
+
+    lv_display_t *disp = lv_display_get_default();
+    lv_display_set_flush_cb(disp, benchFlush);
+    traceWatchDisplay(disp);
+    setupUI();
+    uiApplyText(UI_LABEL_TIME, "12:34 PM");
+    uiApplyText(UI_LABEL_SONG, "Artist Name - A Fairly Long Song Title (Remastered)");
+    lv_refr_now(disp);
+
+    uint32_t before = traceEventCount();
+    uint64_t start = micros();
+    for (int i = 0; i < BENCH_REFRESHES; i++)
+    {
+        lv_obj_invalidate(lv_screen_active());
+        lv_refr_now(disp);
+    }
+    double refreshUs = (double)(micros() - start) / BENCH_REFRESHES;
+    double events = (double)(traceEventCount() - before) / BENCH_REFRESHES;
+    double costUs = events * eventNs / 1000.0;
+    printf("full refresh: %.0f events, %.1f us of tracing in %.0f us (%.2f%%)\n", events, costUs, refreshUs,
+           costUs * 100.0 / refreshUs);
+
+    // The dump goes to stdout as it would to the serial log; measure it instead
+    fflush(stdout);
+    int savedStdout = dup(STDOUT_FILENO);
+    char dumpPath[] = "/tmp/clock-trace-XXXXXX";
+    close(mkstemp(dumpPath));
+    freopen(dumpPath, "w", stdout);
+    start = micros();
+    traceDump();
+    fflush(stdout);
+    uint64_t dumpUs = micros() - start;
+    long dumpBytes = ftell(stdout);
+    dup2(savedStdout, STDOUT_FILENO);
+    close(savedStdout);
+    unlink(dumpPath);
+
+    printf("dump: %ld bytes in %.1f ms on the host, %.1f s of serial at 115200 baud\n", dumpBytes,
+           dumpUs / 1000.0, dumpBytes * 10 / 115200.0);
+}
@@ -0,0 +1,164 @@
+#include <Arduino.h>
+#include <atomic>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+#include "bench.h"
+#include "ui_queue.h"
+
+#define BENCH_DURATION_MS 2000
+#define BENCH_PRODUCERS UI_LABEL_COUNT
+#define BENCH_RENDER_MS 10 // Simulated lv_task_handler() time per frame
+#define BENCH_FRAME_MS 5
+
+struct ProducerStats
+{
+    uint64_t pushes;
+    uint64_t totalNanos;
+    uint64_t maxNanos;
+};
+
+static std::atomic<bool> running;
+static uint32_t lastApplied[UI_LABEL_COUNT];
+static uint32_t outOfOrder;
+
+static uint64_t nowNanos()
+{
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (uint64_t)ts.tv_sec * 1000000000ULL + ts.tv_nsec;
+}
+
+static void busyWaitMs(uint32_t ms)
+{
+    uint64_t end = nowNanos() + ms * 1000000ULL;
+    while (nowNanos() < end)
+        ;
+}
+
+static void recordApplied(int label, const char *text)
+{
+    uint32_t seq = strtoul(text, NULL, 10);
+    if (seq < lastApplied[label])
+        outOfOrder++;
+    lastApplied[label] = seq;
+}
+
+// The bench binds plain ids instead of widgets; the setter decodes the label
+// from the object pointer it was bound with
+static void countingSetter(lv_obj_t *obj, const char *text)
+{
+    recordApplied((int)(intptr_t)obj - 1, text);
+}
+
+template <typename Post>
+static ProducerStats runProducer(int label, Post post)
+{
+    ProducerStats stats = {0, 0, 0};
+    char text[UI_UPDATE_TEXT_SIZE];
+    uint32_t seq = 0;
+
+    while (running.load(std::memory_order_relaxed))
+    {
+        snprintf(text, sizeof(text), "%u update for label %d", ++seq, label);
+
+        uint64_t start = nowNanos();
+        post(label, text);
+        uint64_t elapsed = nowNanos() - start;
+
+        stats.pushes++;
+        stats.totalNanos += elapsed;
+        if (elapsed > stats.maxNanos)
+            stats.maxNanos = elapsed;
+    }
+
+    return stats;
+}
+
+static void printProducers(const char *name, const std::vector<ProducerStats> &stats, uint32_t frames)
+{
+    ProducerStats total = {0, 0, 0};
+    for (const ProducerStats &producer : stats)
+    {
+        total.pushes += producer.pushes;
+        total.totalNanos += producer.totalNanos;
+        if (producer.maxNanos > total.maxNanos)
+            total.maxNanos = producer.maxNanos;
+    }
+
+    printf("%-8s %10llu posts  avg %6.0f ns  max %9.0f us  (%u frames)\n", name,
+           (unsigned long long)total.pushes, (double)total.totalNanos / total.pushes,
+           total.maxNanos / 1000.0, frames);
+}
+
+template <typename Post, typename Consume>
+static void runScenario(const char *name, Post post, Consume consume)
+{
+    std::vector<ProducerStats> stats(BENCH_PRODUCERS);
+    std::vector<std::thread> producers;
+    uint32_t frames = 0;
+
+    running = true;
+    for (int label = 0; label < BENCH_PRODUCERS; label++)
+        producers.emplace_back([&, label]
+                               { stats[label] = runProducer(label, post); });
+
+    uint64_t end = nowNanos() + BENCH_DURATION_MS * 1000000ULL;
+    while (nowNanos() < end)
+    {
+        consume();
+        frames++;
+        vTaskDelay(pdMS_TO_TICKS(BENCH_FRAME_MS));
+    }
+
+    running = false;
+    for (std::thread &producer : producers)
+        producer.join();
+    consume();
+
+    printProducers(name, stats, frames);
+}
+
+void runUiQueueBenchmark()
+{
+    printf("ui queue benchmark: %d producers, %d ms render per frame, %d ms\n",
+           BENCH_PRODUCERS, BENCH_RENDER_MS, BENCH_DURATION_MS);
+
+    // Baseline: every post takes the lock the renderer holds for a whole frame
+    std::mutex guiMutex;
+    char mutexSlots[UI_LABEL_COUNT][UI_UPDATE_TEXT_SIZE] = {};
+    runScenario(
+        "mutex",
+        [&](int label, const char *text)
+        {
+            std::lock_guard<std::mutex> lock(guiMutex);
+            snprintf(mutexSlots[label], UI_UPDATE_TEXT_SIZE, "%s", text);
+        },
+        [&]
+        {
+            std::lock_guard<std::mutex> lock(guiMutex);
+            for (int label = 0; label < UI_LABEL_COUNT; label++)
+                recordApplied(label, mutexSlots[label]);
+            busyWaitMs(BENCH_RENDER_MS);
+        });
+
+    memset(lastApplied, 0, sizeof(lastApplied));
+    outOfOrder = 0;
+    for (int label = 0; label < UI_LABEL_COUNT; label++)
+        uiBindLabel((UiLabelId)label, (lv_obj_t *)(intptr_t)(label + 1), countingSetter);
+
+    runScenario(
+        "queue",
+        [](int label, const char *text)
+        { uiPostText((UiLabelId)label, text); },
+        []
+        {
+            uiDrainUpdates();
+            busyWaitMs(BENCH_RENDER_MS);
+        });
+
+    UiQueueStats queue = getUiQueueStats();
+    printf("queue:   %u posted, %u applied, %u coalesced, %u overwritten, %u out of order\n",
+           queue.posted, queue.applied, queue.coalesced, queue.overwritten, outOfOrder);
+}
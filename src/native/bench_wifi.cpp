@@ -0,0 +1,132 @@
+#include <Arduino.h>
+#include <WiFi.h>
+#include <stdlib.h>
+#include <unistd.h>
+
+#include "bench.h"
+#include "fetch_scheduler.h"
+#include "wifi_manager.h"
+
+// Link model: an all-channel active scan is 13 channels at ~120 ms, plus
+// association and DHCP; joining a known BSSID on a known channel is just
+// the latter
+#define BENCH_SCAN_CONNECT_MS "2000"
+#define BENCH_DIRECT_CONNECT_MS "350"
+#define BENCH_DROPS 8
+#define BENCH_FETCH_INTERVAL_MS 50
+
+static volatile uint32_t fetchRuns;
+static volatile uint32_t fetchOffline; // Runs that would have failed for lack of a link
+
+static uint32_t benchFetchJob()
+{
+    fetchRuns++;
+    if (WiFi.status() != WL_CONNECTED)
+        fetchOffline++;
+    return BENCH_FETCH_INTERVAL_MS;
+}
+
+static void onStateChange(bool connected)
+{
+    FetchScheduler::setNetworkReady(connected);
+}
+
+/**
+ * Waits for the manager to report its next connection
+ */
+static bool waitConnected(uint32_t connectsBefore, uint32_t timeoutMs)
+{
+    uint32_t start = millis();
+    while (WiFiManager::getStats().connects == connectsBefore)
+    {
+        if (millis() - start >= timeoutMs)
+            return false;
+        delay(5);
+    }
+    return true;
+}
+
+static void printHistogram(FILE *out, const WiFiManagerStats &before, const WiFiManagerStats &after)
+{
+    static const uint32_t limits[WIFI_LATENCY_BUCKETS] = WIFI_LATENCY_BUCKET_LIMITS_MS;
+    uint32_t lower = 0;
+    for (int i = 0; i < WIFI_LATENCY_BUCKETS; i++)
+    {
+        uint32_t count = after.latencyHistogram[i] - before.latencyHistogram[i];
+        if (limits[i])
+            fprintf(out, "  %5u-%5u ms %3u %.*s\n", lower, limits[i], count, (int)count, "################");
+        else
+            fprintf(out, "  %5u+      ms %3u %.*s\n", lower, count, (int)count, "################");
+        lower = limits[i];
+    }
+}
+
+static void runDrops(FILE *out, const char *label, bool fast)
+{
+    WiFiManager::setFastReconnect(fast);
+    WiFiManagerStats before = WiFiManager::getStats();
+    uint32_t runsBefore = fetchRuns;
+    uint32_t downMs = 0;
+
+    for (int i = 0; i < BENCH_DROPS; i++)
+    {
+        delay(100);
+        uint32_t connects = WiFiManager::getStats().connects;
+        uint32_t start = millis();
+        WiFi.simulateLinkLoss();
+        waitConnected(connects, 30000);
+        downMs += millis() - start;
+    }
+
+    WiFiManagerStats after = WiFiManager::getStats();
+    fprintf(out, "%s: %d drops, %.0f ms average outage, %u cached-AP joins, %u scans, %u fetches ran\n", label,
+            BENCH_DROPS, (double)downMs / BENCH_DROPS, after.fastConnects - before.fastConnects,
+            after.scanConnects - before.scanConnects, fetchRuns - runsBefore);
+    printHistogram(out, before, after);
+}
+
+void runWiFiBenchmark()
+{
+    setenv("CLOCK_WIFI_CONNECT_MS", BENCH_SCAN_CONNECT_MS, 1);
+    setenv("CLOCK_WIFI_FAST_CONNECT_MS", BENCH_DIRECT_CONNECT_MS, 1);
+
+    // Start without a cached access point
+    char nvsDir[] = "/tmp/clock-bench-XXXXXX";
+    if (mkdtemp(nvsDir))
+        setenv("CLOCK_NVS_DIR", nvsDir, 1);
+
+    // The manager logs every link change; keep the results readable
+    fflush(stdout);
+    int savedStdout = dup(STDOUT_FILENO);
+    FILE *results = fdopen(dup(savedStdout), "w");
+    freopen("/dev/null", "w", stdout);
+
+    fprintf(results, "link model: %s ms to scan and join, %s ms to join a known BSSID and channel\n",
+            BENCH_SCAN_CONNECT_MS, BENCH_DIRECT_CONNECT_MS);
+
+    FetchScheduler::addJob("bench-fetch", benchFetchJob, FETCH_PRIORITY_NORMAL, true, 0);
+    FetchScheduler::start(8192, 3, 1);
+    WiFiManager::start(onStateChange, 4096, 4, 1);
+    waitConnected(0, 30000);
+    fprintf(results, "boot: joined in %u ms (nothing cached yet)\n\n", WiFiManager::getStats().latencyMsMax);
+
+    runDrops(results, "scan on reconnect", false);
+    runDrops(results, "cached BSSID/channel", true);
+
+    // The access point moves: the direct join misses and falls back to a scan
+    WiFiManagerStats before = WiFiManager::getStats();
+    WiFi.simulateApChange();
+    uint32_t start = millis();
+    WiFi.simulateLinkLoss();
+    waitConnected(before.connects, 30000);
+    WiFiManagerStats after = WiFiManager::getStats();
+    fprintf(results, "access point moved: back in %u ms, %u cached-AP miss, %u scan\n", millis() - start,
+            after.fastMisses - before.fastMisses, after.scanConnects - before.scanConnects);
+
+    fprintf(results, "fetches: %u ran, %u while the link was down\n", fetchRuns, fetchOffline);
+
+    fclose(results);
+    fflush(stdout);
+    dup2(savedStdout, STDOUT_FILENO);
+    close(savedStdout);
+}
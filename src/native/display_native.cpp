@@ -0,0 +1,222 @@
+#include <Arduino.h>
+#include <lvgl.h>
+#include <vector>
+
+#include "hardware.h"
+#include "config.h"
+#include "display_stats.h"
+#include "framebuffer.h"
+#include "trace.h"
+
+struct TouchScriptEntry
+{
+    uint32_t timeMs;
+    int32_t x;
+    int32_t y;
+    bool pressed;
+};
+
+static uint16_t framebuffer[SCREEN_HOR_RES * SCREEN_VER_RES];
+static FramebufferStats stats;
+static bool doubleBuffered = true;
+static bool spiModel = true;
+static uint64_t spiBusyUntil;
+static uint64_t frameStartMicros;
+static bool frameFlushed;
+
+static std::vector<TouchScriptEntry> touchScript;
+static size_t touchScriptIndex;
+
+static uint32_t spiTransferMicros(uint32_t bytes)
+{
+    if (!spiModel)
+        return 0;
+
+    return (uint32_t)((uint64_t)bytes * 8 * 1000000ULL / SPI_FREQUENCY);
+}
+
+static void waitForSpi()
+{
+    uint64_t now = micros();
+    if (spiBusyUntil <= now)
+        return;
+
+    uint64_t remaining = spiBusyUntil - now;
+    stats.spiStallMicros += remaining;
+
+    struct timespec ts = {(time_t)(remaining / 1000000), (long)(remaining % 1000000) * 1000L};
+    nanosleep(&ts, NULL);
+}
+
+// Models the DMA driver: wait for the previous chunk to leave the bus, start
+// this one, and only block until it completes when there is no second buffer
+// for LVGL to render into meanwhile.
+static void framebufferFlush(lv_display_t *disp, const lv_area_t *area, uint8_t *px_map)
+{
+    TRACE_SCOPE("flush");
+    waitForSpi();
+
+    int32_t stride = lv_display_get_horizontal_resolution(disp);
+    int32_t width = lv_area_get_width(area);
+    const uint16_t *src = (const uint16_t *)px_map;
+
+    for (int32_t y = area->y1; y <= area->y2; y++)
+    {
+        memcpy(&framebuffer[y * stride + area->x1], src, width * sizeof(uint16_t));
+        src += width;
+    }
+
+    uint32_t bytes = lv_area_get_size(area) * sizeof(uint16_t);
+    uint32_t transfer = spiTransferMicros(bytes);
+    spiBusyUntil = micros() + transfer;
+
+    stats.flushes++;
+    stats.flushBytes += bytes;
+    stats.spiBusyMicros += transfer;
+    recordDisplayFlush(area, bytes);
+    frameFlushed = true;
+
+    if (!doubleBuffered)
+        waitForSpi();
+
+    lv_display_flush_ready(disp);
+}
+
+static void refreshEventCb(lv_event_t *e)
+{
+    if (lv_event_get_code(e) == LV_EVENT_REFR_START)
+    {
+        frameStartMicros = micros();
+        frameFlushed = false;
+        return;
+    }
+
+    if (!frameFlushed)
+        return;
+
+    uint32_t elapsed = (uint32_t)(micros() - frameStartMicros);
+    stats.frames++;
+    stats.frameMicros += elapsed;
+    if (elapsed > stats.maxFrameMicros)
+        stats.maxFrameMicros = elapsed;
+}
+
+void initTouchscreen()
+{
+    lv_indev_t *indev = lv_indev_create();
+    lv_indev_set_type(indev, LV_INDEV_TYPE_POINTER);
+    lv_indev_set_read_cb(indev, touchpadRead);
+}
+
+void initDisplay()
+{
+    static uint8_t draw_buf1[DRAW_BUF_SIZE];
+    static uint8_t draw_buf2[DRAW_BUF_SIZE];
+
+    lv_display_t *disp = lv_display_create(SCREEN_HOR_RES, SCREEN_VER_RES);
+    lv_display_set_flush_cb(disp, framebufferFlush);
+    lv_display_set_buffers(disp, draw_buf1, doubleBuffered ? draw_buf2 : NULL, DRAW_BUF_SIZE,
+                           LV_DISPLAY_RENDER_MODE_PARTIAL);
+    lv_display_add_event_cb(disp, refreshEventCb, LV_EVENT_REFR_START, NULL);
+    lv_display_add_event_cb(disp, refreshEventCb, LV_EVENT_REFR_READY, NULL);
+    initDisplayStats(disp);
+}
+
+// Scripts give panel points rather than raw readings, so there is nothing
+// to calibrate against
+bool touchscreenPressed()
+{
+    return false;
+}
+
+void touchpadRead(lv_indev_t *indev, lv_indev_data_t *data)
+{
+    static TouchScriptEntry current = {0, 0, 0, false};
+
+    uint32_t now = millis();
+    while (touchScriptIndex < touchScript.size() && touchScript[touchScriptIndex].timeMs <= now)
+    {
+        current = touchScript[touchScriptIndex++];
+    }
+
+    data->point.x = current.x;
+    data->point.y = current.y;
+    data->state = current.pressed ? LV_INDEV_STATE_PRESSED : LV_INDEV_STATE_RELEASED;
+}
+
+void setFramebufferDoubleBuffered(bool enabled)
+{
+    doubleBuffered = enabled;
+}
+
+void setFramebufferSpiModel(bool enabled)
+{
+    spiModel = enabled;
+}
+
+FramebufferStats getFramebufferStats()
+{
+    return stats;
+}
+
+bool loadTouchScript(const char *path)
+{
+    FILE *file = fopen(path, "r");
+    if (!file)
+        return false;
+
+    char line[64];
+    while (fgets(line, sizeof(line), file))
+    {
+        TouchScriptEntry entry = {0, 0, 0, false};
+        char up[8];
+        int x, y;
+        if (sscanf(line, "%u %d %d", &entry.timeMs, &x, &y) == 3)
+        {
+            entry.x = x;
+            entry.y = y;
+            entry.pressed = true;
+        }
+        else if (sscanf(line, "%u %7s", &entry.timeMs, up) != 2 || strcmp(up, "up") != 0)
+        {
+            continue;
+        }
+
+        // Releases keep the last pressed point, as the real controller reports
+        if (!entry.pressed && !touchScript.empty())
+        {
+            entry.x = touchScript.back().x;
+            entry.y = touchScript.back().y;
+        }
+        touchScript.push_back(entry);
+    }
+
+    fclose(file);
+    return true;
+}
+
+bool saveFramebufferSnapshot(const char *path)
+{
+    FILE *file = fopen(path, "wb");
+    if (!file)
+        return false;
+
+    lv_display_t *disp = lv_display_get_default();
+    int32_t width = lv_display_get_horizontal_resolution(disp);
+    int32_t height = lv_display_get_vertical_resolution(disp);
+
+    fprintf(file, "P6\n%d %d\n255\n", (int)width, (int)height);
+    for (int32_t i = 0; i < width * height; i++)
+    {
+        uint16_t px = framebuffer[i];
+        uint8_t rgb[3] = {
+            (uint8_t)(((px >> 11) & 0x1f) << 3),
+            (uint8_t)(((px >> 5) & 0x3f) << 2),
+            (uint8_t)((px & 0x1f) << 3),
+        };
+        fwrite(rgb, 1, sizeof(rgb), file);
+    }
+
+    fclose(file);
+    return true;
+}
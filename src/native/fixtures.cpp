@@ -0,0 +1,111 @@
+#include "fixtures.h"
+
+#include <stdio.h>
+#include <string.h>
+
+#define FIXTURE_MARKETS 185 // Spotify lists every market a track is available in, twice
+
+std::string fixtureTime(time_t t)
+{
+    char buf[32];
+    strftime(buf, sizeof(buf), "%Y-%m-%dT%H:%M:%SZ", gmtime(&t));
+    return buf;
+}
+
+static std::string marketsJson()
+{
+    std::string json = "[";
+    for (int i = 0; i < FIXTURE_MARKETS; i++)
+    {
+        char code[8];
+        snprintf(code, sizeof(code), "%s\"%c%c\"", i ? "," : "", 'A' + i / 26, 'A' + i % 26);
+        json += code;
+    }
+    return json + "]";
+}
+
+std::string calendarEventJson(int index, time_t start, time_t end, const char *status)
+{
+    char id[32];
+    snprintf(id, sizeof(id), "evt%08dabcdef", index);
+    if (strcmp(status, "cancelled") == 0)
+        return std::string("{\"kind\":\"calendar#event\",\"etag\":\"\\\"3300000000\\\"\",\"id\":\"") + id +
+               "\",\"status\":\"cancelled\"}";
+
+    std::string attendees;
+    for (int j = 0; j < 4; j++)
+    {
+        char attendee[128];
+        snprintf(attendee, sizeof(attendee), "%s{\"email\":\"person%d@example.com\",\"responseStatus\":\"%s\"}",
+                 j ? "," : "", j, j % 2 ? "accepted" : "needsAction");
+        attendees += attendee;
+    }
+
+    char event[1024];
+    snprintf(event, sizeof(event),
+             "{\"kind\":\"calendar#event\",\"etag\":\"\\\"33%010ld\\\"\",\"id\":\"%s\",\"status\":\"%s\","
+             "\"htmlLink\":\"https://www.google.com/calendar/event?eid=ZXZ0%08d\",\"created\":\"2024-01-02T10:00:00.000Z\","
+             "\"updated\":\"2024-01-03T11:30:00.000Z\",\"summary\":\"Planning sync %d\","
+             "\"description\":\"Agenda: review last week, go over open items, agree on next steps. Join with the link below.\","
+             "\"location\":\"Room %d\",\"creator\":{\"email\":\"owner@example.com\",\"self\":true},"
+             "\"organizer\":{\"email\":\"owner@example.com\",\"self\":true},",
+             (long)(start % 10000000000L), id, status, index, index, 100 + index);
+
+    return event + std::string("\"start\":{\"dateTime\":\"") + fixtureTime(start) + "\",\"timeZone\":\"America/New_York\"},"
+                   "\"end\":{\"dateTime\":\"" + fixtureTime(end) + "\",\"timeZone\":\"America/New_York\"},"
+                   "\"iCalUID\":\"evt" + std::to_string(index) + "@google.com\",\"sequence\":0,\"attendees\":[" + attendees +
+           "],\"reminders\":{\"useDefault\":true},\"eventType\":\"default\"}";
+}
+
+std::string calendarListJson(const std::string &items, const char *nextSyncToken, const char *nextPageToken)
+{
+    std::string json = "{\"kind\":\"calendar#events\",\"etag\":\"\\\"p33c9o\\\"\",\"summary\":\"owner@example.com\","
+                       "\"updated\":\"2024-01-03T11:30:00.000Z\",\"timeZone\":\"America/New_York\",\"accessRole\":\"owner\","
+                       "\"defaultReminders\":[{\"method\":\"popup\",\"minutes\":10}],";
+    if (nextPageToken)
+        json += std::string("\"nextPageToken\":\"") + nextPageToken + "\",";
+    if (nextSyncToken)
+        json += std::string("\"nextSyncToken\":\"") + nextSyncToken + "\",";
+    return json + "\"items\":[" + items + "]}";
+}
+
+std::string spotifyFixture()
+{
+    std::string artist =
+        "{\"external_urls\":{\"spotify\":\"https://open.spotify.com/artist/0OdUWJ0sBjDrqHygGUXeCF\"},"
+        "\"href\":\"https://api.spotify.com/v1/artists/0OdUWJ0sBjDrqHygGUXeCF\",\"id\":\"0OdUWJ0sBjDrqHygGUXeCF\","
+        "\"name\":\"Band of Horses\",\"type\":\"artist\",\"uri\":\"spotify:artist:0OdUWJ0sBjDrqHygGUXeCF\"}";
+
+    std::string images;
+    for (int size : {640, 300, 64})
+    {
+        char image[160];
+        snprintf(image, sizeof(image), "%s{\"height\":%d,\"url\":\"https://i.scdn.co/image/ab67616d0000b273%08x\",\"width\":%d}",
+                 images.empty() ? "" : ",", size, size * 2654435761u, size);
+        images += image;
+    }
+
+    return "{\"timestamp\":1700000000000,\"context\":{\"external_urls\":{\"spotify\":\"https://open.spotify.com/playlist/37i9dQZF1DXcBWIGoYBM5M\"},"
+           "\"href\":\"https://api.spotify.com/v1/playlists/37i9dQZF1DXcBWIGoYBM5M\",\"type\":\"playlist\",\"uri\":\"spotify:playlist:37i9dQZF1DXcBWIGoYBM5M\"},"
+           "\"progress_ms\":44272,\"item\":{\"album\":{\"album_type\":\"album\",\"artists\":[" +
+           artist + "],\"available_markets\":" + marketsJson() +
+           ",\"external_urls\":{\"spotify\":\"https://open.spotify.com/album/5Zj7aHHEbRXoP5OWxLTN9q\"},"
+           "\"href\":\"https://api.spotify.com/v1/albums/5Zj7aHHEbRXoP5OWxLTN9q\",\"id\":\"5Zj7aHHEbRXoP5OWxLTN9q\",\"images\":[" +
+           images + "],\"name\":\"Everything All the Time\",\"release_date\":\"2006-03-21\",\"release_date_precision\":\"day\","
+                    "\"total_tracks\":10,\"type\":\"album\",\"uri\":\"spotify:album:5Zj7aHHEbRXoP5OWxLTN9q\"},\"artists\":[" +
+           artist + "],\"available_markets\":" + marketsJson() +
+           ",\"disc_number\":1,\"duration_ms\":301920,\"explicit\":false,\"external_ids\":{\"isrc\":\"USSUB0670204\"},"
+           "\"external_urls\":{\"spotify\":\"https://open.spotify.com/track/4BkSpWjYCMdEaBgcsE4xTZ\"},"
+           "\"href\":\"https://api.spotify.com/v1/tracks/4BkSpWjYCMdEaBgcsE4xTZ\",\"id\":\"4BkSpWjYCMdEaBgcsE4xTZ\",\"is_local\":false,"
+           "\"name\":\"The Funeral\",\"popularity\":71,\"preview_url\":null,\"track_number\":4,\"type\":\"track\","
+           "\"uri\":\"spotify:track:4BkSpWjYCMdEaBgcsE4xTZ\"},\"currently_playing_type\":\"track\","
+           "\"actions\":{\"disallows\":{\"resuming\":true}},\"is_playing\":true}";
+}
+
+std::string weatherFixture()
+{
+    return "{\"latitude\":40.71,\"longitude\":-74.01,\"generationtime_ms\":0.0269412994384766,\"utc_offset_seconds\":0,"
+           "\"timezone\":\"GMT\",\"timezone_abbreviation\":\"GMT\",\"elevation\":32.0,"
+           "\"current_units\":{\"time\":\"iso8601\",\"interval\":\"seconds\",\"temperature_2m\":\"°F\",\"weather_code\":\"wmo code\"},"
+           "\"current\":{\"time\":\"2024-01-03T12:00\",\"interval\":900,\"temperature_2m\":41.3,\"weather_code\":3}}";
+}
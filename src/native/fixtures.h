@@ -0,0 +1,29 @@
+#pragma once
+
+#include <string>
+#include <time.h>
+
+/**
+ * Canned API payloads for the native benchmarks, shaped like the real
+ * responses (field set and size) so parse cost and transfer size are
+ * representative
+ */
+
+/** RFC 3339 UTC timestamp, as the Calendar API writes them */
+std::string fixtureTime(time_t t);
+
+/** One item of a Calendar events list; status "cancelled" gives a deletion stub */
+std::string calendarEventJson(int index, time_t start, time_t end, const char *status = "confirmed");
+
+/**
+ * Calendar events list response around the given items; a page other than
+ * the last has a nextPageToken and no nextSyncToken
+ */
+std::string calendarListJson(const std::string &items, const char *nextSyncToken = NULL,
+                             const char *nextPageToken = NULL);
+
+/** Spotify currently-playing response for a track in every market */
+std::string spotifyFixture();
+
+/** Open-Meteo current conditions response */
+std::string weatherFixture();
@@ -0,0 +1,50 @@
+#pragma once
+
+#include <stdint.h>
+
+/**
+ * Counters collected by the native framebuffer display driver
+ */
+struct FramebufferStats
+{
+    uint32_t frames;          // Refresh cycles that flushed at least one area
+    uint64_t frameMicros;     // Total time spent in those refresh cycles
+    uint32_t maxFrameMicros;  // Slowest single refresh cycle
+    uint32_t flushes;         // Areas handed to the flush callback
+    uint64_t flushBytes;      // RGB565 bytes that would have gone over SPI
+    uint64_t spiBusyMicros;   // Modelled time the SPI bus spent transferring
+    uint64_t spiStallMicros;  // Time rendering was blocked waiting for the bus
+};
+
+/**
+ * Selects one or two draw buffers for the simulated panel. Must be called
+ * before initDisplay(). With two buffers the modelled SPI transfer of one
+ * chunk overlaps rendering of the next, as the DMA driver in display.cpp does.
+ */
+void setFramebufferDoubleBuffered(bool enabled);
+
+/**
+ * Enables or disables the SPI bandwidth model. Benchmarks that measure CPU
+ * cost only turn it off so modelled bus time does not pollute the results.
+ */
+void setFramebufferSpiModel(bool enabled);
+
+/**
+ * Returns a snapshot of the framebuffer counters since startup
+ */
+FramebufferStats getFramebufferStats();
+
+/**
+ * Loads a scripted touch sequence replayed by touchpadRead(). Each line is
+ * "<ms> <x> <y>" to press at a point or "<ms> up" to release, with times
+ * relative to program start and points in screen coordinates, the same
+ * space TouchInput maps the XPT2046 readings to.
+ * @return false if the file cannot be read
+ */
+bool loadTouchScript(const char *path);
+
+/**
+ * Writes the current framebuffer contents as a binary PPM image
+ * @return false if the file cannot be written
+ */
+bool saveFramebufferSnapshot(const char *path);
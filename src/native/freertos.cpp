@@ -0,0 +1,314 @@
+#include <Arduino.h>
+#include <pthread.h>
+#include <errno.h>
+#include <sys/mman.h>
+
+#define NATIVE_MIN_STACK (256 * 1024)
+#define NATIVE_STACK_FILL 0xA5
+#define NATIVE_MAX_TASKS 32
+
+struct NativeTask
+{
+    pthread_t thread = 0;
+    char name[16] = "";
+    TaskFunction_t taskCode = nullptr;
+    void *parameters = nullptr;
+    UBaseType_t priority = 0;
+    BaseType_t coreId = 0;
+    UBaseType_t number = 0;
+
+    // Stack painted with NATIVE_STACK_FILL, for the high-water mark
+    uint8_t *stack = nullptr;
+    size_t stackSize = 0;
+    uint32_t stackDepth = 0;
+
+    // Direct-to-task notification value
+    pthread_mutex_t notifyMutex = PTHREAD_MUTEX_INITIALIZER;
+    pthread_cond_t notifyCond = PTHREAD_COND_INITIALIZER;
+    uint32_t notifyValue = 0;
+};
+
+struct NativeSemaphore
+{
+    pthread_mutex_t mutex;
+};
+
+static thread_local NativeTask *currentTask = nullptr;
+
+// Live tasks, for uxTaskGetSystemState()
+static NativeTask *liveTasks[NATIVE_MAX_TASKS];
+static UBaseType_t liveTaskCount = 0;
+static UBaseType_t nextTaskNumber = 1;
+static pthread_mutex_t liveTasksMutex = PTHREAD_MUTEX_INITIALIZER;
+
+static void addLiveTask(NativeTask *task)
+{
+    pthread_mutex_lock(&liveTasksMutex);
+    task->number = nextTaskNumber++;
+    if (liveTaskCount < NATIVE_MAX_TASKS)
+        liveTasks[liveTaskCount++] = task;
+    pthread_mutex_unlock(&liveTasksMutex);
+}
+
+static void removeLiveTask(NativeTask *task)
+{
+    pthread_mutex_lock(&liveTasksMutex);
+    for (UBaseType_t i = 0; i < liveTaskCount; i++)
+    {
+        if (liveTasks[i] == task)
+        {
+            liveTasks[i] = liveTasks[--liveTaskCount];
+            break;
+        }
+    }
+    pthread_mutex_unlock(&liveTasksMutex);
+}
+
+// Threads not started through xTaskCreatePinnedToCore (i.e. main(), which
+// plays Arduino's loopTask) get a task record on first use
+static NativeTask *getCurrentTask()
+{
+    if (!currentTask)
+    {
+        currentTask = new NativeTask();
+        snprintf(currentTask->name, sizeof(currentTask->name), "loopTask");
+        currentTask->thread = pthread_self();
+        currentTask->priority = 1;
+        currentTask->coreId = 1;
+        addLiveTask(currentTask);
+    }
+    return currentTask;
+}
+
+static void *taskEntry(void *arg)
+{
+    NativeTask *task = (NativeTask *)arg;
+    currentTask = task;
+    task->taskCode(task->parameters);
+    removeLiveTask(task);
+    return nullptr;
+}
+
+BaseType_t xTaskCreatePinnedToCore(TaskFunction_t taskCode, const char *name, uint32_t stackDepth,
+                                   void *parameters, UBaseType_t priority, TaskHandle_t *createdTask,
+                                   BaseType_t coreId)
+{
+    NativeTask *task = new NativeTask();
+    snprintf(task->name, sizeof(task->name), "%s", name);
+    task->taskCode = taskCode;
+    task->parameters = parameters;
+    task->priority = priority;
+    task->coreId = coreId;
+
+    // Host frames are larger than Xtensa ones, so stackDepth is only a lower
+    // bound. The stack is mapped rather than malloc()ed to keep it out of the
+    // heap figures, and is never unmapped since tasks only end at exit.
+    task->stackDepth = stackDepth;
+    task->stackSize = stackDepth < NATIVE_MIN_STACK ? NATIVE_MIN_STACK : stackDepth;
+    void *stack = mmap(nullptr, task->stackSize, PROT_READ | PROT_WRITE, MAP_PRIVATE | MAP_ANONYMOUS | MAP_STACK, -1, 0);
+    if (stack == MAP_FAILED)
+    {
+        delete task;
+        return pdFAIL;
+    }
+    task->stack = (uint8_t *)stack;
+    memset(task->stack, NATIVE_STACK_FILL, task->stackSize);
+
+    pthread_attr_t attr;
+    pthread_attr_init(&attr);
+    pthread_attr_setstack(&attr, task->stack, task->stackSize);
+    pthread_attr_setdetachstate(&attr, PTHREAD_CREATE_DETACHED);
+    int err = pthread_create(&task->thread, &attr, taskEntry, task);
+    pthread_attr_destroy(&attr);
+
+    if (err != 0)
+    {
+        munmap(task->stack, task->stackSize);
+        delete task;
+        return pdFAIL;
+    }
+
+    pthread_setname_np(task->thread, task->name);
+    addLiveTask(task);
+    if (createdTask)
+        *createdTask = task;
+    return pdPASS;
+}
+
+void vTaskDelete(TaskHandle_t task)
+{
+    if (task != nullptr && task != getCurrentTask())
+        return;
+
+    removeLiveTask(getCurrentTask());
+    pthread_exit(nullptr);
+}
+
+UBaseType_t uxTaskGetStackHighWaterMark(TaskHandle_t task)
+{
+    if (!task)
+        task = getCurrentTask();
+    if (!task->stack)
+        return 0;
+
+    // The stack grows down, so untouched paint is at the low end
+    size_t untouched = 0;
+    while (untouched < task->stackSize && task->stack[untouched] == NATIVE_STACK_FILL)
+        untouched++;
+
+    size_t used = task->stackSize - untouched;
+    return used < task->stackDepth ? task->stackDepth - used : 0;
+}
+
+UBaseType_t uxTaskGetNumberOfTasks()
+{
+    pthread_mutex_lock(&liveTasksMutex);
+    UBaseType_t count = liveTaskCount;
+    pthread_mutex_unlock(&liveTasksMutex);
+    return count;
+}
+
+UBaseType_t uxTaskGetSystemState(TaskStatus_t *taskStatusArray, UBaseType_t arraySize, uint32_t *totalRunTime)
+{
+    pthread_mutex_lock(&liveTasksMutex);
+    if (liveTaskCount > arraySize)
+    {
+        pthread_mutex_unlock(&liveTasksMutex);
+        return 0;
+    }
+
+    for (UBaseType_t i = 0; i < liveTaskCount; i++)
+    {
+        NativeTask *task = liveTasks[i];
+        TaskStatus_t &status = taskStatusArray[i];
+        status.xHandle = task;
+        status.pcTaskName = task->name;
+        status.xTaskNumber = task->number;
+        status.uxCurrentPriority = task->priority;
+        status.usStackHighWaterMark = uxTaskGetStackHighWaterMark(task);
+        status.xCoreID = task->coreId;
+
+        clockid_t clock;
+        struct timespec ts = {};
+        if (pthread_getcpuclockid(task->thread, &clock) == 0)
+            clock_gettime(clock, &ts);
+        status.ulRunTimeCounter = (uint32_t)((uint64_t)ts.tv_sec * 1000000 + ts.tv_nsec / 1000);
+    }
+
+    UBaseType_t count = liveTaskCount;
+    pthread_mutex_unlock(&liveTasksMutex);
+    if (totalRunTime)
+        *totalRunTime = (uint32_t)micros();
+    return count;
+}
+
+void vTaskDelay(TickType_t ticks)
+{
+    struct timespec ts = {(time_t)(ticks / 1000), (long)(ticks % 1000) * 1000000L};
+    while (nanosleep(&ts, &ts) == -1 && errno == EINTR)
+        ;
+}
+
+void vTaskDelayUntil(TickType_t *previousWakeTime, TickType_t timeIncrement)
+{
+    TickType_t wakeTime = *previousWakeTime + timeIncrement;
+    TickType_t now = xTaskGetTickCount();
+
+    // Signed difference handles tick wrap-around like the real kernel
+    if ((int32_t)(wakeTime - now) > 0)
+        vTaskDelay(wakeTime - now);
+
+    *previousWakeTime = wakeTime;
+}
+
+TickType_t xTaskGetTickCount()
+{
+    return millis();
+}
+
+TaskHandle_t xTaskGetCurrentTaskHandle()
+{
+    return getCurrentTask();
+}
+
+const char *pcTaskGetName(TaskHandle_t task)
+{
+    return (task ? task : getCurrentTask())->name;
+}
+
+uint32_t ulTaskNotifyTake(BaseType_t clearCountOnExit, TickType_t ticksToWait)
+{
+    NativeTask *task = getCurrentTask();
+    pthread_mutex_lock(&task->notifyMutex);
+
+    if (task->notifyValue == 0 && ticksToWait > 0)
+    {
+        if (ticksToWait == portMAX_DELAY)
+        {
+            while (task->notifyValue == 0)
+                pthread_cond_wait(&task->notifyCond, &task->notifyMutex);
+        }
+        else
+        {
+            struct timespec deadline;
+            clock_gettime(CLOCK_REALTIME, &deadline);
+            deadline.tv_sec += ticksToWait / 1000;
+            deadline.tv_nsec += (long)(ticksToWait % 1000) * 1000000L;
+            if (deadline.tv_nsec >= 1000000000L)
+            {
+                deadline.tv_sec++;
+                deadline.tv_nsec -= 1000000000L;
+            }
+
+            while (task->notifyValue == 0 &&
+                   pthread_cond_timedwait(&task->notifyCond, &task->notifyMutex, &deadline) != ETIMEDOUT)
+                ;
+        }
+    }
+
+    uint32_t value = task->notifyValue;
+    if (value > 0)
+        task->notifyValue = clearCountOnExit ? 0 : value - 1;
+
+    pthread_mutex_unlock(&task->notifyMutex);
+    return value;
+}
+
+BaseType_t xTaskNotifyGive(TaskHandle_t task)
+{
+    pthread_mutex_lock(&task->notifyMutex);
+    task->notifyValue++;
+    pthread_cond_signal(&task->notifyCond);
+    pthread_mutex_unlock(&task->notifyMutex);
+    return pdPASS;
+}
+
+SemaphoreHandle_t xSemaphoreCreateMutex()
+{
+    NativeSemaphore *semaphore = new NativeSemaphore();
+    pthread_mutex_init(&semaphore->mutex, nullptr);
+    return semaphore;
+}
+
+BaseType_t xSemaphoreTake(SemaphoreHandle_t semaphore, TickType_t ticksToWait)
+{
+    if (ticksToWait == portMAX_DELAY)
+        return pthread_mutex_lock(&semaphore->mutex) == 0 ? pdTRUE : pdFALSE;
+
+    struct timespec deadline;
+    clock_gettime(CLOCK_REALTIME, &deadline);
+    deadline.tv_sec += ticksToWait / 1000;
+    deadline.tv_nsec += (long)(ticksToWait % 1000) * 1000000L;
+    if (deadline.tv_nsec >= 1000000000L)
+    {
+        deadline.tv_sec++;
+        deadline.tv_nsec -= 1000000000L;
+    }
+
+    return pthread_mutex_timedlock(&semaphore->mutex, &deadline) == 0 ? pdTRUE : pdFALSE;
+}
+
+BaseType_t xSemaphoreGive(SemaphoreHandle_t semaphore)
+{
+    return pthread_mutex_unlock(&semaphore->mutex) == 0 ? pdTRUE : pdFALSE;
+}
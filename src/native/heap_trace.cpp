@@ -0,0 +1,103 @@
+#include "heap_trace.h"
+
+#include <atomic>
+#include <errno.h>
+#include <malloc.h>
+#include <stdint.h>
+
+extern "C"
+{
+    void *__libc_malloc(size_t size);
+    void *__libc_calloc(size_t count, size_t size);
+    void *__libc_realloc(void *ptr, size_t size);
+    void *__libc_memalign(size_t alignment, size_t size);
+    void __libc_free(void *ptr);
+}
+
+// Signed so blocks allocated before interposition can't wrap the counter
+static std::atomic<int64_t> inUse{0};
+static std::atomic<int64_t> peak{0};
+
+static void *track(void *ptr)
+{
+    if (!ptr)
+        return ptr;
+
+    int64_t now = inUse.fetch_add(malloc_usable_size(ptr), std::memory_order_relaxed) + malloc_usable_size(ptr);
+    int64_t seen = peak.load(std::memory_order_relaxed);
+    while (now > seen && !peak.compare_exchange_weak(seen, now, std::memory_order_relaxed))
+        ;
+    return ptr;
+}
+
+static void untrack(void *ptr)
+{
+    if (ptr)
+        inUse.fetch_sub(malloc_usable_size(ptr), std::memory_order_relaxed);
+}
+
+extern "C"
+{
+    void *malloc(size_t size)
+    {
+        return track(__libc_malloc(size));
+    }
+
+    void *calloc(size_t count, size_t size)
+    {
+        return track(__libc_calloc(count, size));
+    }
+
+    void *realloc(void *ptr, size_t size)
+    {
+        size_t oldSize = ptr ? malloc_usable_size(ptr) : 0;
+        void *result = __libc_realloc(ptr, size);
+
+        // realloc(ptr, 0) frees; a failed resize leaves the old block alone
+        if (result || size == 0)
+            inUse.fetch_sub(oldSize, std::memory_order_relaxed);
+        return track(result);
+    }
+
+    void *memalign(size_t alignment, size_t size)
+    {
+        return track(__libc_memalign(alignment, size));
+    }
+
+    void *aligned_alloc(size_t alignment, size_t size)
+    {
+        return memalign(alignment, size);
+    }
+
+    int posix_memalign(void **out, size_t alignment, size_t size)
+    {
+        void *ptr = memalign(alignment, size);
+        if (!ptr)
+            return ENOMEM;
+        *out = ptr;
+        return 0;
+    }
+
+    void free(void *ptr)
+    {
+        untrack(ptr);
+        __libc_free(ptr);
+    }
+}
+
+size_t heapTraceInUse()
+{
+    int64_t now = inUse.load(std::memory_order_relaxed);
+    return now > 0 ? now : 0;
+}
+
+size_t heapTracePeak()
+{
+    int64_t seen = peak.load(std::memory_order_relaxed);
+    return seen > 0 ? seen : 0;
+}
+
+void heapTraceResetPeak()
+{
+    peak.store(inUse.load(std::memory_order_relaxed), std::memory_order_relaxed);
+}
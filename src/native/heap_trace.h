@@ -0,0 +1,25 @@
+#pragma once
+
+#include <stddef.h>
+
+/**
+ * The native build interposes malloc and friends to track live heap bytes
+ * and their high-water mark, which mallinfo2() cannot report. Sizes are
+ * usable sizes as reported by malloc_usable_size(), so they include the
+ * allocator's rounding but not its per-block headers.
+ */
+
+/**
+ * Bytes currently allocated by the whole process
+ */
+size_t heapTraceInUse();
+
+/**
+ * Highest heapTraceInUse() since the last heapTraceResetPeak()
+ */
+size_t heapTracePeak();
+
+/**
+ * Restarts peak tracking from the current usage
+ */
+void heapTraceResetPeak();
@@ -0,0 +1,246 @@
+#include <HTTPClient.h>
+
+bool HTTPClient::parseUrl(const String &url, bool &https)
+{
+    const char *rest = url.c_str();
+    if (strncmp(rest, "http://", 7) == 0)
+    {
+        rest += 7;
+        https = false;
+    }
+    else if (strncmp(rest, "https://", 8) == 0)
+    {
+        rest += 8;
+        https = true;
+    }
+    else
+    {
+        return false;
+    }
+
+    const char *pathStart = strchr(rest, '/');
+    String authority = pathStart ? String(rest, pathStart - rest) : String(rest);
+    _path = pathStart ? String(pathStart) : String("/");
+
+    int colon = authority.indexOf(':');
+    _host = colon >= 0 ? authority.substring(0, colon) : authority;
+    _port = colon >= 0 ? authority.substring(colon + 1).toInt() : (https ? 443 : 80);
+    return true;
+}
+
+bool HTTPClient::begin(const String &url)
+{
+    bool https;
+    _headers.clear();
+    if (!parseUrl(url, https))
+        return false;
+
+    _client = https ? (WiFiClient *)&_secureClient : &_plainClient;
+    return true;
+}
+
+bool HTTPClient::begin(WiFiClient &client, const String &url)
+{
+    bool https;
+    _headers.clear();
+    if (!parseUrl(url, https))
+        return false;
+
+    _client = &client;
+    return true;
+}
+
+void HTTPClient::addHeader(const String &name, const String &value)
+{
+    _headers.push_back({name, value});
+}
+
+int HTTPClient::GET()
+{
+    return sendRequest("GET", "");
+}
+
+int HTTPClient::POST(const String &payload)
+{
+    return sendRequest("POST", payload);
+}
+
+void HTTPClient::collectHeaders(const char *headerKeys[], size_t headerKeysCount)
+{
+    _collectedHeaders.clear();
+    for (size_t i = 0; i < headerKeysCount; i++)
+        _collectedHeaders.push_back({headerKeys[i], ""});
+}
+
+String HTTPClient::header(const char *name)
+{
+    for (const auto &header : _collectedHeaders)
+    {
+        if (header.first.equalsIgnoreCase(name))
+            return header.second;
+    }
+    return "";
+}
+
+WiFiClient *HTTPClient::getStreamPtr()
+{
+    if (!_client || !_client->connected())
+        return nullptr;
+
+    _bodyPending = false;
+    return _client;
+}
+
+String HTTPClient::getString()
+{
+    String body;
+    readBody(&body);
+    return body;
+}
+
+void HTTPClient::end()
+{
+    if (!_client)
+        return;
+
+    // Drain an unread body so the next request on this connection starts clean
+    if (_bodyPending && !readBody(NULL))
+        _canReuse = false;
+
+    if (!_reuse || !_canReuse)
+        _client->stop();
+
+    _client = nullptr;
+    _headers.clear();
+}
+
+bool HTTPClient::readLine(String &line)
+{
+    line = "";
+    while (true)
+    {
+        int c = _client->read();
+        if (c < 0)
+            return false;
+        if (c == '\n')
+            break;
+        if (c != '\r')
+            line += (char)c;
+    }
+    return true;
+}
+
+bool HTTPClient::readBody(String *out)
+{
+    if (!_bodyPending)
+        return true;
+    _bodyPending = false;
+
+    char buf[512];
+    if (_chunked)
+    {
+        String line;
+        while (readLine(line))
+        {
+            size_t chunkSize = strtoul(line.c_str(), NULL, 16);
+            if (chunkSize == 0)
+                return readLine(line); // Trailing CRLF after the last chunk
+
+            while (chunkSize > 0)
+            {
+                size_t count = _client->readBytes(buf, chunkSize < sizeof(buf) ? chunkSize : sizeof(buf));
+                if (count == 0)
+                    return false;
+                if (out)
+                    out->concat(buf, count);
+                chunkSize -= count;
+            }
+            readLine(line);
+        }
+        return false;
+    }
+
+    // Without a length the body ends when the server closes the connection
+    size_t remaining = _contentLength >= 0 ? _contentLength : SIZE_MAX;
+    while (remaining > 0)
+    {
+        size_t count = _client->readBytes(buf, remaining < sizeof(buf) ? remaining : sizeof(buf));
+        if (count == 0)
+            break;
+        if (out)
+            out->concat(buf, count);
+        remaining -= count;
+    }
+    return _contentLength < 0 || remaining == 0;
+}
+
+int HTTPClient::sendRequest(const char *method, const String &payload)
+{
+    if (!_client)
+        return HTTPC_ERROR_NOT_CONNECTED;
+
+    if (!_client->connected() && !_client->connect(_host.c_str(), _port))
+        return HTTPC_ERROR_CONNECTION_REFUSED;
+
+    String request = String(method) + " " + _path + " HTTP/1.1\r\n";
+    request += "Host: " + _host + "\r\n";
+    request += _reuse ? "Connection: keep-alive\r\n" : "Connection: close\r\n";
+    for (const auto &header : _headers)
+        request += header.first + ": " + header.second + "\r\n";
+    if (strcmp(method, "POST") == 0)
+        request += "Content-Length: " + String(payload.length()) + "\r\n";
+    request += "\r\n";
+    request += payload;
+
+    if (_client->write((const uint8_t *)request.c_str(), request.length()) != request.length())
+    {
+        _client->stop();
+        return HTTPC_ERROR_SEND_HEADER_FAILED;
+    }
+
+    String line;
+    if (!readLine(line) || !line.startsWith("HTTP/"))
+    {
+        _client->stop();
+        return HTTPC_ERROR_CONNECTION_LOST;
+    }
+    int code = atoi(line.c_str() + line.indexOf(' ') + 1);
+
+    _contentLength = -1;
+    _chunked = false;
+    _canReuse = line.startsWith("HTTP/1.1");
+    for (auto &header : _collectedHeaders)
+        header.second = "";
+    while (readLine(line) && line.length() > 0)
+    {
+        int colon = line.indexOf(':');
+        if (colon < 0)
+            continue;
+
+        String name = line.substring(0, colon);
+        String value = line.substring(colon + 1);
+        value.trim();
+        for (auto &header : _collectedHeaders)
+        {
+            if (header.first.equalsIgnoreCase(name))
+                header.second = value;
+        }
+
+        name.toLowerCase();
+        value.toLowerCase();
+
+        if (name == "content-length")
+            _contentLength = value.toInt();
+        else if (name == "transfer-encoding" && value == "chunked")
+            _chunked = true;
+        else if (name == "connection" && value == "close")
+            _canReuse = false;
+    }
+
+    if (_contentLength < 0 && !_chunked)
+        _canReuse = false;
+
+    bool noBody = strcmp(method, "HEAD") == 0 || code == 204 || code == 304 || code / 100 == 1;
+    _bodyPending = !noBody;
+    return code;
+}
@@ -0,0 +1,131 @@
+#pragma once
+
+/**
+ * Minimal Arduino core for the native build. Provides the timing, Serial and
+ * String APIs the app uses; FreeRTOS calls are shimmed onto pthreads in
+ * freertos/FreeRTOS.h.
+ */
+
+#include <ctype.h>
+#include <math.h>
+#include <stdarg.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+
+#include "WString.h"
+#include "Stream.h"
+#include "freertos/FreeRTOS.h"
+#include "freertos/task.h"
+#include "freertos/semphr.h"
+
+#define F(str) (str)
+
+// Plain statics: every run of the native program is a power-on
+#define RTC_NOINIT_ATTR
+// One kind of memory on the host
+#define IRAM_ATTR
+#define DRAM_ATTR
+
+#define HIGH 1
+#define LOW 0
+
+/** Milliseconds since program start */
+uint32_t millis();
+
+/** Microseconds since program start */
+uint64_t micros();
+
+void delay(uint32_t ms);
+
+/** Pseudo-random number in [0, max), like the ESP32 core's */
+long random(long max);
+/** Pseudo-random number in [min, max) */
+long random(long min, long max);
+
+inline long map(long x, long inMin, long inMax, long outMin, long outMax)
+{
+    return (x - inMin) * (outMax - outMin) / (inMax - inMin) + outMin;
+}
+
+/** The host has no PSRAM, like the CYD: callers fall back to malloc() */
+inline void *ps_malloc(size_t size)
+{
+    return NULL;
+}
+
+/**
+ * Sets the process timezone from a fixed offset, mirroring the ESP32 core's
+ * configTime(). NTP servers are ignored; the host clock is already synced.
+ */
+void configTime(long gmtOffsetSec, int daylightOffsetSec, const char *server1,
+                const char *server2 = nullptr, const char *server3 = nullptr);
+
+/** Sets the process timezone from a POSIX TZ string, like configTzTime() */
+void configTzTime(const char *tz, const char *server1, const char *server2 = nullptr,
+                  const char *server3 = nullptr);
+
+bool getLocalTime(struct tm *info, uint32_t ms = 5000);
+
+class HardwareSerial
+{
+public:
+    void begin(unsigned long baud) {}
+
+    size_t print(const char *str) { return fputs(str, stdout) >= 0 ? strlen(str) : 0; }
+    size_t print(const String &str) { return print(str.c_str()); }
+    size_t print(char c) { return putchar(c) != EOF; }
+    size_t print(int value) { return ::printf("%d", value); }
+    size_t print(unsigned int value) { return ::printf("%u", value); }
+    size_t print(long value) { return ::printf("%ld", value); }
+    size_t print(unsigned long value) { return ::printf("%lu", value); }
+    size_t print(double value, int decimals = 2) { return ::printf("%.*f", decimals, value); }
+
+    size_t println() { return print("\n"); }
+    template <typename T>
+    size_t println(const T &value)
+    {
+        size_t n = print(value);
+        return n + println();
+    }
+
+    size_t printf(const char *format, ...) __attribute__((format(printf, 2, 3)))
+    {
+        va_list args;
+        va_start(args, format);
+        int n = vprintf(format, args);
+        va_end(args);
+        return n < 0 ? 0 : n;
+    }
+
+    void flush() { fflush(stdout); }
+
+    /** Nothing is ever received: stdin is not wired up */
+    int available() { return 0; }
+    int read() { return -1; }
+};
+
+extern HardwareSerial Serial;
+
+class EspClass
+{
+public:
+    /** Free bytes in the malloc arena; the host has no fixed-size heap */
+    uint32_t getFreeHeap();
+
+    /** Lowest getFreeHeap() has returned so far */
+    uint32_t getMinFreeHeap();
+
+    /**
+     * Free chunk at the top of the arena, which glibc can hand out whole: a
+     * lower bound on the largest block, enough to follow fragmentation
+     */
+    uint32_t getMaxAllocHeap();
+};
+
+extern EspClass ESP;
+
+void setup();
+void loop();
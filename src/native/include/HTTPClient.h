@@ -0,0 +1,80 @@
+#pragma once
+
+#include <vector>
+
+#include "Arduino.h"
+#include "WiFiClient.h"
+#include "WiFiClientSecure.h"
+
+#define HTTPC_ERROR_CONNECTION_REFUSED (-1)
+#define HTTPC_ERROR_SEND_HEADER_FAILED (-2)
+#define HTTPC_ERROR_SEND_PAYLOAD_FAILED (-3)
+#define HTTPC_ERROR_NOT_CONNECTED (-4)
+#define HTTPC_ERROR_CONNECTION_LOST (-5)
+#define HTTPC_ERROR_READ_TIMEOUT (-11)
+
+typedef enum
+{
+    HTTP_CODE_OK = 200,
+    HTTP_CODE_NO_CONTENT = 204,
+    HTTP_CODE_NOT_MODIFIED = 304,
+    HTTP_CODE_UNAUTHORIZED = 401,
+    HTTP_CODE_GONE = 410,
+} t_http_codes;
+
+/**
+ * HTTP/1.1 client with the same surface as the ESP32 HTTPClient, running
+ * over the native WiFiClient/WiFiClientSecure. Like the real one it keeps
+ * the connection open after end() when setReuse(true) was called and the
+ * server allows keep-alive.
+ */
+class HTTPClient
+{
+public:
+    ~HTTPClient() { end(); }
+
+    bool begin(const String &url);
+    bool begin(WiFiClient &client, const String &url);
+    void setReuse(bool reuse) { _reuse = reuse; }
+    void addHeader(const String &name, const String &value);
+
+    int GET();
+    int POST(const String &payload);
+
+    /** Only the headers named here are kept; header() returns their raw value */
+    void collectHeaders(const char *headerKeys[], size_t headerKeysCount);
+    String header(const char *name);
+
+    String getString();
+    int getSize() { return _contentLength; }
+
+    /**
+     * The connection, positioned at the start of the body. The caller takes
+     * over reading the body, transfer encoding included.
+     */
+    WiFiClient *getStreamPtr();
+
+    void end();
+
+private:
+    WiFiClient *_client = nullptr;
+    WiFiClient _plainClient;
+    WiFiClientSecure _secureClient;
+
+    String _host;
+    uint16_t _port = 80;
+    String _path;
+    bool _reuse = false;
+    std::vector<std::pair<String, String>> _headers;
+    std::vector<std::pair<String, String>> _collectedHeaders;
+
+    int _contentLength = -1;
+    bool _chunked = false;
+    bool _canReuse = false;
+    bool _bodyPending = false;
+
+    bool parseUrl(const String &url, bool &https);
+    int sendRequest(const char *method, const String &payload);
+    bool readLine(String &line);
+    bool readBody(String *out);
+};
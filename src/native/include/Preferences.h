@@ -0,0 +1,52 @@
+#pragma once
+
+#include "Arduino.h"
+
+/**
+ * Host stand-in for the ESP32 Preferences (NVS) library. Each namespace is
+ * a directory and each key a file under $CLOCK_NVS_DIR (default .clock_nvs
+ * in the working directory), so stored values survive restarts of the
+ * native program just as they survive reboots on the device.
+ */
+class Preferences
+{
+public:
+    bool begin(const char *name, bool readOnly = false);
+    void end() { _dir = ""; }
+
+    bool clear();
+    bool remove(const char *key);
+    bool isKey(const char *key);
+
+    size_t putBytes(const char *key, const void *value, size_t len);
+    size_t getBytesLength(const char *key);
+    size_t getBytes(const char *key, void *buf, size_t maxLen);
+
+    size_t putString(const char *key, const char *value) { return putBytes(key, value, strlen(value)); }
+    size_t putString(const char *key, const String &value) { return putString(key, value.c_str()); }
+    String getString(const char *key, const String &defaultValue = String());
+    /** Copies the string with its terminator; 0 if missing or longer than maxLen */
+    size_t getString(const char *key, char *value, size_t maxLen);
+
+    size_t putUInt(const char *key, uint32_t value) { return putBytes(key, &value, sizeof(value)); }
+    uint32_t getUInt(const char *key, uint32_t defaultValue = 0) { return getValue(key, defaultValue); }
+    size_t putInt(const char *key, int32_t value) { return putBytes(key, &value, sizeof(value)); }
+    int32_t getInt(const char *key, int32_t defaultValue = 0) { return getValue(key, defaultValue); }
+    size_t putULong64(const char *key, uint64_t value) { return putBytes(key, &value, sizeof(value)); }
+    uint64_t getULong64(const char *key, uint64_t defaultValue = 0) { return getValue(key, defaultValue); }
+    size_t putLong64(const char *key, int64_t value) { return putBytes(key, &value, sizeof(value)); }
+    int64_t getLong64(const char *key, int64_t defaultValue = 0) { return getValue(key, defaultValue); }
+
+private:
+    String _dir;
+    bool _readOnly = false;
+
+    String path(const char *key) const { return _dir + "/" + key; }
+
+    template <typename T>
+    T getValue(const char *key, T defaultValue)
+    {
+        T value;
+        return getBytesLength(key) == sizeof(T) && getBytes(key, &value, sizeof(T)) == sizeof(T) ? value : defaultValue;
+    }
+};
@@ -0,0 +1,36 @@
+#pragma once
+
+#include <stddef.h>
+#include <stdint.h>
+
+/**
+ * Host stand-in for the Arduino Stream interface. Implementations only need
+ * to provide available(), read() and peek(); readBytes() loops over read().
+ */
+class Stream
+{
+public:
+    virtual ~Stream() {}
+
+    virtual int available() = 0;
+    virtual int read() = 0;
+    virtual int peek() = 0;
+
+    virtual size_t readBytes(char *buffer, size_t length)
+    {
+        size_t count = 0;
+        while (count < length)
+        {
+            int c = read();
+            if (c < 0)
+                break;
+            buffer[count++] = (char)c;
+        }
+        return count;
+    }
+
+    size_t readBytes(uint8_t *buffer, size_t length)
+    {
+        return readBytes((char *)buffer, length);
+    }
+};
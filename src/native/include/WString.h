@@ -0,0 +1,123 @@
+#pragma once
+
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <strings.h>
+#include <string>
+
+/**
+ * Host stand-in for the Arduino String class, backed by std::string.
+ * Only the subset of the API used by the app is provided.
+ */
+class String
+{
+public:
+    String() {}
+    String(const char *str) : _str(str ? str : "") {}
+    String(const char *str, size_t length) : _str(str ? std::string(str, length) : "") {}
+    String(const std::string &str) : _str(str) {}
+    String(char c) : _str(1, c) {}
+    String(int value) : _str(std::to_string(value)) {}
+    String(unsigned int value) : _str(std::to_string(value)) {}
+    String(long value) : _str(std::to_string(value)) {}
+    String(unsigned long value) : _str(std::to_string(value)) {}
+    String(long long value) : _str(std::to_string(value)) {}
+    String(unsigned long long value) : _str(std::to_string(value)) {}
+    String(float value, unsigned int decimals = 2) : String((double)value, decimals) {}
+    String(double value, unsigned int decimals = 2)
+    {
+        char buf[32];
+        snprintf(buf, sizeof(buf), "%.*f", decimals, value);
+        _str = buf;
+    }
+
+    const char *c_str() const { return _str.c_str(); }
+    unsigned int length() const { return _str.length(); }
+    bool isEmpty() const { return _str.empty(); }
+    char charAt(unsigned int index) const { return index < _str.length() ? _str[index] : 0; }
+    char operator[](unsigned int index) const { return charAt(index); }
+    void reserve(unsigned int size) { _str.reserve(size); }
+
+    bool concat(const char *str)
+    {
+        if (str)
+            _str += str;
+        return true;
+    }
+    bool concat(const char *str, unsigned int length)
+    {
+        if (str)
+            _str.append(str, length);
+        return true;
+    }
+    bool concat(char c)
+    {
+        _str += c;
+        return true;
+    }
+    bool concat(const String &str)
+    {
+        _str += str._str;
+        return true;
+    }
+
+    String &operator+=(const String &rhs)
+    {
+        _str += rhs._str;
+        return *this;
+    }
+    String &operator+=(const char *rhs)
+    {
+        concat(rhs);
+        return *this;
+    }
+    String &operator+=(char rhs)
+    {
+        _str += rhs;
+        return *this;
+    }
+
+    friend String operator+(const String &lhs, const String &rhs) { return String(lhs._str + rhs._str); }
+    friend String operator+(const String &lhs, const char *rhs) { return String(lhs._str + (rhs ? rhs : "")); }
+    friend String operator+(const char *lhs, const String &rhs) { return String((lhs ? lhs : "") + rhs._str); }
+
+    bool operator==(const String &rhs) const { return _str == rhs._str; }
+    bool operator==(const char *rhs) const { return _str == (rhs ? rhs : ""); }
+    bool operator!=(const String &rhs) const { return _str != rhs._str; }
+    bool operator!=(const char *rhs) const { return !(*this == rhs); }
+
+    int indexOf(char c, unsigned int from = 0) const
+    {
+        size_t pos = _str.find(c, from);
+        return pos == std::string::npos ? -1 : (int)pos;
+    }
+    int indexOf(const char *str, unsigned int from = 0) const
+    {
+        size_t pos = _str.find(str, from);
+        return pos == std::string::npos ? -1 : (int)pos;
+    }
+    String substring(unsigned int from) const { return from < _str.length() ? String(_str.substr(from)) : String(); }
+    String substring(unsigned int from, unsigned int to) const
+    {
+        return from < to && from < _str.length() ? String(_str.substr(from, to - from)) : String();
+    }
+    bool equalsIgnoreCase(const String &rhs) const { return strcasecmp(c_str(), rhs.c_str()) == 0; }
+    bool startsWith(const char *prefix) const { return _str.compare(0, strlen(prefix), prefix) == 0; }
+    int toInt() const { return atoi(_str.c_str()); }
+    void trim()
+    {
+        size_t begin = _str.find_first_not_of(" \t\r\n");
+        size_t end = _str.find_last_not_of(" \t\r\n");
+        _str = begin == std::string::npos ? "" : _str.substr(begin, end - begin + 1);
+    }
+    void toLowerCase()
+    {
+        for (char &c : _str)
+            c = (c >= 'A' && c <= 'Z') ? c - 'A' + 'a' : c;
+    }
+
+private:
+    std::string _str;
+};
@@ -0,0 +1,88 @@
+#pragma once
+
+#include "Arduino.h"
+
+typedef enum
+{
+    WL_IDLE_STATUS = 0,
+    WL_NO_SSID_AVAIL = 1,
+    WL_CONNECTED = 3,
+    WL_CONNECT_FAILED = 4,
+    WL_CONNECTION_LOST = 5,
+    WL_DISCONNECTED = 6,
+} wl_status_t;
+
+typedef enum
+{
+    WIFI_OFF = 0,
+    WIFI_STA = 1,
+} wifi_mode_t;
+
+typedef enum
+{
+    ARDUINO_EVENT_WIFI_STA_CONNECTED = 4,
+    ARDUINO_EVENT_WIFI_STA_DISCONNECTED = 5,
+    ARDUINO_EVENT_WIFI_STA_GOT_IP = 7,
+    ARDUINO_EVENT_WIFI_STA_LOST_IP = 8,
+} arduino_event_id_t;
+
+// The disconnect reasons the app distinguishes, as in esp_wifi_types.h
+#define WIFI_REASON_ASSOC_LEAVE 8
+#define WIFI_REASON_BEACON_TIMEOUT 200
+#define WIFI_REASON_NO_AP_FOUND 201
+#define WIFI_REASON_AUTH_FAIL 202
+
+typedef union
+{
+    struct
+    {
+        uint8_t ssid[33];
+        uint8_t ssid_len;
+        uint8_t bssid[6];
+        uint8_t reason;
+    } wifi_sta_disconnected;
+    struct
+    {
+        uint8_t ssid[33];
+        uint8_t ssid_len;
+        uint8_t bssid[6];
+        uint8_t channel;
+    } wifi_sta_connected;
+} arduino_event_info_t;
+
+typedef void (*WiFiEventFuncCb)(arduino_event_id_t event, arduino_event_info_t info);
+
+/**
+ * The host is always online, so the station is simulated: begin() raises
+ * STA_GOT_IP on an event thread after $CLOCK_WIFI_CONNECT_MS (default 0),
+ * standing in for scanning, association and DHCP, or after
+ * $CLOCK_WIFI_FAST_CONNECT_MS when given the access point's BSSID and
+ * channel, which skips the scan. The simulate*() hooks let benchmarks drop
+ * the link or move the access point.
+ */
+class WiFiClass
+{
+public:
+    wl_status_t begin(const char *ssid, const char *passphrase = nullptr, int32_t channel = 0,
+                      const uint8_t *bssid = nullptr, bool connect = true);
+    bool disconnect(bool wifiOff = false, bool eraseAp = false);
+    wl_status_t status();
+
+    bool mode(wifi_mode_t mode) { return true; }
+    void persistent(bool persistent) {}
+    bool setAutoReconnect(bool autoReconnect) { return true; }
+    int onEvent(WiFiEventFuncCb callback);
+
+    uint8_t *BSSID();
+    int32_t channel();
+    int8_t RSSI() { return -55; }
+    String localIP() { return "127.0.0.1"; }
+
+    /** Drops the link as if the access point went away */
+    void simulateLinkLoss(uint8_t reason = WIFI_REASON_BEACON_TIMEOUT);
+
+    /** Moves the access point to a new BSSID and channel */
+    void simulateApChange();
+};
+
+extern WiFiClass WiFi;
@@ -0,0 +1,48 @@
+#pragma once
+
+#include <sys/types.h>
+
+#include "Arduino.h"
+
+/**
+ * Buffered TCP client over a POSIX socket with the ESP32 WiFiClient surface.
+ * When CLOCK_REDIRECT_HTTP ("host:port") is set, every connection goes to
+ * that address instead, so a local stand-in server can answer for any host.
+ */
+class WiFiClient : public Stream
+{
+public:
+    virtual ~WiFiClient() { stop(); }
+
+    virtual int connect(const char *host, uint16_t port);
+    virtual void stop();
+    virtual uint8_t connected();
+
+    virtual size_t write(const uint8_t *buf, size_t size);
+    int available() override;
+    int read() override;
+    int peek() override;
+    virtual int read(uint8_t *buf, size_t size);
+    size_t readBytes(char *buffer, size_t length) override;
+
+    void setTimeout(uint32_t timeoutMs) { _timeoutMs = timeoutMs; }
+
+protected:
+    int _fd = -1;
+    uint32_t _timeoutMs = 5000;
+
+    /** Picks the address to dial, applying the redirect from the named variable */
+    int connectSocket(const char *host, uint16_t port, const char *redirectEnv);
+
+    /** Raw transport hooks; WiFiClientSecure routes them through TLS */
+    virtual ssize_t recvRaw(uint8_t *buf, size_t size);
+    virtual ssize_t sendRaw(const uint8_t *buf, size_t size);
+    virtual size_t pendingRaw() { return 0; }
+
+private:
+    uint8_t _buf[1024];
+    size_t _bufPos = 0;
+    size_t _bufLen = 0;
+
+    bool fill(bool wait);
+};
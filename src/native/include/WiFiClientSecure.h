@@ -0,0 +1,37 @@
+#pragma once
+
+#include "WiFiClient.h"
+
+typedef struct ssl_st SSL;
+typedef struct ssl_session_st SSL_SESSION;
+
+/**
+ * TLS client backed by OpenSSL. Certificates are not verified, matching
+ * setInsecure() on the device. The session from the last handshake is kept
+ * and offered on the next connect(), so reconnects to the same server can
+ * resume instead of doing a full handshake. Redirected by
+ * CLOCK_REDIRECT_HTTPS ("host:port"); SNI still carries the original host.
+ */
+class WiFiClientSecure : public WiFiClient
+{
+public:
+    ~WiFiClientSecure();
+
+    int connect(const char *host, uint16_t port) override;
+    void stop() override;
+
+    void setInsecure() {}
+
+    /** True if the last connect() resumed a previous session */
+    bool sessionReused() const { return _sessionReused; }
+
+protected:
+    ssize_t recvRaw(uint8_t *buf, size_t size) override;
+    ssize_t sendRaw(const uint8_t *buf, size_t size) override;
+    size_t pendingRaw() override;
+
+private:
+    SSL *_ssl = nullptr;
+    SSL_SESSION *_session = nullptr;
+    bool _sessionReused = false;
+};
@@ -0,0 +1,9 @@
+#pragma once
+
+#include "WString.h"
+
+class base64
+{
+public:
+    static String encode(const String &text);
+};
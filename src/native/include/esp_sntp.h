@@ -0,0 +1,15 @@
+#pragma once
+
+#include <stdint.h>
+#include <sys/time.h>
+
+/**
+ * The host clock is kept in sync by the OS, so configTzTime() runs the sync
+ * notification straight away
+ */
+typedef void (*sntp_sync_time_cb_t)(struct timeval *tv);
+
+void sntp_set_time_sync_notification_cb(sntp_sync_time_cb_t callback);
+
+/** Ignored: the host clock needs no polling */
+void sntp_set_sync_interval(uint32_t intervalMs);
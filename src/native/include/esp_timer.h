@@ -0,0 +1,6 @@
+#pragma once
+
+#include <stdint.h>
+
+/** Microseconds since boot from a monotonic clock, like micros() */
+int64_t esp_timer_get_time();
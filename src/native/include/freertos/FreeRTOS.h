@@ -0,0 +1,25 @@
+#pragma once
+
+/**
+ * FreeRTOS shim for the native build. Ticks are milliseconds and tasks are
+ * pthreads; core affinity and priorities are recorded but not enforced.
+ */
+
+#include <stdint.h>
+
+typedef uint32_t TickType_t;
+typedef int BaseType_t;
+typedef unsigned int UBaseType_t;
+
+#define portMAX_DELAY ((TickType_t)0xffffffffUL)
+#define portTICK_PERIOD_MS 1
+#define pdMS_TO_TICKS(ms) ((TickType_t)(ms))
+
+#define pdFALSE 0
+#define pdTRUE 1
+#define pdFAIL pdFALSE
+#define pdPASS pdTRUE
+
+// uxTaskGetSystemState() and its per-task run times are available
+#define configUSE_TRACE_FACILITY 1
+#define configGENERATE_RUN_TIME_STATS 1
@@ -0,0 +1,53 @@
+#pragma once
+
+#include "FreeRTOS.h"
+
+typedef void (*TaskFunction_t)(void *);
+typedef struct NativeTask *TaskHandle_t;
+
+BaseType_t xTaskCreatePinnedToCore(TaskFunction_t taskCode, const char *name, uint32_t stackDepth,
+                                   void *parameters, UBaseType_t priority, TaskHandle_t *createdTask,
+                                   BaseType_t coreId);
+
+/** Deletes the calling task when task is NULL; deleting other tasks is not supported */
+void vTaskDelete(TaskHandle_t task);
+
+void vTaskDelay(TickType_t ticks);
+void vTaskDelayUntil(TickType_t *previousWakeTime, TickType_t timeIncrement);
+TickType_t xTaskGetTickCount();
+
+TaskHandle_t xTaskGetCurrentTaskHandle();
+
+/**
+ * Least free stack a task (NULL for the caller) has had, in bytes, measured
+ * against the stackDepth it was created with. Host frames are bigger than
+ * Xtensa ones, so this reads low compared to the board.
+ */
+UBaseType_t uxTaskGetStackHighWaterMark(TaskHandle_t task);
+
+typedef struct
+{
+    TaskHandle_t xHandle;
+    const char *pcTaskName;
+    UBaseType_t xTaskNumber; // In creation order
+    UBaseType_t uxCurrentPriority;
+    uint32_t ulRunTimeCounter; // CPU time of the thread, in microseconds
+    uint32_t usStackHighWaterMark; // As uxTaskGetStackHighWaterMark()
+    BaseType_t xCoreID;
+} TaskStatus_t;
+
+UBaseType_t uxTaskGetNumberOfTasks();
+
+/**
+ * Fills in one status per live task, main() included once it has used the
+ * FreeRTOS API
+ * @param totalRunTime Set to microseconds since start, the same clock as
+ *        ulRunTimeCounter, so a thread busy on one core gains as fast
+ * @return Tasks filled in, or 0 if taskStatusArray is too small
+ */
+UBaseType_t uxTaskGetSystemState(TaskStatus_t *taskStatusArray, UBaseType_t arraySize, uint32_t *totalRunTime);
+
+/** Waits for a direct-to-task notification, returning the count before it was taken */
+uint32_t ulTaskNotifyTake(BaseType_t clearCountOnExit, TickType_t ticksToWait);
+BaseType_t xTaskNotifyGive(TaskHandle_t task);
+const char *pcTaskGetName(TaskHandle_t task);
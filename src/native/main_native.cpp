@@ -0,0 +1,205 @@
+#include <Arduino.h>
+#include <lvgl.h>
+#include <malloc.h>
+#include <unistd.h>
+
+#include "hardware.h"
+#include "ui_queue.h"
+#include "gui_task.h"
+#include "bench.h"
+#include "framebuffer.h"
+#include "display_stats.h"
+#include "http_pool.h"
+#include "fetch_scheduler.h"
+#include "boot_timeline.h"
+#include "wifi_manager.h"
+#include "time_service.h"
+#include "clock_tick.h"
+#include "trace.h"
+
+struct Benchmark
+{
+    const char *name;
+    void (*run)();
+};
+
+static const Benchmark benchmarks[] = {
+    {"clock", runClockBenchmark},
+    {"uiqueue", runUiQueueBenchmark},
+    {"json", runJsonBenchmark},
+    {"calendar", runCalendarBenchmark},
+    {"rfc3339", runRfc3339Benchmark},
+    {"spotify", runSpotifyBenchmark},
+    {"albumart", runAlbumArtBenchmark},
+    {"oauth", runOAuthBenchmark},
+    {"wifi", runWiFiBenchmark},
+    {"time", runTimeBenchmark},
+    {"tick", runTickBenchmark},
+    {"touch", runTouchBenchmark},
+    {"rotate", runRotateBenchmark},
+    {"marquee", runMarqueeBenchmark},
+    {"kernels", runKernelsBenchmark},
+    {"trace", runTraceBenchmark},
+    {"metrics", runMetricsBenchmark},
+};
+
+static void printUsage(const char *program)
+{
+    printf("Usage: %s [--duration <sec>] [--touch <script>] [--snapshot <file.ppm>] [--single-buffer] [--trace]\n",
+           program);
+    printf("       %s --bench <name>\n", program);
+    printf("  --duration  run for this many seconds, then print a report and exit\n");
+    printf("  --touch     replay a touch script (see framebuffer.h for the format)\n");
+    printf("  --snapshot  write the final framebuffer as a PPM image on exit\n");
+    printf("  --single-buffer  flush synchronously from one draw buffer instead of two\n");
+    printf("  --trace     print the timing trace on exit, for tools/trace_to_chrome.py\n");
+    printf("  --bench     run a benchmark instead of the app:");
+    for (const Benchmark &bench : benchmarks)
+        printf(" %s", bench.name);
+    printf("\n");
+}
+
+static void printReport(uint32_t elapsedMs)
+{
+    // Read while guiTask keeps running, so counters may be a frame apart
+    FramebufferStats fb = getFramebufferStats();
+    DisplayStats display = getDisplayStats();
+    UiQueueStats ui = getUiQueueStats();
+    GuiTaskStats gui = getGuiTaskStats();
+    HttpPoolStats http = HttpPool::getStats();
+    FetchSchedulerStats fetch = FetchScheduler::getStats();
+    WiFiManagerStats wifi = WiFiManager::getStats();
+    TimeServiceStats sntp = TimeService::getStats();
+    ClockTickStats tick = ClockTick::getStats();
+    lv_mem_monitor_t mem;
+    lv_mem_monitor(&mem);
+
+    struct mallinfo2 heap = mallinfo2();
+    float seconds = elapsedMs / 1000.0f;
+
+    printf("\n=== native report (%.1f s) ===\n", seconds);
+    printf("frames:        %u (%.1f fps)\n", fb.frames, fb.frames / seconds);
+    printf("frame time:    avg %.0f us, max %u us\n",
+           fb.frames ? (double)fb.frameMicros / fb.frames : 0.0, fb.maxFrameMicros);
+    printf("flushes:       %u (%llu bytes, %.0f bytes/s)\n",
+           fb.flushes, (unsigned long long)fb.flushBytes, fb.flushBytes / seconds);
+    printf("invalidated:   %u areas (%.1f/s), %u px rendered (%.0f px/s)\n",
+           display.areasInvalidated, display.areasInvalidated / seconds,
+           display.pixelsRendered, display.pixelsRendered / seconds);
+    printf("ui updates:    %u posted, %u applied, %u coalesced, %u overwritten\n",
+           ui.posted, ui.applied, ui.coalesced, ui.overwritten);
+    printf("guiTask:       %u wakeups (%.1f/s, %u notified), %.1f%% idle\n",
+           gui.wakeups, gui.wakeups / seconds, gui.notifiedWakeups,
+           gui.elapsedMicros ? 100.0 - gui.busyMicros * 100.0 / gui.elapsedMicros : 100.0);
+    printf("spi model:     %.0f ms busy, %.0f ms render stalled (%u Hz)\n",
+           fb.spiBusyMicros / 1000.0, fb.spiStallMicros / 1000.0, (unsigned)SPI_FREQUENCY);
+    printf("http pool:     %u reused, %u opened, %u stale retries, %u evicted, %u unpooled\n",
+           http.hits, http.misses, http.staleRetries, http.evictions, http.unpooled);
+    printf("tls handshake: %u (avg %.0f ms, max %u ms)\n", http.handshakes,
+           http.handshakes ? (double)http.handshakeMsTotal / http.handshakes : 0.0, http.handshakeMsMax);
+    printf("fetch worker:  %u batches (%u radio), stack high water %u bytes\n", fetch.batches, fetch.radioBatches,
+           fetch.stackHighWater);
+    for (uint32_t i = 0; i < fetch.jobCount; i++)
+    {
+        const FetchJobStats &job = fetch.jobs[i];
+        printf("  %-14s %u runs, %u early, max %u ms late, max %u ms busy\n", job.name, job.runs, job.earlyRuns,
+               job.maxLateMs, job.busyMsMax);
+    }
+    printf("wifi:          %u connects (%u cached AP, %u scan), %u drops, max %u ms to reconnect\n", wifi.connects,
+           wifi.fastConnects, wifi.scanConnects, wifi.disconnects, wifi.latencyMsMax);
+    printf("time:          %u syncs (%u stepped), last offset %d ms, drift %.2f ppm, %d ms left to slew\n",
+           sntp.syncs, sntp.steps, (int)sntp.lastOffsetMs, sntp.driftPpb / 1000.0, (int)sntp.slewRemainingMs);
+    printf("clock tick:    %.0f wakeups/h (%u kicked, %u early), %.0f GUI posts/h, %u unchanged\n",
+           tick.wakeups * 3600.0 / seconds, tick.kicks, tick.early, tick.posts * 3600.0 / seconds, tick.unchanged);
+    printf("lvgl heap:     %u used / %u total, max %u, frag %u%%\n",
+           (unsigned)(mem.total_size - mem.free_size), (unsigned)mem.total_size,
+           (unsigned)mem.max_used, (unsigned)mem.frag_pct);
+    printf("process heap:  %zu bytes in use\n", heap.uordblks);
+    bootTimelinePrint();
+}
+
+static int runBenchmark(const char *name)
+{
+    for (const Benchmark &bench : benchmarks)
+    {
+        if (strcmp(bench.name, name) != 0)
+            continue;
+
+        lv_init();
+        initDisplay();
+        lv_tick_set_cb(millis);
+        TimeService::begin();
+        bench.run();
+        return 0;
+    }
+
+    fprintf(stderr, "Unknown benchmark %s\n", name);
+    return 1;
+}
+
+int main(int argc, char **argv)
+{
+    uint32_t durationSec = 0;
+    const char *snapshotPath = NULL;
+    bool dumpTrace = false;
+
+    for (int i = 1; i < argc; i++)
+    {
+        if (strcmp(argv[i], "--duration") == 0 && i + 1 < argc)
+        {
+            durationSec = atoi(argv[++i]);
+        }
+        else if (strcmp(argv[i], "--touch") == 0 && i + 1 < argc)
+        {
+            if (!loadTouchScript(argv[++i]))
+            {
+                fprintf(stderr, "Cannot read touch script %s\n", argv[i]);
+                return 1;
+            }
+        }
+        else if (strcmp(argv[i], "--snapshot") == 0 && i + 1 < argc)
+        {
+            snapshotPath = argv[++i];
+        }
+        else if (strcmp(argv[i], "--bench") == 0 && i + 1 < argc)
+        {
+            setvbuf(stdout, NULL, _IOLBF, 0);
+            return runBenchmark(argv[++i]);
+        }
+        else if (strcmp(argv[i], "--single-buffer") == 0)
+        {
+            setFramebufferDoubleBuffered(false);
+        }
+        else if (strcmp(argv[i], "--trace") == 0)
+        {
+            dumpTrace = true;
+        }
+        else
+        {
+            printUsage(argv[0]);
+            return strcmp(argv[i], "--help") == 0 ? 0 : 1;
+        }
+    }
+
+    setvbuf(stdout, NULL, _IOLBF, 0);
+    setup();
+
+    if (durationSec == 0)
+    {
+        loop();
+        return 0;
+    }
+
+    uint32_t start = millis();
+    vTaskDelay(pdMS_TO_TICKS(durationSec * 1000));
+    printReport(millis() - start);
+    if (dumpTrace)
+        traceDump();
+
+    if (snapshotPath && !saveFramebufferSnapshot(snapshotPath))
+        fprintf(stderr, "Cannot write snapshot %s\n", snapshotPath);
+
+    // Tasks are detached and never return, so leave without running destructors under them
+    fflush(stdout);
+    _exit(0);
+}
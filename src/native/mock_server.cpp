@@ -0,0 +1,250 @@
+#include "mock_server.h"
+
+#include <arpa/inet.h>
+#include <netinet/in.h>
+#include <openssl/err.h>
+#include <openssl/ssl.h>
+#include <openssl/x509.h>
+#include <sys/socket.h>
+#include <thread>
+#include <unistd.h>
+
+#define MOCK_CHUNK_SIZE 1024
+
+/**
+ * One accepted connection, plain or TLS
+ */
+struct MockConnection
+{
+    int fd;
+    SSL *ssl;
+
+    ssize_t receive(char *buf, size_t size)
+    {
+        return ssl ? SSL_read(ssl, buf, size) : recv(fd, buf, size, 0);
+    }
+
+    bool sendAll(const char *data, size_t size)
+    {
+        while (size > 0)
+        {
+            ssize_t sent = ssl ? SSL_write(ssl, data, size) : send(fd, data, size, MSG_NOSIGNAL);
+            if (sent <= 0)
+                return false;
+            data += sent;
+            size -= sent;
+        }
+        return true;
+    }
+
+    bool readUntil(std::string &buffer, const char *marker, size_t &end)
+    {
+        char chunk[1024];
+        while ((end = buffer.find(marker)) == std::string::npos)
+        {
+            ssize_t received = receive(chunk, sizeof(chunk));
+            if (received <= 0)
+                return false;
+            buffer.append(chunk, received);
+        }
+        return true;
+    }
+};
+
+String MockRequest::header(const char *name) const
+{
+    for (const auto &header : headers)
+    {
+        if (header.first.equalsIgnoreCase(name))
+            return header.second;
+    }
+    return "";
+}
+
+MockServer::~MockServer()
+{
+    stop();
+}
+
+bool MockServer::createTlsContext()
+{
+    EVP_PKEY *key = EVP_EC_gen("P-256");
+    X509 *cert = X509_new();
+    if (!key || !cert)
+        return false;
+
+    ASN1_INTEGER_set(X509_get_serialNumber(cert), 1);
+    X509_gmtime_adj(X509_getm_notBefore(cert), 0);
+    X509_gmtime_adj(X509_getm_notAfter(cert), 24 * 3600);
+    X509_set_pubkey(cert, key);
+    X509_NAME *name = X509_get_subject_name(cert);
+    X509_NAME_add_entry_by_txt(name, "CN", MBSTRING_ASC, (const unsigned char *)"localhost", -1, -1, 0);
+    X509_set_issuer_name(cert, name);
+    X509_sign(cert, key, EVP_sha256());
+
+    _tls = SSL_CTX_new(TLS_server_method());
+    bool ok = _tls && SSL_CTX_use_certificate(_tls, cert) == 1 && SSL_CTX_use_PrivateKey(_tls, key) == 1;
+
+    X509_free(cert);
+    EVP_PKEY_free(key);
+    return ok;
+}
+
+bool MockServer::start(MockHandler handler, bool tls)
+{
+    _handler = handler;
+    if (tls && !createTlsContext())
+        return false;
+
+    _listenFd = socket(AF_INET, SOCK_STREAM, 0);
+    if (_listenFd < 0)
+        return false;
+
+    struct sockaddr_in addr = {};
+    addr.sin_family = AF_INET;
+    addr.sin_addr.s_addr = htonl(INADDR_LOOPBACK);
+    addr.sin_port = 0;
+
+    socklen_t length = sizeof(addr);
+    if (bind(_listenFd, (struct sockaddr *)&addr, sizeof(addr)) != 0 || listen(_listenFd, 8) != 0 ||
+        getsockname(_listenFd, (struct sockaddr *)&addr, &length) != 0)
+    {
+        stop();
+        return false;
+    }
+
+    _port = ntohs(addr.sin_port);
+    std::thread(&MockServer::acceptLoop, this).detach();
+    return true;
+}
+
+void MockServer::stop()
+{
+    if (_listenFd >= 0)
+    {
+        shutdown(_listenFd, SHUT_RDWR);
+        close(_listenFd);
+    }
+    _listenFd = -1;
+}
+
+String MockServer::url(const char *path) const
+{
+    char buf[40];
+    snprintf(buf, sizeof(buf), "%s://127.0.0.1:%u", _tls ? "https" : "http", _port);
+    return String(buf) + path;
+}
+
+void MockServer::acceptLoop()
+{
+    while (true)
+    {
+        int fd = accept(_listenFd, NULL, NULL);
+        if (fd < 0)
+            return;
+        std::thread(&MockServer::serve, this, fd).detach();
+    }
+}
+
+void MockServer::serve(int fd)
+{
+    MockConnection connection = {fd, nullptr};
+    if (_tls)
+    {
+        connection.ssl = SSL_new(_tls);
+        SSL_set_fd(connection.ssl, fd);
+        if (SSL_accept(connection.ssl) != 1)
+        {
+            SSL_free(connection.ssl);
+            close(fd);
+            return;
+        }
+    }
+
+    std::string buffer;
+    size_t headerEnd;
+
+    while (connection.readUntil(buffer, "\r\n\r\n", headerEnd))
+    {
+        MockRequest request;
+        std::string head = buffer.substr(0, headerEnd);
+        buffer.erase(0, headerEnd + 4);
+
+        size_t lineEnd = head.find("\r\n");
+        std::string requestLine = head.substr(0, lineEnd);
+        size_t space = requestLine.find(' ');
+        request.method = requestLine.substr(0, space).c_str();
+        request.path = requestLine.substr(space + 1, requestLine.rfind(' ') - space - 1).c_str();
+
+        while (lineEnd != std::string::npos)
+        {
+            size_t start = lineEnd + 2;
+            lineEnd = head.find("\r\n", start);
+            std::string line = head.substr(start, lineEnd == std::string::npos ? std::string::npos : lineEnd - start);
+            size_t colon = line.find(':');
+            if (colon == std::string::npos)
+                continue;
+
+            String value = line.substr(colon + 1).c_str();
+            value.trim();
+            request.headers.push_back({line.substr(0, colon).c_str(), value});
+        }
+
+        size_t contentLength = request.header("Content-Length").toInt();
+        char chunk[1024];
+        while (buffer.size() < contentLength)
+        {
+            ssize_t received = connection.receive(chunk, sizeof(chunk));
+            if (received <= 0)
+                break;
+            buffer.append(chunk, received);
+        }
+        request.body = buffer.substr(0, contentLength).c_str();
+        buffer.erase(0, contentLength);
+        _requests++;
+
+        MockResponse response = _handler(request);
+
+        char line[64];
+        snprintf(line, sizeof(line), "HTTP/1.1 %d Mock\r\n", response.status);
+        String out = line;
+        for (const auto &header : response.headers)
+            out += header.first + ": " + header.second + "\r\n";
+
+        bool hasBody = response.status != 204 && response.status != 304;
+        if (hasBody && response.chunked)
+            out += "Transfer-Encoding: chunked\r\n";
+        else if (hasBody)
+            out += "Content-Length: " + String(response.body.length()) + "\r\n";
+        out += "\r\n";
+
+        if (hasBody && response.chunked)
+        {
+            for (size_t offset = 0; offset < response.body.length(); offset += MOCK_CHUNK_SIZE)
+            {
+                size_t size = response.body.length() - offset;
+                size = size < MOCK_CHUNK_SIZE ? size : MOCK_CHUNK_SIZE;
+                snprintf(line, sizeof(line), "%zx\r\n", size);
+                out += line;
+                out.concat(response.body.c_str() + offset, size);
+                out += "\r\n";
+            }
+            out += "0\r\n\r\n";
+        }
+        else if (hasBody)
+        {
+            out += response.body;
+        }
+
+        if (!connection.sendAll(out.c_str(), out.length()))
+            break;
+        _bytesSent += out.length();
+    }
+
+    if (connection.ssl)
+    {
+        SSL_shutdown(connection.ssl);
+        SSL_free(connection.ssl);
+    }
+    close(fd);
+}
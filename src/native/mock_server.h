@@ -0,0 +1,70 @@
+#pragma once
+
+#include <Arduino.h>
+#include <atomic>
+#include <functional>
+#include <vector>
+
+typedef struct ssl_ctx_st SSL_CTX;
+
+/**
+ * Request as seen by a MockServer handler
+ */
+struct MockRequest
+{
+    String method;
+    String path; // Including the query string
+    std::vector<std::pair<String, String>> headers;
+    String body;
+
+    /** Value of a request header, or "" when absent */
+    String header(const char *name) const;
+};
+
+struct MockResponse
+{
+    int status = 200;
+    std::vector<std::pair<String, String>> headers;
+    String body;
+    bool chunked = false; // Send the body in chunks instead of with a Content-Length
+};
+
+typedef std::function<MockResponse(const MockRequest &)> MockHandler;
+
+/**
+ * Minimal HTTP/1.1 server on a loopback port for the native benchmarks, so
+ * API clients can be exercised end to end without the real services.
+ * Connections are kept alive and each one is served on its own thread. In
+ * TLS mode it presents a throwaway self-signed certificate; point the
+ * clients' https:// requests at it with CLOCK_REDIRECT_HTTPS.
+ */
+class MockServer
+{
+public:
+    ~MockServer();
+
+    /** Listens on an ephemeral port; the handler runs on connection threads */
+    bool start(MockHandler handler, bool tls = false);
+    void stop();
+
+    uint16_t port() const { return _port; }
+
+    /** Absolute URL for a path on this server */
+    String url(const char *path) const;
+
+    /** Requests served, and response bytes (headers and body) sent back */
+    uint32_t requests() const { return _requests; }
+    uint64_t bytesSent() const { return _bytesSent; }
+
+private:
+    int _listenFd = -1;
+    SSL_CTX *_tls = nullptr;
+    uint16_t _port = 0;
+    MockHandler _handler;
+    std::atomic<uint32_t> _requests{0};
+    std::atomic<uint64_t> _bytesSent{0};
+
+    void acceptLoop();
+    void serve(int fd);
+    bool createTlsContext();
+};
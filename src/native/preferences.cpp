@@ -0,0 +1,120 @@
+#include <Preferences.h>
+#include <dirent.h>
+#include <errno.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+bool Preferences::begin(const char *name, bool readOnly)
+{
+    const char *root = getenv("CLOCK_NVS_DIR");
+    String base = root && *root ? root : ".clock_nvs";
+    mkdir(base.c_str(), 0755);
+
+    _dir = base + "/" + name;
+    _readOnly = readOnly;
+    return mkdir(_dir.c_str(), 0755) == 0 || errno == EEXIST;
+}
+
+bool Preferences::clear()
+{
+    if (_dir.isEmpty() || _readOnly)
+        return false;
+
+    DIR *dir = opendir(_dir.c_str());
+    if (!dir)
+        return false;
+
+    struct dirent *entry;
+    while ((entry = readdir(dir)) != NULL)
+    {
+        if (entry->d_name[0] != '.')
+            unlink(path(entry->d_name).c_str());
+    }
+    closedir(dir);
+    return true;
+}
+
+bool Preferences::remove(const char *key)
+{
+    return !_dir.isEmpty() && !_readOnly && unlink(path(key).c_str()) == 0;
+}
+
+bool Preferences::isKey(const char *key)
+{
+    struct stat st;
+    return !_dir.isEmpty() && stat(path(key).c_str(), &st) == 0;
+}
+
+size_t Preferences::putBytes(const char *key, const void *value, size_t len)
+{
+    if (_dir.isEmpty() || _readOnly)
+        return 0;
+
+    // Write and rename so a crash never leaves a torn value, as NVS guarantees
+    String target = path(key);
+    String temp = target + ".tmp";
+    FILE *file = fopen(temp.c_str(), "wb");
+    if (!file)
+        return 0;
+
+    size_t written = fwrite(value, 1, len, file);
+    fclose(file);
+    if (written != len || rename(temp.c_str(), target.c_str()) != 0)
+        return 0;
+    return len;
+}
+
+size_t Preferences::getBytesLength(const char *key)
+{
+    struct stat st;
+    if (_dir.isEmpty() || stat(path(key).c_str(), &st) != 0)
+        return 0;
+    return st.st_size;
+}
+
+size_t Preferences::getBytes(const char *key, void *buf, size_t maxLen)
+{
+    size_t length = getBytesLength(key);
+    if (length == 0 || length > maxLen)
+        return 0;
+
+    FILE *file = fopen(path(key).c_str(), "rb");
+    if (!file)
+        return 0;
+
+    size_t count = fread(buf, 1, length, file);
+    fclose(file);
+    return count;
+}
+
+size_t Preferences::getString(const char *key, char *value, size_t maxLen)
+{
+    if (!isKey(key))
+        return 0;
+
+    size_t length = getBytesLength(key);
+    if (length + 1 > maxLen || getBytes(key, value, length) != length)
+        return 0;
+    value[length] = '\0';
+    return length + 1;
+}
+
+String Preferences::getString(const char *key, const String &defaultValue)
+{
+    size_t length = getBytesLength(key);
+    if (length == 0)
+        return defaultValue;
+
+    String value;
+    value.reserve(length);
+    char buf[256];
+    FILE *file = fopen(path(key).c_str(), "rb");
+    if (!file)
+        return defaultValue;
+
+    size_t count;
+    while ((count = fread(buf, 1, sizeof(buf), file)) > 0)
+        value.concat(buf, count);
+    fclose(file);
+    return value;
+}
@@ -0,0 +1,121 @@
+#include <WiFi.h>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+static std::recursive_mutex wifiMutex;
+static std::vector<WiFiEventFuncCb> callbacks;
+static uint32_t attempt;  // Bumped by every begin() and disconnect(), cancelling pending connects
+static bool connected;
+static uint8_t apBssid[6] = {0x02, 0x00, 0x5e, 0x10, 0x00, 0x01};
+static uint8_t apChannel = 6;
+
+static uint32_t envMs(const char *name, uint32_t defaultMs)
+{
+    const char *value = getenv(name);
+    return value && *value ? atoi(value) : defaultMs;
+}
+
+/** Runs the callbacks one at a time, as the ESP32 event task does */
+static void dispatch(arduino_event_id_t event, const arduino_event_info_t &info)
+{
+    for (WiFiEventFuncCb callback : callbacks)
+        callback(event, info);
+}
+
+static void dispatchDisconnected(uint8_t reason)
+{
+    arduino_event_info_t info = {};
+    info.wifi_sta_disconnected.reason = reason;
+    dispatch(ARDUINO_EVENT_WIFI_STA_DISCONNECTED, info);
+}
+
+wl_status_t WiFiClass::begin(const char *ssid, const char *passphrase, int32_t channel, const uint8_t *bssid,
+                             bool connect)
+{
+    uint32_t thisAttempt;
+    bool direct = bssid && channel > 0;
+    bool found;
+    {
+        std::lock_guard<std::recursive_mutex> lock(wifiMutex);
+        thisAttempt = ++attempt;
+        connected = false;
+        found = !direct || (memcmp(bssid, apBssid, sizeof(apBssid)) == 0 && channel == apChannel);
+    }
+
+    uint32_t delayMs = direct ? envMs("CLOCK_WIFI_FAST_CONNECT_MS", envMs("CLOCK_WIFI_CONNECT_MS", 0))
+                              : envMs("CLOCK_WIFI_CONNECT_MS", 0);
+    std::thread([=]()
+                {
+                    delay(delayMs);
+                    std::lock_guard<std::recursive_mutex> lock(wifiMutex);
+                    if (attempt != thisAttempt)
+                        return;
+
+                    if (!found)
+                    {
+                        dispatchDisconnected(WIFI_REASON_NO_AP_FOUND);
+                        return;
+                    }
+
+                    connected = true;
+                    arduino_event_info_t info = {};
+                    memcpy(info.wifi_sta_connected.bssid, apBssid, sizeof(apBssid));
+                    info.wifi_sta_connected.channel = apChannel;
+                    dispatch(ARDUINO_EVENT_WIFI_STA_CONNECTED, info);
+                    dispatch(ARDUINO_EVENT_WIFI_STA_GOT_IP, info); })
+        .detach();
+    return WL_DISCONNECTED;
+}
+
+bool WiFiClass::disconnect(bool wifiOff, bool eraseAp)
+{
+    std::lock_guard<std::recursive_mutex> lock(wifiMutex);
+    attempt++;
+    if (connected)
+    {
+        connected = false;
+        dispatchDisconnected(WIFI_REASON_ASSOC_LEAVE);
+    }
+    return true;
+}
+
+wl_status_t WiFiClass::status()
+{
+    std::lock_guard<std::recursive_mutex> lock(wifiMutex);
+    return connected ? WL_CONNECTED : WL_DISCONNECTED;
+}
+
+int WiFiClass::onEvent(WiFiEventFuncCb callback)
+{
+    std::lock_guard<std::recursive_mutex> lock(wifiMutex);
+    callbacks.push_back(callback);
+    return callbacks.size();
+}
+
+uint8_t *WiFiClass::BSSID()
+{
+    return apBssid;
+}
+
+int32_t WiFiClass::channel()
+{
+    return apChannel;
+}
+
+void WiFiClass::simulateLinkLoss(uint8_t reason)
+{
+    std::lock_guard<std::recursive_mutex> lock(wifiMutex);
+    if (connected)
+    {
+        connected = false;
+        dispatchDisconnected(reason);
+    }
+}
+
+void WiFiClass::simulateApChange()
+{
+    std::lock_guard<std::recursive_mutex> lock(wifiMutex);
+    apBssid[5]++;
+    apChannel = apChannel % 11 + 1;
+}
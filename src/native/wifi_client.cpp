@@ -0,0 +1,261 @@
+#include <WiFiClient.h>
+#include <WiFiClientSecure.h>
+#include <errno.h>
+#include <netdb.h>
+#include <poll.h>
+#include <sys/socket.h>
+#include <unistd.h>
+#include <openssl/ssl.h>
+
+static int dial(const char *host, uint16_t port)
+{
+    struct addrinfo hints = {};
+    hints.ai_family = AF_UNSPEC;
+    hints.ai_socktype = SOCK_STREAM;
+
+    char portStr[8];
+    snprintf(portStr, sizeof(portStr), "%u", port);
+
+    struct addrinfo *result;
+    if (getaddrinfo(host, portStr, &hints, &result) != 0)
+        return -1;
+
+    int fd = -1;
+    for (struct addrinfo *addr = result; addr != NULL; addr = addr->ai_next)
+    {
+        fd = socket(addr->ai_family, addr->ai_socktype, addr->ai_protocol);
+        if (fd < 0)
+            continue;
+
+        if (connect(fd, addr->ai_addr, addr->ai_addrlen) == 0)
+            break;
+
+        close(fd);
+        fd = -1;
+    }
+
+    freeaddrinfo(result);
+    return fd;
+}
+
+int WiFiClient::connectSocket(const char *host, uint16_t port, const char *redirectEnv)
+{
+    stop();
+
+    const char *redirect = getenv(redirectEnv);
+    if (redirect && *redirect)
+    {
+        String target(redirect);
+        int colon = target.indexOf(':');
+        String redirectHost = colon >= 0 ? target.substring(0, colon) : target;
+        uint16_t redirectPort = colon >= 0 ? target.substring(colon + 1).toInt() : port;
+        _fd = dial(redirectHost.c_str(), redirectPort);
+    }
+    else
+    {
+        _fd = dial(host, port);
+    }
+
+    return _fd >= 0;
+}
+
+int WiFiClient::connect(const char *host, uint16_t port)
+{
+    return connectSocket(host, port, "CLOCK_REDIRECT_HTTP");
+}
+
+void WiFiClient::stop()
+{
+    if (_fd >= 0)
+        close(_fd);
+    _fd = -1;
+    _bufPos = _bufLen = 0;
+}
+
+uint8_t WiFiClient::connected()
+{
+    if (_bufPos < _bufLen || pendingRaw() > 0)
+        return 1;
+    if (_fd < 0)
+        return 0;
+
+    // A readable socket with nothing to read means the peer closed it
+    char probe;
+    ssize_t peeked = recv(_fd, &probe, 1, MSG_PEEK | MSG_DONTWAIT);
+    if (peeked == 0 || (peeked < 0 && errno != EAGAIN && errno != EWOULDBLOCK))
+    {
+        stop();
+        return 0;
+    }
+    return 1;
+}
+
+ssize_t WiFiClient::recvRaw(uint8_t *buf, size_t size)
+{
+    return recv(_fd, buf, size, 0);
+}
+
+ssize_t WiFiClient::sendRaw(const uint8_t *buf, size_t size)
+{
+    return send(_fd, buf, size, MSG_NOSIGNAL);
+}
+
+bool WiFiClient::fill(bool wait)
+{
+    if (_bufPos < _bufLen)
+        return true;
+    if (_fd < 0)
+        return false;
+
+    if (pendingRaw() == 0)
+    {
+        struct pollfd pfd = {_fd, POLLIN, 0};
+        if (poll(&pfd, 1, wait ? (int)_timeoutMs : 0) <= 0)
+            return false;
+    }
+
+    ssize_t received = recvRaw(_buf, sizeof(_buf));
+    if (received <= 0)
+    {
+        if (received == 0)
+            stop();
+        return false;
+    }
+
+    _bufPos = 0;
+    _bufLen = received;
+    return true;
+}
+
+size_t WiFiClient::write(const uint8_t *buf, size_t size)
+{
+    size_t written = 0;
+    while (_fd >= 0 && written < size)
+    {
+        ssize_t sent = sendRaw(buf + written, size - written);
+        if (sent <= 0)
+            break;
+        written += sent;
+    }
+    return written;
+}
+
+int WiFiClient::available()
+{
+    fill(false);
+    return _bufLen - _bufPos;
+}
+
+int WiFiClient::read()
+{
+    if (!fill(true))
+        return -1;
+    return _buf[_bufPos++];
+}
+
+int WiFiClient::peek()
+{
+    if (!fill(true))
+        return -1;
+    return _buf[_bufPos];
+}
+
+int WiFiClient::read(uint8_t *buf, size_t size)
+{
+    if (!fill(true))
+        return -1;
+
+    size_t count = size < _bufLen - _bufPos ? size : _bufLen - _bufPos;
+    memcpy(buf, _buf + _bufPos, count);
+    _bufPos += count;
+    return count;
+}
+
+size_t WiFiClient::readBytes(char *buffer, size_t length)
+{
+    size_t total = 0;
+    while (total < length)
+    {
+        int count = read((uint8_t *)buffer + total, length - total);
+        if (count <= 0)
+            break;
+        total += count;
+    }
+    return total;
+}
+
+static SSL_CTX *sslContext()
+{
+    static SSL_CTX *ctx = nullptr;
+    if (!ctx)
+    {
+        ctx = SSL_CTX_new(TLS_client_method());
+        SSL_CTX_set_verify(ctx, SSL_VERIFY_NONE, NULL);
+        SSL_CTX_set_session_cache_mode(ctx, SSL_SESS_CACHE_CLIENT);
+    }
+    return ctx;
+}
+
+WiFiClientSecure::~WiFiClientSecure()
+{
+    stop();
+    if (_session)
+        SSL_SESSION_free(_session);
+}
+
+int WiFiClientSecure::connect(const char *host, uint16_t port)
+{
+    if (!connectSocket(host, port, "CLOCK_REDIRECT_HTTPS"))
+        return 0;
+
+    _ssl = SSL_new(sslContext());
+    SSL_set_fd(_ssl, _fd);
+    SSL_set_tlsext_host_name(_ssl, host);
+    if (_session)
+        SSL_set_session(_ssl, _session);
+
+    if (SSL_connect(_ssl) != 1)
+    {
+        stop();
+        return 0;
+    }
+
+    _sessionReused = SSL_session_reused(_ssl);
+
+    // TLS 1.3 tickets may arrive after the handshake; get1 returns the latest
+    if (_session)
+        SSL_SESSION_free(_session);
+    _session = SSL_get1_session(_ssl);
+    return 1;
+}
+
+void WiFiClientSecure::stop()
+{
+    if (_ssl)
+    {
+        if (_session)
+            SSL_SESSION_free(_session);
+        _session = SSL_get1_session(_ssl);
+        SSL_shutdown(_ssl);
+        SSL_free(_ssl);
+        _ssl = nullptr;
+    }
+    WiFiClient::stop();
+}
+
+ssize_t WiFiClientSecure::recvRaw(uint8_t *buf, size_t size)
+{
+    int received = SSL_read(_ssl, buf, size);
+    return received > 0 ? received : (SSL_get_error(_ssl, received) == SSL_ERROR_ZERO_RETURN ? 0 : -1);
+}
+
+ssize_t WiFiClientSecure::sendRaw(const uint8_t *buf, size_t size)
+{
+    int sent = SSL_write(_ssl, buf, size);
+    return sent > 0 ? sent : -1;
+}
+
+size_t WiFiClientSecure::pendingRaw()
+{
+    return _ssl ? SSL_pending(_ssl) : 0;
+}
@@ -0,0 +1,183 @@
+#include "oauth_token.h"
+#include "http_pool.h"
+#include "http_body_stream.h"
+#include "time_service.h"
+
+#include <ArduinoJson.h>
+#include <HTTPClient.h>
+#include <Preferences.h>
+#include <base64.h>
+
+#define OAUTH_NVS_NAMESPACE "oauth"
+#define OAUTH_DEFAULT_LIFETIME_SEC 3600 // When the response has no expires_in
+#define OAUTH_REFRESH_AHEAD_SEC 300     // Refresh this long before expiry...
+#define OAUTH_REFRESH_AHEAD_FRACTION 4  // ...or a quarter of the lifetime if that is shorter
+#define OAUTH_EXPIRY_MARGIN_SEC 30      // get() treats tokens this close to expiry as expired
+#define OAUTH_RETRY_MIN_MS 5000
+#define OAUTH_RETRY_MAX_MS (5 * 60 * 1000)
+
+OAuthToken::OAuthToken(const char *name, const char *tokenUrl, const char *clientId, const char *clientSecret,
+                       const char *refreshToken, OAuthClientAuth clientAuth)
+    : _name(name), _tokenUrl(tokenUrl), _clientId(clientId), _clientSecret(clientSecret),
+      _refreshToken(refreshToken), _clientAuth(clientAuth), _expiresAt(0), _lifetimeSec(0), _retryMs(0),
+      _loaded(false), _stats()
+{
+}
+
+uint32_t OAuthToken::refreshAheadSec() const
+{
+    uint32_t fraction = _lifetimeSec / OAUTH_REFRESH_AHEAD_FRACTION;
+    return fraction < OAUTH_REFRESH_AHEAD_SEC ? fraction : OAUTH_REFRESH_AHEAD_SEC;
+}
+
+uint32_t OAuthToken::secondsLeft()
+{
+    if (!_loaded)
+        load();
+
+    time_t now = TimeService::now();
+    return !_token.isEmpty() && _expiresAt > now ? _expiresAt - now : 0;
+}
+
+String OAuthToken::get()
+{
+    if (secondsLeft() > OAUTH_EXPIRY_MARGIN_SEC)
+        return _token;
+
+    // maintain() should have refreshed it already; this is the fallback
+    _stats.syncRefreshes++;
+    return refresh() ? _token : String();
+}
+
+void OAuthToken::invalidate()
+{
+    _token = "";
+    _expiresAt = 0;
+    _loaded = true; // The copy in NVS is no better
+}
+
+uint32_t OAuthToken::maintain()
+{
+    uint32_t left = secondsLeft();
+    uint32_t ahead = refreshAheadSec();
+
+    // Also refresh when run up to the job's slack early, so a coalesced run
+    // isn't wasted
+    if (left > ahead + OAUTH_REFRESH_SLACK_MS / 1000)
+        return (left - ahead) * 1000;
+
+    if (refresh())
+    {
+        _retryMs = 0;
+        return (secondsLeft() - refreshAheadSec()) * 1000;
+    }
+
+    // Jittered so clients that failed together don't retry together
+    _retryMs = _retryMs == 0 ? OAUTH_RETRY_MIN_MS : _retryMs * 2;
+    if (_retryMs > OAUTH_RETRY_MAX_MS)
+        _retryMs = OAUTH_RETRY_MAX_MS;
+    return _retryMs / 2 + random(_retryMs / 2 + 1);
+}
+
+bool OAuthToken::refresh()
+{
+    Serial.printf("Refreshing %s token...\n", _name);
+
+    HTTPClient *http = HttpPool::begin(_tokenUrl);
+    if (!http)
+    {
+        _stats.failures++;
+        return false;
+    }
+
+    http->addHeader("Content-Type", "application/x-www-form-urlencoded");
+    String body = "grant_type=refresh_token&refresh_token=" + String(_refreshToken);
+    if (_clientAuth == OAUTH_CLIENT_AUTH_BASIC)
+        http->addHeader("Authorization", "Basic " + base64::encode(String(_clientId) + ":" + String(_clientSecret)));
+    else
+        body += "&client_id=" + String(_clientId) + "&client_secret=" + String(_clientSecret);
+
+    bool refreshed = false;
+    int httpCode = HttpPool::POST(http, body);
+    if (httpCode == HTTP_CODE_OK)
+    {
+        // Google adds an id_token that can be larger than the access token
+        StaticJsonDocument<64> filter;
+        filter["access_token"] = true;
+        filter["expires_in"] = true;
+
+        HttpBodyStream response(*http);
+        StaticJsonDocument<1024> doc;
+        DeserializationError error = deserializeJson(doc, response, DeserializationOption::Filter(filter));
+        const char *token = doc["access_token"];
+        if (!error && token && *token)
+        {
+            _token = token;
+            _lifetimeSec = doc["expires_in"] | OAUTH_DEFAULT_LIFETIME_SEC;
+            _expiresAt = TimeService::now() + _lifetimeSec;
+            refreshed = true;
+        }
+    }
+    else
+    {
+        Serial.printf("%s token refresh failed: %d\n", _name, httpCode);
+    }
+    HttpPool::end(http);
+
+    if (!refreshed)
+    {
+        _stats.failures++;
+        return false;
+    }
+
+    _stats.refreshes++;
+    save();
+    return true;
+}
+
+void OAuthToken::load()
+{
+    _loaded = true;
+    if (!TimeService::isSet())
+        return;
+
+    char expiryKey[16];
+    snprintf(expiryKey, sizeof(expiryKey), "%s_exp", _name);
+    char lifetimeKey[16];
+    snprintf(lifetimeKey, sizeof(lifetimeKey), "%s_life", _name);
+
+    Preferences prefs;
+    if (!prefs.begin(OAUTH_NVS_NAMESPACE, true))
+        return;
+
+    time_t expiresAt = prefs.getLong64(expiryKey, 0);
+    if (expiresAt > TimeService::now() + OAUTH_EXPIRY_MARGIN_SEC)
+    {
+        _token = prefs.getString(_name);
+        _expiresAt = expiresAt;
+        _lifetimeSec = prefs.getUInt(lifetimeKey, OAUTH_DEFAULT_LIFETIME_SEC);
+        if (!_token.isEmpty())
+            _stats.nvsLoads++;
+    }
+    prefs.end();
+}
+
+void OAuthToken::save()
+{
+    if (!TimeService::isSet())
+        return;
+
+    char expiryKey[16];
+    snprintf(expiryKey, sizeof(expiryKey), "%s_exp", _name);
+    char lifetimeKey[16];
+    snprintf(lifetimeKey, sizeof(lifetimeKey), "%s_life", _name);
+
+    Preferences prefs;
+    if (!prefs.begin(OAUTH_NVS_NAMESPACE))
+        return;
+
+    prefs.putString(_name, _token);
+    prefs.putLong64(expiryKey, _expiresAt);
+    prefs.putUInt(lifetimeKey, _lifetimeSec);
+    prefs.end();
+}
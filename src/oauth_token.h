@@ -0,0 +1,85 @@
+#pragma once
+
+#include <Arduino.h>
+#include <time.h>
+
+#define OAUTH_REFRESH_SLACK_MS (5 * 60 * 1000) // Scheduler slack for maintain() jobs
+
+enum OAuthClientAuth
+{
+    OAUTH_CLIENT_AUTH_BASIC, // Client credentials in an Authorization: Basic header (Spotify)
+    OAUTH_CLIENT_AUTH_BODY,  // Client credentials as form fields (Google)
+};
+
+struct OAuthTokenStats
+{
+    uint32_t refreshes;     // Tokens obtained from the endpoint
+    uint32_t failures;      // Refresh attempts that failed
+    uint32_t syncRefreshes; // Refreshes get() had to do on the fetch path
+    uint32_t nvsLoads;      // Tokens still valid in NVS after a reboot
+};
+
+/**
+ * Access token for one OAuth 2.0 client, obtained with a long-lived refresh
+ * token. The expiry comes from the response's expires_in, and maintain(),
+ * run as a FetchScheduler job, refreshes the token ahead of it so API calls
+ * never wait for the token endpoint. Failed refreshes back off
+ * exponentially with jitter. The token is kept in NVS so a reboot within
+ * its lifetime doesn't cost a refresh.
+ *
+ * Expiry is tracked in wall-clock time, so use it after the clock is set.
+ * Not thread-safe: use each instance from the network worker only.
+ */
+class OAuthToken
+{
+public:
+    /**
+     * @param name NVS key prefix, at most 10 characters
+     */
+    OAuthToken(const char *name, const char *tokenUrl, const char *clientId, const char *clientSecret,
+               const char *refreshToken, OAuthClientAuth clientAuth);
+
+    /**
+     * @return A valid access token, refreshed on the spot only if maintain()
+     *         has not kept one; "" if none could be obtained
+     */
+    String get();
+
+    /**
+     * Drops the token, e.g. after an API answered 401, so the next get()
+     * fetches a new one
+     */
+    void invalidate();
+
+    /**
+     * Job body: refreshes the token when it is within the refresh window of
+     * expiring, or retries a failed refresh
+     * @return Milliseconds until it should run again
+     */
+    uint32_t maintain();
+
+    /** Seconds until the current token expires, 0 without one */
+    uint32_t secondsLeft();
+
+    OAuthTokenStats getStats() const { return _stats; }
+
+private:
+    const char *_name;
+    const char *_tokenUrl;
+    const char *_clientId;
+    const char *_clientSecret;
+    const char *_refreshToken;
+    OAuthClientAuth _clientAuth;
+
+    String _token;
+    time_t _expiresAt;
+    uint32_t _lifetimeSec;
+    uint32_t _retryMs;
+    bool _loaded;
+    OAuthTokenStats _stats;
+
+    bool refresh();
+    void load();
+    void save();
+    uint32_t refreshAheadSec() const;
+};
@@ -0,0 +1,89 @@
+#include "rfc3339.h"
+
+static bool readDigits(const char *&p, int count, int &value)
+{
+    value = 0;
+    for (int i = 0; i < count; i++, p++)
+    {
+        if (*p < '0' || *p > '9')
+            return false;
+        value = value * 10 + (*p - '0');
+    }
+    return true;
+}
+
+static bool expect(const char *&p, char c)
+{
+    if (*p != c)
+        return false;
+    p++;
+    return true;
+}
+
+static int daysInMonth(int year, int month)
+{
+    static const uint8_t days[] = {31, 28, 31, 30, 31, 30, 31, 31, 30, 31, 30, 31};
+    bool leap = (year % 4 == 0 && year % 100 != 0) || year % 400 == 0;
+    return month == 2 && leap ? 29 : days[month - 1];
+}
+
+bool parseRfc3339(const char *text, time_t &out)
+{
+    const char *p = text;
+    int year, month, day, hour, minute, second;
+
+    if (!p || !readDigits(p, 4, year) || !expect(p, '-') || !readDigits(p, 2, month) || !expect(p, '-') ||
+        !readDigits(p, 2, day))
+        return false;
+
+    // RFC 3339 allows a lowercase t, or a space, between date and time
+    if (*p != 'T' && *p != 't' && *p != ' ')
+        return false;
+    p++;
+
+    if (!readDigits(p, 2, hour) || !expect(p, ':') || !readDigits(p, 2, minute) || !expect(p, ':') ||
+        !readDigits(p, 2, second))
+        return false;
+
+    if (*p == '.')
+    {
+        p++;
+        if (*p < '0' || *p > '9')
+            return false;
+        while (*p >= '0' && *p <= '9')
+            p++;
+    }
+
+    int offset = 0;
+    if (*p == 'Z' || *p == 'z')
+    {
+        p++;
+    }
+    else if (*p == '+' || *p == '-')
+    {
+        int sign = *p++ == '-' ? -1 : 1;
+        int offsetHour, offsetMinute;
+        if (!readDigits(p, 2, offsetHour) || !expect(p, ':') || !readDigits(p, 2, offsetMinute) ||
+            offsetHour > 23 || offsetMinute > 59)
+            return false;
+        offset = sign * (offsetHour * 3600 + offsetMinute * 60);
+    }
+    else
+    {
+        return false;
+    }
+
+    // A leap second (:60) lands on the first second of the next minute, as with timegm()
+    if (*p != '\0' || month < 1 || month > 12 || day < 1 || day > daysInMonth(year, month) || hour > 23 ||
+        minute > 59 || second > 60)
+        return false;
+
+    int64_t seconds = daysFromCivil(year, month, day) * 86400 + hour * 3600 + minute * 60 + second - offset;
+
+    // Out of range for a 32-bit time_t
+    if ((int64_t)(time_t)seconds != seconds)
+        return false;
+
+    out = seconds;
+    return true;
+}
@@ -0,0 +1,52 @@
+#pragma once
+
+#include <stdint.h>
+#include <time.h>
+
+/*
+ * Civil date arithmetic after Howard Hinnant's days_from_civil, split into
+ * single-expression helpers so it stays constexpr under C++11
+ */
+
+constexpr int64_t civilEra(int64_t year)
+{
+    return (year >= 0 ? year : year - 399) / 400;
+}
+
+constexpr int64_t civilYearOfEra(int64_t year)
+{
+    return year - civilEra(year) * 400;
+}
+
+/** Day of a March-based year, so the leap day falls at its end */
+constexpr int64_t civilDayOfYear(unsigned month, unsigned day)
+{
+    return (153 * (month > 2 ? month - 3 : month + 9) + 2) / 5 + day - 1;
+}
+
+constexpr int64_t daysFromMarchYear(int64_t year, unsigned month, unsigned day)
+{
+    return civilEra(year) * 146097 + civilYearOfEra(year) * 365 + civilYearOfEra(year) / 4 -
+           civilYearOfEra(year) / 100 + civilDayOfYear(month, day) - 719468;
+}
+
+/**
+ * Days since 1970-01-01 of a proleptic Gregorian date
+ */
+constexpr int64_t daysFromCivil(int64_t year, unsigned month, unsigned day)
+{
+    return daysFromMarchYear(month <= 2 ? year - 1 : year, month, day);
+}
+
+static_assert(daysFromCivil(1970, 1, 1) == 0, "epoch");
+static_assert(daysFromCivil(2000, 3, 1) == 11017, "leap century");
+static_assert(daysFromCivil(1969, 12, 31) == -1, "before epoch");
+
+/**
+ * Parses an RFC 3339 timestamp such as "2024-03-10T07:00:00Z" or
+ * "2024-03-10T03:00:00.250-04:00" in a single pass, without allocating and
+ * independent of the process timezone. Fractional seconds are truncated.
+ * @param out Seconds since the epoch, UTC
+ * @return false if the text is not one complete, valid timestamp
+ */
+bool parseRfc3339(const char *text, time_t &out);
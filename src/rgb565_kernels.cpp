@@ -0,0 +1,372 @@
+#include "rgb565_kernels.h"
+
+#if defined(__XTENSA__)
+#include <esp_attr.h>
+#define RGB565_VARIANT "xtensa"
+#define RGB565_FAST_MEM IRAM_ATTR
+#elif defined(__SSE2__)
+#include <emmintrin.h>
+#define RGB565_VARIANT "sse2"
+#elif defined(__ARM_NEON)
+#include <arm_neon.h>
+#define RGB565_VARIANT "neon"
+#else
+#define RGB565_VARIANT "portable"
+#endif
+
+#ifndef RGB565_FAST_MEM
+#define RGB565_FAST_MEM
+#endif
+
+// Green in the top half, red and blue in the bottom, each with room below
+// it for the multiply to spill into: 00000GGGGGG00000RRRRR000000BBBBB
+#define RGB565_SPREAD_MASK 0x07E0F81Fu
+
+static bool lvglHooks = true;
+
+static inline uint32_t spread(uint16_t color)
+{
+    return (color | (uint32_t)color << 16) & RGB565_SPREAD_MASK;
+}
+
+/**
+ * Coverage in LVGL's units: mask scaled by opa, then cut to 0-32
+ */
+static inline uint32_t coverage(uint8_t mask, uint8_t opa)
+{
+    uint32_t alpha = opa == 255 ? mask : (uint32_t)mask * opa >> 8;
+    return (alpha + 4) >> 3;
+}
+
+/**
+ * lv_color_16_16_mix() with the foreground already spread. The packed
+ * arithmetic works out to bg + floor((fg - bg) * cover / 32) per channel,
+ * which is what the vector versions compute lane by lane.
+ */
+static inline uint16_t mix(uint32_t fg, uint16_t bg, uint32_t cover)
+{
+    uint32_t b = spread(bg);
+    uint32_t result = ((((fg - b) * cover) >> 5) + b) & RGB565_SPREAD_MASK;
+    return (uint16_t)(result >> 16 | result);
+}
+
+static inline uint16_t *nextRow(uint16_t *row, int32_t stride)
+{
+    return (uint16_t *)((uint8_t *)row + stride);
+}
+
+static void RGB565_FAST_MEM fillRowPortable(uint16_t *dest, int32_t width, uint16_t color)
+{
+    int32_t x = 0;
+    if (((uintptr_t)dest & 2) && width > 0)
+        dest[x++] = color;
+
+    // Two pixels per store once aligned
+    uint32_t pair = color | (uint32_t)color << 16;
+    uint32_t *words = (uint32_t *)(dest + x);
+    int32_t pairs = (width - x) >> 1;
+    for (int32_t i = 0; i < pairs; i++)
+        words[i] = pair;
+
+    x += pairs * 2;
+    if (x < width)
+        dest[x] = color;
+}
+
+static void RGB565_FAST_MEM blendRowPortable(uint16_t *dest, const uint8_t *mask, int32_t width, uint16_t color,
+                                             uint8_t opa)
+{
+    uint32_t fg = spread(color);
+    for (int32_t x = 0; x < width; x++)
+    {
+        if (mask[x] == 0)
+            continue;
+        if (mask[x] == 255 && opa == 255)
+            dest[x] = color;
+        else
+            dest[x] = mix(fg, dest[x], coverage(mask[x], opa));
+    }
+}
+
+static inline uint32_t swapPair(uint32_t pair)
+{
+    return (pair & 0xFF00FF00u) >> 8 | (pair & 0x00FF00FFu) << 8;
+}
+
+static void RGB565_FAST_MEM swapPortable(uint16_t *pixels, uint32_t count)
+{
+    uint32_t i = 0;
+    if (((uintptr_t)pixels & 2) && count > 0)
+    {
+        pixels[0] = pixels[0] << 8 | pixels[0] >> 8;
+        i = 1;
+    }
+
+    uint32_t *words = (uint32_t *)(pixels + i);
+    uint32_t pairs = (count - i) >> 1;
+    for (uint32_t j = 0; j < pairs; j++)
+        words[j] = swapPair(words[j]);
+
+    i += pairs * 2;
+    if (i < count)
+        pixels[i] = pixels[i] << 8 | pixels[i] >> 8;
+}
+
+#if defined(__XTENSA__)
+
+// The LX6 has no SIMD, but loads and stores are word-wide and a loop with a
+// fixed trip count becomes a zero-overhead LOOP, so work in 4-pixel groups
+
+static void RGB565_FAST_MEM fillRowFast(uint16_t *dest, int32_t width, uint16_t color)
+{
+    int32_t x = 0;
+    if (((uintptr_t)dest & 2) && width > 0)
+        dest[x++] = color;
+
+    uint32_t pair = color | (uint32_t)color << 16;
+    uint32_t *words = (uint32_t *)(dest + x);
+    for (int32_t groups = (width - x) >> 3; groups > 0; groups--, words += 4, x += 8)
+    {
+        words[0] = pair;
+        words[1] = pair;
+        words[2] = pair;
+        words[3] = pair;
+    }
+    fillRowPortable(dest + x, width - x, color);
+}
+
+/**
+ * Glyph masks are mostly empty or solid, so look at them a word at a time
+ * and only mix the edges
+ */
+static void RGB565_FAST_MEM blendRowFast(uint16_t *dest, const uint8_t *mask, int32_t width, uint16_t color,
+                                         uint8_t opa)
+{
+    int32_t x = (4 - ((uintptr_t)mask & 3)) & 3;
+    if (x > width)
+        x = width;
+    blendRowPortable(dest, mask, x, color, opa);
+
+    for (; x + 3 < width; x += 4)
+    {
+        uint32_t quad = *(const uint32_t *)(mask + x);
+        if (quad == 0)
+            continue;
+        if (quad == 0xFFFFFFFFu && opa == 255)
+            dest[x] = dest[x + 1] = dest[x + 2] = dest[x + 3] = color;
+        else
+            blendRowPortable(dest + x, mask + x, 4, color, opa);
+    }
+    blendRowPortable(dest + x, mask + x, width - x, color, opa);
+}
+
+static void RGB565_FAST_MEM swapFast(uint16_t *pixels, uint32_t count)
+{
+    uint32_t i = 0;
+    if (((uintptr_t)pixels & 2) && count > 0)
+    {
+        pixels[0] = pixels[0] << 8 | pixels[0] >> 8;
+        i = 1;
+    }
+
+    uint32_t *words = (uint32_t *)(pixels + i);
+    for (uint32_t groups = (count - i) >> 3; groups > 0; groups--, words += 4, i += 8)
+    {
+        uint32_t a = words[0], b = words[1], c = words[2], d = words[3];
+        words[0] = swapPair(a);
+        words[1] = swapPair(b);
+        words[2] = swapPair(c);
+        words[3] = swapPair(d);
+    }
+    swapPortable(pixels + i, count - i);
+}
+
+#elif defined(__SSE2__)
+
+static void fillRowFast(uint16_t *dest, int32_t width, uint16_t color)
+{
+    __m128i v = _mm_set1_epi16((short)color);
+    int32_t x = 0;
+    for (; x + 7 < width; x += 8)
+        _mm_storeu_si128((__m128i *)(dest + x), v);
+    fillRowPortable(dest + x, width - x, color);
+}
+
+/**
+ * Eight pixels at a time with the channels split into 16-bit lanes
+ */
+static void blendRowFast(uint16_t *dest, const uint8_t *mask, int32_t width, uint16_t color, uint8_t opa)
+{
+    const __m128i zero = _mm_setzero_si128();
+    const __m128i four = _mm_set1_epi16(4);
+    const __m128i low5 = _mm_set1_epi16(0x1F);
+    const __m128i low6 = _mm_set1_epi16(0x3F);
+    const __m128i opaV = _mm_set1_epi16(opa);
+    const __m128i fgR = _mm_set1_epi16(color >> 11);
+    const __m128i fgG = _mm_set1_epi16(color >> 5 & 0x3F);
+    const __m128i fgB = _mm_set1_epi16(color & 0x1F);
+
+    int32_t x = 0;
+    for (; x + 7 < width; x += 8)
+    {
+        __m128i alpha = _mm_unpacklo_epi8(_mm_loadl_epi64((const __m128i *)(mask + x)), zero);
+        if (_mm_movemask_epi8(_mm_cmpeq_epi16(alpha, zero)) == 0xFFFF)
+            continue;
+        if (opa != 255)
+            alpha = _mm_srli_epi16(_mm_mullo_epi16(alpha, opaV), 8);
+        __m128i cover = _mm_srli_epi16(_mm_add_epi16(alpha, four), 3);
+
+        __m128i bg = _mm_loadu_si128((const __m128i *)(dest + x));
+        __m128i r = _mm_srli_epi16(bg, 11);
+        __m128i g = _mm_and_si128(_mm_srli_epi16(bg, 5), low6);
+        __m128i b = _mm_and_si128(bg, low5);
+
+        // bg + floor((fg - bg) * cover / 32): the arithmetic shift floors
+        r = _mm_add_epi16(r, _mm_srai_epi16(_mm_mullo_epi16(_mm_sub_epi16(fgR, r), cover), 5));
+        g = _mm_add_epi16(g, _mm_srai_epi16(_mm_mullo_epi16(_mm_sub_epi16(fgG, g), cover), 5));
+        b = _mm_add_epi16(b, _mm_srai_epi16(_mm_mullo_epi16(_mm_sub_epi16(fgB, b), cover), 5));
+
+        __m128i out = _mm_or_si128(_mm_or_si128(_mm_slli_epi16(r, 11), _mm_slli_epi16(g, 5)), b);
+        _mm_storeu_si128((__m128i *)(dest + x), out);
+    }
+    blendRowPortable(dest + x, mask + x, width - x, color, opa);
+}
+
+static void swapFast(uint16_t *pixels, uint32_t count)
+{
+    uint32_t i = 0;
+    for (; i + 7 < count; i += 8)
+    {
+        __m128i v = _mm_loadu_si128((const __m128i *)(pixels + i));
+        _mm_storeu_si128((__m128i *)(pixels + i), _mm_or_si128(_mm_slli_epi16(v, 8), _mm_srli_epi16(v, 8)));
+    }
+    swapPortable(pixels + i, count - i);
+}
+
+#elif defined(__ARM_NEON)
+
+static void fillRowFast(uint16_t *dest, int32_t width, uint16_t color)
+{
+    uint16x8_t v = vdupq_n_u16(color);
+    int32_t x = 0;
+    for (; x + 7 < width; x += 8)
+        vst1q_u16(dest + x, v);
+    fillRowPortable(dest + x, width - x, color);
+}
+
+/**
+ * Eight pixels at a time with the channels split into 16-bit lanes
+ */
+static void blendRowFast(uint16_t *dest, const uint8_t *mask, int32_t width, uint16_t color, uint8_t opa)
+{
+    const int16x8_t fgR = vdupq_n_s16(color >> 11);
+    const int16x8_t fgG = vdupq_n_s16(color >> 5 & 0x3F);
+    const int16x8_t fgB = vdupq_n_s16(color & 0x1F);
+
+    int32_t x = 0;
+    for (; x + 7 < width; x += 8)
+    {
+        uint8x8_t m = vld1_u8(mask + x);
+        if (vget_lane_u64(vreinterpret_u64_u8(m), 0) == 0)
+            continue;
+        uint16x8_t alpha = vmovl_u8(m);
+        if (opa != 255)
+            alpha = vshrq_n_u16(vmulq_n_u16(alpha, opa), 8);
+        int16x8_t cover = vreinterpretq_s16_u16(vshrq_n_u16(vaddq_u16(alpha, vdupq_n_u16(4)), 3));
+
+        uint16x8_t bg = vld1q_u16(dest + x);
+        int16x8_t r = vreinterpretq_s16_u16(vshrq_n_u16(bg, 11));
+        int16x8_t g = vreinterpretq_s16_u16(vandq_u16(vshrq_n_u16(bg, 5), vdupq_n_u16(0x3F)));
+        int16x8_t b = vreinterpretq_s16_u16(vandq_u16(bg, vdupq_n_u16(0x1F)));
+
+        // bg + floor((fg - bg) * cover / 32): the arithmetic shift floors
+        r = vaddq_s16(r, vshrq_n_s16(vmulq_s16(vsubq_s16(fgR, r), cover), 5));
+        g = vaddq_s16(g, vshrq_n_s16(vmulq_s16(vsubq_s16(fgG, g), cover), 5));
+        b = vaddq_s16(b, vshrq_n_s16(vmulq_s16(vsubq_s16(fgB, b), cover), 5));
+
+        uint16x8_t out = vorrq_u16(vorrq_u16(vshlq_n_u16(vreinterpretq_u16_s16(r), 11),
+                                             vshlq_n_u16(vreinterpretq_u16_s16(g), 5)),
+                                   vreinterpretq_u16_s16(b));
+        vst1q_u16(dest + x, out);
+    }
+    blendRowPortable(dest + x, mask + x, width - x, color, opa);
+}
+
+static void swapFast(uint16_t *pixels, uint32_t count)
+{
+    uint32_t i = 0;
+    for (; i + 7 < count; i += 8)
+        vst1q_u8((uint8_t *)(pixels + i), vrev16q_u8(vld1q_u8((const uint8_t *)(pixels + i))));
+    swapPortable(pixels + i, count - i);
+}
+
+#else
+
+#define fillRowFast fillRowPortable
+#define blendRowFast blendRowPortable
+#define swapFast swapPortable
+
+#endif
+
+void RGB565_FAST_MEM rgb565Fill(uint16_t *dest, int32_t width, int32_t height, int32_t stride, uint16_t color)
+{
+    for (int32_t y = 0; y < height; y++, dest = nextRow(dest, stride))
+        fillRowFast(dest, width, color);
+}
+
+void RGB565_FAST_MEM rgb565BlendA8(uint16_t *dest, int32_t width, int32_t height, int32_t stride,
+                                   const uint8_t *mask, int32_t maskStride, uint16_t color, uint8_t opa)
+{
+    for (int32_t y = 0; y < height; y++, dest = nextRow(dest, stride), mask += maskStride)
+        blendRowFast(dest, mask, width, color, opa);
+}
+
+void RGB565_FAST_MEM rgb565Swap(uint16_t *pixels, uint32_t count)
+{
+    swapFast(pixels, count);
+}
+
+void rgb565FillPortable(uint16_t *dest, int32_t width, int32_t height, int32_t stride, uint16_t color)
+{
+    for (int32_t y = 0; y < height; y++, dest = nextRow(dest, stride))
+        fillRowPortable(dest, width, color);
+}
+
+void rgb565BlendA8Portable(uint16_t *dest, int32_t width, int32_t height, int32_t stride, const uint8_t *mask,
+                           int32_t maskStride, uint16_t color, uint8_t opa)
+{
+    for (int32_t y = 0; y < height; y++, dest = nextRow(dest, stride), mask += maskStride)
+        blendRowPortable(dest, mask, width, color, opa);
+}
+
+void rgb565SwapPortable(uint16_t *pixels, uint32_t count)
+{
+    swapPortable(pixels, count);
+}
+
+const char *rgb565KernelVariant()
+{
+    return RGB565_VARIANT;
+}
+
+void rgb565SetLvglHooks(bool enabled)
+{
+    lvglHooks = enabled;
+}
+
+bool RGB565_FAST_MEM rgb565LvglFill(void *dest, int32_t width, int32_t height, int32_t stride, uint16_t color)
+{
+    if (!lvglHooks)
+        return false;
+    rgb565Fill((uint16_t *)dest, width, height, stride, color);
+    return true;
+}
+
+bool RGB565_FAST_MEM rgb565LvglBlendA8(void *dest, int32_t width, int32_t height, int32_t stride,
+                                       const uint8_t *mask, int32_t maskStride, uint16_t color, uint8_t opa)
+{
+    if (!lvglHooks)
+        return false;
+    rgb565BlendA8((uint16_t *)dest, width, height, stride, mask, maskStride, color, opa);
+    return true;
+}
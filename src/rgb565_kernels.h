@@ -0,0 +1,105 @@
+#pragma once
+
+/*
+ * RGB565 pixel kernels for the software renderer and the panel driver.
+ * Each kernel has a portable C version and, chosen at compile time, one
+ * tuned for the target: Xtensa (word-wide loads and stores, run from IRAM),
+ * SSE2 or NEON on a host. All versions give bit-identical results, the
+ * blends the same as LVGL's lv_color_16_16_mix().
+ *
+ * lv_conf.h includes this header into LVGL's RGB565 blend code through
+ * LV_DRAW_SW_ASM_CUSTOM_INCLUDE, which LVGL compiles as C, so it has to
+ * stay valid C.
+ */
+
+#include <stdbool.h>
+#include <stdint.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/**
+ * Fills a rectangle with one colour
+ * @param dest First pixel of the rectangle
+ * @param width Width in pixels
+ * @param height Height in pixels
+ * @param stride Bytes from one row to the next
+ * @param color Colour to fill with
+ */
+void rgb565Fill(uint16_t *dest, int32_t width, int32_t height, int32_t stride, uint16_t color);
+
+/**
+ * Blends one colour onto a rectangle through an 8-bit coverage mask, as
+ * when drawing anti-aliased glyphs
+ * @param dest First pixel of the rectangle
+ * @param width Width in pixels
+ * @param height Height in pixels
+ * @param stride Bytes from one row of dest to the next
+ * @param mask Coverage per pixel, 0 keeps dest and 255 replaces it
+ * @param maskStride Bytes from one row of the mask to the next
+ * @param color Colour to blend in
+ * @param opa Opacity applied on top of the mask; 255 for none
+ */
+void rgb565BlendA8(uint16_t *dest, int32_t width, int32_t height, int32_t stride, const uint8_t *mask,
+                   int32_t maskStride, uint16_t color, uint8_t opa);
+
+/**
+ * Swaps the bytes of each pixel in place, for panels that take RGB565
+ * big-endian
+ * @param pixels Pixels to swap
+ * @param count Number of pixels
+ */
+void rgb565Swap(uint16_t *pixels, uint32_t count);
+
+/** Portable C versions of the above, for comparison */
+void rgb565FillPortable(uint16_t *dest, int32_t width, int32_t height, int32_t stride, uint16_t color);
+void rgb565BlendA8Portable(uint16_t *dest, int32_t width, int32_t height, int32_t stride, const uint8_t *mask,
+                           int32_t maskStride, uint16_t color, uint8_t opa);
+void rgb565SwapPortable(uint16_t *pixels, uint32_t count);
+
+/**
+ * Name of the versions compiled in: "portable", "xtensa", "sse2" or "neon"
+ */
+const char *rgb565KernelVariant(void);
+
+/**
+ * Switches the LVGL hooks below between these kernels and LVGL's own
+ * generic ones; on by default
+ */
+void rgb565SetLvglHooks(bool enabled);
+
+/**
+ * LVGL hooks
+ * @return Whether the blend was done; if not, LVGL falls back to its own
+ */
+bool rgb565LvglFill(void *dest, int32_t width, int32_t height, int32_t stride, uint16_t color);
+bool rgb565LvglBlendA8(void *dest, int32_t width, int32_t height, int32_t stride, const uint8_t *mask,
+                       int32_t maskStride, uint16_t color, uint8_t opa);
+
+#ifdef __cplusplus
+}
+#endif
+
+/*
+ * The blend-to-RGB565 entry points LVGL looks for. Solid fills and masked
+ * fills (text, anti-aliased edges) are taken over; opacity-only fills and
+ * image blends stay with LVGL.
+ */
+#define LV_DRAW_SW_COLOR_BLEND_TO_RGB565(dsc)                                                          \
+    (rgb565LvglFill((dsc)->dest_buf, (dsc)->dest_w, (dsc)->dest_h, (dsc)->dest_stride,                 \
+                    lv_color_to_u16((dsc)->color))                                                     \
+         ? LV_RESULT_OK                                                                                \
+         : LV_RESULT_INVALID)
+
+#define LV_DRAW_SW_COLOR_BLEND_TO_RGB565_WITH_MASK(dsc)                                                \
+    (rgb565LvglBlendA8((dsc)->dest_buf, (dsc)->dest_w, (dsc)->dest_h, (dsc)->dest_stride,              \
+                       (dsc)->mask_buf, (dsc)->mask_stride, lv_color_to_u16((dsc)->color), 255)        \
+         ? LV_RESULT_OK                                                                                \
+         : LV_RESULT_INVALID)
+
+#define LV_DRAW_SW_COLOR_BLEND_TO_RGB565_MIX_MASK_OPA(dsc)                                             \
+    (rgb565LvglBlendA8((dsc)->dest_buf, (dsc)->dest_w, (dsc)->dest_h, (dsc)->dest_stride,              \
+                       (dsc)->mask_buf, (dsc)->mask_stride, lv_color_to_u16((dsc)->color), (dsc)->opa) \
+         ? LV_RESULT_OK                                                                                \
+         : LV_RESULT_INVALID)
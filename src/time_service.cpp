@@ -0,0 +1,243 @@
+#include "time_service.h"
+
+#include <Preferences.h>
+#include <esp_sntp.h>
+#include <esp_timer.h>
+#include <sys/time.h>
+#include <mutex>
+
+#include "config.h"
+#include "metrics.h"
+
+#define TIME_SYNC_INTERVAL_MIN 60
+#define TIME_STEP_THRESHOLD_MS 1000 // Larger errors are stepped rather than slewed
+#define TIME_SLEW_RATE_PPM 500      // As adjtime(): a second takes 33 minutes
+#define TIME_DRIFT_MIN_INTERVAL_MIN 10
+#define TIME_DRIFT_MAX_PPM 500      // Crystals are within 50; more is a bad sample
+#define TIME_DRIFT_SAVE_PPB 500     // Smaller changes are not worth a flash write
+#define TIME_MIN_VALID 1700000000   // Nov 2023; a clock before this was never set
+#define TIME_NVS_NAMESPACE "time"
+
+ClockModel::ClockModel()
+    : _seeded(false), _baseMonoUs(0), _baseTimeUs(0), _driftPpb(0), _slewUs(0), _haveSample(false),
+      _sampleMonoUs(0), _sampleNtpUs(0), _driftMeasured(false), _steps(0)
+{
+}
+
+void ClockModel::anchor(int64_t monoUs, int64_t timeUs)
+{
+    _baseMonoUs = monoUs;
+    _baseTimeUs = timeUs;
+    _slewUs = 0;
+}
+
+void ClockModel::seed(int64_t monoUs, int64_t timeUs)
+{
+    anchor(monoUs, timeUs);
+    _seeded = true;
+}
+
+int64_t ClockModel::slewAppliedUs(int64_t monoUs) const
+{
+    int64_t budget = (monoUs - _baseMonoUs) * TIME_SLEW_RATE_PPM / 1000000;
+    if (_slewUs >= 0)
+        return _slewUs < budget ? _slewUs : budget;
+    return -_slewUs < budget ? _slewUs : -budget;
+}
+
+int64_t ClockModel::slewRemainingUs(int64_t monoUs) const
+{
+    return _slewUs - slewAppliedUs(monoUs);
+}
+
+int64_t ClockModel::now(int64_t monoUs) const
+{
+    if (!_seeded)
+        return 0;
+
+    int64_t elapsed = monoUs - _baseMonoUs;
+    return _baseTimeUs + elapsed + elapsed * _driftPpb / 1000000000 + slewAppliedUs(monoUs);
+}
+
+void ClockModel::setDriftPpb(int32_t driftPpb)
+{
+    _driftPpb = driftPpb;
+}
+
+int64_t ClockModel::sample(int64_t monoUs, int64_t ntpUs)
+{
+    int64_t offset = _seeded ? ntpUs - now(monoUs) : 0;
+
+    // Drift from the raw counter against NTP, independent of corrections
+    if (!_haveSample)
+    {
+        _sampleMonoUs = monoUs;
+        _sampleNtpUs = ntpUs;
+        _haveSample = true;
+    }
+    else if (monoUs - _sampleMonoUs >= (int64_t)TIME_DRIFT_MIN_INTERVAL_MIN * 60 * 1000000)
+    {
+        int64_t monoElapsed = monoUs - _sampleMonoUs;
+        int64_t measured = ((ntpUs - _sampleNtpUs) - monoElapsed) * 1000000000 / monoElapsed;
+        if (measured >= -TIME_DRIFT_MAX_PPM * 1000 && measured <= TIME_DRIFT_MAX_PPM * 1000)
+        {
+            // Each sample carries some network jitter; average over a few
+            int32_t drift = _driftMeasured ? _driftPpb + (int32_t)(measured - _driftPpb) / 4 : (int32_t)measured;
+            _driftMeasured = true;
+            if (_seeded)
+            {
+                int64_t current = now(monoUs);
+                anchor(monoUs, current);
+            }
+            _driftPpb = drift;
+        }
+        _sampleMonoUs = monoUs;
+        _sampleNtpUs = ntpUs;
+    }
+
+    if (!_seeded || offset > (int64_t)TIME_STEP_THRESHOLD_MS * 1000 || offset < -(int64_t)TIME_STEP_THRESHOLD_MS * 1000)
+    {
+        if (_seeded)
+            _steps++;
+        seed(monoUs, ntpUs);
+        return offset;
+    }
+
+    // Continue from the current reading and slew the error in from here
+    anchor(monoUs, now(monoUs));
+    _slewUs = offset;
+    return offset;
+}
+
+static ClockModel model;
+static std::mutex modelMutex;
+static TimeServiceStats stats;
+static void (*syncedCallback)();
+static int32_t savedDriftPpb;
+
+static int64_t monotonicUs()
+{
+    return esp_timer_get_time();
+}
+
+static void saveDrift(int32_t driftPpb)
+{
+    if (abs(driftPpb - savedDriftPpb) < TIME_DRIFT_SAVE_PPB)
+        return;
+
+    Preferences prefs;
+    if (prefs.begin(TIME_NVS_NAMESPACE))
+    {
+        prefs.putInt("drift_ppb", driftPpb);
+        prefs.end();
+        savedDriftPpb = driftPpb;
+    }
+}
+
+/**
+ * SNTP has just set the system clock to tv; the system clock may jump, but
+ * what the app reads is the model, which slews towards it
+ */
+static void timeSyncNotification(struct timeval *tv)
+{
+    int64_t ntpUs = (int64_t)tv->tv_sec * 1000000 + tv->tv_usec;
+    int32_t offsetMs;
+    int32_t driftPpb;
+    {
+        std::lock_guard<std::mutex> lock(modelMutex);
+        int64_t offset = model.sample(monotonicUs(), ntpUs);
+        stats.syncs++;
+        stats.steps = model.steps();
+        stats.lastOffsetMs = offsetMs = offset / 1000;
+        driftPpb = model.driftPpb();
+    }
+    saveDrift(driftPpb);
+
+    struct tm timeinfo;
+    TimeService::localTime(&timeinfo);
+    char timeStr[64];
+    strftime(timeStr, sizeof(timeStr), "%Y-%m-%d %H:%M:%S %Z", &timeinfo);
+    Serial.printf("Time synchronized: %s, offset %d ms, drift %.2f ppm\n", timeStr, (int)offsetMs,
+                  driftPpb / 1000.0);
+
+    if (syncedCallback)
+        syncedCallback();
+}
+
+static void exportMetrics()
+{
+    static Metric *syncs = Metrics::counter("time.syncs");
+    static Metric *steps = Metrics::counter("time.steps");
+    static Metric *offsetMs = Metrics::gauge("time.offset_ms");
+    static Metric *driftPpb = Metrics::gauge("time.drift_ppb");
+
+    TimeServiceStats current = TimeService::getStats();
+    syncs->set(current.syncs);
+    steps->set(current.steps);
+    offsetMs->set(current.lastOffsetMs);
+    driftPpb->set(current.driftPpb);
+}
+
+bool TimeService::begin()
+{
+    Metrics::addSource(exportMetrics);
+    setenv("TZ", TIME_ZONE, 1);
+    tzset();
+
+    Preferences prefs;
+    if (prefs.begin(TIME_NVS_NAMESPACE, true))
+    {
+        savedDriftPpb = prefs.getInt("drift_ppb", 0);
+        prefs.end();
+    }
+
+    struct timeval tv;
+    gettimeofday(&tv, NULL);
+
+    std::lock_guard<std::mutex> lock(modelMutex);
+    model.setDriftPpb(savedDriftPpb);
+    if (tv.tv_sec >= TIME_MIN_VALID)
+        model.seed(monotonicUs(), (int64_t)tv.tv_sec * 1000000 + tv.tv_usec);
+    return model.isSeeded();
+}
+
+void TimeService::startSync(void (*onSynced)())
+{
+    syncedCallback = onSynced;
+    sntp_set_time_sync_notification_cb(timeSyncNotification);
+    sntp_set_sync_interval(TIME_SYNC_INTERVAL_MIN * 60 * 1000);
+    configTzTime(TIME_ZONE, "pool.ntp.org", "time.nist.gov");
+}
+
+bool TimeService::isSet()
+{
+    return now() >= TIME_MIN_VALID;
+}
+
+int64_t TimeService::nowUs()
+{
+    std::lock_guard<std::mutex> lock(modelMutex);
+    return model.now(monotonicUs());
+}
+
+time_t TimeService::now()
+{
+    return nowUs() / 1000000;
+}
+
+bool TimeService::localTime(struct tm *info)
+{
+    time_t seconds = now();
+    if (seconds < TIME_MIN_VALID)
+        return false;
+    return localtime_r(&seconds, info) != NULL;
+}
+
+TimeServiceStats TimeService::getStats()
+{
+    std::lock_guard<std::mutex> lock(modelMutex);
+    TimeServiceStats current = stats;
+    current.driftPpb = model.driftPpb();
+    current.slewRemainingMs = model.slewRemainingUs(monotonicUs()) / 1000;
+    return current;
+}
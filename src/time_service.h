@@ -0,0 +1,111 @@
+#pragma once
+
+#include <Arduino.h>
+#include <time.h>
+
+/**
+ * Wall clock as a function of a monotonic microsecond counter, corrected
+ * by NTP samples. Offsets under TIME_STEP_THRESHOLD_MS are slewed away at
+ * TIME_SLEW_RATE_PPM, so the clock never jumps and never runs backwards;
+ * larger ones are stepped. The rate error of the counter's oscillator is
+ * estimated from samples at least TIME_DRIFT_MIN_INTERVAL_MIN apart and
+ * corrected between syncs.
+ *
+ * Pure arithmetic with no clock of its own, so the native benchmark can
+ * drive it through simulated days. Not thread-safe; TimeService locks it.
+ */
+class ClockModel
+{
+public:
+    ClockModel();
+
+    /** Starts from a time not known to be accurate, e.g. the RTC's */
+    void seed(int64_t monoUs, int64_t timeUs);
+
+    /**
+     * Takes an NTP sample
+     * @return Offset of the sample from the clock before it, in microseconds
+     */
+    int64_t sample(int64_t monoUs, int64_t ntpUs);
+
+    /** Wall time in microseconds since the epoch, 0 if never seeded */
+    int64_t now(int64_t monoUs) const;
+
+    /** Applied rate correction in parts per billion */
+    int32_t driftPpb() const { return _driftPpb; }
+
+    /** Starts from an earlier estimate; call before seeding */
+    void setDriftPpb(int32_t driftPpb);
+
+    /** Slew still to be applied at monoUs */
+    int64_t slewRemainingUs(int64_t monoUs) const;
+
+    bool isSeeded() const { return _seeded; }
+    uint32_t steps() const { return _steps; }
+
+private:
+    bool _seeded;
+    int64_t _baseMonoUs; // Anchor: the clock read _baseTimeUs at _baseMonoUs
+    int64_t _baseTimeUs;
+    int32_t _driftPpb;
+    int64_t _slewUs;     // Correction being slewed in since the anchor
+    bool _haveSample;
+    int64_t _sampleMonoUs; // Reference for the next drift measurement
+    int64_t _sampleNtpUs;
+    bool _driftMeasured;
+    uint32_t _steps;
+
+    void anchor(int64_t monoUs, int64_t timeUs);
+    int64_t slewAppliedUs(int64_t monoUs) const;
+};
+
+struct TimeServiceStats
+{
+    uint32_t syncs;
+    uint32_t steps;       // Syncs too far off to slew
+    int32_t lastOffsetMs; // Error found by the last sync
+    int32_t driftPpb;
+    int32_t slewRemainingMs;
+};
+
+/**
+ * The clock for the rest of the app; use it instead of time(NULL) or
+ * getLocalTime(). Local time follows the POSIX TZ rules in TIME_ZONE, so
+ * daylight saving switches by itself. SNTP resyncs every
+ * TIME_SYNC_INTERVAL_MIN and the result is slewed in by a ClockModel, whose
+ * drift estimate is kept in NVS so it applies from the next boot on.
+ * Thread-safe.
+ */
+class TimeService
+{
+public:
+    /**
+     * Sets the timezone, loads the drift estimate and starts from the RTC,
+     * which ESP-IDF keeps across soft resets and deep sleep. Call at boot.
+     * @return true if the time can be shown before NTP answers
+     */
+    static bool begin();
+
+    /**
+     * Starts SNTP. Call once the network is up.
+     * @param onSynced Runs on the SNTP task after every sync
+     */
+    static void startSync(void (*onSynced)());
+
+    /** @return true once the clock holds a real date, from NTP or the RTC */
+    static bool isSet();
+
+    /** Seconds since the epoch */
+    static time_t now();
+
+    /** Microseconds since the epoch */
+    static int64_t nowUs();
+
+    /**
+     * Current local time
+     * @return false if the clock is not set
+     */
+    static bool localTime(struct tm *info);
+
+    static TimeServiceStats getStats();
+};
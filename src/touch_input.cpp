@@ -0,0 +1,257 @@
+#include "touch_input.h"
+
+#include <Preferences.h>
+
+#include "config.h"
+#include "metrics.h"
+
+#define TOUCH_Z_THRESHOLD 400    // Pressure below this is a release, as in XPT2046_Touchscreen
+#define TOUCH_MAX_SPREAD 80      // Raw units (~6 px) the middle of a burst may span
+#define TOUCH_IIR_SHIFT 1        // New point weight 1/2
+#define TOUCH_IIR_SNAP 120       // Raw units; moves further than this skip the filter
+#define TOUCH_RELEASE_READS 2
+#define TOUCH_MIN_DETERMINANT 100000 // Raw units squared; below this the points are collinear
+#define TOUCH_NVS_NAMESPACE "touch"
+#define TOUCH_NVS_KEY "screen_cal" // "cal" mapped to portrait panel coordinates
+
+// Nominal raw ranges of the CYD's touch layer, across the portrait panel
+#define TOUCH_RAW_MIN_X 200
+#define TOUCH_RAW_MAX_X 3700
+#define TOUCH_RAW_MIN_Y 240
+#define TOUCH_RAW_MAX_Y 3800
+
+static TouchCalibration calibration;
+static TouchInputStats stats;
+static bool pressed;
+static int lightReads;
+static int32_t filteredX; // Raw units << 4
+static int32_t filteredY;
+static TouchPoint point;
+
+static TouchCalibration defaultCalibration()
+{
+    // Portrait panel position from each raw axis...
+    int32_t panelXScale = ((TFT_HOR_RES - 1) << 16) / (TOUCH_RAW_MAX_X - TOUCH_RAW_MIN_X);
+    int32_t panelXOffset = (1 << 16) - panelXScale * TOUCH_RAW_MIN_X;
+    int32_t panelYScale = ((TFT_VER_RES - 1) << 16) / (TOUCH_RAW_MAX_Y - TOUCH_RAW_MIN_Y);
+    int32_t panelYOffset = (1 << 16) - panelYScale * TOUCH_RAW_MIN_Y;
+
+    // ...turned a quarter like the scan: x = last column - panel y, y = panel x
+    TouchCalibration nominal = {};
+    nominal.b = -panelYScale;
+    nominal.c = ((SCREEN_HOR_RES - 1) << 16) - panelYOffset;
+    nominal.d = panelXScale;
+    nominal.f = panelXOffset;
+    return nominal;
+}
+
+TouchPoint touchCalibrationApply(const TouchCalibration &cal, int32_t rawX, int32_t rawY)
+{
+    int32_t x = ((int64_t)cal.a * rawX + (int64_t)cal.b * rawY + cal.c) >> 16;
+    int32_t y = ((int64_t)cal.d * rawX + (int64_t)cal.e * rawY + cal.f) >> 16;
+
+    TouchPoint mapped;
+    mapped.x = x < 0 ? 0 : x >= SCREEN_HOR_RES ? SCREEN_HOR_RES - 1 : x;
+    mapped.y = y < 0 ? 0 : y >= SCREEN_VER_RES ? SCREEN_VER_RES - 1 : y;
+    return mapped;
+}
+
+bool touchCalibrationSolve(const TouchPoint screen[3], const TouchPoint raw[3], TouchCalibration *cal)
+{
+    // Cramer's rule on [rawX rawY 1] * [a b c]' = screenX, and likewise for y
+    double x0 = raw[0].x, y0 = raw[0].y;
+    double x1 = raw[1].x, y1 = raw[1].y;
+    double x2 = raw[2].x, y2 = raw[2].y;
+    double det = x0 * (y1 - y2) - y0 * (x1 - x2) + (x1 * y2 - x2 * y1);
+    if (det > -TOUCH_MIN_DETERMINANT && det < TOUCH_MIN_DETERMINANT)
+        return false;
+
+    double coef[2][3];
+    for (int axis = 0; axis < 2; axis++)
+    {
+        double s0 = axis ? screen[0].y : screen[0].x;
+        double s1 = axis ? screen[1].y : screen[1].x;
+        double s2 = axis ? screen[2].y : screen[2].x;
+        coef[axis][0] = (s0 * (y1 - y2) - y0 * (s1 - s2) + (s1 * y2 - s2 * y1)) / det;
+        coef[axis][1] = (x0 * (s1 - s2) - s0 * (x1 - x2) + (x1 * s2 - x2 * s1)) / det;
+        coef[axis][2] = (x0 * (y1 * s2 - y2 * s1) - y0 * (x1 * s2 - x2 * s1) + s0 * (x1 * y2 - x2 * y1)) / det;
+    }
+
+    // Rounded to the middle of the pixel, as the shift truncates
+    cal->a = lround(coef[0][0] * 65536);
+    cal->b = lround(coef[0][1] * 65536);
+    cal->c = lround(coef[0][2] * 65536) + (1 << 15);
+    cal->d = lround(coef[1][0] * 65536);
+    cal->e = lround(coef[1][1] * 65536);
+    cal->f = lround(coef[1][2] * 65536) + (1 << 15);
+    return true;
+}
+
+static void exportMetrics()
+{
+    static Metric *reads = Metrics::counter("touch.reads");
+    static Metric *presses = Metrics::counter("touch.presses");
+    static Metric *rejected = Metrics::counter("touch.rejected");
+
+    TouchInputStats current = TouchInput::getStats();
+    reads->set(current.reads);
+    presses->set(current.presses);
+    rejected->set(current.rejected);
+}
+
+void TouchInput::begin()
+{
+    Metrics::addSource(exportMetrics);
+    calibration = defaultCalibration();
+
+    Preferences prefs;
+    if (prefs.begin(TOUCH_NVS_NAMESPACE, true))
+    {
+        TouchCalibration saved;
+        if (prefs.getBytesLength(TOUCH_NVS_KEY) == sizeof(saved) &&
+            prefs.getBytes(TOUCH_NVS_KEY, &saved, sizeof(saved)) == sizeof(saved))
+        {
+            calibration = saved;
+            Serial.println("Touch calibration loaded");
+        }
+        prefs.end();
+    }
+}
+
+static void sortSamples(uint16_t *values, int count)
+{
+    for (int i = 1; i < count; i++)
+    {
+        uint16_t value = values[i];
+        int j = i;
+        for (; j > 0 && values[j - 1] > value; j--)
+            values[j] = values[j - 1];
+        values[j] = value;
+    }
+}
+
+/**
+ * Reduces a burst to its median
+ * @return false if the burst is too spread out to trust
+ */
+static bool burstMedian(const TouchSample *samples, int count, uint16_t *x, uint16_t *y)
+{
+    uint16_t xs[TOUCH_BURST_SIZE];
+    uint16_t ys[TOUCH_BURST_SIZE];
+    if (count > TOUCH_BURST_SIZE)
+        count = TOUCH_BURST_SIZE;
+    for (int i = 0; i < count; i++)
+    {
+        xs[i] = samples[i].x;
+        ys[i] = samples[i].y;
+    }
+    sortSamples(xs, count);
+    sortSamples(ys, count);
+
+    *x = xs[count / 2];
+    *y = ys[count / 2];
+
+    // Ignore one outlier at either end; the rest must agree
+    int low = count > 2 ? 1 : 0;
+    int high = count > 2 ? count - 2 : count - 1;
+    return xs[high] - xs[low] <= TOUCH_MAX_SPREAD && ys[high] - ys[low] <= TOUCH_MAX_SPREAD;
+}
+
+bool TouchInput::update(const TouchSample *samples, int count, TouchPoint *out)
+{
+    stats.reads++;
+
+    // Light pressure: pen lifting, or a dip in the middle of a press
+    bool light = !samples || count == 0;
+    if (!light)
+    {
+        uint32_t z = 0;
+        for (int i = 0; i < count; i++)
+            z += samples[i].z;
+        light = z / count < TOUCH_Z_THRESHOLD;
+    }
+    else
+    {
+        stats.idleReads++;
+    }
+
+    if (light)
+    {
+        if (pressed && ++lightReads >= TOUCH_RELEASE_READS)
+            pressed = false;
+        *out = point;
+        return pressed;
+    }
+    lightReads = 0;
+
+    stats.bursts++;
+    uint16_t x, y;
+    if (!burstMedian(samples, count, &x, &y))
+    {
+        stats.rejected++;
+        *out = point;
+        return pressed;
+    }
+
+    int32_t dx = ((int32_t)x << 4) - filteredX;
+    int32_t dy = ((int32_t)y << 4) - filteredY;
+    if (!pressed || abs(dx) > TOUCH_IIR_SNAP << 4 || abs(dy) > TOUCH_IIR_SNAP << 4)
+    {
+        filteredX = (int32_t)x << 4;
+        filteredY = (int32_t)y << 4;
+    }
+    else
+    {
+        filteredX += dx >> TOUCH_IIR_SHIFT;
+        filteredY += dy >> TOUCH_IIR_SHIFT;
+    }
+
+    if (!pressed)
+        stats.presses++;
+    pressed = true;
+    point = touchCalibrationApply(calibration, (filteredX + 8) >> 4, (filteredY + 8) >> 4);
+    *out = point;
+    return true;
+}
+
+TouchPoint TouchInput::lastRaw()
+{
+    TouchPoint raw;
+    raw.x = (filteredX + 8) >> 4;
+    raw.y = (filteredY + 8) >> 4;
+    return raw;
+}
+
+bool TouchInput::calibrate(const TouchPoint screen[3], const TouchPoint raw[3])
+{
+    TouchCalibration solved;
+    if (!touchCalibrationSolve(screen, raw, &solved))
+        return false;
+
+    calibration = solved;
+    Preferences prefs;
+    if (prefs.begin(TOUCH_NVS_NAMESPACE))
+    {
+        prefs.putBytes(TOUCH_NVS_KEY, &solved, sizeof(solved));
+        prefs.end();
+    }
+    Serial.printf("Touch calibrated: x = %.4f*rx %+.4f*ry %+.1f, y = %.4f*rx %+.4f*ry %+.1f\n", solved.a / 65536.0,
+                  solved.b / 65536.0, solved.c / 65536.0, solved.d / 65536.0, solved.e / 65536.0,
+                  solved.f / 65536.0);
+    return true;
+}
+
+TouchCalibration TouchInput::getCalibration()
+{
+    return calibration;
+}
+
+void TouchInput::setCalibration(const TouchCalibration &cal)
+{
+    calibration = cal;
+}
+
+TouchInputStats TouchInput::getStats()
+{
+    return stats;
+}
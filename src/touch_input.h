@@ -0,0 +1,98 @@
+#pragma once
+
+#include <Arduino.h>
+
+#define TOUCH_BURST_SIZE 5 // X/Y conversions per read; odd, for the median
+
+/**
+ * One XPT2046 read: 12-bit positions, in the orientation the old
+ * XPT2046_Touchscreen setRotation(2) produced, and pressure (Z1 + 4095 - Z2)
+ */
+struct TouchSample
+{
+    uint16_t x;
+    uint16_t y;
+    uint16_t z;
+};
+
+struct TouchPoint
+{
+    int16_t x;
+    int16_t y;
+};
+
+/**
+ * Affine map from raw to screen coordinates in 16.16 fixed point:
+ * x = (a * rawX + b * rawY + c) >> 16, y = (d * rawX + e * rawY + f) >> 16.
+ * Unlike separate per-axis ranges it also absorbs a panel mounted slightly
+ * rotated or skewed against the touch layer.
+ */
+struct TouchCalibration
+{
+    int32_t a, b, c;
+    int32_t d, e, f;
+};
+
+struct TouchInputStats
+{
+    uint32_t reads;     // LVGL input reads
+    uint32_t idleReads; // Reads answered from the pen IRQ without SPI traffic
+    uint32_t bursts;    // Bursts filtered
+    uint32_t rejected;  // Bursts too spread out to trust, e.g. while the pen lands
+    uint32_t presses;
+};
+
+/**
+ * Turns raw XPT2046 bursts into LVGL points. Each burst is reduced to its
+ * median per axis, so single spikes never reach the output, and bursts
+ * whose samples still disagree are dropped. While held, the point goes
+ * through an IIR filter that snaps on large moves so drags do not lag; a
+ * release needs TOUCH_RELEASE_READS light readings in a row so pressure
+ * dips do not split a press. The calibration is loaded from NVS, with the
+ * panel's nominal ranges as the fallback.
+ *
+ * Only guiTask may call it, from the LVGL read callback and the
+ * calibration screen.
+ */
+class TouchInput
+{
+public:
+    /** Loads the calibration; call before the first read */
+    static void begin();
+
+    /**
+     * Processes one LVGL input read
+     * @param samples Burst read from the controller, or NULL if the pen IRQ
+     *        shows the panel untouched and nothing was read
+     * @param count Samples in the burst
+     * @param point Set to the current, or last pressed, point in screen
+     *        coordinates
+     * @return true while pressed
+     */
+    static bool update(const TouchSample *samples, int count, TouchPoint *point);
+
+    /** Filtered raw position of the current or last press */
+    static TouchPoint lastRaw();
+
+    /**
+     * Solves the calibration from three touches and saves it to NVS
+     * @param screen Targets in screen coordinates
+     * @param raw Raw positions touched for them
+     * @return false if the points are (nearly) collinear
+     */
+    static bool calibrate(const TouchPoint screen[3], const TouchPoint raw[3]);
+
+    static TouchCalibration getCalibration();
+    static void setCalibration(const TouchCalibration &calibration);
+
+    static TouchInputStats getStats();
+};
+
+/** Applies a calibration to a raw point */
+TouchPoint touchCalibrationApply(const TouchCalibration &calibration, int32_t rawX, int32_t rawY);
+
+/**
+ * Solves the affine calibration mapping raw[i] onto screen[i]
+ * @return false if the points are (nearly) collinear
+ */
+bool touchCalibrationSolve(const TouchPoint screen[3], const TouchPoint raw[3], TouchCalibration *calibration);
@@ -0,0 +1,148 @@
+#include "trace.h"
+
+#include <Arduino.h>
+#include <atomic>
+#include <esp_timer.h>
+#include <mutex>
+#include <string.h>
+
+#define TRACE_SLOTS (TRACE_ENABLED ? TRACE_RING_SIZE : 1)
+#define TRACE_MAX_TASKS 12
+#define TRACE_TASK_NAME_SIZE 16
+
+struct TraceEvent
+{
+    uint32_t us; // Wraps after 71 minutes; the host tool unwraps it
+    const char *name;
+    uint8_t task;
+    char phase;
+};
+
+struct TraceTask
+{
+    TaskHandle_t handle;
+    char name[TRACE_TASK_NAME_SIZE];
+};
+
+// The ESP32's IRAM only takes 32-bit accesses, so the ring lives in internal
+// DRAM and only the recording path is placed in IRAM. Disabled builds keep
+// one slot so the functions still link.
+static DRAM_ATTR TraceEvent ring[TRACE_SLOTS];
+static std::atomic<uint32_t> head{0};
+static std::atomic<bool> recording{true};
+
+static TraceTask tasks[TRACE_MAX_TASKS];
+static std::atomic<uint32_t> taskCount{0};
+static std::mutex taskMutex;
+
+/**
+ * Small id for the calling task. A task is looked up by handle and only
+ * takes the lock the first time it records anything.
+ */
+static uint8_t IRAM_ATTR taskId()
+{
+    TaskHandle_t self = xTaskGetCurrentTaskHandle();
+    uint32_t count = taskCount.load(std::memory_order_acquire);
+    for (uint32_t i = 0; i < count; i++)
+    {
+        if (tasks[i].handle == self)
+            return i;
+    }
+
+    std::lock_guard<std::mutex> lock(taskMutex);
+    count = taskCount.load(std::memory_order_relaxed);
+    for (uint32_t i = 0; i < count; i++)
+    {
+        if (tasks[i].handle == self)
+            return i;
+    }
+    if (count == TRACE_MAX_TASKS)
+        return TRACE_MAX_TASKS - 1; // Lumped in with the last one
+
+    tasks[count].handle = self;
+    strncpy(tasks[count].name, pcTaskGetName(self), TRACE_TASK_NAME_SIZE - 1);
+    taskCount.store(count + 1, std::memory_order_release);
+    return count;
+}
+
+void IRAM_ATTR traceRecord(char phase, const char *name)
+{
+    if (!recording.load(std::memory_order_relaxed))
+        return;
+
+    uint32_t index = head.fetch_add(1, std::memory_order_relaxed);
+    TraceEvent &event = ring[index & (TRACE_SLOTS - 1)];
+    event.us = (uint32_t)esp_timer_get_time();
+    event.name = name;
+    event.task = taskId();
+    event.phase = phase;
+}
+
+static void refreshEventCb(lv_event_t *e)
+{
+    switch (lv_event_get_code(e))
+    {
+    case LV_EVENT_REFR_START:
+        TRACE_BEGIN("refresh");
+        break;
+    case LV_EVENT_REFR_READY:
+        TRACE_END("refresh");
+        break;
+    case LV_EVENT_RENDER_START:
+        TRACE_BEGIN("render");
+        break;
+    case LV_EVENT_RENDER_READY:
+        TRACE_END("render");
+        break;
+    default:
+        break;
+    }
+}
+
+void traceWatchDisplay(lv_display_t *disp)
+{
+    if (!TRACE_ENABLED)
+        return;
+
+    lv_display_add_event_cb(disp, refreshEventCb, LV_EVENT_REFR_START, NULL);
+    lv_display_add_event_cb(disp, refreshEventCb, LV_EVENT_REFR_READY, NULL);
+    lv_display_add_event_cb(disp, refreshEventCb, LV_EVENT_RENDER_START, NULL);
+    lv_display_add_event_cb(disp, refreshEventCb, LV_EVENT_RENDER_READY, NULL);
+}
+
+void traceDump()
+{
+    recording.store(false);
+    delay(1); // Let a record that already got past the check finish
+
+    uint32_t end = head.load();
+    uint32_t start = end > TRACE_SLOTS ? end - TRACE_SLOTS : 0;
+    uint32_t count = taskCount.load();
+
+    Serial.printf("trace: begin %u events, %u overwritten\n", (unsigned)(end - start), (unsigned)start);
+    for (uint32_t i = 0; i < count; i++)
+        Serial.printf("trace: task %u %s\n", (unsigned)i, tasks[i].name);
+    for (uint32_t i = start; i != end; i++)
+    {
+        const TraceEvent &event = ring[i & (TRACE_SLOTS - 1)];
+        Serial.printf("trace: %u %c %u %s\n", (unsigned)event.us, event.phase, event.task, event.name);
+    }
+    Serial.println("trace: end");
+
+    head.store(0);
+    recording.store(true);
+}
+
+void traceServiceSerial()
+{
+    while (Serial.available())
+    {
+        if (Serial.read() == 't')
+            traceDump();
+    }
+}
+
+uint32_t traceEventCount()
+{
+    return head.load();
+}
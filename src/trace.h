@@ -0,0 +1,77 @@
+#pragma once
+
+#include <lvgl.h>
+#include <stdint.h>
+
+#include "config.h"
+
+/**
+ * Timing trace: begin/end and instant events, each with a microsecond
+ * timestamp and the task it happened on, go into a fixed ring that keeps the
+ * last TRACE_RING_SIZE of them. Recording is a few stores and takes no lock,
+ * so it can sit in the GUI loop and the render path.
+ *
+ * The macros compile to nothing unless TRACE_ENABLED is set. Event names
+ * must be string literals: only the pointer is stored.
+ *
+ * traceDump() prints the ring over serial as "trace:" lines, which
+ * tools/trace_to_chrome.py turns into Chrome trace_event JSON for Perfetto
+ * or chrome://tracing.
+ */
+
+#if TRACE_ENABLED
+#define TRACE_BEGIN(name) traceRecord('B', name)
+#define TRACE_END(name) traceRecord('E', name)
+#define TRACE_INSTANT(name) traceRecord('i', name)
+#define TRACE_SCOPE(name) TraceScope TRACE_CONCAT(traceScope, __LINE__)(name)
+#define TRACE_CONCAT(a, b) TRACE_CONCAT_(a, b)
+#define TRACE_CONCAT_(a, b) a##b
+#else
+#define TRACE_BEGIN(name) ((void)0)
+#define TRACE_END(name) ((void)0)
+#define TRACE_INSTANT(name) ((void)0)
+#define TRACE_SCOPE(name) ((void)0)
+#endif
+
+/**
+ * Records one event. Use the macros rather than calling this directly.
+ * @param phase 'B' begin, 'E' end or 'i' instant, as in the Chrome format
+ * @param name Event name, a string literal
+ */
+void traceRecord(char phase, const char *name);
+
+/**
+ * Begins an event here and ends it at the end of the enclosing scope
+ */
+class TraceScope
+{
+public:
+    TraceScope(const char *name) : _name(name) { traceRecord('B', name); }
+    ~TraceScope() { traceRecord('E', _name); }
+
+private:
+    const char *_name;
+};
+
+/**
+ * Adds the display's refresh and render phases to the trace
+ * @param disp Display to watch
+ */
+void traceWatchDisplay(lv_display_t *disp);
+
+/**
+ * Prints the recorded events, oldest first, and starts the ring over.
+ * Recording pauses while it prints; at 115200 baud a full ring takes a few
+ * seconds, so call it from a task that can afford to block.
+ */
+void traceDump();
+
+/**
+ * Dumps the trace if 't' has arrived over serial since the last call
+ */
+void traceServiceSerial();
+
+/**
+ * @return Events recorded since the last dump, including overwritten ones
+ */
+uint32_t traceEventCount();
@@ -0,0 +1,134 @@
+#include "ui_cache.h"
+
+#include <Arduino.h>
+#include <Preferences.h>
+#include <stddef.h>
+#include <string.h>
+
+#define UI_CACHE_NVS_NAMESPACE "uicache"
+#define UI_CACHE_NVS_INTERVAL_MIN 10 // Song titles change every few minutes
+#define UI_CACHE_RTC_MAGIC 0x55494331 // "UIC1"
+
+struct CachedLabel
+{
+    UiLabelId label;
+    const char *key;
+};
+
+static const CachedLabel cachedLabels[] = {
+    {UI_LABEL_TEMPERATURE, "weather"},
+    {UI_LABEL_SONG, "song"},
+    {UI_LABEL_CALENDAR, "calendar"},
+};
+
+#define UI_CACHE_LABELS (sizeof(cachedLabels) / sizeof(cachedLabels[0]))
+
+/**
+ * Survives soft resets and deep sleep but holds garbage after power-on,
+ * hence the checksum
+ */
+struct RtcUiCache
+{
+    uint32_t magic;
+    uint32_t checksum;
+    uint32_t present; // Bit per label that has been cached
+    char text[UI_CACHE_LABELS][UI_UPDATE_TEXT_SIZE];
+};
+
+RTC_NOINIT_ATTR static RtcUiCache rtcCache;
+
+static bool nvsPending[UI_CACHE_LABELS];
+static uint32_t nvsWrittenAt[UI_CACHE_LABELS];
+static bool nvsWritten[UI_CACHE_LABELS];
+
+static uint32_t rtcChecksum()
+{
+    // FNV-1a
+    uint32_t hash = 2166136261u;
+    const uint8_t *bytes = (const uint8_t *)&rtcCache.present;
+    size_t length = sizeof(rtcCache) - offsetof(RtcUiCache, present);
+    for (size_t i = 0; i < length; i++)
+        hash = (hash ^ bytes[i]) * 16777619u;
+    return hash;
+}
+
+static int findLabel(UiLabelId label)
+{
+    for (size_t i = 0; i < UI_CACHE_LABELS; i++)
+    {
+        if (cachedLabels[i].label == label)
+            return i;
+    }
+    return -1;
+}
+
+static void writeNvs(int index)
+{
+    Preferences prefs;
+    if (prefs.begin(UI_CACHE_NVS_NAMESPACE))
+    {
+        prefs.putString(cachedLabels[index].key, rtcCache.text[index]);
+        prefs.end();
+    }
+    nvsPending[index] = false;
+    nvsWritten[index] = true;
+    nvsWrittenAt[index] = millis();
+}
+
+void uiCacheSave(UiLabelId label, const char *text)
+{
+    int index = findLabel(label);
+    if (index < 0)
+        return;
+
+    bool present = rtcCache.present & (1u << index);
+    if (!present || strncmp(rtcCache.text[index], text, UI_UPDATE_TEXT_SIZE - 1) != 0)
+    {
+        strncpy(rtcCache.text[index], text, UI_UPDATE_TEXT_SIZE - 1);
+        rtcCache.text[index][UI_UPDATE_TEXT_SIZE - 1] = '\0';
+        rtcCache.present |= 1u << index;
+        rtcCache.checksum = rtcChecksum();
+        nvsPending[index] = true;
+    }
+
+    // Changes that came too soon after the last write go out on a later call
+    uint32_t now = millis();
+    for (size_t i = 0; i < UI_CACHE_LABELS; i++)
+    {
+        if (nvsPending[i] && (!nvsWritten[i] || now - nvsWrittenAt[i] >= UI_CACHE_NVS_INTERVAL_MIN * 60 * 1000))
+            writeNvs(i);
+    }
+}
+
+int uiCacheRestore()
+{
+    if (rtcCache.magic != UI_CACHE_RTC_MAGIC || rtcCache.checksum != rtcChecksum())
+    {
+        // Power-on: reload RTC memory from NVS
+        memset(&rtcCache, 0, sizeof(rtcCache));
+        Preferences prefs;
+        if (prefs.begin(UI_CACHE_NVS_NAMESPACE, true))
+        {
+            for (size_t i = 0; i < UI_CACHE_LABELS; i++)
+            {
+                if (!prefs.isKey(cachedLabels[i].key))
+                    continue;
+                prefs.getString(cachedLabels[i].key, rtcCache.text[i], UI_UPDATE_TEXT_SIZE);
+                rtcCache.present |= 1u << i;
+            }
+            prefs.end();
+        }
+        rtcCache.magic = UI_CACHE_RTC_MAGIC;
+        rtcCache.checksum = rtcChecksum();
+    }
+
+    int restored = 0;
+    for (size_t i = 0; i < UI_CACHE_LABELS; i++)
+    {
+        if (!(rtcCache.present & (1u << i)))
+            continue;
+        uiApplyText(cachedLabels[i].label, rtcCache.text[i]);
+        restored++;
+    }
+    return restored;
+}
@@ -0,0 +1,24 @@
+#pragma once
+
+#include "ui_queue.h"
+
+/**
+ * Last text shown on the labels fed by the network (weather, now playing
+ * and calendar), kept so the next boot paints it in its first frame instead
+ * of placeholders. A soft reset or deep sleep reads it back from RTC memory;
+ * after a power loss it comes from NVS, which is written at most every
+ * UI_CACHE_NVS_INTERVAL_MIN per label to spare the flash.
+ */
+
+/**
+ * Remembers text just posted to a label. Other labels are ignored. Call
+ * from the network worker only; may write flash.
+ */
+void uiCacheSave(UiLabelId label, const char *text);
+
+/**
+ * Applies the remembered text to the bound labels. Call while building the
+ * UI, after uiBindLabel().
+ * @return Number of labels restored
+ */
+int uiCacheRestore();
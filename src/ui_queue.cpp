@@ -0,0 +1,155 @@
+#include "ui_queue.h"
+
+#include <string.h>
+
+#include "metrics.h"
+#include "trace.h"
+
+struct UiBinding
+{
+    lv_obj_t *obj;
+    UiLabelSetter setter;
+};
+
+static UiUpdateQueue queues[UI_LABEL_COUNT];
+static UiBinding bindings[UI_LABEL_COUNT];
+static std::atomic<uint32_t> postedCount{0};
+static UiQueueStats consumerStats;
+static TaskHandle_t consumerTask;
+
+void UiUpdateQueue::push(UiLabelId label, const char *text)
+{
+    uint32_t index = head.load(std::memory_order_relaxed);
+    Slot &slot = slots[index % UI_QUEUE_CAPACITY];
+
+    slot.seq.store(index * 2 + 1, std::memory_order_relaxed);
+    std::atomic_thread_fence(std::memory_order_release);
+
+    size_t length = strlen(text);
+    if (length >= UI_UPDATE_TEXT_SIZE)
+    {
+        length = UI_UPDATE_TEXT_SIZE - 1;
+        while (length > 0 && ((uint8_t)text[length] & 0xc0) == 0x80)
+            length--;
+    }
+    slot.update.label = label;
+    memcpy(slot.update.text, text, length);
+    slot.update.text[length] = '\0';
+
+    slot.seq.store(index * 2 + 2, std::memory_order_release);
+    head.store(index + 1, std::memory_order_release);
+}
+
+bool UiUpdateQueue::pop(UiUpdate &out, uint32_t &overwritten)
+{
+    while (true)
+    {
+        uint32_t currentHead = head.load(std::memory_order_acquire);
+        if (tail == currentHead)
+            return false;
+
+        // The producer lapped us; everything older than one ring is gone
+        if (currentHead - tail > UI_QUEUE_CAPACITY)
+        {
+            overwritten += currentHead - tail - UI_QUEUE_CAPACITY;
+            tail = currentHead - UI_QUEUE_CAPACITY;
+        }
+
+        Slot &slot = slots[tail % UI_QUEUE_CAPACITY];
+        uint32_t expected = tail * 2 + 2;
+        tail++;
+
+        if (slot.seq.load(std::memory_order_acquire) != expected)
+        {
+            overwritten++;
+            continue;
+        }
+
+        memcpy(&out, &slot.update, sizeof(out));
+        std::atomic_thread_fence(std::memory_order_acquire);
+
+        // Rewritten while we were copying: the copy may be torn
+        if (slot.seq.load(std::memory_order_relaxed) != expected)
+        {
+            overwritten++;
+            continue;
+        }
+
+        return true;
+    }
+}
+
+void uiBindLabel(UiLabelId label, lv_obj_t *obj, UiLabelSetter setter)
+{
+    bindings[label].obj = obj;
+    bindings[label].setter = setter;
+}
+
+void uiApplyText(UiLabelId label, const char *text)
+{
+    if (bindings[label].obj)
+        bindings[label].setter(bindings[label].obj, text);
+}
+
+static void exportMetrics()
+{
+    static Metric *posted = Metrics::counter("ui.posted");
+    static Metric *overwritten = Metrics::counter("ui.overwritten");
+    static Metric *applied = Metrics::counter("ui.applied");
+
+    UiQueueStats current = getUiQueueStats();
+    posted->set(current.posted);
+    overwritten->set(current.overwritten);
+    applied->set(current.applied);
+}
+
+void uiSetConsumerTask(TaskHandle_t task)
+{
+    Metrics::addSource(exportMetrics);
+    consumerTask = task;
+}
+
+void uiPostText(UiLabelId label, const char *text)
+{
+    TRACE_INSTANT("ui post");
+    queues[label].push(label, text);
+    postedCount.fetch_add(1, std::memory_order_relaxed);
+
+    if (consumerTask)
+        xTaskNotifyGive(consumerTask);
+}
+
+uint32_t uiDrainUpdates()
+{
+    static UiUpdate latest[UI_LABEL_COUNT];
+    bool pending[UI_LABEL_COUNT] = {};
+    UiUpdate update;
+    uint32_t updated = 0;
+
+    for (int label = 0; label < UI_LABEL_COUNT; label++)
+    {
+        while (queues[label].pop(update, consumerStats.overwritten))
+        {
+            if (pending[label])
+                consumerStats.coalesced++;
+            latest[label] = update;
+            pending[label] = true;
+        }
+
+        if (!pending[label] || !bindings[label].obj)
+            continue;
+
+        bindings[label].setter(bindings[label].obj, latest[label].text);
+        consumerStats.applied++;
+        updated++;
+    }
+
+    return updated;
+}
+
+UiQueueStats getUiQueueStats()
+{
+    UiQueueStats stats = consumerStats;
+    stats.posted = postedCount.load(std::memory_order_relaxed);
+    return stats;
+}
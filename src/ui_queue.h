@@ -0,0 +1,114 @@
+#pragma once
+
+#include <atomic>
+#include <lvgl.h>
+#include <freertos/FreeRTOS.h>
+#include <freertos/task.h>
+
+#define UI_UPDATE_TEXT_SIZE 128
+#define UI_QUEUE_CAPACITY 4
+
+/**
+ * Labels that background tasks may update. Each label must only ever be
+ * posted to from one task, which makes every queue single-producer.
+ */
+enum UiLabelId : uint8_t
+{
+    UI_LABEL_TIME,
+    UI_LABEL_DATE,
+    UI_LABEL_TEMPERATURE,
+    UI_LABEL_SONG,
+    UI_LABEL_CALENDAR,
+    UI_LABEL_SONG_PROGRESS,
+    UI_LABEL_ALBUM_ART,
+    UI_LABEL_COUNT,
+};
+
+struct UiUpdate
+{
+    UiLabelId label;
+    char text[UI_UPDATE_TEXT_SIZE];
+};
+
+struct UiQueueStats
+{
+    uint32_t posted;      // Updates pushed by producers
+    uint32_t overwritten; // Updates overwritten before guiTask saw them
+    uint32_t coalesced;   // Updates superseded by a newer one in the same drain
+    uint32_t applied;     // Updates applied to a widget
+};
+
+/**
+ * Lossy single-producer/single-consumer ring of UI updates. push() never
+ * blocks: when the ring is full it overwrites the oldest entry, so a slow
+ * consumer only ever loses stale updates. Each slot carries a sequence
+ * number that is odd while being written, letting the consumer detect (and
+ * skip) slots overwritten underneath it without taking a lock.
+ */
+class UiUpdateQueue
+{
+public:
+    /** Producer side. Text longer than the slot is cut at a UTF-8 boundary. */
+    void push(UiLabelId label, const char *text);
+
+    /**
+     * Consumer side
+     * @param out Filled with the oldest intact update
+     * @param overwritten Incremented for each update lost to overwriting
+     * @return false if the queue is empty
+     */
+    bool pop(UiUpdate &out, uint32_t &overwritten);
+
+private:
+    struct Slot
+    {
+        std::atomic<uint32_t> seq{0};
+        UiUpdate update;
+    };
+
+    Slot slots[UI_QUEUE_CAPACITY];
+    std::atomic<uint32_t> head{0};
+    uint32_t tail = 0;
+};
+
+typedef void (*UiLabelSetter)(lv_obj_t *obj, const char *text);
+
+/**
+ * Routes updates for a label id to a widget. Called while building the UI,
+ * before guiTask starts draining.
+ * @param label Label id
+ * @param obj Widget to update
+ * @param setter Function applying text to the widget, e.g. lv_label_set_text
+ */
+void uiBindLabel(UiLabelId label, lv_obj_t *obj, UiLabelSetter setter);
+
+/**
+ * Applies text to a bound label right away, bypassing the queues. Only for
+ * filling in the UI while it is built, before guiTask starts.
+ */
+void uiApplyText(UiLabelId label, const char *text);
+
+/**
+ * Sets the task to notify whenever text is posted, so it can sleep until
+ * there is something to draw
+ */
+void uiSetConsumerTask(TaskHandle_t task);
+
+/**
+ * Queues new text for a label and notifies the consumer task. Safe to call
+ * from the label's producer task at any time; never blocks and never
+ * touches LVGL.
+ */
+void uiPostText(UiLabelId label, const char *text);
+
+/**
+ * Drains all queues and applies the newest text per label. Only guiTask may
+ * call this, before lv_task_handler().
+ * @return Number of labels updated
+ */
+uint32_t uiDrainUpdates();
+
+/**
+ * Returns the queue counters since startup
+ */
+UiQueueStats getUiQueueStats();
@@ -0,0 +1,299 @@
+#include "wifi_manager.h"
+
+#include <Preferences.h>
+#include <WiFi.h>
+#include <atomic>
+#include <mutex>
+
+#include "metrics.h"
+#include "secrets.h"
+
+#define WIFI_NVS_NAMESPACE "wifi"
+#define WIFI_ATTEMPT_TIMEOUT_MS 15000
+#define WIFI_RETRY_MIN_MS 1000
+#define WIFI_RETRY_MAX_MS 60000
+#define WIFI_EVENT_QUEUE_SIZE 8 // Power of two
+
+/**
+ * Link events handed from the WiFi event task to the manager task
+ */
+struct WiFiEvent
+{
+    bool connected;
+    uint8_t reason; // Disconnect reason
+};
+
+static WiFiEvent eventQueue[WIFI_EVENT_QUEUE_SIZE];
+static std::atomic<uint32_t> eventHead{0};
+static uint32_t eventTail;
+
+static TaskHandle_t managerTask;
+static WiFiStateCallback stateCallback;
+static std::atomic<uint8_t> state{WIFI_STATE_CONNECTING};
+static std::atomic<bool> fastReconnect{true};
+static WiFiManagerStats stats;
+static std::mutex statsMutex; // Stats are read from other tasks
+
+static uint8_t cachedBssid[6];
+static int32_t cachedChannel; // 0 when nothing is cached
+static bool attemptFast;      // Current attempt skips the scan
+static uint32_t attemptStartedAt;
+static uint32_t linkLostAt;   // Start of the outage being measured
+static uint32_t retryDelayMs;
+static uint32_t retryAt;
+
+static const uint32_t latencyBucketLimits[WIFI_LATENCY_BUCKETS] = WIFI_LATENCY_BUCKET_LIMITS_MS;
+static_assert(WIFI_LATENCY_BUCKETS == METRIC_BUCKETS, "wifi.latency_ms mirrors the latency histogram");
+static Metric *latencyMetric;
+
+static void onWiFiEvent(arduino_event_id_t event, arduino_event_info_t info)
+{
+    WiFiEvent linkEvent = {};
+    if (event == ARDUINO_EVENT_WIFI_STA_GOT_IP)
+        linkEvent.connected = true;
+    else if (event == ARDUINO_EVENT_WIFI_STA_DISCONNECTED)
+        linkEvent.reason = info.wifi_sta_disconnected.reason;
+    else
+        return;
+
+    // The event task is the only producer; a full queue drops the oldest
+    uint32_t head = eventHead.load(std::memory_order_relaxed);
+    eventQueue[head % WIFI_EVENT_QUEUE_SIZE] = linkEvent;
+    eventHead.store(head + 1, std::memory_order_release);
+    if (managerTask)
+        xTaskNotifyGive(managerTask);
+}
+
+static void loadCachedAp()
+{
+    Preferences prefs;
+    if (!prefs.begin(WIFI_NVS_NAMESPACE, true))
+        return;
+
+    if (prefs.getBytes("bssid", cachedBssid, sizeof(cachedBssid)) == sizeof(cachedBssid))
+        cachedChannel = prefs.getInt("channel", 0);
+    prefs.end();
+}
+
+static void saveCachedAp()
+{
+    const uint8_t *bssid = WiFi.BSSID();
+    int32_t channel = WiFi.channel();
+    if (!bssid || (channel == cachedChannel && memcmp(bssid, cachedBssid, sizeof(cachedBssid)) == 0))
+        return;
+
+    memcpy(cachedBssid, bssid, sizeof(cachedBssid));
+    cachedChannel = channel;
+
+    Preferences prefs;
+    if (!prefs.begin(WIFI_NVS_NAMESPACE))
+        return;
+    prefs.putBytes("bssid", cachedBssid, sizeof(cachedBssid));
+    prefs.putInt("channel", cachedChannel);
+    prefs.end();
+}
+
+static void startAttempt(uint32_t now)
+{
+    attemptFast = fastReconnect && cachedChannel > 0;
+    attemptStartedAt = now;
+    state = WIFI_STATE_CONNECTING;
+
+    if (attemptFast)
+        WiFi.begin(WIFI_SSID, WIFI_PASSWORD, cachedChannel, cachedBssid);
+    else
+        WiFi.begin(WIFI_SSID, WIFI_PASSWORD);
+}
+
+static void recordLatency(uint32_t latencyMs)
+{
+    int bucket = 0;
+    while (bucket < WIFI_LATENCY_BUCKETS - 1 && latencyMs >= latencyBucketLimits[bucket])
+        bucket++;
+    stats.latencyHistogram[bucket]++;
+    latencyMetric->observe(latencyMs);
+    if (latencyMs > stats.latencyMsMax)
+        stats.latencyMsMax = latencyMs;
+}
+
+static void handleConnected(uint32_t now)
+{
+    if (state == WIFI_STATE_CONNECTED)
+        return; // DHCP renewal
+
+    uint32_t latencyMs = now - linkLostAt;
+    {
+        std::lock_guard<std::mutex> lock(statsMutex);
+        stats.connects++;
+        if (attemptFast)
+            stats.fastConnects++;
+        else
+            stats.scanConnects++;
+        recordLatency(latencyMs);
+    }
+
+    state = WIFI_STATE_CONNECTED;
+    retryDelayMs = 0;
+    Serial.printf("WiFi connected in %u ms (%s), channel %d, RSSI %d\n", (unsigned)latencyMs,
+                  attemptFast ? "cached AP" : "scan", (int)WiFi.channel(), (int)WiFi.RSSI());
+
+    saveCachedAp();
+    if (stateCallback)
+        stateCallback(true);
+}
+
+static void handleAttemptFailed(uint32_t now, uint8_t reason)
+{
+    {
+        std::lock_guard<std::mutex> lock(statsMutex);
+        stats.failedAttempts++;
+        if (attemptFast)
+            stats.fastMisses++;
+    }
+
+    // The cached access point is gone or moved: scan straight away
+    if (attemptFast)
+    {
+        if (reason == WIFI_REASON_NO_AP_FOUND)
+            cachedChannel = 0;
+        attemptFast = false;
+        attemptStartedAt = now;
+        WiFi.begin(WIFI_SSID, WIFI_PASSWORD);
+        return;
+    }
+
+    retryDelayMs = retryDelayMs == 0 ? WIFI_RETRY_MIN_MS : retryDelayMs * 2;
+    if (retryDelayMs > WIFI_RETRY_MAX_MS)
+        retryDelayMs = WIFI_RETRY_MAX_MS;
+    retryAt = now + retryDelayMs;
+    state = WIFI_STATE_BACKOFF;
+    Serial.printf("WiFi connect failed (reason %u), retrying in %u ms\n", reason, (unsigned)retryDelayMs);
+}
+
+static void handleDisconnected(uint32_t now, uint8_t reason)
+{
+    if (state == WIFI_STATE_CONNECTED)
+    {
+        Serial.printf("WiFi lost (reason %u)\n", reason);
+        statsMutex.lock();
+        stats.disconnects++;
+        statsMutex.unlock();
+        linkLostAt = now;
+        if (stateCallback)
+            stateCallback(false);
+
+        // Most drops are the same access point coming back; try it first
+        retryDelayMs = 0;
+        startAttempt(now);
+    }
+    else if (state == WIFI_STATE_CONNECTING && reason != WIFI_REASON_ASSOC_LEAVE)
+    {
+        // ASSOC_LEAVE is our own disconnect() after a timeout
+        handleAttemptFailed(now, reason);
+    }
+}
+
+static void wifiManagerTask(void *pvParameters)
+{
+    // Set here too: the first event can beat xTaskCreate() returning
+    managerTask = xTaskGetCurrentTaskHandle();
+
+    uint32_t now = millis();
+    linkLostAt = now;
+    startAttempt(now);
+
+    while (1)
+    {
+        // Sleep until an event, or the attempt's timeout or retry time
+        TickType_t wait = portMAX_DELAY;
+        if (state != WIFI_STATE_CONNECTED)
+        {
+            uint32_t deadline = state == WIFI_STATE_CONNECTING ? attemptStartedAt + WIFI_ATTEMPT_TIMEOUT_MS : retryAt;
+            int32_t waitMs = (int32_t)(deadline - now);
+            wait = pdMS_TO_TICKS(waitMs > 0 ? waitMs : 0);
+        }
+        ulTaskNotifyTake(pdTRUE, wait);
+
+        now = millis();
+        uint32_t head = eventHead.load(std::memory_order_acquire);
+        if (head - eventTail > WIFI_EVENT_QUEUE_SIZE)
+            eventTail = head - WIFI_EVENT_QUEUE_SIZE;
+
+        for (; eventTail != head; eventTail++)
+        {
+            const WiFiEvent &event = eventQueue[eventTail % WIFI_EVENT_QUEUE_SIZE];
+            if (event.connected)
+                handleConnected(now);
+            else
+                handleDisconnected(now, event.reason);
+        }
+
+        if (state == WIFI_STATE_CONNECTING && (int32_t)(now - attemptStartedAt) >= WIFI_ATTEMPT_TIMEOUT_MS)
+        {
+            WiFi.disconnect();
+            handleAttemptFailed(now, 0);
+        }
+        else if (state == WIFI_STATE_BACKOFF && (int32_t)(now - retryAt) >= 0)
+        {
+            startAttempt(now);
+        }
+    }
+}
+
+static void exportMetrics()
+{
+    static Metric *connects = Metrics::counter("wifi.connects");
+    static Metric *disconnects = Metrics::counter("wifi.disconnects");
+    static Metric *failedAttempts = Metrics::counter("wifi.failed_attempts");
+    static Metric *latencyMsMax = Metrics::gauge("wifi.latency_ms_max");
+
+    WiFiManagerStats current = WiFiManager::getStats();
+    connects->set(current.connects);
+    disconnects->set(current.disconnects);
+    failedAttempts->set(current.failedAttempts);
+    latencyMsMax->set(current.latencyMsMax);
+}
+
+void WiFiManager::start(WiFiStateCallback onStateChange, uint32_t stackSize, UBaseType_t priority,
+                        BaseType_t core)
+{
+    // The stats count a latency under a bucket's limit; metric bounds are inclusive
+    uint32_t latencyBounds[METRIC_BUCKETS - 1];
+    for (int i = 0; i < METRIC_BUCKETS - 1; i++)
+        latencyBounds[i] = latencyBucketLimits[i] - 1;
+    latencyMetric = Metrics::histogram("wifi.latency_ms", latencyBounds);
+    Metrics::addSource(exportMetrics);
+    stateCallback = onStateChange;
+    loadCachedAp();
+
+    // The manager does its own reconnecting, and keeps the AP in its own NVS
+    // namespace instead of rewriting the driver's config on every begin()
+    WiFi.persistent(false);
+    WiFi.setAutoReconnect(false);
+    WiFi.mode(WIFI_STA);
+    WiFi.onEvent(onWiFiEvent);
+
+    Serial.printf("Connecting to WiFi: %s%s\n", WIFI_SSID, cachedChannel > 0 ? " (cached AP)" : "");
+    xTaskCreatePinnedToCore(wifiManagerTask, "wifi", stackSize, NULL, priority, &managerTask, core);
+}
+
+bool WiFiManager::isConnected()
+{
+    return state == WIFI_STATE_CONNECTED;
+}
+
+WiFiState WiFiManager::getState()
+{
+    return (WiFiState)state.load();
+}
+
+void WiFiManager::setFastReconnect(bool enabled)
+{
+    fastReconnect = enabled;
+}
+
+WiFiManagerStats WiFiManager::getStats()
+{
+    std::lock_guard<std::mutex> lock(statsMutex);
+    return stats;
+}
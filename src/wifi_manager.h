@@ -0,0 +1,64 @@
+#pragma once
+
+#include <Arduino.h>
+
+#define WIFI_LATENCY_BUCKETS 8
+
+/** Upper bounds of the reconnect latency buckets; the last is open-ended */
+#define WIFI_LATENCY_BUCKET_LIMITS_MS {250, 500, 1000, 2000, 4000, 8000, 16000, 0}
+
+enum WiFiState : uint8_t
+{
+    WIFI_STATE_CONNECTING,
+    WIFI_STATE_CONNECTED,
+    WIFI_STATE_BACKOFF, // Waiting to retry after a failed attempt
+};
+
+struct WiFiManagerStats
+{
+    uint32_t connects;
+    uint32_t disconnects;
+    uint32_t fastConnects;  // Joined the cached BSSID and channel without a scan
+    uint32_t scanConnects;
+    uint32_t fastMisses;    // Cached access point gone; fell back to a scan
+    uint32_t failedAttempts;
+    uint32_t latencyMsMax;
+    // Time from losing the link (or from boot) until an IP address, by
+    // WIFI_LATENCY_BUCKET_LIMITS_MS
+    uint32_t latencyHistogram[WIFI_LATENCY_BUCKETS];
+};
+
+/**
+ * Called on the manager's task whenever the link comes up or goes down
+ */
+typedef void (*WiFiStateCallback)(bool connected);
+
+/**
+ * Keeps the station connected. Driven by WiFi events rather than polling:
+ * a task sleeps until the event handler or a retry deadline wakes it. The
+ * BSSID and channel of the last access point are kept in NVS, so a
+ * reconnect (or boot) joins it directly instead of scanning every channel;
+ * if it has gone, the next attempt scans. Failed attempts back off
+ * exponentially.
+ */
+class WiFiManager
+{
+public:
+    /**
+     * Starts connecting and the manager task
+     * @param onStateChange Told about every link change
+     */
+    static void start(WiFiStateCallback onStateChange, uint32_t stackSize, UBaseType_t priority,
+                      BaseType_t core);
+
+    static bool isConnected();
+    static WiFiState getState();
+
+    /**
+     * Enables or disables joining the cached access point directly, for
+     * comparing reconnect latency. On by default.
+     */
+    static void setFastReconnect(bool enabled);
+
+    static WiFiManagerStats getStats();
+};
@@ -0,0 +1,329 @@
+#!/usr/bin/env python3
+"""
+Decode the CYD Clock's metrics frames from a serial log
+
+Reads the "metrics:" lines the clock prints every METRICS_INTERVAL_MS (see
+src/metrics.h) and prints, for the last run in the log, every metric's
+range, histogram percentiles, per-task stack headroom and CPU, and the heap
+trend. A largest free block that keeps shrinking while free heap holds
+steady is fragmentation; both shrinking is a leak. Other lines in the log
+are ignored, as are frames that fail their CRC.
+
+    pio device monitor | tee clock.log
+    python tools/metrics_decode.py clock.log
+    python tools/metrics_decode.py clock.log --csv clock.csv
+    python tools/metrics_decode.py clock.log --check   # exit 1 on a regression
+
+Uses only the standard library.
+"""
+
+import argparse
+import base64
+import binascii
+import csv
+import sys
+
+PREFIX = "metrics: "
+VERSION = 1
+COUNTER, GAUGE, HISTOGRAM = 0, 1, 2
+TYPE_NAMES = {COUNTER: "counter", GAUGE: "gauge", HISTOGRAM: "histogram"}
+WRAP = 1 << 32  # Uptime, counters and histogram sums are 32-bit
+
+
+def crc16(data):
+    """CRC-16/CCITT-FALSE, as the clock computes it"""
+    crc = 0xFFFF
+    for byte in data:
+        crc ^= byte << 8
+        for _ in range(8):
+            crc = ((crc << 1) ^ 0x1021) if crc & 0x8000 else crc << 1
+        crc &= 0xFFFF
+    return crc
+
+
+class Reader:
+    def __init__(self, data):
+        self.data = data
+        self.pos = 0
+
+    def byte(self):
+        value = self.data[self.pos]
+        self.pos += 1
+        return value
+
+    def varint(self):
+        value, shift = 0, 0
+        while True:
+            byte = self.byte()
+            value |= (byte & 0x7F) << shift
+            shift += 7
+            if not byte & 0x80:
+                return value
+
+    def bytes(self, length):
+        value = self.data[self.pos:self.pos + length]
+        if len(value) < length:
+            raise IndexError
+        self.pos += length
+        return value
+
+
+def read_frames(lines):
+    """
+    Yield (kind, sample, uptime_ms, first, count, reader) for each frame
+    that decodes and passes its CRC
+    """
+    for line in lines:
+        start = line.find(PREFIX)
+        if start < 0:
+            continue
+        try:
+            data = base64.b64decode(line[start + len(PREFIX):].strip(), validate=True)
+        except (binascii.Error, ValueError):
+            continue
+        if len(data) < 8 or crc16(data[:-2]) != int.from_bytes(data[-2:], "big"):
+            continue
+
+        reader = Reader(data[:-2])
+        try:
+            if reader.byte() != VERSION:
+                continue
+            kind = chr(reader.byte())
+            sample, uptime, first = reader.varint(), reader.varint(), reader.varint()
+            count = reader.byte()
+        except IndexError:
+            continue
+        yield kind, sample, uptime, first, count, reader
+
+
+class Unwrapper:
+    """Undoes 32-bit wrap-around of values that only go up"""
+
+    def __init__(self):
+        self.state = {}
+
+    def __call__(self, key, raw):
+        last, offset = self.state.get(key, (raw, 0))
+        if raw < last:
+            offset += WRAP
+        self.state[key] = (raw, offset)
+        return raw + offset
+
+
+class Run:
+    """Samples from one boot of the clock"""
+
+    def __init__(self):
+        self.schema = {}  # index -> (type, name, bounds)
+        self.samples = {}  # sample number -> {"uptime": ms, "values": {name: value}}
+        self.unwrap = Unwrapper()
+        self.unknown = 0  # Value entries that arrived before their schema
+        self.last_sample = -1
+
+    def add_schema(self, first, count, reader):
+        for index in range(first, first + count):
+            kind = reader.byte()
+            name = reader.bytes(reader.byte()).decode(errors="replace")
+            bounds = [reader.varint() for _ in range(reader.byte())] if kind == HISTOGRAM else None
+            self.schema[index] = (kind, name, bounds)
+
+    def add_values(self, sample, uptime, first, count, reader):
+        entry = self.samples.setdefault(sample, {"uptime": self.unwrap("uptime", uptime), "values": {}})
+        values = entry["values"]
+        for index in range(first, first + count):
+            if index not in self.schema:
+                # Entries are variable length: without the schema the rest of
+                # the frame cannot be read
+                self.unknown += first + count - index
+                return
+            kind, name, bounds = self.schema[index]
+            if kind == COUNTER:
+                values[name] = self.unwrap(name, reader.varint())
+            elif kind == GAUGE:
+                raw = reader.varint()
+                values[name] = (raw >> 1) ^ -(raw & 1)
+            else:
+                counts = [self.unwrap((name, i), reader.varint()) for i in range(len(bounds) + 1)]
+                values[name] = (counts, self.unwrap((name, "sum"), reader.varint()))
+
+    def metrics(self):
+        return [self.schema[i] for i in sorted(self.schema)]
+
+    def series(self, name, since_hours=0):
+        """(hours, value) for each sample that has the metric"""
+        points = []
+        for sample in sorted(self.samples):
+            entry = self.samples[sample]
+            hours = entry["uptime"] / 3600000.0
+            if name in entry["values"] and hours >= since_hours:
+                points.append((hours, entry["values"][name]))
+        return points
+
+
+def read_runs(lines):
+    runs = [Run()]
+    for kind, sample, uptime, first, count, reader in read_frames(lines):
+        run = runs[-1]
+        # The sample number starts over when the clock reboots
+        if sample < run.last_sample:
+            run = Run()
+            runs.append(run)
+        run.last_sample = sample
+        try:
+            if kind == "S":
+                run.add_schema(first, count, reader)
+            elif kind == "V":
+                run.add_values(sample, uptime, first, count, reader)
+        except IndexError:
+            continue
+    return [run for run in runs if run.samples]
+
+
+def slope(points):
+    """Least-squares change per hour, or None with too few points"""
+    if len(points) < 3:
+        return None
+    n = len(points)
+    mean_x = sum(x for x, _ in points) / n
+    mean_y = sum(y for _, y in points) / n
+    var_x = sum((x - mean_x) ** 2 for x, _ in points)
+    if var_x == 0:
+        return None
+    return sum((x - mean_x) * (y - mean_y) for x, y in points) / var_x
+
+
+def percentile(counts, bounds, fraction):
+    """Upper bound of the bucket holding the given fraction of observations"""
+    total = sum(counts)
+    if not total:
+        return "-"
+    running = 0
+    for i, count in enumerate(counts):
+        running += count
+        if running >= fraction * total:
+            return f"<={bounds[i]}" if i < len(bounds) else f">{bounds[-1]}"
+    return "-"
+
+
+def print_summary(run, restarts, warmup_hours):
+    samples = sorted(run.samples)
+    hours = (run.samples[samples[-1]]["uptime"] - run.samples[samples[0]]["uptime"]) / 3600000.0
+    print(f"{len(samples)} samples over {hours:.2f} h", end="")
+    print(f", after {restarts} restart{'s' if restarts != 1 else ''} earlier in the log" if restarts else "")
+    if run.unknown:
+        print(f"{run.unknown} values skipped: sent before their schema")
+
+    print(f"\n{'metric':<24} {'type':<9} {'first':>11} {'min':>11} {'max':>11} {'last':>11}")
+    for kind, name, bounds in run.metrics():
+        if kind == HISTOGRAM:
+            continue
+        values = [value for _, value in run.series(name)]
+        if values:
+            print(f"{name:<24} {TYPE_NAMES[kind]:<9} {values[0]:>11} {min(values):>11} {max(values):>11} "
+                  f"{values[-1]:>11}")
+
+    histograms = [(name, bounds) for kind, name, bounds in run.metrics() if kind == HISTOGRAM]
+    if histograms:
+        print(f"\n{'histogram':<24} {'count':>9} {'mean':>9} {'p50':>9} {'p95':>9} {'p99':>9}")
+        for name, bounds in histograms:
+            series = run.series(name)
+            if not series:
+                continue
+            counts, total = series[-1][1]
+            n = sum(counts)
+            mean = f"{total / n:.0f}" if n else "-"
+            print(f"{name:<24} {n:>9} {mean:>9} {percentile(counts, bounds, 0.5):>9} "
+                  f"{percentile(counts, bounds, 0.95):>9} {percentile(counts, bounds, 0.99):>9}")
+
+    tasks = sorted(name[len("stack."):] for _, name, _ in run.metrics() if name.startswith("stack."))
+    if tasks:
+        print(f"\n{'task':<18} {'min free stack':>15} {'avg cpu':>8} {'max cpu':>8}")
+        for task in tasks:
+            stack = [value for _, value in run.series("stack." + task)]
+            cpu = [value / 10.0 for _, value in run.series("cpu." + task)]
+            cpu_avg = f"{sum(cpu) / len(cpu):.1f}%" if cpu else "-"
+            cpu_max = f"{max(cpu):.1f}%" if cpu else "-"
+            print(f"{task:<18} {min(stack):>13} B {cpu_avg:>8} {cpu_max:>8}")
+
+    print(f"\nheap trend per hour after {warmup_hours * 60:.0f} min:", end="")
+    for name, unit in (("heap.free", "B"), ("heap.largest", "B"), ("heap.frag_pct", "%")):
+        change = slope(run.series(name, warmup_hours))
+        print(f"  {name} {'-' if change is None else f'{change:+.0f} {unit}'}", end="")
+    print()
+
+
+def check(run, warmup_hours, max_largest_drop, min_stack):
+    """
+    @return Descriptions of the regressions found
+    """
+    problems = []
+    change = slope(run.series("heap.largest", warmup_hours))
+    if change is not None and change < -max_largest_drop:
+        free_change = slope(run.series("heap.free", warmup_hours)) or 0
+        cause = "leak" if free_change < -max_largest_drop else "fragmentation"
+        problems.append(f"largest free block shrinking {-change:.0f} B/h ({cause}; free heap {free_change:+.0f} B/h)")
+
+    for _, name, _ in run.metrics():
+        if name.startswith("stack."):
+            lowest = min(value for _, value in run.series(name))
+            if lowest < min_stack:
+                problems.append(f"{name[len('stack.'):]} down to {lowest} B of free stack")
+    return problems
+
+
+def write_csv(run, path):
+    columns = []
+    for kind, name, bounds in run.metrics():
+        columns += [name + ".count", name + ".sum"] if kind == HISTOGRAM else [name]
+
+    with open(path, "w", newline="") as out:
+        writer = csv.writer(out)
+        writer.writerow(["uptime_s"] + columns)
+        for sample in sorted(run.samples):
+            entry = run.samples[sample]
+            row = [f"{entry['uptime'] / 1000.0:.1f}"]
+            for kind, name, _ in run.metrics():
+                value = entry["values"].get(name)
+                if kind == HISTOGRAM:
+                    row += [sum(value[0]), value[1]] if value else ["", ""]
+                else:
+                    row.append("" if value is None else value)
+            writer.writerow(row)
+
+
+def main():
+    parser = argparse.ArgumentParser(description=__doc__.strip().splitlines()[0])
+    parser.add_argument("log", nargs="?", help="serial log (default: stdin)")
+    parser.add_argument("--csv", help="also write every sample to this CSV file")
+    parser.add_argument("--check", action="store_true",
+                        help="exit with status 1 if the heap or a stack looks like it is running out")
+    parser.add_argument("--warmup", type=float, default=10,
+                        help="minutes after boot left out of the heap trend, while caches fill (default: 10)")
+    parser.add_argument("--max-largest-drop", type=float, default=1024,
+                        help="bytes per hour the largest free block may shrink (default: 1024)")
+    parser.add_argument("--min-stack", type=int, default=512,
+                        help="least free stack a task may have, in bytes (default: 512)")
+    args = parser.parse_args()
+
+    with open(args.log, errors="replace") if args.log else sys.stdin as log:
+        runs = read_runs(log)
+    if not runs:
+        sys.exit("No metrics frames found: is METRICS_INTERVAL_MS set in src/config.h?")
+
+    run = runs[-1]
+    warmup_hours = args.warmup / 60.0
+    print_summary(run, len(runs) - 1, warmup_hours)
+    if args.csv:
+        write_csv(run, args.csv)
+
+    if args.check:
+        problems = check(run, warmup_hours, args.max_largest_drop, args.min_stack)
+        for problem in problems:
+            print(f"FAIL: {problem}")
+        if problems:
+            sys.exit(1)
+        print("OK: no heap or stack regression")
+
+
+if __name__ == "__main__":
+    main()
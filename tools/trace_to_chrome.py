@@ -0,0 +1,121 @@
+#!/usr/bin/env python3
+"""
+Convert a CYD Clock timing trace to Chrome trace_event JSON
+
+Reads a serial log containing a trace dump (the "trace:" lines printed when
+'t' is sent to a TRACE_ENABLED build, or by the native build's --trace) and
+writes JSON that Perfetto (https://ui.perfetto.dev) and chrome://tracing
+open. Other lines in the log are ignored; if it holds several dumps, the
+last one is used.
+
+    pio device monitor | tee clock.log      # then send 't'
+    python tools/trace_to_chrome.py clock.log > clock.json
+
+Uses only the standard library.
+"""
+
+import argparse
+import json
+import sys
+
+PREFIX = "trace: "
+WRAP = 1 << 32  # Timestamps are 32-bit microseconds
+
+
+def read_dumps(lines):
+    """
+    Split the log into dumps, each a (tasks, events) pair
+    """
+    dumps = []
+    tasks, events = None, None
+    for line in lines:
+        start = line.find(PREFIX)
+        if start < 0:
+            continue
+        fields = line[start + len(PREFIX):].rstrip("\r\n").split(" ", 3)
+
+        if fields[0] == "begin":
+            tasks, events = {}, []
+        elif events is None:
+            continue
+        elif fields[0] == "end":
+            dumps.append((tasks, events))
+            tasks, events = None, None
+        elif fields[0] == "task" and len(fields) >= 3:
+            tasks[int(fields[1])] = " ".join(fields[2:])
+        elif len(fields) == 4:
+            events.append((int(fields[0]), fields[1], int(fields[2]), fields[3]))
+
+    # A dump cut off by the end of the log is still worth looking at
+    if events:
+        dumps.append((tasks, events))
+    return dumps
+
+
+def to_chrome(tasks, events):
+    """
+    Build trace_event records. Timestamps are unwrapped, the ring's cut-off
+    leaves ends without a begin (dropped) and begins without an end (closed
+    at the last timestamp).
+    """
+    records = []
+    for task_id, name in sorted(tasks.items()):
+        records.append({"name": "thread_name", "ph": "M", "pid": 1, "tid": task_id, "args": {"name": name}})
+
+    offset = 0
+    last = None
+    open_events = {}
+    for us, phase, task_id, name in events:
+        if last is not None and us + offset < last - WRAP // 2:
+            offset += WRAP
+        ts = us + offset
+        last = ts
+
+        stack = open_events.setdefault(task_id, [])
+        if phase == "B":
+            stack.append(name)
+        elif phase == "E":
+            if name not in stack:
+                continue
+            # Unwind anything left open inside it, so the nesting stays valid
+            while stack:
+                inner = stack.pop()
+                if inner == name:
+                    break
+                records.append({"name": inner, "ph": "E", "ts": ts, "pid": 1, "tid": task_id})
+
+        record = {"name": name, "ph": phase, "ts": ts, "pid": 1, "tid": task_id}
+        if phase == "i":
+            record["s"] = "t"
+        records.append(record)
+
+    for task_id, stack in open_events.items():
+        for name in reversed(stack):
+            records.append({"name": name, "ph": "E", "ts": last, "pid": 1, "tid": task_id})
+
+    return {"traceEvents": records, "displayTimeUnit": "ms"}
+
+
+def main():
+    parser = argparse.ArgumentParser(description=__doc__.strip().splitlines()[0])
+    parser.add_argument("log", nargs="?", help="serial log (default: stdin)")
+    parser.add_argument("-o", "--output", help="JSON file to write (default: stdout)")
+    args = parser.parse_args()
+
+    with open(args.log, errors="replace") if args.log else sys.stdin as log:
+        dumps = read_dumps(log)
+    if not dumps:
+        sys.exit("No trace dump found: send 't' to a TRACE_ENABLED build, or run the native build with --trace")
+
+    tasks, events = dumps[-1]
+    trace = to_chrome(tasks, events)
+    if args.output:
+        with open(args.output, "w") as out:
+            json.dump(trace, out)
+    else:
+        json.dump(trace, sys.stdout)
+    print(f"{len(events)} events on {len(tasks)} tasks", file=sys.stderr)
+
+
+if __name__ == "__main__":
+    main()